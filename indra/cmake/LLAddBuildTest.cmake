@@ -262,6 +262,51 @@ FUNCTION(LL_ADD_INTEGRATION_TEST
 
 ENDFUNCTION(LL_ADD_INTEGRATION_TEST)
 
+# A benchmark is built like an integration test, from tests/<name>_test.cpp,
+# but only when BUILD_BENCHMARKS is on and it is never run by the build:
+# its output is for human examination. Run BENCHMARK_<name> by hand.
+FUNCTION(LL_ADD_BENCHMARK
+    testname
+    additional_source_files
+    library_dependencies
+    )
+  if(NOT BUILD_BENCHMARKS)
+    return()
+  endif(NOT BUILD_BENCHMARKS)
+
+  SET(source_files
+    tests/${testname}_test.cpp
+    ${CMAKE_SOURCE_DIR}/test/test.cpp
+    ${CMAKE_SOURCE_DIR}/test/lltut.cpp
+    ${additional_source_files}
+    )
+
+  SET(libraries
+    ${library_dependencies}
+    ${BOOST_COROUTINE_LIBRARY}
+    ${BOOST_CONTEXT_LIBRARY}
+    ${BOOST_SYSTEM_LIBRARY}
+    ${PTHREAD_LIBRARY}
+    )
+
+  ADD_EXECUTABLE(BENCHMARK_${testname} ${source_files})
+  SET_TARGET_PROPERTIES(BENCHMARK_${testname} PROPERTIES RUNTIME_OUTPUT_DIRECTORY "${EXE_STAGING_DIR}")
+
+  if(USESYSTEMLIBS)
+    SET_TARGET_PROPERTIES(BENCHMARK_${testname} PROPERTIES COMPILE_FLAGS -I"${TUT_INCLUDE_DIR}")
+  endif(USESYSTEMLIBS)
+
+  if (WINDOWS)
+    LIST(APPEND libraries ole32)
+    SET_TARGET_PROPERTIES(BENCHMARK_${testname}
+        PROPERTIES
+        LINK_FLAGS "/debug /SUBSYSTEM:CONSOLE"
+        )
+  endif (WINDOWS)
+
+  TARGET_LINK_LIBRARIES(BENCHMARK_${testname} ${libraries})
+ENDFUNCTION(LL_ADD_BENCHMARK)
+
 MACRO(SET_TEST_PATH LISTVAR)
   IF(WINDOWS)
     # We typically build/package only Release variants of third-party
@@ -23,6 +23,7 @@ set(SCRIPTS_PREFIX ../scripts)
 set(VIEWER_PREFIX)
 set(INTEGRATION_TESTS_PREFIX)
 option(LL_TESTS "Build and run unit and integration tests (disable for build timing runs to reduce variation" OFF)
+option(BUILD_BENCHMARKS "Also build the benchmarks next to the LL_TESTS tests, to be run by hand" OFF)
 
 # Compiler and toolchain options
 set(COMPILER_JOBS "" CACHE STRING "Amount of simultaneous compiler jobs")
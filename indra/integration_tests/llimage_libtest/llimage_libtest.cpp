@@ -40,6 +40,8 @@
 #include "llimagebmp.h"
 #include "llimagetga.h"
 #include "llimagej2c.h"
+#include "llimageworker.h"
+#include "llthreadpool.h"
 #include "lldir.h"
 #include "lldiriterator.h"
 #include "v4coloru.h"
@@ -99,6 +101,10 @@ static const char USAGE[] = "\n"
 "        Results in <metric>_report.csv\n"
 " -s, --image-stats\n"
 "        Output stats for each input and output image.\n"
+" -bd, --benchmark-decode <n>\n"
+"        Decode all input images with LLImageDecodeThread using 1, 2, 4... up to <n> workers\n"
+"        and print the decode throughput in images/second for each worker count.\n"
+"        0 uses the default worker count for this machine. Nothing is saved.\n"
 "\n";
 
 // true when all image loading is done. Used by metric logging thread to know when to stop the thread.
@@ -315,6 +321,72 @@ void store_output_file(std::list<std::string> &output_filenames, std::list<std::
 	}
 }
 
+// Counts decodes completed by LLImageDecodeThread
+class DecodeCounter : public LLImageDecodeThread::Responder
+{
+public:
+	DecodeCounter(LLAtomicS32& done, LLAtomicS32& failed)
+	:	mDone(done),
+		mFailed(failed)
+	{
+	}
+
+	void completed(bool success, LLImageRaw* raw, LLImageRaw* aux) override
+	{
+		if (!success)
+		{
+			++mFailed;
+		}
+		++mDone;
+	}
+
+private:
+	LLAtomicS32& mDone;
+	LLAtomicS32& mFailed;
+};
+
+// Decode every input file with num_workers decode workers, return images/second
+F64 benchmark_decode(const std::list<std::string> &input_filenames, U32 num_workers, int discard_level)
+{
+	// Load all the files first so that only decoding is timed
+	std::vector<LLPointer<LLImageFormatted> > images;
+	for (const std::string& filename : input_filenames)
+	{
+		LLPointer<LLImageFormatted> image = create_image(filename);
+		if (image.notNull() && image->load(filename))
+		{
+			images.push_back(image);
+		}
+	}
+	if (images.empty())
+	{
+		return 0.0;
+	}
+
+	LLAtomicS32 done(0);
+	LLAtomicS32 failed(0);
+	LLImageDecodeThread decode_thread(true, num_workers);
+
+	LLTimer timer;
+	for (U32 i = 0; i < images.size(); ++i)
+	{
+		// Same priority scheme as the viewer: normal band, later requests first
+		U32 priority = LLQueuedThread::PRIORITY_NORMAL | (i & LLQueuedThread::PRIORITY_LOWBITS);
+		decode_thread.decodeImage(images[i], priority, llmax(discard_level, 0), FALSE, new DecodeCounter(done, failed));
+	}
+	while (done < (S32)images.size())
+	{
+		decode_thread.update(1.f);
+		ms_sleep(1);
+	}
+	F64 elapsed = timer.getElapsedTimeF64();
+
+	std::cout << "Decoded " << images.size() << " images (" << (S32)failed << " failed) with "
+			  << decode_thread.getWorkerCount() << " workers in " << elapsed << "s : "
+			  << (elapsed > 0.0 ? images.size() / elapsed : 0.0) << " images/s" << std::endl;
+	return elapsed > 0.0 ? images.size() / elapsed : 0.0;
+}
+
 // Holds the metric gathering output in a thread safe way
 class LogThread : public LLThread
 {
@@ -358,6 +430,7 @@ int main(int argc, char** argv)
 	int blocks_size = -1;
 	int levels = 0;
 	bool reversible = false;
+	int benchmark_workers = -1;
     std::string filter_name = "";
 
 	// Init whatever is necessary
@@ -559,6 +632,24 @@ int main(int argc, char** argv)
 		{
 			image_stats = true;
 		}
+		else if (!strcmp(argv[arg], "--benchmark-decode") || !strcmp(argv[arg], "-bd"))
+		{
+			std::string value_str;
+			if ((arg + 1) < argc)
+			{
+				value_str = argv[arg+1];
+			}
+			if (((arg + 1) >= argc) || (value_str[0] == '-'))
+			{
+				std::cout << "No valid --benchmark-decode argument given, default worker count will be used" << std::endl;
+				benchmark_workers = 0;
+			}
+			else
+			{
+				benchmark_workers = llmax(atoi(value_str.c_str()), 0);
+				arg += 1;
+			}
+		}
 	}
 		
 	// Check arguments consistency. Exit with proper message if inconsistent.
@@ -582,6 +673,26 @@ int main(int argc, char** argv)
 		fast_timer_log_thread->start();
 	}
     
+	// Decode benchmark replaces the regular load/filter/save pass
+	if (benchmark_workers >= 0)
+	{
+		U32 max_workers = benchmark_workers ? (U32)benchmark_workers : LLThreadPool::getDefaultWorkerCount();
+		// More than one worker decodes on the shared pool, as in the viewer
+		LLThreadPool::initClass(max_workers);
+		for (U32 workers = 1; ; workers *= 2)
+		{
+			workers = llmin(workers, max_workers);
+			benchmark_decode(input_filenames, workers, discard_level);
+			if (workers == max_workers)
+			{
+				break;
+			}
+		}
+		SUBSYSTEM_CLEANUP(LLThreadPool);
+		SUBSYSTEM_CLEANUP(LLImage);
+		return 0;
+	}
+
     // Load the filter once and for all
     LLImageFilter filter(filter_name);
 
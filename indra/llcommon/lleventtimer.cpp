@@ -37,14 +37,18 @@
 //
 //////////////////////////////////////////////////////////////////////////////
 
+std::atomic<U64> LLEventTimer::sNextSerial(0);
+
 LLEventTimer::LLEventTimer(F32 period)
-: mEventTimer()
+: mEventTimer(),
+  mSerial(++sNextSerial)
 {
 	mPeriod = period;
 }
 
 LLEventTimer::LLEventTimer(const LLDate& time)
-: mEventTimer()
+: mEventTimer(),
+  mSerial(++sNextSerial)
 {
 	mPeriod = (F32)(time.secondsSinceEpoch() - LLDate::now().secondsSinceEpoch());
 }
@@ -57,27 +61,53 @@ LLEventTimer::~LLEventTimer()
 //static
 void LLEventTimer::updateClass() 
 {
-	std::list<LLEventTimer*> completed_timers;
-	for (instance_iter iter = beginInstances(), iter_end = endInstances(); iter != iter_end;)
+	// tick() may start new timers, or delete other timers in the snapshot
+	// and start new ones at their address, so each timer is remembered by
+	// address and serial number and looked up again before it is touched.
+	typedef std::pair<LLEventTimer*, U64> timer_id_t;
+	auto find_timer = [](const timer_id_t& id) -> LLEventTimer*
+	{
+		LLEventTimer* timerp = getInstance(id.first);
+		return (timerp && timerp->mSerial == id.second) ? timerp : NULL;
+	};
+
+	std::vector<timer_id_t> timers;
+	{
+		snapshot instances;
+		timers.reserve(instances.size());
+		for (snapshot::iterator iter = instances.begin(), iter_end = instances.end(); iter != iter_end; ++iter)
+		{
+			timers.push_back(timer_id_t(&*iter, iter->mSerial));
+		}
+	}
+
+	std::list<timer_id_t> completed_timers;
+	for (std::vector<timer_id_t>::const_iterator iter = timers.begin(), iter_end = timers.end(); iter != iter_end; ++iter)
 	{
-		LLEventTimer& timer = *iter++;
+		LLEventTimer* timerp = find_timer(*iter);
+		if (!timerp)
+		{
+			continue;
+		}
+		LLEventTimer& timer = *timerp;
 		F32 et = timer.mEventTimer.getElapsedTimeF32();
 		if (timer.mEventTimer.getStarted() && et > timer.mPeriod) {
 			timer.mEventTimer.reset();
 			if ( timer.tick() )
 			{
-				completed_timers.push_back( &timer );
+				completed_timers.push_back( *iter );
 			}
 		}
 	}
 
 	if ( completed_timers.size() > 0 )
 	{
-		for (std::list<LLEventTimer*>::iterator completed_iter = completed_timers.begin(); 
+		for (std::list<timer_id_t>::iterator completed_iter = completed_timers.begin(); 
 			 completed_iter != completed_timers.end(); 
 			 ++completed_iter ) 
 		{
-			delete *completed_iter;
+			// a later tick() may already have deleted it
+			delete find_timer(*completed_iter);
 		}
 	}
 }
@@ -32,6 +32,8 @@
 #include "llinstancetracker.h"
 #include "lltimer.h"
 
+#include <atomic>
+
 // class for scheduling a function to be called at a given frequency (approximate, inprecise)
 class LL_COMMON_API LLEventTimer : public LLInstanceTracker<LLEventTimer>
 {
@@ -50,6 +52,11 @@ public:
 protected:
 	LLTimer mEventTimer;
 	F32 mPeriod;
+
+private:
+	// Tells this timer from one created later at the same address
+	const U64 mSerial;
+	static std::atomic<U64> sNextSerial;
 };
 
 #endif //LL_EVENTTIMER_H
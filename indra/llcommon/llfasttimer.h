@@ -30,6 +30,7 @@
 #include "llpreprocessor.h"
 #include "llinstancetracker.h"
 #include "lltrace.h"
+#include "lltracering.h"
 #include "lltreeiterators.h"
 
 #if LL_WINDOWS
@@ -342,6 +343,11 @@ LL_FORCE_INLINE BlockTimer::~BlockTimer()
 	// we are only tracking self time, so subtract our total time delta from parents
 	mParentTimerData.mChildTime += total_time;
 
+	if (EventRing::isEnabled())
+	{
+		EventRing::record(cur_timer_data->mTimeBlock, mStartTime, total_time);
+	}
+
 	//pop stack
 	*cur_timer_data = mParentTimerData;
 #endif
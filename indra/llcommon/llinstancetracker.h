@@ -29,9 +29,13 @@
 #define LL_LLINSTANCETRACKER_H
 
 #include <map>
+#include <mutex>
+#include <set>
 #include <typeinfo>
+#include <vector>
 
 #include "llatomic.h"
+#include "llopenhashmap.h"
 #include "llstringtable.h"
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost/iterator/indirect_iterator.hpp>
@@ -60,9 +64,14 @@ protected:
 		void incrementDepth();
 		void decrementDepth();
 		U32 getDepth();
+
+		/// Guards the container against threads adding or removing
+		/// instances while another looks one up or takes a snapshot.
+		std::mutex mMutex;
 	private:
 		LLAtomicU32 sIterationNestDepth;
     };
+    typedef std::lock_guard<std::mutex> lock_t;
 };
 
 LL_COMMON_API void assert_main_thread();
@@ -73,16 +82,61 @@ enum EInstanceTrackerAllowKeyCollisions
 	LLInstanceTrackerReplaceOnCollision
 };
 
+/// Container behind an LLInstanceTracker. Ordered storage (std::map/std::set)
+/// iterates in key order; hashed storage (LLOpenHashMap) finds an instance in
+/// constant time, which pays off for classes with many live instances that
+/// are looked up often.
+enum EInstanceTrackerStorage
+{
+	LLInstanceTrackerOrdered,
+	LLInstanceTrackerHashed
+};
+
+template<typename KEY, typename T, EInstanceTrackerStorage STORAGE>
+struct LLInstanceTrackerContainer
+{
+	typedef std::multimap<KEY, T*> type;
+};
+
+template<typename KEY, typename T>
+struct LLInstanceTrackerContainer<KEY, T, LLInstanceTrackerHashed>
+{
+	typedef LLOpenHashMap<KEY, T*> type;
+};
+
+/// the unkeyed tracker looks instances up by their own address
+template<typename T>
+struct LLInstanceTrackerContainer<void, T, LLInstanceTrackerOrdered>
+{
+	typedef std::set<T*> type;
+
+	static void insert(type& set, T* instance) { set.insert(instance); }
+	static T* get(T* entry) { return entry; }
+};
+
+template<typename T>
+struct LLInstanceTrackerContainer<void, T, LLInstanceTrackerHashed>
+{
+	typedef LLOpenHashMap<T*, T*> type;
+
+	static void insert(type& map, T* instance) { map.insert(std::make_pair(instance, instance)); }
+	static T* get(const typename type::value_type& entry) { return entry.second; }
+};
+
 /// This mix-in class adds support for tracking all instances of the specified class parameter T
 /// The (optional) key associates a value of type KEY with a given instance of T, for quick lookup
 /// If KEY is not provided, then instances are stored in a simple set
+/// STORAGE selects the container, see EInstanceTrackerStorage
 /// @NOTE: see explicit specialization below for default KEY==void case
-/// @NOTE: this class is not thread-safe unless used as read-only
-template<typename T, typename KEY = void, EInstanceTrackerAllowKeyCollisions KEY_COLLISION_BEHAVIOR = LLInstanceTrackerErrorOnCollision>
+/// @NOTE: getInstance(), instanceCount() and snapshot may be used while other
+/// threads create and destroy instances; instance_iter and key_iter may not
+template<typename T, typename KEY = void,
+		 EInstanceTrackerAllowKeyCollisions KEY_COLLISION_BEHAVIOR = LLInstanceTrackerErrorOnCollision,
+		 EInstanceTrackerStorage STORAGE = LLInstanceTrackerOrdered>
 class LLInstanceTracker : public LLInstanceTrackerBase
 {
 	typedef LLInstanceTracker<T, KEY> self_t;
-	typedef typename std::multimap<KEY, T*> InstanceMap;
+	typedef typename LLInstanceTrackerContainer<KEY, T, STORAGE>::type InstanceMap;
 	struct StaticData: public StaticBase
 	{
 		InstanceMap sMap;
@@ -175,11 +229,42 @@ public:
 		typename InstanceMap::iterator mIterator;
 	};
 
+	/// Copy of the instances tracked at construction. Unlike instance_iter,
+	/// it stays valid while instances are created or destroyed, on this
+	/// thread or any other. It does not keep the instances alive, so anything
+	/// destroyed after the snapshot was taken must not be touched.
+	class snapshot
+	{
+		typedef std::vector<T*> InstanceVector;
+	public:
+		typedef boost::indirect_iterator<typename InstanceVector::const_iterator> iterator;
+
+		snapshot()
+		{
+			StaticData& data(getStatic());
+			lock_t lock(data.mMutex);
+			mInstances.reserve(data.sMap.size());
+			for (typename InstanceMap::const_iterator it = data.sMap.begin(), end = data.sMap.end();
+				 it != end; ++it)
+			{
+				mInstances.push_back(it->second);
+			}
+		}
+
+		iterator begin() const { return iterator(mInstances.begin()); }
+		iterator end() const { return iterator(mInstances.end()); }
+		size_t size() const { return mInstances.size(); }
+
+	private:
+		InstanceVector mInstances;
+	};
+
 	static T* getInstance(const KEY& k)
 	{
-		const InstanceMap& map(getMap_());
-		typename InstanceMap::const_iterator found = map.find(k);
-		return (found == map.end()) ? NULL : found->second;
+		StaticData& data(getStatic());
+		lock_t lock(data.mMutex);
+		typename InstanceMap::const_iterator found = data.sMap.find(k);
+		return (found == data.sMap.end()) ? NULL : found->second;
 	}
 
 	static instance_iter beginInstances() 
@@ -194,7 +279,9 @@ public:
 
 	static S32 instanceCount() 
 	{ 
-		return getMap_().size(); 
+		StaticData& data(getStatic());
+		lock_t lock(data.mMutex);
+		return data.sMap.size(); 
 	}
 
 	static key_iter beginKeys()
@@ -231,10 +318,11 @@ private:
 	void add_(const KEY& key) 
 	{ 
 		mInstanceKey = key; 
-		InstanceMap& map = getMap_();
-		typename InstanceMap::iterator insertion_point_it = map.lower_bound(key);
-		if (insertion_point_it != map.end() 
-			&& insertion_point_it->first == key)
+		StaticData& data(getStatic());
+		lock_t lock(data.mMutex);
+		InstanceMap& map = data.sMap;
+		typename InstanceMap::iterator insertion_point_it = map.find(key);
+		if (insertion_point_it != map.end())
 		{ // found existing entry with that key
 			switch(KEY_COLLISION_BEHAVIOR)
 			{
@@ -256,12 +344,14 @@ private:
 		}
 		else
 		{ // new key
-			map.insert(insertion_point_it, std::make_pair(key, static_cast<T*>(this)));
+			map.insert(std::make_pair(key, static_cast<T*>(this)));
 		}
 	}
 	void remove_()
 	{
-		InstanceMap& map = getMap_();
+		StaticData& data(getStatic());
+		lock_t lock(data.mMutex);
+		InstanceMap& map = data.sMap;
 		typename InstanceMap::iterator iter = map.find(mInstanceKey);
 		if (iter != map.end())
 		{
@@ -274,12 +364,13 @@ private:
 };
 
 /// explicit specialization for default case where KEY is void
-/// use a simple std::set<T*>
-template<typename T, EInstanceTrackerAllowKeyCollisions KEY_COLLISION_BEHAVIOR>
-class LLInstanceTracker<T, void, KEY_COLLISION_BEHAVIOR> : public LLInstanceTrackerBase
+/// use a simple std::set<T*>, or a hash set of T* with hashed STORAGE
+template<typename T, EInstanceTrackerAllowKeyCollisions KEY_COLLISION_BEHAVIOR, EInstanceTrackerStorage STORAGE>
+class LLInstanceTracker<T, void, KEY_COLLISION_BEHAVIOR, STORAGE> : public LLInstanceTrackerBase
 {
 	typedef LLInstanceTracker<T, void> self_t;
-	typedef typename std::set<T*> InstanceSet;
+	typedef LLInstanceTrackerContainer<void, T, STORAGE> container_t;
+	typedef typename container_t::type InstanceSet;
 	struct StaticData: public StaticBase
 	{
 		InstanceSet sSet;
@@ -299,11 +390,45 @@ public:
 	 */
 	static T* getInstance(T* k)
 	{
-		const InstanceSet& set(getSet_());
-		typename InstanceSet::const_iterator found = set.find(k);
-		return (found == set.end())? NULL : *found;
+		StaticData& data(getStatic());
+		lock_t lock(data.mMutex);
+		typename InstanceSet::const_iterator found = data.sSet.find(k);
+		return (found == data.sSet.end())? NULL : container_t::get(*found);
+	}
+	static S32 instanceCount()
+	{
+		StaticData& data(getStatic());
+		lock_t lock(data.mMutex);
+		return data.sSet.size();
 	}
-	static S32 instanceCount() { return getSet_().size(); }
+
+	/// Copy of the instances tracked at construction; see the keyed
+	/// LLInstanceTracker::snapshot.
+	class snapshot
+	{
+		typedef std::vector<T*> InstanceVector;
+	public:
+		typedef boost::indirect_iterator<typename InstanceVector::const_iterator> iterator;
+
+		snapshot()
+		{
+			StaticData& data(getStatic());
+			lock_t lock(data.mMutex);
+			mInstances.reserve(data.sSet.size());
+			for (typename InstanceSet::const_iterator it = data.sSet.begin(), end = data.sSet.end();
+				 it != end; ++it)
+			{
+				mInstances.push_back(container_t::get(*it));
+			}
+		}
+
+		iterator begin() const { return iterator(mInstances.begin()); }
+		iterator end() const { return iterator(mInstances.end()); }
+		size_t size() const { return mInstances.size(); }
+
+	private:
+		InstanceVector mInstances;
+	};
 
 	class instance_iter : public boost::iterator_facade<instance_iter, T, boost::forward_traversal_tag>
 	{
@@ -342,7 +467,7 @@ public:
 
 		T& dereference() const
 		{
-			return **mIterator;
+			return *container_t::get(*mIterator);
 		}
 
 		typename InstanceSet::iterator mIterator;
@@ -355,8 +480,7 @@ protected:
 	LLInstanceTracker()
 	{
 		// make sure static data outlives all instances
-		getStatic();
-		getSet_().insert(static_cast<T*>(this));
+		add_();
 	}
 	virtual ~LLInstanceTracker()
 	{
@@ -364,12 +488,22 @@ protected:
 #ifdef LL_DEBUG
 		llassert_always(getStatic().getDepth() == 0);
 #endif
-		getSet_().erase(static_cast<T*>(this));
+		StaticData& data(getStatic());
+		lock_t lock(data.mMutex);
+		data.sSet.erase(static_cast<T*>(this));
 	}
 
 	LLInstanceTracker(const LLInstanceTracker& other)
 	{
-		getSet_().insert(static_cast<T*>(this));
+		add_();
+	}
+
+private:
+	void add_()
+	{
+		StaticData& data(getStatic());
+		lock_t lock(data.mMutex);
+		container_t::insert(data.sSet, static_cast<T*>(this));
 	}
 };
 
@@ -0,0 +1,429 @@
+/**
+ * @file lllockfreequeue.h
+ * @brief Bounded lock-free single/multi producer queues and a blocking adapter
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLLOCKFREEQUEUE_H
+#define LL_LLLOCKFREEQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "llmutex.h"
+
+namespace LLLockFree
+{
+	// Keep the producer and consumer indices on separate cache lines
+	enum { CACHE_LINE_SIZE = 64 };
+
+	inline size_t round_up_pow2(size_t n)
+	{
+		size_t result = 2;
+		while (result < n)
+		{
+			result <<= 1;
+		}
+		return result;
+	}
+}
+
+//============================================================================
+// LLSPSCQueue
+//
+// Bounded ring buffer for exactly one producer thread and one consumer
+// thread. tryPush() must only ever be called from the producer and tryPop()
+// from the consumer; neither ever blocks or takes a lock.
+//
+// A ring can be closed, after which tryPush() fails until it is reopened.
+// LLBlockingQueue uses that to divert producers while it is overflowing.
+//
+// T must be default constructible and movable. Popped slots are reset to T()
+// so that the queue does not keep references alive.
+
+template<typename T>
+class LLSPSCQueue
+{
+public:
+	typedef T value_type;
+
+	// capacity is rounded up to a power of 2
+	explicit LLSPSCQueue(size_t capacity) :
+		mBuffer(LLLockFree::round_up_pow2(capacity)),
+		mMask(mBuffer.size() - 1),
+		mHead(0),
+		mTail(0),
+		mClosed(false)
+	{
+	}
+
+	// PRODUCER THREAD. Returns false if the queue is full or closed.
+	bool tryPush(const T& value)
+	{
+		const size_t tail = mTail.load(std::memory_order_relaxed);
+		if (mClosed.load(std::memory_order_relaxed) || tail - mHead.load(std::memory_order_acquire) > mMask)
+		{
+			return false;
+		}
+		mBuffer[tail & mMask] = value;
+		mTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// CONSUMER THREAD. Returns false if the queue is empty.
+	bool tryPop(T& value)
+	{
+		const size_t head = mHead.load(std::memory_order_relaxed);
+		if (head == mTail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		T& slot = mBuffer[head & mMask];
+		value = std::move(slot);
+		slot = T();
+		mHead.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Exact when called from either end, a snapshot otherwise
+	bool empty() const
+	{
+		return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+	}
+
+	// Only the producer may close the ring, anyone may reopen it
+	void close() { mClosed.store(true, std::memory_order_relaxed); }
+	void reopen() { mClosed.store(false, std::memory_order_relaxed); }
+	bool isClosed() const { return mClosed.load(std::memory_order_relaxed); }
+
+	size_t capacity() const { return mBuffer.size(); }
+
+private:
+	LLSPSCQueue(const LLSPSCQueue&);
+	LLSPSCQueue& operator=(const LLSPSCQueue&);
+
+	std::vector<T> mBuffer;
+	const size_t mMask;
+	char mPad0[LLLockFree::CACHE_LINE_SIZE];
+	std::atomic<size_t> mHead;	// next slot to pop, written by the consumer
+	char mPad1[LLLockFree::CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> mTail;	// next slot to push, written by the producer
+	std::atomic<bool> mClosed;
+	char mPad2[LLLockFree::CACHE_LINE_SIZE];
+};
+
+//============================================================================
+// LLMPSCQueue
+//
+// Bounded ring buffer for any number of producer threads and one consumer
+// thread. Each cell carries a sequence number telling producers and the
+// consumer whose turn it is, so producers only contend on a single
+// compare-and-swap of the tail index. Elements pushed by one producer are
+// popped in the order that producer pushed them.
+//
+// Closing sets the top bit of the tail index, so a producer can never claim
+// a cell after the ring has been closed.
+//
+// Same requirements on T as LLSPSCQueue.
+
+template<typename T>
+class LLMPSCQueue
+{
+public:
+	typedef T value_type;
+
+	// capacity is rounded up to a power of 2
+	explicit LLMPSCQueue(size_t capacity) :
+		mCapacity(LLLockFree::round_up_pow2(capacity)),
+		mMask(mCapacity - 1),
+		mCells(new Cell[mCapacity]),
+		mTail(0),
+		mHead(0)
+	{
+		for (size_t i = 0; i < mCapacity; ++i)
+		{
+			mCells[i].mSequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	// ANY THREAD. Returns false if the queue is full or closed.
+	bool tryPush(const T& value)
+	{
+		size_t pos = mTail.load(std::memory_order_relaxed);
+		Cell* cell;
+		for (;;)
+		{
+			if (pos & CLOSED_BIT)
+			{
+				return false;
+			}
+			cell = &mCells[pos & mMask];
+			const size_t seq = cell->mSequence.load(std::memory_order_acquire);
+			const std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+			if (diff == 0)
+			{
+				// Cell is free for this lap, claim it
+				if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (diff < 0)
+			{
+				// Consumer has not freed this cell yet
+				return false;
+			}
+			else
+			{
+				// Another producer got here first
+				pos = mTail.load(std::memory_order_relaxed);
+			}
+		}
+		cell->mValue = value;
+		cell->mSequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// CONSUMER THREAD. Returns false if the queue is empty, or if the oldest
+	// claimed cell is still being written by its producer.
+	bool tryPop(T& value)
+	{
+		Cell& cell = mCells[mHead & mMask];
+		const size_t seq = cell.mSequence.load(std::memory_order_acquire);
+		if ((std::ptrdiff_t)seq - (std::ptrdiff_t)(mHead + 1) < 0)
+		{
+			return false;
+		}
+		value = std::move(cell.mValue);
+		cell.mValue = T();
+		// Hand the cell to the producer one lap ahead
+		cell.mSequence.store(mHead + mCapacity, std::memory_order_release);
+		++mHead;
+		return true;
+	}
+
+	// CONSUMER THREAD. A cell that has been claimed but not written yet
+	// counts as queued, so tryPop() can fail while this returns false.
+	bool empty() const
+	{
+		return mHead == (mTail.load(std::memory_order_acquire) & ~CLOSED_BIT);
+	}
+
+	void close() { mTail.fetch_or(CLOSED_BIT, std::memory_order_relaxed); }
+	void reopen() { mTail.fetch_and(~CLOSED_BIT, std::memory_order_relaxed); }
+	bool isClosed() const { return (mTail.load(std::memory_order_relaxed) & CLOSED_BIT) != 0; }
+
+	size_t capacity() const { return mCapacity; }
+
+private:
+	LLMPSCQueue(const LLMPSCQueue&);
+	LLMPSCQueue& operator=(const LLMPSCQueue&);
+
+	static const size_t CLOSED_BIT = ~(~size_t(0) >> 1);
+
+	struct Cell
+	{
+		std::atomic<size_t> mSequence;
+		T mValue;
+	};
+
+	const size_t mCapacity;
+	const size_t mMask;
+	std::unique_ptr<Cell[]> mCells;
+	char mPad0[LLLockFree::CACHE_LINE_SIZE];
+	std::atomic<size_t> mTail;	// shared by all producers
+	char mPad1[LLLockFree::CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	size_t mHead;				// consumer only
+	char mPad2[LLLockFree::CACHE_LINE_SIZE - sizeof(size_t)];
+};
+
+//============================================================================
+// LLBlockingQueue
+//
+// Wraps one of the bounded queues above with the two things the lock-free
+// rings cannot do on their own: accept elements when the ring is full and
+// let the consumer sleep while it is empty.
+//
+// - push() never fails. When the ring is full it is closed and elements go
+//   to a locked overflow list instead. The consumer reopens the ring only
+//   once it has emptied it and taken the whole list, so everything in the
+//   ring predates everything in the list, which predates everything pushed
+//   after reopening, and each producer's elements stay in order.
+// - The consumer only touches the condition when it is about to sleep, and
+//   producers only touch it when a consumer is actually sleeping, so the
+//   common push/pop path is lock free.
+//
+// The threading rules of QUEUE apply: with LLSPSCQueue there must be a
+// single producer thread. There is always a single consumer thread.
+
+template<typename QUEUE>
+class LLBlockingQueue
+{
+public:
+	typedef typename QUEUE::value_type value_type;
+
+	explicit LLBlockingQueue(size_t capacity) :
+		mRing(capacity),
+		mOverflowCount(0),
+		mWaiters(0),
+		mWakeRequested(false)
+	{
+	}
+
+	// PRODUCER THREAD(S)
+	void push(const value_type& value)
+	{
+		if (!mRing.tryPush(value))
+		{
+			pushOverflow(value);
+		}
+
+		// Pairs with the fence in waitForData(): either the consumer sees
+		// this element before sleeping or we see it as a waiter.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (mWaiters.load(std::memory_order_relaxed) > 0)
+		{
+			mCondition.lock();
+			mCondition.signal();
+			mCondition.unlock();
+		}
+	}
+
+	// CONSUMER THREAD. Returns false if nothing is queued.
+	bool tryPop(value_type& value)
+	{
+		if (!mDrained.empty())
+		{
+			value = std::move(mDrained.front());
+			mDrained.pop_front();
+			return true;
+		}
+		if (mRing.tryPop(value))
+		{
+			return true;
+		}
+		return popOverflow(value);
+	}
+
+	// CONSUMER THREAD. Appends everything queued to out, returns the count.
+	template<typename CONTAINER>
+	size_t popAll(CONTAINER& out)
+	{
+		size_t count = 0;
+		value_type value;
+		while (tryPop(value))
+		{
+			out.push_back(std::move(value));
+			++count;
+		}
+		return count;
+	}
+
+	// CONSUMER THREAD. Sleeps until something is queued or wake() is called.
+	// May return with nothing queued.
+	void waitForData()
+	{
+		if (!empty())
+		{
+			return;
+		}
+
+		mCondition.lock();
+		mWaiters.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		while (empty() && !mWakeRequested)
+		{
+			mCondition.wait();
+		}
+		mWakeRequested = false;
+		mWaiters.fetch_sub(1, std::memory_order_relaxed);
+		mCondition.unlock();
+	}
+
+	// ANY THREAD. Makes a current or the next waitForData() return.
+	void wake()
+	{
+		mCondition.lock();
+		mWakeRequested = true;
+		mCondition.broadcast();
+		mCondition.unlock();
+	}
+
+	// CONSUMER THREAD
+	bool empty() const
+	{
+		return mDrained.empty() && mRing.empty() && mOverflowCount.load(std::memory_order_acquire) == 0;
+	}
+
+private:
+	LLBlockingQueue(const LLBlockingQueue&);
+	LLBlockingQueue& operator=(const LLBlockingQueue&);
+
+	// Closing and reopening the ring only ever happen under mOverflowMutex
+	void pushOverflow(const value_type& value)
+	{
+		LLMutexLock lock(&mOverflowMutex);
+		// The consumer may have reopened the ring or freed a slot since
+		if (!mRing.isClosed() && mRing.tryPush(value))
+		{
+			return;
+		}
+		mRing.close();
+		mOverflow.push_back(value);
+		mOverflowCount.fetch_add(1, std::memory_order_release);
+	}
+
+	// CONSUMER THREAD
+	bool popOverflow(value_type& value)
+	{
+		// While anything is in the overflow list the ring stays closed, so
+		// once it is empty it stays empty until we reopen it.
+		if (mOverflowCount.load(std::memory_order_acquire) == 0 || !mRing.empty())
+		{
+			return false;
+		}
+		{
+			LLMutexLock lock(&mOverflowMutex);
+			mDrained.swap(mOverflow);
+			mOverflowCount.store(0, std::memory_order_release);
+			mRing.reopen();
+		}
+		value = std::move(mDrained.front());
+		mDrained.pop_front();
+		return true;
+	}
+
+	QUEUE mRing;
+	LLMutex mOverflowMutex;
+	std::deque<value_type> mOverflow;
+	std::atomic<size_t> mOverflowCount;
+	std::deque<value_type> mDrained;	// taken from mOverflow, consumer only
+	LLCondition mCondition;
+	std::atomic<S32> mWaiters;
+	bool mWakeRequested;
+};
+
+#endif // LL_LLLOCKFREEQUEUE_H
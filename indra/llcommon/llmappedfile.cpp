@@ -0,0 +1,223 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file llmappedfile.cpp
+ * @brief A file mapped into memory
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "linden_common.h"
+
+#include "llmappedfile.h"
+#include "llstring.h"
+
+LLMappedFile::LLMappedFile()
+:	mData(NULL),
+	mSize(0),
+	mWritable(false),
+#if LL_WINDOWS
+	mFile(INVALID_HANDLE_VALUE),
+	mMapping(NULL)
+#else
+	mFile(-1)
+#endif
+{
+}
+
+LLMappedFile::~LLMappedFile()
+{
+	close();
+}
+
+#if LL_WINDOWS
+
+bool LLMappedFile::open(const std::string& filename, size_t min_size, bool writable)
+{
+	close();
+
+	llutf16string utf16filename = utf8str_to_utf16str(filename);
+	mFile = CreateFileW((LPCWSTR)utf16filename.c_str(),
+						writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+						FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+						writable ? OPEN_ALWAYS : OPEN_EXISTING,
+						FILE_ATTRIBUTE_NORMAL, NULL);
+	if (mFile == INVALID_HANDLE_VALUE)
+	{
+		LL_WARNS() << "Unable to open " << filename << ": " << GetLastError() << LL_ENDL;
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(mFile, &file_size))
+	{
+		LL_WARNS() << "Unable to get the size of " << filename << ": " << GetLastError() << LL_ENDL;
+		close();
+		return false;
+	}
+	U64 size = llmax((U64)file_size.QuadPart, (U64)min_size);
+	if (!size || (!writable && (U64)file_size.QuadPart < min_size))
+	{
+		close();
+		return false;
+	}
+
+	// a writable mapping larger than the file extends the file
+	mMapping = CreateFileMappingW(mFile, NULL, writable ? PAGE_READWRITE : PAGE_WRITECOPY,
+								  (DWORD)(size >> 32), (DWORD)size, NULL);
+	if (!mMapping)
+	{
+		LL_WARNS() << "Unable to map " << filename << ": " << GetLastError() << LL_ENDL;
+		close();
+		return false;
+	}
+	mData = (U8*)MapViewOfFile(mMapping, writable ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, (SIZE_T)size);
+	if (!mData)
+	{
+		LL_WARNS() << "Unable to map " << filename << ": " << GetLastError() << LL_ENDL;
+		close();
+		return false;
+	}
+	mSize = (size_t)size;
+	mWritable = writable;
+	return true;
+}
+
+void LLMappedFile::close()
+{
+	if (mData)
+	{
+		UnmapViewOfFile(mData);
+		mData = NULL;
+	}
+	if (mMapping)
+	{
+		CloseHandle(mMapping);
+		mMapping = NULL;
+	}
+	if (mFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+	mSize = 0;
+	mWritable = false;
+}
+
+bool LLMappedFile::flush(bool wait)
+{
+	if (!mData || !mWritable)
+	{
+		return true;
+	}
+	if (!FlushViewOfFile(mData, 0))
+	{
+		return false;
+	}
+	return !wait || FlushFileBuffers(mFile);
+}
+
+#else // !LL_WINDOWS
+
+bool LLMappedFile::open(const std::string& filename, size_t min_size, bool writable)
+{
+	close();
+
+	mFile = ::open(filename.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+	if (mFile < 0)
+	{
+		if (writable || errno != ENOENT)
+		{
+			LL_WARNS() << "Unable to open " << filename << ": " << strerror(errno) << LL_ENDL;
+		}
+		return false;
+	}
+
+	struct stat file_status;
+	if (fstat(mFile, &file_status))
+	{
+		LL_WARNS() << "Unable to get the size of " << filename << ": " << strerror(errno) << LL_ENDL;
+		close();
+		return false;
+	}
+	size_t size = llmax((size_t)file_status.st_size, min_size);
+	if (!size || (!writable && (size_t)file_status.st_size < min_size))
+	{
+		close();
+		return false;
+	}
+	if (writable && (size_t)file_status.st_size < size && ftruncate(mFile, size))
+	{
+		LL_WARNS() << "Unable to grow " << filename << " to " << size << " bytes: " << strerror(errno) << LL_ENDL;
+		close();
+		return false;
+	}
+
+	void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, writable ? MAP_SHARED : MAP_PRIVATE, mFile, 0);
+	if (data == MAP_FAILED)
+	{
+		LL_WARNS() << "Unable to map " << filename << ": " << strerror(errno) << LL_ENDL;
+		close();
+		return false;
+	}
+	mData = (U8*)data;
+	mSize = size;
+	mWritable = writable;
+	return true;
+}
+
+void LLMappedFile::close()
+{
+	if (mData)
+	{
+		munmap(mData, mSize);
+		mData = NULL;
+	}
+	if (mFile >= 0)
+	{
+		::close(mFile);
+		mFile = -1;
+	}
+	mSize = 0;
+	mWritable = false;
+}
+
+bool LLMappedFile::flush(bool wait)
+{
+	if (!mData || !mWritable)
+	{
+		return true;
+	}
+	return !msync(mData, mSize, wait ? MS_SYNC : MS_ASYNC);
+}
+
+#endif // !LL_WINDOWS
@@ -0,0 +1,79 @@
+/**
+ * @file llmappedfile.h
+ * @brief A file mapped into memory
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMAPPEDFILE_H
+#define LL_LLMAPPEDFILE_H
+
+#include <string>
+
+#include "stdtypes.h"
+
+// Maps a whole file into memory. Reading or writing the mapping only pages
+// in, and later writes back, the pages that were touched, which makes it a
+// good fit for large fixed-record index files that are updated a few records
+// at a time.
+//
+// A writable mapping is shared with the file. A read-only mapping is
+// private copy-on-write: the caller may still modify the memory, but the
+// changes never reach the file, so code written for the writable case keeps
+// working when a second viewer instance has the cache open read-only.
+class LL_COMMON_API LLMappedFile
+{
+public:
+	LLMappedFile();
+	~LLMappedFile();
+
+	// Writable: creates filename if needed and grows it to at least
+	// min_size bytes. Read-only: filename must already exist and be at
+	// least min_size bytes long. Either way the whole file is mapped.
+	bool open(const std::string& filename, size_t min_size, bool writable);
+	void close();
+
+	bool isOpen() const { return mData != NULL; }
+	bool isWritable() const { return mWritable; }
+	U8* getData() const { return mData; }
+	size_t getSize() const { return mSize; }
+
+	// Starts writing modified pages back to the file, waiting for them to
+	// reach the disk if wait is true.
+	bool flush(bool wait = false);
+
+private:
+	LLMappedFile(const LLMappedFile&);
+	LLMappedFile& operator=(const LLMappedFile&);
+
+	U8* mData;
+	size_t mSize;
+	bool mWritable;
+#if LL_WINDOWS
+	void* mFile;
+	void* mMapping;
+#else
+	int mFile;
+#endif
+};
+
+#endif // LL_LLMAPPEDFILE_H
@@ -0,0 +1,291 @@
+/**
+ * @file llopenhashmap.h
+ * @brief Open addressing hash map with linear probing
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLOPENHASHMAP_H
+#define LL_LLOPENHASHMAP_H
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include "stdtypes.h"
+
+//============================================================================
+// LLOpenHashMap
+//
+// Unique-key hash map that keeps its entries in one flat array. Lookups
+// hash the key, then walk forward from the home slot until they find the key
+// or an empty slot, so a hit is usually a single cache line rather than the
+// chain of tree nodes std::map visits. The table grows by doubling when it
+// is three quarters full, and erase() shifts the following entries back
+// instead of leaving tombstones, so lookups never slow down as entries come
+// and go.
+//
+// The interface is the subset of std::map that LLInstanceTracker needs.
+// Iteration order is unspecified. Any insert() or erase() invalidates all
+// iterators.
+//
+// KEY and VALUE must be default constructible; erased slots are reset so
+// the table does not keep key storage alive.
+
+template<typename KEY, typename VALUE, typename HASH = std::hash<KEY> >
+class LLOpenHashMap
+{
+public:
+	typedef KEY key_type;
+	typedef VALUE mapped_type;
+	// the key is not const so that entries can be moved within the table;
+	// callers must not modify it
+	typedef std::pair<KEY, VALUE> value_type;
+
+private:
+	struct Slot
+	{
+		Slot() : mHash(0) {}
+
+		size_t mHash;	// 0 marks an empty slot
+		value_type mValue;
+	};
+	typedef std::vector<Slot> slot_vec_t;
+
+	template<typename SLOT, typename V>
+	class iter_t : public boost::iterator_facade<iter_t<SLOT, V>, V, boost::forward_traversal_tag>
+	{
+	public:
+		iter_t() : mSlot(NULL), mEnd(NULL) {}
+		iter_t(SLOT* slot, SLOT* end) : mSlot(slot), mEnd(end) { skipEmpty(); }
+
+		// iterator converts to const_iterator
+		template<typename OTHER_SLOT, typename OTHER_V>
+		iter_t(const iter_t<OTHER_SLOT, OTHER_V>& other) : mSlot(other.mSlot), mEnd(other.mEnd) {}
+
+	private:
+		friend class boost::iterator_core_access;
+		template<typename, typename> friend class iter_t;
+		friend class LLOpenHashMap;
+
+		void skipEmpty()
+		{
+			while (mSlot != mEnd && !mSlot->mHash)
+			{
+				++mSlot;
+			}
+		}
+		void increment() { ++mSlot; skipEmpty(); }
+		template<typename OTHER_SLOT, typename OTHER_V>
+		bool equal(const iter_t<OTHER_SLOT, OTHER_V>& other) const { return mSlot == other.mSlot; }
+		V& dereference() const { return mSlot->mValue; }
+
+		SLOT* mSlot;
+		SLOT* mEnd;
+	};
+
+public:
+	typedef iter_t<Slot, value_type> iterator;
+	typedef iter_t<const Slot, const value_type> const_iterator;
+
+	LLOpenHashMap() : mSize(0), mMask(0) {}
+
+	size_t size() const { return mSize; }
+	bool empty() const { return !mSize; }
+
+	iterator begin() { return iterator(firstSlot(), lastSlot()); }
+	iterator end() { return iterator(lastSlot(), lastSlot()); }
+	const_iterator begin() const { return const_iterator(firstSlot(), lastSlot()); }
+	const_iterator end() const { return const_iterator(lastSlot(), lastSlot()); }
+
+	iterator find(const KEY& key)
+	{
+		size_t index = findIndex(key, hashOf(key));
+		return index == mSlots.size() ? end() : iterator(&mSlots[index], lastSlot());
+	}
+
+	const_iterator find(const KEY& key) const
+	{
+		size_t index = findIndex(key, hashOf(key));
+		return index == mSlots.size() ? end() : const_iterator(&mSlots[index], lastSlot());
+	}
+
+	size_t count(const KEY& key) const { return find(key) == end() ? 0 : 1; }
+
+	// Returns the existing entry and false if the key is already present.
+	std::pair<iterator, bool> insert(const value_type& value)
+	{
+		size_t hash = hashOf(value.first);
+		size_t index = findIndex(value.first, hash);
+		if (index != mSlots.size())
+		{
+			return std::make_pair(iterator(&mSlots[index], lastSlot()), false);
+		}
+
+		if ((mSize + 1) * 4 > mSlots.size() * 3)
+		{
+			rehash(mSlots.empty() ? MIN_CAPACITY : mSlots.size() * 2);
+		}
+		index = hash & mMask;
+		while (mSlots[index].mHash)
+		{
+			index = (index + 1) & mMask;
+		}
+		mSlots[index].mHash = hash;
+		mSlots[index].mValue = value;
+		++mSize;
+		return std::make_pair(iterator(&mSlots[index], lastSlot()), true);
+	}
+
+	void erase(iterator it)
+	{
+		eraseIndex(it.mSlot - firstSlot());
+	}
+
+	size_t erase(const KEY& key)
+	{
+		size_t index = findIndex(key, hashOf(key));
+		if (index == mSlots.size())
+		{
+			return 0;
+		}
+		eraseIndex(index);
+		return 1;
+	}
+
+	void clear()
+	{
+		slot_vec_t().swap(mSlots);
+		mSize = 0;
+		mMask = 0;
+	}
+
+	// Make room for count entries without growing again.
+	void reserve(size_t count)
+	{
+		size_t capacity = MIN_CAPACITY;
+		while (capacity * 3 < count * 4)
+		{
+			capacity <<= 1;
+		}
+		if (capacity > mSlots.size())
+		{
+			rehash(capacity);
+		}
+	}
+
+private:
+	enum { MIN_CAPACITY = 16 };
+
+	Slot* firstSlot() { return mSlots.empty() ? NULL : &mSlots[0]; }
+	Slot* lastSlot() { return firstSlot() + mSlots.size(); }
+	const Slot* firstSlot() const { return mSlots.empty() ? NULL : &mSlots[0]; }
+	const Slot* lastSlot() const { return firstSlot() + mSlots.size(); }
+
+	// Spread the bits of the user hash: std::hash of a pointer or an integer
+	// is the value itself, whose low bits are mostly equal.
+	static size_t hashOf(const KEY& key)
+	{
+		U64 hash = (U64)HASH()(key);
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		size_t result = (size_t)hash;
+		return result ? result : 1;
+	}
+
+	// Returns mSlots.size() if key is not present.
+	size_t findIndex(const KEY& key, size_t hash) const
+	{
+		if (mSlots.empty())
+		{
+			return 0;
+		}
+		size_t index = hash & mMask;
+		while (mSlots[index].mHash)
+		{
+			if (mSlots[index].mHash == hash && mSlots[index].mValue.first == key)
+			{
+				return index;
+			}
+			index = (index + 1) & mMask;
+		}
+		return mSlots.size();
+	}
+
+	void eraseIndex(size_t hole)
+	{
+		// Move back every following entry of the run that could not sit in
+		// its home slot while the hole was occupied.
+		size_t next = hole;
+		while (true)
+		{
+			next = (next + 1) & mMask;
+			Slot& candidate = mSlots[next];
+			if (!candidate.mHash)
+			{
+				break;
+			}
+			size_t home = candidate.mHash & mMask;
+			// is home cyclically outside (hole, next]?
+			bool movable = (hole <= next) ? (home <= hole || home > next)
+										  : (home <= hole && home > next);
+			if (movable)
+			{
+				mSlots[hole].mHash = candidate.mHash;
+				mSlots[hole].mValue = std::move(candidate.mValue);
+				hole = next;
+			}
+		}
+		mSlots[hole].mHash = 0;
+		mSlots[hole].mValue = value_type();
+		--mSize;
+	}
+
+	void rehash(size_t capacity)
+	{
+		slot_vec_t old(capacity);
+		old.swap(mSlots);
+		mMask = capacity - 1;
+		for (typename slot_vec_t::iterator it = old.begin(); it != old.end(); ++it)
+		{
+			if (it->mHash)
+			{
+				size_t index = it->mHash & mMask;
+				while (mSlots[index].mHash)
+				{
+					index = (index + 1) & mMask;
+				}
+				mSlots[index].mHash = it->mHash;
+				mSlots[index].mValue = std::move(it->mValue);
+			}
+		}
+	}
+
+	slot_vec_t mSlots;
+	size_t mSize;
+	size_t mMask;
+};
+
+#endif // LL_LLOPENHASHMAP_H
@@ -42,6 +42,8 @@
 
 #include "llsd.h"
 
+#include <boost/thread/thread.hpp>
+
 #if LL_MSVC && _M_X64
 #      define LL_X86_64 1
 #      define LL_X86 1
@@ -859,3 +861,9 @@ std::string LLProcessorInfo::getCPUFamilyName() const { return mImpl->getCPUFami
 std::string LLProcessorInfo::getCPUBrandName() const { return mImpl->getCPUBrandName(); }
 std::string LLProcessorInfo::getCPUFeatureDescription() const { return mImpl->getCPUFeatureDescription(); }
 
+U32 LLProcessorInfo::getCPUThreadCount() const
+{
+	U32 count = boost::thread::hardware_concurrency();
+	return count ? count : 1;
+}
+
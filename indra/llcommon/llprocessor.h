@@ -43,6 +43,7 @@ public:
 	std::string getCPUFamilyName() const;
 	std::string getCPUBrandName() const;
 	std::string getCPUFeatureDescription() const;
+	U32 getCPUThreadCount() const; // hardware threads, 1 if unknown
 private:
 	LLProcessorInfoImpl* mImpl;
 };
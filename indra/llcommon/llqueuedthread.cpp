@@ -28,21 +28,35 @@
 #include "linden_common.h"
 #include "llqueuedthread.h"
 
+#include <memory>
+
 #include "llstl.h"
+#include "llthreadpool.h"
 #include "lltimer.h"	// ms_sleep()
 #include "lltracethreadrecorder.h"
 
 //============================================================================
 
 // MAIN THREAD
-LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded, bool should_pause) :
+LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded, bool should_pause, LLThreadPool* pool, U32 max_pool_tasks) :
 	LLThread(name),
 	mThreaded(threaded),
     mStarted(false),
 	mIdleThread(true),
-    mNextHandle(0)
+    mNextHandle(0),
+	mPool(threaded ? pool : nullptr),
+	mPoolTasks(0),
+	mMaxPoolTasks(max_pool_tasks),
+	mPoolTasksRunning(0),
+	mPoolTasksHeld(0)
 {
-	if (mThreaded)
+	if (mPool)
+	{
+		// No thread of our own, but the queue is live
+		mStatus = RUNNING;
+		mStarted = true;
+	}
+	else if (mThreaded)
 	{
 		if(should_pause)
 		{
@@ -69,7 +83,33 @@ void LLQueuedThread::shutdown()
 	setQuitting();
 
 	unpause(); // MAIN THREAD
-	if (mThreaded)
+	if (mPool)
+	{
+		// Requests still queued are aborted by the pool tasks already posted
+		// for them. A task dropped by a pool that is shutting down counts as
+		// finished once the pool lets go of it, see postPoolTask().
+		S32 timeout = 100;
+		for ( ; timeout>0; timeout--)
+		{
+			if (mPoolTasks <= 0)
+			{
+				break;
+			}
+			ms_sleep(100);
+		}
+		if (timeout == 0)
+		{
+			// Workers would be left running on a deleted object
+			LL_ERRS() << "~LLQueuedThread (" << mName << ") timed out waiting for thread pool with "
+					  << (S32)mPoolTasks << " tasks outstanding!" << LL_ENDL;
+		}
+		lockData();
+		mPoolRetries.clear();
+		mPoolTasksHeld = 0;
+		unlockData();
+		mStatus = STOPPED;
+	}
+	else if (mThreaded)
 	{
 		S32 timeout = 100;
 		for ( ; timeout>0; timeout--)
@@ -134,11 +174,24 @@ S32 LLQueuedThread::updateQueue(F32 max_time_ms)
 	// Frame Update
 	if (mThreaded)
 	{
+		if (mPool)
+		{
+			// Give requests that were not done last pass another one, at
+			// the priority they were put back with
+			std::vector<U32> retries;
+			lockData();
+			retries.swap(mPoolRetries);
+			unlockData();
+			for (std::vector<U32>::const_iterator iter = retries.begin(); iter != retries.end(); ++iter)
+			{
+				postPoolTask(*iter);
+			}
+		}
 		pending = getPending();
-		if(pending > 0)
+		if(pending > 0 && !mPool)
 		{
-		unpause();
-	}
+			unpause();
+		}
 	}
 	else
 	{
@@ -155,6 +208,10 @@ S32 LLQueuedThread::updateQueue(F32 max_time_ms)
 void LLQueuedThread::incQueue()
 {
 	// Something has been added to the queue
+	if (mPool)
+	{
+		return; // see addRequest()
+	}
 	if (!isPaused())
 	{
 		if (mThreaded)
@@ -182,7 +239,7 @@ void LLQueuedThread::waitOnPending()
 	{
 		update(0);
 
-		if (mIdleThread)
+		if (mPool ? (mPoolTasks <= 0 && getPending() <= 0) : (bool)mIdleThread)
 		{
 			break;
 		}
@@ -240,7 +297,14 @@ bool LLQueuedThread::addRequest(QueuedRequest* req)
 #endif
 	unlockData();
 
-	incQueue();
+	if (mPool)
+	{
+		postPoolTask(req->getPriority());
+	}
+	else
+	{
+		incQueue();
+	}
 
 	return true;
 }
@@ -465,8 +529,15 @@ S32 LLQueuedThread::processNextRequest()
 			lockData();
 			req->setStatus(STATUS_QUEUED);
 			mRequestQueue.insert(req);
+			if (mPool)
+			{
+				// Never sleep on a shared worker. Reposting right away would
+				// spin the pool on a request that is waiting for something,
+				// leave it for the next update() instead.
+				mPoolRetries.push_back(req->getPriority());
+			}
 			unlockData();
-			if (mThreaded && start_priority < PRIORITY_NORMAL)
+			if (mThreaded && !mPool && start_priority < PRIORITY_NORMAL)
 			{
 				ms_sleep(1); // sleep the thread a little
 			}
@@ -525,6 +596,68 @@ void LLQueuedThread::run()
 	LL_INFOS() << "LLQueuedThread " << mName << " EXITING." << LL_ENDL;
 }
 
+namespace
+{
+	// Shared by every copy of a posted task. The count drops when the last
+	// copy goes away, after the task ran or when the pool dropped it.
+	class PoolTaskCount
+	{
+	public:
+		PoolTaskCount(LLAtomicS32& count) : mCount(count) { ++mCount; }
+		~PoolTaskCount() { --mCount; }
+
+	private:
+		LLAtomicS32& mCount;
+	};
+}
+
+// May be called from any thread
+void LLQueuedThread::postPoolTask(U32 priority)
+{
+	lockData();
+	if (mMaxPoolTasks && mPoolTasksRunning >= mMaxPoolTasks)
+	{
+		// Posted by the next task to finish, see processPoolTask()
+		++mPoolTasksHeld;
+		unlockData();
+		return;
+	}
+	++mPoolTasksRunning;
+	unlockData();
+
+	// Each task processes whichever request is at the front of mRequestQueue
+	// when it runs, so the order in which the pool runs them does not matter.
+	std::shared_ptr<PoolTaskCount> count = std::make_shared<PoolTaskCount>(mPoolTasks);
+	mPool->post([this, count]() { processPoolTask(); }, priority);
+}
+
+// Runs on a POOL WORKER thread
+void LLQueuedThread::processPoolTask()
+{
+	processNextRequest();
+
+	// Pass our slot on to a request that was held back by mMaxPoolTasks
+	bool post_held = false;
+	U32 priority = PRIORITY_NORMAL;
+	lockData();
+	--mPoolTasksRunning;
+	if (mPoolTasksHeld > 0)
+	{
+		--mPoolTasksHeld;
+		post_held = true;
+		if (!mRequestQueue.empty())
+		{
+			priority = (*mRequestQueue.begin())->getPriority();
+		}
+	}
+	unlockData();
+
+	if (post_held)
+	{
+		postPoolTask(priority);
+	}
+}
+
 // virtual
 void LLQueuedThread::startThread()
 {
@@ -31,15 +31,25 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "llatomic.h"
 
 #include "llthread.h"
 #include "llsimplehash.h"
 
+class LLThreadPool;
+
 //============================================================================
 // Note: ~LLQueuedThread is O(N) N=# of queued threads, assumed to be small
 //   It is assumed that LLQueuedThreads are rarely created/destroyed.
+//
+// A threaded LLQueuedThread may be backed by an LLThreadPool instead of its own
+// thread. Requests are still ordered by priority and addressed by handle, but
+// are processed by however many pool workers are free, so processRequest() must
+// not assume it is the only request in progress. A pooled queue never starts its
+// own thread: pause() has no effect and startThread(), endThread() and
+// threadedUpdate() are not called.
 
 class LL_COMMON_API LLQueuedThread : public LLThread
 {
@@ -149,7 +159,9 @@ public:
 	static handle_t nullHandle() { return handle_t(0); }
 	
 public:
-	LLQueuedThread(const std::string& name, bool threaded = true, bool should_pause = false);
+	// With a pool, at most max_pool_tasks requests are processed at once
+	// (0 = as many as the pool has workers).
+	LLQueuedThread(const std::string& name, bool threaded = true, bool should_pause = false, LLThreadPool* pool = nullptr, U32 max_pool_tasks = 0);
 	virtual ~LLQueuedThread();
 	void shutdown() override;
 	
@@ -164,6 +176,9 @@ private:
 	virtual void endThread(void);
 	virtual void threadedUpdate(void);
 
+	void postPoolTask(U32 priority);
+	void processPoolTask();
+
 protected:
 	handle_t generateHandle();
 	bool addRequest(QueuedRequest* req);
@@ -181,6 +196,8 @@ public:
 
 	virtual S32 getPending();
 	bool getThreaded() { return mThreaded ? true : false; }
+	LLThreadPool* getThreadPool() const { return mPool; }
+	U32 getMaxPoolTasks() const { return mMaxPoolTasks; }
 
 	// Request accessors
 	status_t getRequestStatus(handle_t handle);
@@ -208,6 +225,13 @@ protected:
 	request_hash_t mRequestHash;
 
 	handle_t mNextHandle;
+
+	LLThreadPool* mPool; // if set, requests are processed by pool workers instead of our own thread
+	LLAtomicS32 mPoolTasks; // tasks posted to mPool that have not finished yet
+	const U32 mMaxPoolTasks; // 0 = no limit
+	U32 mPoolTasksRunning; // counted against mMaxPoolTasks (data lock)
+	U32 mPoolTasksHeld; // requests waiting for a task slot (data lock)
+	std::vector<U32> mPoolRetries; // priorities of requests put back unfinished, posted again by the next update() (data lock)
 };
 
 #endif // LL_LLQUEUEDTHREAD_H
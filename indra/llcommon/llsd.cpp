@@ -38,6 +38,12 @@
 #include "llsdserialize.h"
 #include "stringize.h"
 
+#if LLSD_COMPACT_STORAGE
+#include <memory>
+#include <set>
+#include <type_traits>
+#endif
+
 #ifndef LL_RELEASE_FOR_DOWNLOAD
 #define NAME_UNNAMED_NAMESPACE
 #endif
@@ -79,7 +85,11 @@ class LLSD::Impl
 protected:
 	Impl();
 
-	enum StaticAllocationMarker { STATIC_USAGE_COUNT = 0xFFFFFFFF };
+	enum StaticAllocationMarker
+	{
+		STATIC_USAGE_COUNT = 0xFFFFFFFF,
+		INLINE_USAGE_COUNT = 0xFFFFFFFE		///< the LLSD_COMPACT_STORAGE stand-ins
+	};
 	Impl(StaticAllocationMarker);
 		///< This constructor is used for static objects and causes the
 		//   suppresses adjusting the debugging counters when they are
@@ -87,7 +97,8 @@ protected:
 		
 	virtual ~Impl();
 	
-	bool shared() const							{ return (mUseCount > 1) && (mUseCount != STATIC_USAGE_COUNT); }
+	bool isStatic() const						{ return mUseCount >= INLINE_USAGE_COUNT; }
+	bool shared() const							{ return (mUseCount > 1) && !isStatic(); }
 	
 	U32 mUseCount;
 
@@ -143,7 +154,11 @@ public:
 	virtual const LLSD& ref(Integer) const		{ return undef(); }
 
 	virtual LLSD::map_const_iterator beginMap() const { return endMap(); }
+#if LLSD_COMPACT_STORAGE
+	virtual LLSD::map_const_iterator endMap() const { static const LLSD::MapList empty = { nullptr, nullptr }; return LLSD::map_const_iterator(&empty, nullptr); }
+#else
 	virtual LLSD::map_const_iterator endMap() const { static const std::map<String, LLSD> empty; return empty.end(); }
+#endif
 	virtual LLSD::array_const_iterator beginArray() const { return endArray(); }
 	virtual LLSD::array_const_iterator endArray() const { static const std::vector<LLSD> empty; return empty.end(); }
 
@@ -160,6 +175,11 @@ public:
 	static Impl& getImpl(LLSD& llsd)				{ return safe(reinterpret_cast<Impl*>(llsd.impl)); }
 
 	static const LLSD& undef();
+
+#if LLSD_COMPACT_STORAGE
+	static bool isInline(const Impl* impl)			{ return impl && impl->mUseCount == INLINE_USAGE_COUNT; }
+		///< true when impl only stands in for a value held in LLSD::mInline
+#endif
 	
 	static U32 sAllocationCount;
 	static U32 sOutstandingCount;
@@ -184,6 +204,7 @@ namespace
 
 	public:
 		ImplBase(DataRef value) : mValue(value) { }
+		ImplBase(DataRef value, StaticAllocationMarker marker) : Impl(marker), mValue(value) { }
 
 		LLSD::Type type() const override { return T; }
 
@@ -207,6 +228,7 @@ namespace
 	{
 	public:
 		ImplBoolean(LLSD::Boolean v) : Base(v) { }
+		ImplBoolean(LLSD::Boolean v, StaticAllocationMarker marker) : Base(v, marker) { }
 
 		LLSD::Boolean	asBoolean() const override { return mValue; }
 		LLSD::Integer	asInteger() const override { return mValue ? 1 : 0; }
@@ -228,6 +250,7 @@ namespace
 	{
 	public:
 		ImplInteger(LLSD::Integer v) : Base(v) { }
+		ImplInteger(LLSD::Integer v, StaticAllocationMarker marker) : Base(v, marker) { }
 
 		LLSD::Boolean	asBoolean() const override { return mValue != 0; }
 		LLSD::Integer	asInteger() const override { return mValue; }
@@ -244,6 +267,7 @@ namespace
 	{
 	public:
 		ImplReal(LLSD::Real v) : Base(v) { }
+		ImplReal(LLSD::Real v, StaticAllocationMarker marker) : Base(v, marker) { }
 
 		LLSD::Boolean	asBoolean() const override;
 		LLSD::Integer	asInteger() const override;
@@ -310,6 +334,7 @@ namespace
 	{
 	public:
 		ImplUUID(const LLSD::UUID& v) : Base(v) { }
+		ImplUUID(const LLSD::UUID& v, StaticAllocationMarker marker) : Base(v, marker) { }
 
 		LLSD::String	asString() const override { return mValue.asString(); }
 		LLSD::UUID		asUUID() const override { return mValue; }
@@ -360,6 +385,344 @@ namespace
 	};
 
 
+#if LLSD_COMPACT_STORAGE
+	class ImplInline : public LLSD::Impl
+		///< LLSD::impl points at one of these, one static instance per type,
+		//   while a Boolean, Integer, Real or UUID value is held in
+		//   LLSD::mInline.  Like the undefined Impl it is never counted or
+		//   deleted, and it answers nothing but type().
+	{
+	public:
+		template<LLSD::Type T>
+		static LLSD::Impl* instance()
+		{
+			// Never destroyed, static LLSDs may still point here at exit
+			static ImplInline* sInstance = new ImplInline(T);
+			return sInstance;
+		}
+
+		LLSD::Type type() const override { return mType; }
+
+		class View
+			///< Presents the value of an LLSD through the Impl subclass that
+			//   would have held it, built on the stack for an inline value.
+		{
+		public:
+			View(const LLSD::Impl* impl, const LLSD::Inline& value);
+			~View();
+
+			const LLSD::Impl* operator->() const { return mImpl; }
+
+		private:
+			const LLSD::Impl* mImpl;
+			bool mConstructed;
+			std::aligned_union<0, ImplBoolean, ImplInteger, ImplReal, ImplUUID>::type mStorage;
+		};
+
+	private:
+		ImplInline(LLSD::Type type) : Impl(INLINE_USAGE_COUNT), mType(type) { }
+
+		LLSD::Type mType;
+	};
+
+	ImplInline::View::View(const LLSD::Impl* impl, const LLSD::Inline& value)
+		: mImpl(&safe(impl)),
+		  mConstructed(isInline(impl))
+	{
+		if (!mConstructed)
+		{
+			return;
+		}
+
+		// The static marker keeps these out of the allocation counters
+		void* storage = &mStorage;
+		switch (impl->type())
+		{
+		case LLSD::TypeBoolean:
+			mImpl = new (storage) ImplBoolean(value.mBoolean, STATIC_USAGE_COUNT);
+			break;
+		case LLSD::TypeInteger:
+			mImpl = new (storage) ImplInteger(value.mInteger, STATIC_USAGE_COUNT);
+			break;
+		case LLSD::TypeReal:
+			mImpl = new (storage) ImplReal(value.mReal, STATIC_USAGE_COUNT);
+			break;
+		default:
+			{
+				LLUUID id;
+				memcpy(id.mData, value.mUUID, UUID_BYTES);
+				mImpl = new (storage) ImplUUID(id, STATIC_USAGE_COUNT);
+			}
+			break;
+		}
+	}
+
+	ImplInline::View::~View()
+	{
+		if (!mConstructed)
+		{
+			return;
+		}
+
+		// ~Impl is protected, destroy through the subclass
+		switch (mImpl->type())
+		{
+		case LLSD::TypeBoolean:
+			static_cast<const ImplBoolean*>(mImpl)->~ImplBoolean();
+			break;
+		case LLSD::TypeInteger:
+			static_cast<const ImplInteger*>(mImpl)->~ImplInteger();
+			break;
+		case LLSD::TypeReal:
+			static_cast<const ImplReal*>(mImpl)->~ImplReal();
+			break;
+		default:
+			static_cast<const ImplUUID*>(mImpl)->~ImplUUID();
+			break;
+		}
+	}
+
+
+	class ImplMap : public LLSD::Impl
+	{
+	private:
+		typedef LLSD::MapNode Node;
+		typedef std::pair<const LLSD::String, LLSD> Entry;
+
+		struct KeyLess
+		{
+			typedef void is_transparent;
+			bool operator()(const Node* a, const Node* b) const				{ return a->mEntry.first < b->mEntry.first; }
+			bool operator()(const Node* a, const LLSD::String& k) const		{ return a->mEntry.first < k; }
+			bool operator()(const LLSD::String& k, const Node* b) const		{ return k < b->mEntry.first; }
+		};
+		typedef std::set<Node*, KeyLess> Index;
+
+		// Small maps are searched along the list, larger ones through mIndex
+		static const S32 INDEX_THRESHOLD = 16;
+
+		LLSD::MapList mList;
+		std::unique_ptr<Index> mIndex;
+		S32 mSize;
+
+	protected:
+		ImplMap(const ImplMap& other);
+
+	public:
+		ImplMap();
+		~ImplMap();
+
+		ImplMap& makeMap(LLSD::Impl*&) override;
+
+		LLSD::Type type() const override { return LLSD::TypeMap; }
+
+		LLSD::Boolean asBoolean() const override { return mSize != 0; }
+
+		bool has(const LLSD::String&) const override; 
+
+		using LLSD::Impl::get; // Unhiding get(LLSD::Integer)
+		using LLSD::Impl::erase; // Unhiding erase(LLSD::Integer)
+		using LLSD::Impl::ref; // Unhiding ref(LLSD::Integer)
+		LLSD get(const LLSD::String&) const override; 
+		void insert(const LLSD::String& k, const LLSD& v);
+		void erase(const LLSD::String&) override;
+		              LLSD& ref(const LLSD::String&);
+		const LLSD& ref(const LLSD::String&) const override;
+
+		int size() const override { return mSize; }
+
+		LLSD::map_iterator beginMap() { return LLSD::map_iterator(&mList, mList.mFirst); }
+		LLSD::map_iterator endMap() { return LLSD::map_iterator(&mList, nullptr); }
+		LLSD::map_const_iterator beginMap() const override { return LLSD::map_const_iterator(&mList, mList.mFirst); }
+		LLSD::map_const_iterator endMap() const override { return LLSD::map_const_iterator(&mList, nullptr); }
+
+		void dumpStats() const override;
+		void calcStats(S32 type_counts[], S32 share_counts[]) const override;
+
+	private:
+		Node* find(const LLSD::String& k) const;
+		Node* lowerBound(const LLSD::String& k) const;
+			///< first node not less than k, nullptr if there is none
+		Node* insertBefore(Node* next, const LLSD::String& k, const LLSD& v);
+	};
+
+	ImplMap::ImplMap()
+		: mList(),
+		  mSize(0)
+	{
+	}
+
+	ImplMap::ImplMap(const ImplMap& other)
+		: mList(),
+		  mSize(0)
+	{
+		for (const Node* node = other.mList.mFirst; node; node = node->mNext)
+		{
+			insertBefore(nullptr, node->mEntry.first, node->mEntry.second);
+		}
+	}
+
+	ImplMap::~ImplMap()
+	{
+		Node* node = mList.mFirst;
+		while (node)
+		{
+			Node* next = node->mNext;
+			delete node;
+			node = next;
+		}
+	}
+
+	ImplMap& ImplMap::makeMap(LLSD::Impl*& var)
+	{
+		if (shared())
+		{
+			ImplMap* i = new ImplMap(*this);
+			Impl::assign(var, i);
+			return *i;
+		}
+		else
+		{
+			return *this;
+		}
+	}
+
+	ImplMap::Node* ImplMap::find(const LLSD::String& k) const
+	{
+		Node* node = lowerBound(k);
+		return (node && node->mEntry.first == k) ? node : nullptr;
+	}
+
+	ImplMap::Node* ImplMap::lowerBound(const LLSD::String& k) const
+	{
+		// Keys usually arrive in order from the parsers, check the end first
+		if (!mList.mLast || mList.mLast->mEntry.first < k)
+		{
+			return nullptr;
+		}
+		if (mIndex)
+		{
+			return *mIndex->lower_bound(k);
+		}
+		Node* node = mList.mFirst;
+		while (node->mEntry.first < k)
+		{
+			node = node->mNext;
+		}
+		return node;
+	}
+
+	ImplMap::Node* ImplMap::insertBefore(Node* next, const LLSD::String& k, const LLSD& v)
+	{
+		Node* node = new Node{ Entry(k, v), nullptr, next };
+
+		node->mPrev = next ? next->mPrev : mList.mLast;
+		(node->mPrev ? node->mPrev->mNext : mList.mFirst) = node;
+		(next ? next->mPrev : mList.mLast) = node;
+		++mSize;
+
+		if (mIndex)
+		{
+			if (next)
+			{
+				mIndex->insert(node);
+			}
+			else
+			{
+				mIndex->insert(mIndex->end(), node);
+			}
+		}
+		else if (mSize > INDEX_THRESHOLD)
+		{
+			mIndex.reset(new Index);
+			for (Node* n = mList.mFirst; n; n = n->mNext)
+			{
+				mIndex->insert(mIndex->end(), n);
+			}
+		}
+		return node;
+	}
+
+	bool ImplMap::has(const LLSD::String& k) const
+	{
+		return find(k) != nullptr;
+	}
+	
+	LLSD ImplMap::get(const LLSD::String& k) const
+	{
+		Node* node = find(k);
+		return node ? node->mEntry.second : LLSD();
+	}
+	
+	void ImplMap::insert(const LLSD::String& k, const LLSD& v)
+	{
+		Node* next = lowerBound(k);
+		if (!next || next->mEntry.first != k)
+		{
+			insertBefore(next, k, v);
+		}
+	}
+	
+	void ImplMap::erase(const LLSD::String& k)
+	{
+		Node* node = find(k);
+		if (!node)
+		{
+			return;
+		}
+
+		if (mIndex)
+		{
+			mIndex->erase(node);
+		}
+		(node->mPrev ? node->mPrev->mNext : mList.mFirst) = node->mNext;
+		(node->mNext ? node->mNext->mPrev : mList.mLast) = node->mPrev;
+		--mSize;
+
+		// k may be the key being destroyed, don't use it after this
+		delete node;
+	}
+	
+	LLSD& ImplMap::ref(const LLSD::String& k)
+	{
+		Node* next = lowerBound(k);
+		if (next && next->mEntry.first == k)
+		{
+			return next->mEntry.second;
+		}
+		return insertBefore(next, k, LLSD())->mEntry.second;
+	}
+	
+	const LLSD& ImplMap::ref(const LLSD::String& k) const
+	{
+		Node* node = find(k);
+		return node ? node->mEntry.second : undef();
+	}
+
+	void ImplMap::dumpStats() const
+	{
+		std::cout << "Map size: " << mSize << std::endl;
+
+		std::cout << "LLSD Net Objects: " << llsd::sLLSDNetObjects << std::endl;
+		std::cout << "LLSD allocations: " << llsd::sLLSDAllocationCount << std::endl;
+
+		std::cout << "LLSD::Impl Net Objects: " << sOutstandingCount << std::endl;
+		std::cout << "LLSD::Impl allocations: " << sAllocationCount << std::endl;
+
+		Impl::dumpStats();
+	}
+
+	void ImplMap::calcStats(S32 type_counts[], S32 share_counts[]) const
+	{
+		for (const Node* node = mList.mFirst; node; node = node->mNext)
+		{
+			Impl::calcStats(node->mEntry.second, type_counts, share_counts);
+		}
+
+		// Add in the values for this map
+		Impl::calcStats(type_counts, share_counts);
+	}
+#else
 	class ImplMap : public LLSD::Impl
 	{
 	private:
@@ -479,6 +842,7 @@ namespace
 		// Add in the values for this map
 		Impl::calcStats(type_counts, share_counts);
 	}
+#endif // LLSD_COMPACT_STORAGE
 
 
 	class ImplArray : public LLSD::Impl
@@ -637,23 +1001,26 @@ LLSD::Impl::Impl()
 	++sOutstandingCount;
 }
 
-LLSD::Impl::Impl(StaticAllocationMarker)
-	: mUseCount(0)
+LLSD::Impl::Impl(StaticAllocationMarker marker)
+	: mUseCount(marker)
 {
 }
 
 LLSD::Impl::~Impl()
 {
-	--sOutstandingCount;
+	if (!isStatic())
+	{
+		--sOutstandingCount;
+	}
 }
 
 void LLSD::Impl::reset(Impl*& var, Impl* impl)
 {
-	if (impl && impl->mUseCount != STATIC_USAGE_COUNT) 
+	if (impl && !impl->isStatic()) 
 	{
 		++impl->mUseCount;
 	}
-	if (var  &&  var->mUseCount != STATIC_USAGE_COUNT && --var->mUseCount == 0)
+	if (var  &&  !var->isStatic() && --var->mUseCount == 0)
 	{
 		delete var;
 	}
@@ -805,7 +1172,19 @@ LLSD::LLSD() : impl(nullptr)					{ ALLOC_LLSD_OBJECT; }
 LLSD::~LLSD()							{ FREE_LLSD_OBJECT; Impl::reset(impl, nullptr); }
 
 LLSD::LLSD(const LLSD& other) : impl(nullptr) { ALLOC_LLSD_OBJECT;  assign(other); }
+#if LLSD_COMPACT_STORAGE
+void LLSD::assign(const LLSD& other)
+{
+	// Copy first, other may belong to the Impl that is about to be released
+	if (Impl::isInline(other.impl))
+	{
+		mInline = other.mInline;
+	}
+	Impl::assign(impl, other.impl);
+}
+#else
 void LLSD::assign(const LLSD& other)	{ Impl::assign(impl, other.impl); }
+#endif
 
 
 void LLSD::clear()						{ Impl::assignUndefined(impl); }
@@ -826,16 +1205,32 @@ LLSD::LLSD(const Binary& v) : impl(nullptr)	{ ALLOC_LLSD_OBJECT;	assign(v); }
 LLSD::LLSD(F32 v) : impl(nullptr)				{ ALLOC_LLSD_OBJECT;	assign((Real)v); }
 
 // Scalar Assignment
+#if LLSD_COMPACT_STORAGE
+void LLSD::assign(Boolean v)			{ mInline.mBoolean = v;	Impl::reset(impl, ImplInline::instance<TypeBoolean>()); }
+void LLSD::assign(Integer v)			{ mInline.mInteger = v;	Impl::reset(impl, ImplInline::instance<TypeInteger>()); }
+void LLSD::assign(Real v)				{ mInline.mReal = v;	Impl::reset(impl, ImplInline::instance<TypeReal>()); }
+void LLSD::assign(const UUID& v)		{ memcpy(mInline.mUUID, v.mData, UUID_BYTES);	Impl::reset(impl, ImplInline::instance<TypeUUID>()); }
+#else
 void LLSD::assign(Boolean v)			{ safe(impl).assign(impl, v); }
 void LLSD::assign(Integer v)			{ safe(impl).assign(impl, v); }
 void LLSD::assign(Real v)				{ safe(impl).assign(impl, v); }
-void LLSD::assign(const String& v)		{ safe(impl).assign(impl, v); }
 void LLSD::assign(const UUID& v)		{ safe(impl).assign(impl, v); }
+#endif
+void LLSD::assign(const String& v)		{ safe(impl).assign(impl, v); }
 void LLSD::assign(const Date& v)		{ safe(impl).assign(impl, v); }
 void LLSD::assign(const URI& v)			{ safe(impl).assign(impl, v); }
 void LLSD::assign(const Binary& v)		{ safe(impl).assign(impl, v); }
 
 // Scalar Accessors
+#if LLSD_COMPACT_STORAGE
+LLSD::Boolean	LLSD::asBoolean() const	{ return ImplInline::View(impl, mInline)->asBoolean(); }
+LLSD::Integer	LLSD::asInteger() const	{ return ImplInline::View(impl, mInline)->asInteger(); }
+LLSD::Real		LLSD::asReal() const	{ return ImplInline::View(impl, mInline)->asReal(); }
+LLSD::String	LLSD::asString() const	{ return ImplInline::View(impl, mInline)->asString(); }
+LLSD::UUID		LLSD::asUUID() const	{ return ImplInline::View(impl, mInline)->asUUID(); }
+LLSD::Date		LLSD::asDate() const	{ return ImplInline::View(impl, mInline)->asDate(); }
+LLSD::URI		LLSD::asURI() const		{ return ImplInline::View(impl, mInline)->asURI(); }
+#else
 LLSD::Boolean	LLSD::asBoolean() const	{ return safe(impl).asBoolean(); }
 LLSD::Integer	LLSD::asInteger() const	{ return safe(impl).asInteger(); }
 LLSD::Real		LLSD::asReal() const	{ return safe(impl).asReal(); }
@@ -843,6 +1238,7 @@ LLSD::String	LLSD::asString() const	{ return safe(impl).asString(); }
 LLSD::UUID		LLSD::asUUID() const	{ return safe(impl).asUUID(); }
 LLSD::Date		LLSD::asDate() const	{ return safe(impl).asDate(); }
 LLSD::URI		LLSD::asURI() const		{ return safe(impl).asURI(); }
+#endif
 const LLSD::Binary&	LLSD::asBinary() const	{ return safe(impl).asBinary(); }
 
 const LLSD::String& LLSD::asStringRef() const { return safe(impl).asStringRef(); }
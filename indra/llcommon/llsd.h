@@ -27,6 +27,7 @@
 #ifndef LL_LLSD_NEW_H
 #define LL_LLSD_NEW_H
 
+#include <iterator>
 #include <map>
 #include <string>
 #include <vector>
@@ -147,6 +148,17 @@
 // Normally undefined, used for diagnostics
 //#define LLSD_DEBUG_INFO	1
 
+// Set to 1 to build LLSD with compact storage: Boolean, Integer, Real and
+// UUID values are held in the LLSD object itself instead of a separately
+// allocated Impl, and map entries are linked in key order, searched in place
+// while the map is small and through an index once it grows.  sizeof(LLSD)
+// grows from one pointer to three.  Map iterators are then LLSD::MapIterator
+// rather than std::map iterators, with the same interface and the same
+// stability: inserting or erasing one key never moves another entry.
+#ifndef LLSD_COMPACT_STORAGE
+#define LLSD_COMPACT_STORAGE 0
+#endif
+
 class LL_COMMON_API LLSD
 {
 public:
@@ -313,8 +325,16 @@ public:
 	//@{
 		int size() const;
 
+#if LLSD_COMPACT_STORAGE
+		class MapNode;
+		struct MapList { MapNode* mFirst; MapNode* mLast; };
+		template<typename ENTRY> class MapIterator;
+		typedef MapIterator<std::pair<const String, LLSD> >			map_iterator;
+		typedef MapIterator<const std::pair<const String, LLSD> >	map_const_iterator;
+#else
 		typedef std::map<String, LLSD>::iterator		map_iterator;
 		typedef std::map<String, LLSD>::const_iterator	map_const_iterator;
+#endif
 		
 		map_iterator		beginMap();
 		map_iterator		endMap();
@@ -392,8 +412,20 @@ public:
 	//@{
 public:
 		class Impl;
+#if LLSD_COMPACT_STORAGE
+		union Inline
+		{
+			Boolean	mBoolean;
+			Integer	mInteger;
+			Real	mReal;
+			U8		mUUID[UUID_BYTES];
+		};
+#endif
 private:
 		Impl* impl;
+#if LLSD_COMPACT_STORAGE
+		Inline mInline;		///< Boolean, Integer, Real or UUID value when impl is a stand-in
+#endif
 		friend class LLSD::Impl;
 	//@}
 
@@ -414,6 +446,52 @@ public:
 
 LL_COMMON_API std::ostream& operator<<(std::ostream& s, const LLSD& llsd);
 
+#if LLSD_COMPACT_STORAGE
+/// One map entry, linked to its neighbours in key order
+class LLSD::MapNode
+{
+public:
+	std::pair<const LLSD::String, LLSD> mEntry;
+	MapNode* mPrev;
+	MapNode* mNext;
+};
+
+/// Bidirectional iterator over a map's entries in key order. Like a std::map
+/// iterator it stays valid until its own entry is erased.
+template<typename ENTRY>
+class LLSD::MapIterator
+{
+public:
+	typedef std::bidirectional_iterator_tag			iterator_category;
+	typedef std::pair<const LLSD::String, LLSD>		value_type;
+	typedef std::ptrdiff_t							difference_type;
+	typedef ENTRY*									pointer;
+	typedef ENTRY&									reference;
+
+	MapIterator() : mList(nullptr), mNode(nullptr) { }
+	MapIterator(const MapList* list, MapNode* node) : mList(list), mNode(node) { }
+	// Also converts map_iterator to map_const_iterator
+	MapIterator(const MapIterator<value_type>& other) : mList(other.mList), mNode(other.mNode) { }
+
+	reference operator*() const		{ return mNode->mEntry; }
+	pointer operator->() const		{ return &mNode->mEntry; }
+
+	MapIterator& operator++()		{ mNode = mNode->mNext; return *this; }
+	MapIterator operator++(int)		{ MapIterator prev(*this); ++*this; return prev; }
+	MapIterator& operator--()		{ mNode = mNode ? mNode->mPrev : mList->mLast; return *this; }
+	MapIterator operator--(int)		{ MapIterator next(*this); --*this; return next; }
+
+	friend bool operator==(const MapIterator& a, const MapIterator& b)	{ return a.mNode == b.mNode; }
+	friend bool operator!=(const MapIterator& a, const MapIterator& b)	{ return a.mNode != b.mNode; }
+
+private:
+	template<typename> friend class MapIterator;
+
+	const MapList* mList;	///< for decrementing from the end
+	MapNode* mNode;			///< nullptr at the end
+};
+#endif // LLSD_COMPACT_STORAGE
+
 namespace llsd
 {
 
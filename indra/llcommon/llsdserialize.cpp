@@ -1218,6 +1218,362 @@ bool LLSDBinaryParser::parseString(
 }
 
 
+/**
+ * LLSDBinaryBufferReader
+ *
+ * Parses binary LLSD straight out of a contiguous buffer. Accepts exactly
+ * what LLSDBinaryParser::doParse() accepts and returns the same counts, but
+ * bounds every read against the end of the buffer instead of going through
+ * an istream, and builds each string, blob and array directly from the
+ * buffer without the stream parser's scratch copies.
+ */
+namespace
+{
+class LLSDBinaryBufferReader
+{
+public:
+	LLSDBinaryBufferReader(const U8* buf, size_t size) :
+		mCur(buf),
+		mEnd(buf + size)
+	{
+	}
+
+	S32 parse(LLSD& data);
+
+	size_t remaining() const { return mEnd - mCur; }
+
+private:
+	bool getChar(char& c)
+	{
+		if (mCur == mEnd) return false;
+		c = (char)*mCur++;
+		return true;
+	}
+
+	bool readBytes(void* out, size_t size)
+	{
+		if (remaining() < size) return false;
+		memcpy(out, mCur, size);	 /*Flawfinder: ignore*/
+		mCur += size;
+		return true;
+	}
+
+	// 4 byte network order size, rejected if larger than what is left
+	bool readSize(S32& size)
+	{
+		U32 size_nbo = 0;
+		if (!readBytes(&size_nbo, sizeof(U32))) return false;
+		size = (S32)ntohl(size_nbo);
+		return size >= 0 && (size_t)size <= remaining();
+	}
+
+	bool readString(std::string& value)
+	{
+		S32 size = 0;
+		if (!readSize(size)) return false;
+		value.assign((const char*)mCur, size);
+		mCur += size;
+		return true;
+	}
+
+	bool readDelimitedString(std::string& value, char delim);
+	S32 parseMap(LLSD& map);
+	S32 parseArray(LLSD& array);
+
+	const U8* mCur;
+	const U8* const mEnd;
+};
+
+S32 LLSDBinaryBufferReader::parse(LLSD& data)
+{
+	char c;
+	if (!getChar(c))
+	{
+		return 0;
+	}
+	S32 parse_count = 1;
+	bool ok = true;
+	switch (c)
+	{
+	case '{':
+	{
+		S32 child_count = parseMap(data);
+		if (child_count == LLSDParser::PARSE_FAILURE)
+		{
+			ok = false;
+		}
+		else
+		{
+			parse_count += child_count;
+		}
+		break;
+	}
+
+	case '[':
+	{
+		S32 child_count = parseArray(data);
+		if (child_count == LLSDParser::PARSE_FAILURE)
+		{
+			ok = false;
+		}
+		else
+		{
+			parse_count += child_count;
+		}
+		break;
+	}
+
+	case '!':
+		data.clear();
+		break;
+
+	case '0':
+		data = false;
+		break;
+
+	case '1':
+		data = true;
+		break;
+
+	case 'i':
+	{
+		U32 value_nbo = 0;
+		ok = readBytes(&value_nbo, sizeof(U32));
+		data = (S32)ntohl(value_nbo);
+		break;
+	}
+
+	case 'r':
+	{
+		F64 real_nbo = 0.0;
+		ok = readBytes(&real_nbo, sizeof(F64));
+		data = ll_ntohd(real_nbo);
+		break;
+	}
+
+	case 'u':
+	{
+		LLUUID id;
+		ok = readBytes(id.mData, UUID_BYTES);
+		data = id;
+		break;
+	}
+
+	case '\'':
+	case '"':
+	{
+		std::string value;
+		ok = readDelimitedString(value, c);
+		data = value;
+		break;
+	}
+
+	case 's':
+	{
+		std::string value;
+		ok = readString(value);
+		data = value;
+		break;
+	}
+
+	case 'l':
+	{
+		std::string value;
+		ok = readString(value);
+		data = LLURI(value);
+		break;
+	}
+
+	case 'd':
+	{
+		F64 real = 0.0;
+		ok = readBytes(&real, sizeof(F64));
+		data = LLDate(real);
+		break;
+	}
+
+	case 'b':
+	{
+		S32 size = 0;
+		ok = readSize(size);
+		if (ok)
+		{
+			data = LLSD::Binary(mCur, mCur + size);
+			mCur += size;
+		}
+		break;
+	}
+
+	default:
+		ok = false;
+		LL_INFOS() << "Unrecognized character while parsing: int(" << (int)c
+			<< ")" << LL_ENDL;
+		break;
+	}
+
+	if (!ok)
+	{
+		data.clear();
+		return LLSDParser::PARSE_FAILURE;
+	}
+	return parse_count;
+}
+
+S32 LLSDBinaryBufferReader::parseMap(LLSD& map)
+{
+	map = LLSD::emptyMap();
+	S32 size = 0;
+	// Every entry takes at least two bytes
+	if (!readSize(size) || (size_t)size > remaining() / 2)
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+	S32 parse_count = 0;
+	S32 count = 0;
+	char c = 0;
+	std::string name;
+	while (getChar(c) && c != '}' && count < size)
+	{
+		name.clear();
+		switch (c)
+		{
+		case 'k':
+			if (!readString(name)) return LLSDParser::PARSE_FAILURE;
+			break;
+		case '\'':
+		case '"':
+			if (!readDelimitedString(name, c)) return LLSDParser::PARSE_FAILURE;
+			break;
+		}
+		LLSD child;
+		S32 child_count = parse(child);
+		if (child_count <= 0)
+		{
+			// There must be a value for every key
+			return LLSDParser::PARSE_FAILURE;
+		}
+		parse_count += child_count;
+		map.insert(name, child);
+		++count;
+	}
+	if ((c != '}') || (count < size))
+	{
+		// Make sure it is correctly terminated and we parsed as many
+		// as were said to be there.
+		return LLSDParser::PARSE_FAILURE;
+	}
+	return parse_count;
+}
+
+S32 LLSDBinaryBufferReader::parseArray(LLSD& array)
+{
+	array = LLSD::emptyArray();
+	S32 size = 0;
+	if (!readSize(size))
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+
+	// Size the array once and parse each element in place. readSize()
+	// already checked there is at least a byte per element.
+	if (size > 0)
+	{
+		array[size - 1] = LLSD();
+	}
+
+	S32 parse_count = 0;
+	S32 count = 0;
+	while (count < size && mCur != mEnd && *mCur != ']')
+	{
+		S32 child_count = parse(array[count]);
+		if (child_count <= 0)
+		{
+			return LLSDParser::PARSE_FAILURE;
+		}
+		parse_count += child_count;
+		++count;
+	}
+	char c = 0;
+	if (!getChar(c) || (c != ']') || (count < size))
+	{
+		// Make sure it is correctly terminated and we parsed as many
+		// as were said to be there.
+		return LLSDParser::PARSE_FAILURE;
+	}
+	return parse_count;
+}
+
+// Same escapes as deserialize_string_delim()
+bool LLSDBinaryBufferReader::readDelimitedString(std::string& value, char delim)
+{
+	value.clear();
+	const U8* start = mCur;
+	while (mCur != mEnd)
+	{
+		char c = (char)*mCur++;
+		if (c == delim)
+		{
+			value.assign((const char*)start, mCur - start - 1);
+			return true;
+		}
+		if (c != '\\')
+		{
+			continue;
+		}
+
+		// Escaped, fall back to building the string a byte at a time
+		value.assign((const char*)start, mCur - start - 1);
+		--mCur;
+		while (mCur != mEnd)
+		{
+			c = (char)*mCur++;
+			if (c == delim)
+			{
+				return true;
+			}
+			if (c != '\\')
+			{
+				value += c;
+				continue;
+			}
+			if (!getChar(c)) return false;
+			switch (c)
+			{
+			case 'a': value += '\a'; break;
+			case 'b': value += '\b'; break;
+			case 'f': value += '\f'; break;
+			case 'n': value += '\n'; break;
+			case 'r': value += '\r'; break;
+			case 't': value += '\t'; break;
+			case 'v': value += '\v'; break;
+			case 'x':
+			{
+				char hi, lo;
+				if (!getChar(hi) || !getChar(lo)) return false;
+				value += (char)((hex_as_nybble(hi) << 4) | hex_as_nybble(lo));
+				break;
+			}
+			default: value += c; break;
+			}
+		}
+		return false;
+	}
+	return false;
+}
+} // anonymous namespace
+
+// static
+S32 LLSDSerialize::fromBinary(LLSD& sd, const U8* buf, size_t size, size_t* consumed)
+{
+	LLSDBinaryBufferReader reader(buf, size);
+	S32 parse_count = reader.parse(sd);
+	if (consumed)
+	{
+		*consumed = size - reader.remaining();
+	}
+	return parse_count;
+}
+
 /**
  * LLSDFormatter
  */
@@ -2049,14 +2405,8 @@ std::ostream& operator<<(std::ostream& s, const LLSD& llsd)
 
 //return a string containing gzipped bytes of binary serialized LLSD
 // VERY inefficient -- creates several copies of LLSD block in memory
-std::string zip_llsd(LLSD& data)
-{ 
-	std::stringstream llsd_strm;
-
-	LLSDSerialize::toBinary(data, llsd_strm);
-
-	const U32 CHUNK = 65536;
-
+std::string zip_buffer(const U8* in, size_t size)
+{
 	z_stream strm;
 	strm.zalloc = Z_NULL;
 	strm.zfree = Z_NULL;
@@ -2069,59 +2419,38 @@ std::string zip_llsd(LLSD& data)
 		return std::string();
 	}
 
-	std::string source = llsd_strm.str();
-
-	U8 out[CHUNK];
-
-	strm.avail_in = source.size();
-	strm.next_in = (U8*) source.data();
-	U8* output = NULL;
+	// deflateBound() is an upper limit for the compressed size, so a single
+	// Z_FINISH call writes the whole block straight into the result.
+	std::string result;
+	result.resize(deflateBound(&strm, size));
 
-	U32 cur_size = 0;
-
-	U32 have = 0;
+	strm.avail_in = size;
+	strm.next_in = (U8*) in;
+	strm.avail_out = result.size();
+	strm.next_out = (U8*) &result[0];
 
-	do
+	ret = deflate(&strm, Z_FINISH);
+	if (ret != Z_STREAM_END)
 	{
-		strm.avail_out = CHUNK;
-		strm.next_out = out;
+		deflateEnd(&strm);
+		LL_WARNS() << "Failed to compress LLSD block." << LL_ENDL;
+		return std::string();
+	}
 
-		ret = deflate(&strm, Z_FINISH);
-		if (ret == Z_OK || ret == Z_STREAM_END)
-		{ //copy result into output
-			if (strm.avail_out >= CHUNK)
-			{
-				free(output);
-				LL_WARNS() << "Failed to compress LLSD block." << LL_ENDL;
-				return std::string();
-			}
+	result.resize(strm.total_out);
+	deflateEnd(&strm);
 
-			have = CHUNK-strm.avail_out;
-			U8* tmp = (U8*) realloc(output, cur_size+have);
-			if (!tmp)
-			{
-				free(output);
-				LL_WARNS() << "Failed to compress LLSD block." << LL_ENDL;
-				return std::string();
-			}
-			output = tmp;
-			memcpy(output+cur_size, out, have);
-			cur_size += have;
-		}
-		else 
-		{
-			free(output);
-			LL_WARNS() << "Failed to compress LLSD block." << LL_ENDL;
-			return std::string();
-		}
-	}
-	while (ret == Z_OK);
+	return result;
+}
 
-	std::string::size_type size = cur_size;
+std::string zip_llsd(LLSD& data)
+{ 
+	std::stringstream llsd_strm;
 
-	std::string result((char*) output, size);
-	deflateEnd(&strm);
-	free(output);
+	LLSDSerialize::toBinary(data, llsd_strm);
+
+	std::string source = llsd_strm.str();
+	std::string result = zip_buffer((const U8*) source.data(), source.size());
 
 #if 0 //verify results work with unzip_llsd
 	std::istringstream test(result);
@@ -2135,100 +2464,109 @@ std::string zip_llsd(LLSD& data)
 	return result;
 }
 
-// <alchemy>
-//decompress a block of LLSD from provided istream
-// not very efficient -- creats a copy of decompressed LLSD block in memory
-// and deserializes from that copy using LLSDSerialize
-bool unzip_llsd(LLSD& data, std::istream& is, S32 size)
+bool unzip_buffer(const U8* in, size_t size, std::vector<U8>& out)
 {
-	U8* result = NULL;
-	U32 cur_size = 0;
 	z_stream strm;
-		
-	const U32 CHUNK = 65536;
-
-	U8 *in = new U8[size];
-	is.read((char*) in, size); 
-
-	U8 out[CHUNK];
-		
 	strm.zalloc = Z_NULL;
 	strm.zfree = Z_NULL;
 	strm.opaque = Z_NULL;
 	strm.avail_in = size;
-	strm.next_in = in;
+	strm.next_in = (U8*) in;
 
-	S32 ret = inflateInit(&strm);
-	
+	if (inflateInit(&strm) != Z_OK)
+	{
+		return false;
+	}
+
+	// Inflate straight into out, growing it when it fills up. LLSD blocks
+	// typically shrink to a third or less, so start from four times the
+	// input unless the caller already provided more room.
+	const size_t MIN_OUTPUT = 4096;
+	if (out.capacity() < size * 4)
+	{
+		out.reserve(llmax(size * 4, MIN_OUTPUT));
+	}
+	out.resize(out.capacity());
+
+	size_t cur_size = 0;
+	S32 ret = Z_OK;
 	do
 	{
-		strm.avail_out = CHUNK;
-		strm.next_out = out;
+		if (cur_size == out.size())
+		{
+			out.resize(out.size() * 2);
+		}
+		strm.avail_out = out.size() - cur_size;
+		strm.next_out = &out[cur_size];
 		ret = inflate(&strm, Z_NO_FLUSH);
 		
 		switch (ret)
 		{
 		case Z_NEED_DICT:
-			ret = Z_DATA_ERROR;
 		case Z_DATA_ERROR:
 		case Z_MEM_ERROR:
 		case Z_STREAM_ERROR:
 			inflateEnd(&strm);
-			free(result);
-			delete [] in;
+			out.clear();
 			return false;
+		case Z_BUF_ERROR:
+			if (strm.avail_out)
+			{	// no progress possible with room to spare: truncated input
+				inflateEnd(&strm);
+				out.clear();
+				return false;
+			}
 			break;
 		}
+		cur_size = out.size() - strm.avail_out;
 
-		U32 have = CHUNK-strm.avail_out;
-
-		U8* tmp = (U8*) realloc(result, cur_size + have);
-		if (!tmp)
-		{
-			inflateEnd(&strm);
-			free(result);
-			delete [] in;
-			return false;
-		}
-		result = tmp;
-		memcpy(result+cur_size, out, have);
-		cur_size += have;
-
-	} while (ret == Z_OK);
+	} while (ret != Z_STREAM_END);
 
 	inflateEnd(&strm);
-	delete [] in;
+	out.resize(cur_size);
+	return true;
+}
 
-	if (ret != Z_STREAM_END)
+bool unzip_llsd(LLSD& data, const U8* in, S32 size)
+{
+	std::vector<U8> result;
+	if (size <= 0 || !unzip_buffer(in, size, result))
 	{
-		free(result);
 		return false;
 	}
 
-	//result now points to the decompressed LLSD block
+	//result now holds the decompressed LLSD block
+	static const std::string deprecated_header("<? LLSD/Binary ?>");
+
+	size_t offset = 0;
+	if (result.size() >= deprecated_header.size()
+		&& !memcmp(result.data(), deprecated_header.data(), deprecated_header.size()))
 	{
-		std::string res_str((char*) result, cur_size);
+		offset = llmin(deprecated_header.size() + 1, result.size());
+	}
 
-		std::string deprecated_header("<? LLSD/Binary ?>");
+	if (!LLSDSerialize::fromBinary(data, result.data() + offset, result.size() - offset))
+	{
+		LL_WARNS() << "Failed to unzip LLSD block" << LL_ENDL;
+		return false;
+	}
 
-		if (res_str.substr(0, deprecated_header.size()) == deprecated_header)
-		{
-			res_str = res_str.substr(deprecated_header.size()+1, cur_size);
-		}
-		cur_size = res_str.size();
+	return true;
+}
 
-		std::istringstream istr(res_str);
-		
-		if (!LLSDSerialize::fromBinary(data, istr, cur_size))
-		{
-			LL_WARNS() << "Failed to unzip LLSD block" << LL_ENDL;
-			free(result);
-			return false;
-		}		
+// <alchemy>
+//decompress a block of LLSD from provided istream
+bool unzip_llsd(LLSD& data, std::istream& is, S32 size)
+{
+	if (size <= 0)
+	{
+		return false;
 	}
 
-	free(result);
-	return true;
+	std::vector<U8> in(size);
+	is.read((char*) in.data(), size); 
+
+	return unzip_llsd(data, in.data(), (S32) is.gcount());
 }
 
 //This unzip function will only work with a gzip header and trailer - while the contents
@@ -302,6 +302,49 @@ public:
 	 */
 	LLSDXMLParser(bool emit_errors=true);
 
+	/**
+	 * @class LLSDXMLParser::Handler
+	 * @brief Receives a parsed document as a sequence of events.
+	 *
+	 * Used with parseEvents() to walk large documents, such as inventory
+	 * responses, without building the whole LLSD tree first. Inside a map
+	 * each entry is announced by key() before its value. Scalars arrive
+	 * through value(). beginMap() and beginArray() may return COLLECT to
+	 * receive that map or array as a single LLSD through value() instead
+	 * of as further events, or SKIP to ignore it.
+	 */
+	class LL_COMMON_API Handler
+	{
+	public:
+		enum EAction
+		{
+			DESCEND,	// report the contents as events
+			COLLECT,	// build the contents and pass them to value()
+			SKIP		// ignore the contents
+		};
+
+		virtual ~Handler() {}
+
+		virtual EAction beginMap()					{ return DESCEND; }
+		virtual void endMap()						{}
+		virtual EAction beginArray()				{ return DESCEND; }
+		virtual void endArray()						{}
+		virtual void key(const std::string& key)	{}
+		virtual void value(const LLSD& value)		{}
+	};
+
+	/**
+	 * @brief Parse one llsd document from the stream as events.
+	 *
+	 * Events are delivered as the input is read, so on failure the
+	 * handler will already have seen everything before the error.
+	 * @param istr The input stream.
+	 * @param handler Receives the events.
+	 * @return Returns the number of LLSD elements read. Returns
+	 * PARSE_FAILURE (-1) on parse failure.
+	 */
+	S32 parseEvents(std::istream& istr, Handler& handler);
+
 protected:
 	/** 
 	 * @brief Call this method to parse a stream for LLSD.
@@ -791,6 +834,13 @@ public:
 		return fromXMLEmbedded(sd, str, emit_errors);
 //		return fromXMLDocument(sd, str, emit_errors);
 	}
+	// Streams the document to handler instead of building an LLSD,
+	// see LLSDXMLParser::Handler.
+	static S32 fromXMLEvents(LLSDXMLParser::Handler& handler, std::istream& str, bool emit_errors=true)
+	{
+		LLPointer<LLSDXMLParser> p = new LLSDXMLParser(emit_errors);
+		return p->parseEvents(str, handler);
+	}
 
 	/*
 	 * Binary Methods
@@ -812,10 +862,31 @@ public:
 		(void)p->parse(str, sd, max_bytes);
 		return sd;
 	}
+
+	/**
+	 * @brief Parse binary LLSD held in memory, without an istream.
+	 *
+	 * Accepts the same input as the stream version, but is considerably
+	 * cheaper for large payloads such as mesh headers and inventory.
+	 * @param sd[out] The parsed data. Undefined on failure.
+	 * @param buf The serialized data, without the "<? LLSD/Binary ?>" header.
+	 * @param size Number of bytes in buf.
+	 * @param consumed[out] If not null, the number of bytes parsed.
+	 * @return Returns the number of LLSD objects parsed into sd. Returns
+	 * PARSE_FAILURE (-1) on parse failure.
+	 */
+	static S32 fromBinary(LLSD& sd, const U8* buf, size_t size, size_t* consumed = nullptr);
 };
 
 //dirty little zip functions -- yell at davep
 LL_COMMON_API std::string zip_llsd(LLSD& data);
 LL_COMMON_API bool unzip_llsd(LLSD& data, std::istream& is, S32 size);
+// Same as above, reading the compressed block straight from memory.
+LL_COMMON_API bool unzip_llsd(LLSD& data, const U8* in, S32 size);
+// zlib compress size bytes of in; returns an empty string on failure.
+LL_COMMON_API std::string zip_buffer(const U8* in, size_t size);
+// Inflate a zlib block directly into out, which is grown as needed. Any
+// capacity already reserved in out is used first. Returns false on error.
+LL_COMMON_API bool unzip_buffer(const U8* in, size_t size, std::vector<U8>& out);
 LL_COMMON_API U8* unzip_llsdNavMesh( bool& valid, unsigned int& outsize,std::istream& is, S32 size);
 #endif // LL_LLSDSERIALIZE_H
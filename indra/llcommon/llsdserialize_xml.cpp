@@ -32,6 +32,7 @@
 
 #include <iostream>
 #include <deque>
+#include <vector>
 
 #include <boost/type_traits.hpp>
 #include <boost/regex.hpp>
@@ -248,6 +249,7 @@ public:
 	~Impl();
 	
 	S32 parse(std::istream& input, LLSD& data);
+	S32 parse(std::istream& input, Handler& handler);
 	S32 parseLines(std::istream& input, LLSD& data);
 
 	void parsePart(const char *buf, int len);
@@ -285,6 +287,10 @@ private:
 		ELEMENT_UNKNOWN
 	};
 	static Element readElement(const XML_Char* name);
+	void readValue(Element element, LLSD& value);
+
+	void startStreamedElement(Element element);
+	void endStreamedElement(Element element);
 	
 	static const XML_Char* findAttribute(const XML_Char* name, const XML_Char** pairs);
 	
@@ -307,11 +313,24 @@ private:
 	
 	std::string mCurrentKey;		// Current XML <tag>
 	std::string mCurrentContent;	// String data between <tag> and </tag>
+
+	// Event delivery, see LLSDXMLParser::Handler. While mHandler is set,
+	// elements outside a collected subtree are tracked in mFrames only and
+	// mStack is used solely to build mCollected.
+	enum Frame {
+		FRAME_MAP,
+		FRAME_ARRAY,
+		FRAME_VALUE
+	};
+	Handler* mHandler;
+	std::vector<Frame> mFrames;
+	LLSD mCollected;
 };
 
 
 LLSDXMLParser::Impl::Impl(bool emit_errors)
-	: mEmitErrors(emit_errors)
+	: mEmitErrors(emit_errors),
+	  mHandler(nullptr)
 {
 	mParser = XML_ParserCreate(nullptr);
 	reset();
@@ -409,6 +428,24 @@ S32 LLSDXMLParser::Impl::parse(std::istream& input, LLSD& data)
 	return mParseCount;
 }
 
+S32 LLSDXMLParser::Impl::parse(std::istream& input, Handler& handler)
+{
+	mHandler = &handler;
+	LLSD unused;
+	S32 count;
+	try
+	{
+		count = parse(input, unused);
+	}
+	catch (...)
+	{
+		mHandler = nullptr;
+		throw;
+	}
+	mHandler = nullptr;
+	return count;
+}
+
 
 S32 LLSDXMLParser::Impl::parseLines(std::istream& input, LLSD& data)
 {
@@ -505,6 +542,9 @@ void LLSDXMLParser::Impl::reset()
 	mSkipping = false;
 	
 	mCurrentKey.clear();
+
+	mFrames.clear();
+	mCollected.clear();
 	
 	XML_ParserReset(mParser, "utf-8");
 	XML_SetUserData(mParser, this);
@@ -599,6 +639,14 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 			return;
 	
 		case ELEMENT_KEY:
+			if (mHandler && mStack.empty())
+			{
+				if (mFrames.empty() || mFrames.back() != FRAME_MAP)
+				{
+					return startSkipping();
+				}
+				return;
+			}
 			if (mStack.empty()  ||  !(mStack.back()->isMap()))
 			{
 				return startSkipping();
@@ -619,6 +667,12 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 	
 
 	if (!mInLLSDElement) { return startSkipping(); }
+
+	if (mHandler && mStack.empty())
+	{
+		// not inside a collected subtree
+		return startStreamedElement(element);
+	}
 	
 	if (mStack.empty())
 	{
@@ -694,6 +748,10 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 	
 		case ELEMENT_KEY:
 			mCurrentKey = mCurrentContent;
+			if (mHandler && mStack.empty())
+			{
+				mHandler->key(mCurrentKey);
+			}
 			return;
 			
 		default:
@@ -703,9 +761,26 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 	
 	if (!mInLLSDElement) { return; }
 
+	if (mHandler && mStack.empty())
+	{
+		return endStreamedElement(element);
+	}
+
 	LLSD& value = *mStack.back();
 	mStack.pop_back();
-	
+	readValue(element, value);
+	mCurrentContent.clear();
+
+	if (mHandler && mStack.empty())
+	{
+		// finished collecting a map or array for the handler
+		mHandler->value(mCollected);
+		mCollected.clear();
+	}
+}
+
+void LLSDXMLParser::Impl::readValue(Element element, LLSD& value)
+{
 	switch (element)
 	{
 		case ELEMENT_UNDEF:
@@ -791,6 +866,89 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 			// other values, map and array, have already been set
 			break;
 	}
+}
+
+void LLSDXMLParser::Impl::startStreamedElement(Element element)
+{
+	if (!mFrames.empty())
+	{
+		switch (mFrames.back())
+		{
+			case FRAME_MAP:
+				if (mCurrentKey.empty()) { return startSkipping(); }
+				mCurrentKey.clear();
+				break;
+
+			case FRAME_ARRAY:
+				break;
+
+			default:
+				// improperly nested value in a non-structure
+				return startSkipping();
+		}
+	}
+
+	++mParseCount;
+	Handler::EAction action = Handler::DESCEND;
+	Frame frame = FRAME_VALUE;
+	switch (element)
+	{
+		case ELEMENT_MAP:
+			action = mHandler->beginMap();
+			frame = FRAME_MAP;
+			break;
+
+		case ELEMENT_ARRAY:
+			action = mHandler->beginArray();
+			frame = FRAME_ARRAY;
+			break;
+
+		default:
+			// scalars are delivered from the end element handler
+			;
+	}
+
+	if (action == Handler::SKIP)
+	{
+		return startSkipping();
+	}
+	if (action == Handler::COLLECT && frame != FRAME_VALUE)
+	{
+		// build this one element as a tree, then hand it over whole
+		mCollected = (frame == FRAME_MAP) ? LLSD::emptyMap() : LLSD::emptyArray();
+		mStack.push_back(&mCollected);
+		return;
+	}
+	mFrames.push_back(frame);
+}
+
+void LLSDXMLParser::Impl::endStreamedElement(Element element)
+{
+	if (mFrames.empty())
+	{
+		return;
+	}
+
+	Frame frame = mFrames.back();
+	mFrames.pop_back();
+	switch (frame)
+	{
+		case FRAME_MAP:
+			mHandler->endMap();
+			break;
+
+		case FRAME_ARRAY:
+			mHandler->endArray();
+			break;
+
+		default:
+		{
+			LLSD value;
+			readValue(element, value);
+			mHandler->value(value);
+			break;
+		}
+	}
 
 	mCurrentContent.clear();
 }
@@ -911,6 +1069,15 @@ void LLSDXMLParser::parsePart(const char *buf, int len)
 	impl.parsePart(buf, len);
 }
 
+S32 LLSDXMLParser::parseEvents(std::istream& input, Handler& handler)
+{
+	#ifdef XML_PARSER_PERFORMANCE_TESTS
+	XML_Timer timer( &parseTime );
+	#endif	// XML_PARSER_PERFORMANCE_TESTS
+
+	return impl.parse(input, handler);
+}
+
 // virtual
 S32 LLSDXMLParser::doParse(std::istream& input, LLSD& data) const
 {
@@ -0,0 +1,131 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file llsdzipbatch.cpp
+ * @brief Compress or decompress independent LLSD blocks on a thread pool
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llsdzipbatch.h"
+
+#include <sstream>
+
+#include "llsdserialize.h"
+#include "llthreadpool.h"
+
+LLSDZipBatch::LLSDZipBatch()
+:	mStarted(false),
+	mRemaining(0)
+{
+}
+
+LLSDZipBatch::~LLSDZipBatch()
+{
+	// every running job holds a reference, so nothing can be in flight here
+	llassert(!mStarted || mRemaining == 0);
+}
+
+U32 LLSDZipBatch::addZip(const LLSD& data)
+{
+	llassert(!mStarted);
+
+	std::ostringstream binary;
+	LLSDSerialize::toBinary(data, binary);
+
+	Job job;
+	job.mZip = true;
+	job.mSucceeded = false;
+	job.mBinary = binary.str();
+	job.mInput = nullptr;
+	job.mInputSize = 0;
+	mJobs.push_back(job);
+	return (U32)mJobs.size() - 1;
+}
+
+U32 LLSDZipBatch::addUnzip(const U8* data, S32 size)
+{
+	llassert(!mStarted);
+
+	Job job;
+	job.mZip = false;
+	job.mSucceeded = false;
+	job.mInput = data;
+	job.mInputSize = size;
+	mJobs.push_back(job);
+	return (U32)mJobs.size() - 1;
+}
+
+void LLSDZipBatch::start(LLThreadPool* pool, U32 priority)
+{
+	llassert(!mStarted);
+	mStarted = true;
+	mRemaining = (S32)mJobs.size();
+
+	if (!pool)
+	{
+		pool = LLThreadPool::getShared();
+	}
+
+	U32 count = (U32)mJobs.size();
+	for (U32 i = 0; i < count; ++i)
+	{
+		LLPointer<LLSDZipBatch> self(this);
+		if (!pool || !pool->post([self, i]() mutable { self->run(i); }, priority))
+		{
+			run(i);
+		}
+	}
+}
+
+void LLSDZipBatch::wait()
+{
+	llassert(mStarted);
+
+	LLMutexLock lock(&mDoneCondition);
+	while (mRemaining > 0)
+	{
+		mDoneCondition.wait();
+	}
+}
+
+void LLSDZipBatch::run(U32 index)
+{
+	Job& job = mJobs[index];
+	if (job.mZip)
+	{
+		job.mZipped = zip_buffer((const U8*)job.mBinary.data(), job.mBinary.size());
+		job.mSucceeded = !job.mZipped.empty();
+		job.mBinary.clear();
+	}
+	else
+	{
+		job.mSucceeded = unzip_llsd(job.mUnzipped, job.mInput, job.mInputSize);
+	}
+
+	if (--mRemaining == 0)
+	{
+		LLMutexLock lock(&mDoneCondition);
+		mDoneCondition.broadcast();
+	}
+}
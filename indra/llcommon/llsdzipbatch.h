@@ -0,0 +1,100 @@
+/**
+ * @file llsdzipbatch.h
+ * @brief Compress or decompress independent LLSD blocks on a thread pool
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSDZIPBATCH_H
+#define LL_LLSDZIPBATCH_H
+
+#include <string>
+#include <vector>
+
+#include "llatomic.h"
+#include "llmutex.h"
+#include "llpointer.h"
+#include "llqueuedthread.h"
+#include "llrefcount.h"
+#include "llsd.h"
+
+class LLThreadPool;
+
+//============================================================================
+// LLSDZipBatch
+//
+// A set of zip_llsd() / unzip_llsd() jobs that run in parallel on an
+// LLThreadPool. Queue the blocks with addZip() and addUnzip(), call start(),
+// then poll isDone() or block in wait() and collect the results by the index
+// the add call returned.
+//
+// LLSD refcounts are not thread safe, so addZip() serializes its data on the
+// calling thread and only the deflate runs on the pool. Buffers given to
+// addUnzip() are not copied and must stay valid until the batch is done.
+
+class LL_COMMON_API LLSDZipBatch : public LLThreadSafeRefCount
+{
+public:
+	LLSDZipBatch();
+
+	// Queue a job. Only valid before start().
+	U32 addZip(const LLSD& data);
+	U32 addUnzip(const U8* data, S32 size);
+
+	// Hand the queued jobs to pool, or to the shared pool if pool is null.
+	// Without a pool the jobs run on the calling thread before returning.
+	void start(LLThreadPool* pool = nullptr, U32 priority = LLQueuedThread::PRIORITY_NORMAL);
+
+	bool isDone() const { return mStarted && mRemaining == 0; }
+	void wait();
+
+	// Results, valid once isDone()
+	U32 size() const { return (U32)mJobs.size(); }
+	bool succeeded(U32 index) const { return mJobs[index].mSucceeded; }
+	const std::string& getZipped(U32 index) const { return mJobs[index].mZipped; }
+	const LLSD& getUnzipped(U32 index) const { return mJobs[index].mUnzipped; }
+
+protected:
+	~LLSDZipBatch();
+
+private:
+	struct Job
+	{
+		bool mZip;
+		bool mSucceeded;
+		std::string mBinary;	// serialized input of a zip job
+		const U8* mInput;		// compressed input of an unzip job
+		S32 mInputSize;
+		std::string mZipped;
+		LLSD mUnzipped;
+	};
+
+	void run(U32 index);
+
+private:
+	std::vector<Job> mJobs;
+	bool mStarted;
+	LLAtomicS32 mRemaining;
+	LLCondition mDoneCondition;
+};
+
+#endif // LL_LLSDZIPBATCH_H
@@ -51,83 +51,38 @@ LLStringTableEntry::~LLStringTableEntry()
 	mCount = 0;
 }
 
-LLStringTable::LLStringTable(int tablesize)
-: mUniqueEntries(0)
+LLStringTable::Key::Key(const char* str)
+:	mString(str)
 {
-	S32 i;
-	if (!tablesize)
-		tablesize = 4096; // some arbitrary default
-	// Make sure tablesize is power of 2
-	for (i = 31; i>0; i--)
+	// FNV-1a; the shard comes from the top bits, so they need to be mixed.
+	// Only the part that survives truncation counts, so that a long string
+	// lands in the same shard as its stored copy.
+	U32 hash = 2166136261U;
+	const char* end = str + MAX_STRINGS_LENGTH - 1;
+	for (const char* c = str; *c && c != end; ++c)
 	{
-		if (tablesize & (1<<i))
-		{
-			if (tablesize >= (3<<(i-1)))
-				tablesize = (1<<(i+1));
-			else
-				tablesize = (1<<i);
-			break;
-		}
+		hash = (hash ^ (U8)*c) * 16777619U;
 	}
-	mMaxEntries = tablesize;
+	mHash = hash;
+}
 
-#if !STRING_TABLE_HASH_MAP
-	// ALlocate strings
-	mStringList = new string_list_ptr_t[mMaxEntries];
-	// Clear strings
-	for (i = 0; i < mMaxEntries; i++)
-	{
-		mStringList[i] = nullptr;
-	}
-#endif
+LLStringTable::LLStringTable(int tablesize)
+: mUniqueEntries(0)
+{
+	// the shards grow as strings are added, tablesize is no longer needed
 }
 
 LLStringTable::~LLStringTable()
 {
-#if !STRING_TABLE_HASH_MAP
-	if (mStringList)
+	for (S32 i = 0; i < SHARD_COUNT; i++)
 	{
-		for (S32 i = 0; i < mMaxEntries; i++)
+		string_hash_t& strings = mShards[i].mStrings;
+		for (string_hash_t::iterator iter = strings.begin(); iter != strings.end(); ++iter)
 		{
-			if (mStringList[i])
-			{
-				string_list_t::iterator iter;
-				for (iter = mStringList[i]->begin(); iter != mStringList[i]->end(); iter++)
-					delete *iter; // *iter = (LLStringTableEntry*)
-			}
-			delete mStringList[i];
+			delete iter->second;
 		}
-		delete [] mStringList;
-		mStringList = nullptr;
+		strings.clear();
 	}
-#else
-	// Need to clean up the string hash
-	for_each(mStringHash.begin(), mStringHash.end(), DeletePairedPointer());
-	mStringHash.clear();
-#endif
-}
-
-
-static U32 hash_my_string(const char *str, int max_entries)
-{
-	U32 retval = 0;
-#if 0
-	while (*str)
-	{
-		retval <<= 1;
-		retval += *str++;
-	}
-#else
-	while (*str)
-	{
-		retval = (retval<<4) + *str;
-		U32 x = (retval & 0xf0000000);
-		if (x) retval = retval ^ (x>>24);
-		retval = retval & (~x);
-		str++;
-	}
-#endif
-	return (retval & (max_entries-1)); // max_entries is gauranteed to be power of 2
 }
 
 char* LLStringTable::checkString(const std::string& str)
@@ -157,43 +112,14 @@ LLStringTableEntry* LLStringTable::checkStringEntry(const char *str)
 {
 	if (str)
 	{
-		char *ret_val;
-		LLStringTableEntry	*entry;
-		U32					hash_value = hash_my_string(str, mMaxEntries);
-#if STRING_TABLE_HASH_MAP
-#if 1 // Microsoft
-		string_hash_t::iterator lower = mStringHash.lower_bound(hash_value);
-		string_hash_t::iterator upper = mStringHash.upper_bound(hash_value);
-#else // stlport
-		std::pair<string_hash_t::iterator, string_hash_t::iterator> P = mStringHash.equal_range(hash_value);
-		string_hash_t::iterator lower = P.first;
-		string_hash_t::iterator upper = P.second;
-#endif
-		for (string_hash_t::iterator iter = lower; iter != upper; iter++)
-		{
-			entry = iter->second;
-			ret_val = entry->mString;
-			if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-			{
-				return entry;
-			}
-		}
-#else
-		string_list_t		*strlist = mStringList[hash_value];
-		if (strlist)
+		Key key(str);
+		Shard& shard = getShard(key);
+		std::lock_guard<std::mutex> lock(shard.mMutex);
+		string_hash_t::const_iterator found = shard.mStrings.find(key);
+		if (found != shard.mStrings.end())
 		{
-			string_list_t::iterator iter;
-			for (iter = strlist->begin(); iter != strlist->end(); iter++)
-			{
-				entry = *iter;
-				ret_val = entry->mString;
-				if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-				{
-					return entry;
-				}
-			}
+			return found->second;
 		}
-#endif
 	}
 	return nullptr;
 }
@@ -227,61 +153,29 @@ LLStringTableEntry* LLStringTable::addStringEntry(const char *str)
 {
 	if (str)
 	{
-		char *ret_val = nullptr;
-		LLStringTableEntry	*entry;
-		U32					hash_value = hash_my_string(str, mMaxEntries);
-#if STRING_TABLE_HASH_MAP
-#if 1 // Microsoft
-		string_hash_t::iterator lower = mStringHash.lower_bound(hash_value);
-		string_hash_t::iterator upper = mStringHash.upper_bound(hash_value);
-#else // stlport
-		std::pair<string_hash_t::iterator, string_hash_t::iterator> P = mStringHash.equal_range(hash_value);
-		string_hash_t::iterator lower = P.first;
-		string_hash_t::iterator upper = P.second;
-#endif
-		for (string_hash_t::iterator iter = lower; iter != upper; iter++)
+		Key key(str);
+		Shard& shard = getShard(key);
+		std::lock_guard<std::mutex> lock(shard.mMutex);
+		string_hash_t::iterator found = shard.mStrings.find(key);
+		if (found != shard.mStrings.end())
 		{
-			entry = iter->second;
-			ret_val = entry->mString;
-			if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-			{
-				entry->incCount();
-				return entry;
-			}
+			found->second->incCount();
+			return found->second;
 		}
 
-		// not found, so add!
+		// not found, so add! Key the entry by its own, possibly truncated,
+		// copy of the string.
 		LLStringTableEntry* newentry = new LLStringTableEntry(str);
-		ret_val = newentry->mString;
-		mStringHash.insert(string_hash_t::value_type(hash_value, newentry));
-#else
-		string_list_t		*strlist = mStringList[hash_value];
-
-		if (strlist)
+		Key entry_key(newentry->mString);
+		std::pair<string_hash_t::iterator, bool> inserted =
+			shard.mStrings.insert(std::make_pair(entry_key, newentry));
+		if (!inserted.second)
 		{
-			string_list_t::iterator iter;
-			for (iter = strlist->begin(); iter != strlist->end(); ++iter)
-			{
-				entry = *iter;
-				ret_val = entry->mString;
-				if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-				{
-					entry->incCount();
-					return entry;
-				}
-			}
+			// str was too long and its truncation is already interned
+			delete newentry;
+			inserted.first->second->incCount();
+			return inserted.first->second;
 		}
-		else
-		{
-			mStringList[hash_value] = new string_list_t;
-			strlist = mStringList[hash_value];
-		}
-
-		// not found, so add!
-		LLStringTableEntry *newentry = new LLStringTableEntry(str);
-		//ret_val = newentry->mString;
-		strlist->push_front(newentry);
-#endif
 		mUniqueEntries++;
 		return newentry;
 	}
@@ -295,66 +189,22 @@ void LLStringTable::removeString(const char *str)
 {
 	if (str)
 	{
-		char *ret_val;
-		LLStringTableEntry	*entry;
-		U32					hash_value = hash_my_string(str, mMaxEntries);
-#if STRING_TABLE_HASH_MAP
+		Key key(str);
+		Shard& shard = getShard(key);
+		std::lock_guard<std::mutex> lock(shard.mMutex);
+		string_hash_t::iterator found = shard.mStrings.find(key);
+		if (found != shard.mStrings.end())
 		{
-#if 1 // Microsoft
-			string_hash_t::iterator lower = mStringHash.lower_bound(hash_value);
-			string_hash_t::iterator upper = mStringHash.upper_bound(hash_value);
-#else // stlport
-			std::pair<string_hash_t::iterator, string_hash_t::iterator> P = mStringHash.equal_range(hash_value);
-			string_hash_t::iterator lower = P.first;
-			string_hash_t::iterator upper = P.second;
-#endif
-			for (string_hash_t::iterator iter = lower; iter != upper; iter++)
+			LLStringTableEntry* entry = found->second;
+			if (!entry->decCount())
 			{
-				entry = iter->second;
-				ret_val = entry->mString;
-				if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
+				if (--mUniqueEntries < 0)
 				{
-					if (!entry->decCount())
-					{
-						mUniqueEntries--;
-						if (mUniqueEntries < 0)
-						{
-							LL_ERRS() << "LLStringTable:removeString trying to remove too many strings!" << LL_ENDL;
-						}
-						delete iter->second;
-						mStringHash.erase(iter);
-					}
-					return;
+					LL_ERRS() << "LLStringTable:removeString trying to remove too many strings!" << LL_ENDL;
 				}
+				shard.mStrings.erase(found);
+				delete entry;
 			}
 		}
-#else
-		string_list_t		*strlist = mStringList[hash_value];
-
-		if (strlist)
-		{
-			string_list_t::iterator iter;
-			for (iter = strlist->begin(); iter != strlist->end(); ++iter)
-			{
-				entry = *iter;
-				ret_val = entry->mString;
-				if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-				{
-					if (!entry->decCount())
-					{
-						mUniqueEntries--;
-						if (mUniqueEntries < 0)
-						{
-							LL_ERRS() << "LLStringTable:removeString trying to remove too many strings!" << LL_ENDL;
-						}
-						strlist->remove(entry);
-						delete entry;
-					}
-					return;
-				}
-			}
-		}
-#endif
 	}
 }
-
@@ -29,19 +29,14 @@
 #define LL_STRING_TABLE_H
 
 #include "lldefs.h"
+#include "llatomic.h"
 #include "llformat.h"
+#include "llopenhashmap.h"
 #include "llstl.h"
 #include <list>
+#include <mutex>
 #include <set>
 
-#if LL_WINDOWS
-# if (_MSC_VER >= 1300 && _MSC_VER < 1400)
-#  define STRING_TABLE_HASH_MAP 1
-# endif
-#else
-//# define STRING_TABLE_HASH_MAP 1
-#endif
-
 const U32 MAX_STRINGS_LENGTH = 256;
 
 class LL_COMMON_API LLStringTableEntry
@@ -57,6 +52,16 @@ public:
 	S32  mCount;
 };
 
+// Interns strings: every distinct string gets one LLStringTableEntry, so
+// two interned strings are equal exactly when their entries (or mString
+// pointers) are. Entries are reference counted by addString()/removeString()
+// and never move while they are referenced.
+//
+// The table is split into shards, each with its own lock, picked by the
+// string's hash. Any thread may add, check and remove strings; threads only
+// contend when they touch the same shard at the same time.
+//
+// Strings are truncated to MAX_STRINGS_LENGTH - 1 characters.
 class LL_COMMON_API LLStringTable
 {
 public:
@@ -74,21 +79,43 @@ public:
 	LLStringTableEntry *addStringEntry(const std::string& str);
 	void  removeString(const char *str);
 
-	S32 mMaxEntries;
-	S32 mUniqueEntries;
-	
-#if STRING_TABLE_HASH_MAP
-#if LL_WINDOWS
-	typedef std::hash_multimap<U32, LLStringTableEntry *> string_hash_t;
-#else
-	typedef __gnu_cxx::hash_multimap<U32, LLStringTableEntry *> string_hash_t;
-#endif
-	string_hash_t mStringHash;
-#else
-	typedef std::list<LLStringTableEntry *> string_list_t;
-	typedef string_list_t * string_list_ptr_t;
-	string_list_ptr_t	*mStringList;
-#endif	
+	LLAtomicS32 mUniqueEntries;
+
+private:
+	LLStringTable(const LLStringTable&);
+	LLStringTable& operator=(const LLStringTable&);
+
+	// A string being looked up or the string of an entry, with its hash
+	// computed once up front
+	struct Key
+	{
+		Key() : mString(NULL), mHash(0) {}
+		Key(const char* str);
+
+		bool operator==(const Key& other) const
+		{
+			return mHash == other.mHash && !strncmp(mString, other.mString, MAX_STRINGS_LENGTH);
+		}
+
+		const char* mString;
+		U32 mHash;
+	};
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const { return key.mHash; }
+	};
+	typedef LLOpenHashMap<Key, LLStringTableEntry*, KeyHash> string_hash_t;
+
+	struct Shard
+	{
+		std::mutex mMutex;
+		string_hash_t mStrings;
+	};
+	enum { SHARD_COUNT = 16 };
+
+	Shard& getShard(const Key& key) { return mShards[key.mHash >> 28]; }
+
+	Shard mShards[SHARD_COUNT];
 };
 
 extern LL_COMMON_API LLStringTable gStringTable;
@@ -34,6 +34,7 @@
 #include "lltimer.h"
 #include "lltrace.h"
 #include "lltracethreadrecorder.h"
+#include "lltracering.h"
 
 #include <chrono>
 
@@ -108,6 +109,7 @@ void LLThread::runWrapper()
 
 	// for now, hard code all LLThreads to report to single master thread recorder, which is known to be running on main thread
 	mRecorder = std::make_unique<LLTrace::ThreadRecorder>(*LLTrace::get_master_thread_recorder());
+	LLTrace::EventRing::setThreadName(mName);
 
 	// Run the user supplied function
 	run();
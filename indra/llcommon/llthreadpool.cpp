@@ -0,0 +1,312 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file llthreadpool.cpp
+ * @brief Shared, priority-aware work-stealing thread pool
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llthreadpool.h"
+
+#include "llformat.h"
+#include "llprocessor.h"
+#include "llqueuedthread.h"
+#include "lltrace.h"
+#include "lltracethreadrecorder.h"
+
+static LLTrace::CountStatHandle<S32> sTasksRun("threadpool_tasks", "number of tasks run by thread pool workers");
+static LLTrace::CountStatHandle<S32> sTasksStolen("threadpool_steals", "number of thread pool tasks run by a worker other than the one they were queued on");
+static LLTrace::SampleStatHandle<S32> sQueueDepth("threadpool_queue_depth", "number of tasks waiting in the thread pool");
+
+// Identifies the pool and worker the calling thread belongs to, if any.
+static LL_THREAD_LOCAL LLThreadPool* sCurrentPool = nullptr;
+static LL_THREAD_LOCAL U32 sCurrentWorker = 0;
+
+//static
+LLThreadPool* LLThreadPool::sShared = nullptr;
+
+//static
+void LLThreadPool::initClass(U32 num_workers)
+{
+	llassert(sShared == nullptr);
+	sShared = new LLThreadPool("threadpool", num_workers);
+}
+
+//static
+void LLThreadPool::cleanupClass()
+{
+	delete sShared;
+	sShared = nullptr;
+}
+
+//static
+U32 LLThreadPool::getDefaultWorkerCount()
+{
+	U32 hw_threads = LLProcessorInfo().getCPUThreadCount();
+	return hw_threads > 1 ? hw_threads - 1 : 1;
+}
+
+//static
+U32 LLThreadPool::getBand(U32 priority)
+{
+	return (priority & LLQueuedThread::PRIORITY_HIGHBITS) >> 28;
+}
+
+//============================================================================
+
+// MAIN THREAD
+LLThreadPool::LLThreadPool(const std::string& name, U32 num_workers) :
+	mName(name),
+	mPending(0),
+	mNextWorker(0),
+	mQuitting(false)
+{
+	for (U32 i = 0; i < NUM_PRIORITY_BANDS; ++i)
+	{
+		mBandPending[i] = 0;
+	}
+
+	if (num_workers == 0)
+	{
+		num_workers = getDefaultWorkerCount();
+	}
+
+	// Create every worker before starting any, findWork() walks mWorkers.
+	mWorkers.reserve(num_workers);
+	for (U32 i = 0; i < num_workers; ++i)
+	{
+		mWorkers.push_back(new Worker(*this, i));
+	}
+	for (Worker* worker : mWorkers)
+	{
+		worker->start();
+	}
+
+	LL_INFOS() << "Started thread pool \"" << mName << "\" with " << num_workers << " workers" << LL_ENDL;
+}
+
+// MAIN THREAD
+LLThreadPool::~LLThreadPool()
+{
+	shutdown();
+}
+
+// MAIN THREAD
+void LLThreadPool::shutdown()
+{
+	mWorkCondition.lock();
+	mQuitting = true;
+	mWorkCondition.broadcast();
+	mWorkCondition.unlock();
+
+	// Join every worker before deleting any, an idle worker may still be
+	// looking through its siblings' deques.
+	for (Worker* worker : mWorkers)
+	{
+		worker->shutdown();
+	}
+
+	S32 dropped = 0;
+	for (Worker* worker : mWorkers)
+	{
+		dropped += worker->clear();
+		delete worker;
+	}
+	mWorkers.clear();
+
+	if (dropped)
+	{
+		LL_WARNS() << "Thread pool \"" << mName << "\" shut down with " << dropped << " pending tasks" << LL_ENDL;
+	}
+}
+
+bool LLThreadPool::isWorkerThread() const
+{
+	return sCurrentPool == this;
+}
+
+// May be called from any thread
+bool LLThreadPool::post(const task_t& task, U32 priority)
+{
+	if (mQuitting || mWorkers.empty())
+	{
+		return false;
+	}
+
+	// Keep work created by a worker on that worker, it is likely to share data
+	// with the task that created it. Everything else is spread round-robin.
+	U32 index = isWorkerThread() ? sCurrentWorker : (mNextWorker++ % mWorkers.size());
+
+	Task queued;
+	queued.mFunc = task;
+	queued.mPriority = priority;
+
+	// Count before pushing so that a worker which finds the task never sees
+	// the counters go negative.
+	++mBandPending[getBand(priority)];
+	S32 pending = ++mPending;
+	mWorkers[index]->push(queued);
+
+	LLTrace::sample(sQueueDepth, pending);
+
+	mWorkCondition.lock();
+	mWorkCondition.signal();
+	mWorkCondition.unlock();
+	return true;
+}
+
+// WORKER THREAD
+bool LLThreadPool::findWork(U32 index, Task& task)
+{
+	const U32 num_workers = (U32)mWorkers.size();
+	for (S32 band = NUM_PRIORITY_BANDS - 1; band >= 0; --band)
+	{
+		if (mBandPending[band] <= 0)
+		{
+			continue;
+		}
+
+		bool found = mWorkers[index]->popLocal(task, band);
+		for (U32 i = 1; !found && i < num_workers; ++i)
+		{
+			found = mWorkers[(index + i) % num_workers]->stealFrom(task, band);
+			if (found)
+			{
+				LLTrace::add(sTasksStolen, 1);
+			}
+		}
+
+		if (found)
+		{
+			--mBandPending[band];
+			--mPending;
+			return true;
+		}
+	}
+	return false;
+}
+
+// WORKER THREAD
+void LLThreadPool::waitForWork()
+{
+	mWorkCondition.lock();
+	while (mPending <= 0 && !mQuitting)
+	{
+		mWorkCondition.wait();
+	}
+	mWorkCondition.unlock();
+}
+
+// WORKER THREAD
+void LLThreadPool::runTask(Task& task)
+{
+	task.mFunc();
+	task.mFunc = nullptr;
+
+	LLTrace::add(sTasksRun, 1);
+	LLTrace::get_thread_recorder()->pushToParent();
+}
+
+//============================================================================
+
+LLThreadPool::Worker::Worker(LLThreadPool& pool, U32 index) :
+	LLThread(llformat("%s %u", pool.getName().c_str(), index)),
+	mPool(pool),
+	mIndex(index)
+{
+}
+
+// Owner and thieves work at opposite ends of each deque: the owner runs the
+// oldest task first, thieves take the newest.
+void LLThreadPool::Worker::push(const Task& task)
+{
+	LLMutexLock lock(&mQueueMutex);
+	mQueues[getBand(task.mPriority)].push_back(task);
+}
+
+bool LLThreadPool::Worker::popLocal(Task& task, U32 band)
+{
+	LLMutexLock lock(&mQueueMutex);
+	std::deque<Task>& queue = mQueues[band];
+	if (queue.empty())
+	{
+		return false;
+	}
+	task = std::move(queue.front());
+	queue.pop_front();
+	return true;
+}
+
+bool LLThreadPool::Worker::stealFrom(Task& task, U32 band)
+{
+	LLMutexLock lock(&mQueueMutex);
+	std::deque<Task>& queue = mQueues[band];
+	if (queue.empty())
+	{
+		return false;
+	}
+	task = std::move(queue.back());
+	queue.pop_back();
+	return true;
+}
+
+S32 LLThreadPool::Worker::clear()
+{
+	LLMutexLock lock(&mQueueMutex);
+	S32 count = 0;
+	for (U32 band = 0; band < NUM_PRIORITY_BANDS; ++band)
+	{
+		count += (S32)mQueues[band].size();
+		mQueues[band].clear();
+	}
+	return count;
+}
+
+//virtual
+void LLThreadPool::Worker::run()
+{
+	sCurrentPool = &mPool;
+	sCurrentWorker = mIndex;
+
+	Task task;
+	while (!mPool.mQuitting)
+	{
+		if (mPool.findWork(mIndex, task))
+		{
+			mPool.runTask(task);
+		}
+		else if (mPool.mPending > 0)
+		{
+			// A task has been counted but not pushed yet
+			LLThread::yield();
+		}
+		else
+		{
+			mPool.waitForWork();
+		}
+	}
+
+	LLTrace::get_thread_recorder()->pushToParent();
+	sCurrentPool = nullptr;
+}
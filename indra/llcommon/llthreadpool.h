@@ -0,0 +1,138 @@
+/**
+ * @file llthreadpool.h
+ * @brief Shared, priority-aware work-stealing thread pool
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTHREADPOOL_H
+#define LL_LLTHREADPOOL_H
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "llatomic.h"
+#include "llmutex.h"
+#include "llthread.h"
+
+//============================================================================
+// LLThreadPool
+//
+// A fixed set of worker threads, each owning its own set of task deques.
+// Tasks posted from outside the pool are spread round-robin over the workers;
+// tasks posted from inside a worker go to that worker's own deques. An idle
+// worker first drains its own deques (oldest first) and then steals from the
+// newest end of its siblings' deques before going to sleep.
+//
+// Priorities use the LLQueuedThread::priority_t scale. Only the high bits
+// (PRIORITY_HIGHBITS) are significant to the pool: each band has its own
+// deque and higher bands are always drained (and stolen) first. Fine grained
+// ordering within a band is left to the client, see LLQueuedThread.
+//
+// A process-wide pool is created with initClass() and shared by every
+// subsystem that does not need a thread of its own.
+
+class LL_COMMON_API LLThreadPool
+{
+public:
+	typedef std::function<void()> task_t;
+
+	// num_workers == 0 means getDefaultWorkerCount()
+	LLThreadPool(const std::string& name, U32 num_workers = 0);
+	~LLThreadPool();
+
+	// May be called from any thread, including a worker of this pool.
+	// Returns false if the pool is shutting down and the task was dropped.
+	bool post(const task_t& task, U32 priority);
+
+	// Stops accepting tasks, discards anything still queued and joins the workers.
+	void shutdown();
+
+	U32 getWorkerCount() const { return (U32)mWorkers.size(); }
+	S32 getPending() const { return mPending; }
+	bool isQuitting() const { return mQuitting; }
+	const std::string& getName() const { return mName; }
+
+	// true if the calling thread is one of this pool's workers
+	bool isWorkerThread() const;
+
+	// One worker per hardware thread, less one for the main thread.
+	static U32 getDefaultWorkerCount();
+
+	// Shared pool
+	static void initClass(U32 num_workers = 0);
+	static void cleanupClass();
+	static LLThreadPool* getShared() { return sShared; }
+
+private:
+	// No copy constructor or copy assignment
+	LLThreadPool(const LLThreadPool&);
+	LLThreadPool& operator=(const LLThreadPool&);
+
+	enum { NUM_PRIORITY_BANDS = 8 };
+
+	struct Task
+	{
+		task_t mFunc;
+		U32 mPriority;
+	};
+
+	class Worker : public LLThread
+	{
+	public:
+		Worker(LLThreadPool& pool, U32 index);
+
+		void push(const Task& task);
+		bool popLocal(Task& task, U32 band);
+		bool stealFrom(Task& task, U32 band);
+		S32 clear();
+
+	private:
+		void run(void) override;
+
+		LLThreadPool& mPool;
+		const U32 mIndex;
+		LLMutex mQueueMutex;
+		std::deque<Task> mQueues[NUM_PRIORITY_BANDS];
+	};
+
+	static U32 getBand(U32 priority);
+
+	bool findWork(U32 index, Task& task);
+	void waitForWork();
+	void runTask(Task& task);
+
+private:
+	std::string mName;
+	std::vector<Worker*> mWorkers;
+	LLCondition mWorkCondition;
+	LLAtomicS32 mPending;
+	LLAtomicS32 mBandPending[NUM_PRIORITY_BANDS];
+	LLAtomicU32 mNextWorker;
+	LLAtomic32<bool> mQuitting;
+
+	static LLThreadPool* sShared;
+};
+
+#endif // LL_LLTHREADPOOL_H
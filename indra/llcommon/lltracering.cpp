@@ -0,0 +1,339 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file lltracering.cpp
+ * @brief Per-thread ring buffers of recent block timer scopes
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltracering.h"
+
+#include <iomanip>
+#include <ostream>
+
+#include "llfasttimer.h"
+#include "llmutex.h"
+
+namespace LLTrace
+{
+
+std::atomic<bool> EventRing::sEnabled(false);
+
+// All rings handed out since initClass(), guarded by the ring mutex. A
+// ring's mInUse and mThreadName are only touched with the mutex held. The
+// mutex is never destroyed, as thread recorders can outlive static
+// destruction.
+static LLMutex& ring_mutex()
+{
+	static LLMutex* sMutex = new LLMutex;
+	return *sMutex;
+}
+static std::vector<EventRing*> sRings;
+// Rings dropped by cleanupClass(). A thread may still be writing to one.
+static std::vector<EventRing*> sRetiredRings;
+static U32 sRingCapacity = 0;
+// Bumped by cleanupClass() so that threads drop their stale ring pointers
+static std::atomic<U32> sRingGeneration(1);
+
+static LL_THREAD_LOCAL EventRing* sThreadRing = nullptr;
+static LL_THREAD_LOCAL U32 sThreadRingGeneration = 0;
+
+EventRing::EventRing(U32 capacity, U32 id)
+:	mEvents(new Event[capacity]),
+	mMask(capacity - 1),
+	mClaimed(0),
+	mHead(0),
+	mID(id),
+	mInUse(false)
+{
+	for (U32 i = 0; i < capacity; ++i)
+	{
+		mEvents[i].mTimer.store(nullptr, std::memory_order_relaxed);
+		mEvents[i].mStart.store(0, std::memory_order_relaxed);
+		mEvents[i].mDuration.store(0, std::memory_order_relaxed);
+	}
+}
+
+EventRing::~EventRing()
+{
+	delete[] mEvents;
+}
+
+//static
+void EventRing::initClass(U32 events_per_thread)
+{
+	{
+		LLMutexLock lock(&ring_mutex());
+		U32 capacity = 0;
+		if (events_per_thread)
+		{
+			capacity = 1;
+			while (capacity < events_per_thread)
+			{
+				capacity <<= 1;
+			}
+		}
+		sRingCapacity = capacity;
+	}
+	sEnabled = (events_per_thread != 0);
+	if (sEnabled)
+	{
+		LL_INFOS() << "Recording block timer events, " << sRingCapacity << " per thread" << LL_ENDL;
+		setThreadName("main");
+	}
+}
+
+//static
+void EventRing::cleanupClass()
+{
+	sEnabled = false;
+
+	// Other threads can be in the middle of record() with their ring, so
+	// the rings are retired rather than freed. No thread takes one up
+	// again once it sees the new generation.
+	LLMutexLock lock(&ring_mutex());
+	++sRingGeneration;
+	sRetiredRings.insert(sRetiredRings.end(), sRings.begin(), sRings.end());
+	sRings.clear();
+	sRingCapacity = 0;
+}
+
+//static
+EventRing* EventRing::getThreadRing()
+{
+	if (sThreadRing && sThreadRingGeneration == sRingGeneration.load(std::memory_order_relaxed))
+	{
+		return sThreadRing;
+	}
+
+	LLMutexLock lock(&ring_mutex());
+	if (!sEnabled || !sRingCapacity)
+	{
+		return nullptr;
+	}
+
+	// take over the ring of a thread that has exited, if there is one
+	EventRing* ring = nullptr;
+	for (EventRing* candidate : sRings)
+	{
+		if (!candidate->mInUse && candidate->mMask + 1 == sRingCapacity)
+		{
+			ring = candidate;
+			// no thread writes to it and writeChromeTrace() needs the mutex
+			ring->mClaimed.store(0, std::memory_order_relaxed);
+			ring->mHead.store(0, std::memory_order_relaxed);
+			break;
+		}
+	}
+	if (!ring)
+	{
+		ring = new EventRing(sRingCapacity, (U32)sRings.size() + 1);
+		sRings.push_back(ring);
+	}
+	ring->mInUse = true;
+	ring->mThreadName = "thread " + std::to_string(ring->mID);
+
+	sThreadRing = ring;
+	sThreadRingGeneration = sRingGeneration.load(std::memory_order_relaxed);
+	return ring;
+}
+
+//static
+void EventRing::record(BlockTimerStatHandle* timer, U64 start, U64 duration)
+{
+	EventRing* ring = getThreadRing();
+	if (ring)
+	{
+		ring->push(timer, start, duration);
+	}
+}
+
+//static
+void EventRing::setThreadName(const std::string& name)
+{
+	EventRing* ring = getThreadRing();
+	if (ring)
+	{
+		LLMutexLock lock(&ring_mutex());
+		ring->mThreadName = name;
+	}
+}
+
+//static
+void EventRing::releaseThread()
+{
+	if (!sThreadRing)
+	{
+		return;
+	}
+
+	LLMutexLock lock(&ring_mutex());
+	if (sThreadRing && sThreadRingGeneration == sRingGeneration.load(std::memory_order_relaxed))
+	{
+		sThreadRing->mInUse = false;
+	}
+	sThreadRing = nullptr;
+}
+
+void EventRing::push(BlockTimerStatHandle* timer, U64 start, U64 duration)
+{
+	const U64 head = mHead.load(std::memory_order_relaxed);
+	Event& event = mEvents[head & mMask];
+	// Claim the slot before it starts changing, so that a reader which sees
+	// any of the new values also sees the claim. See copyTo().
+	mClaimed.store(head + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	event.mTimer.store(timer, std::memory_order_relaxed);
+	event.mStart.store(start, std::memory_order_relaxed);
+	event.mDuration.store(duration, std::memory_order_relaxed);
+	mHead.store(head + 1, std::memory_order_release);
+}
+
+void EventRing::copyTo(std::vector<Snapshot>& events) const
+{
+	const U64 capacity = mMask + 1;
+	const U64 head = mHead.load(std::memory_order_acquire);
+	const U64 first = (head > capacity) ? head - capacity : 0;
+
+	const size_t base = events.size();
+	for (U64 i = first; i < head; ++i)
+	{
+		const Event& event = mEvents[i & mMask];
+		Snapshot snapshot;
+		snapshot.mTimer = event.mTimer.load(std::memory_order_relaxed);
+		snapshot.mStart = event.mStart.load(std::memory_order_relaxed);
+		snapshot.mDuration = event.mDuration.load(std::memory_order_relaxed);
+		events.push_back(snapshot);
+	}
+
+	// The writer may have lapped us while copying. Every index below
+	// claimed - capacity shares its slot with an event that has been, or is
+	// being, written since.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const U64 claimed = mClaimed.load(std::memory_order_relaxed);
+	if (claimed > first + capacity)
+	{
+		const U64 stale = llmin(claimed - capacity - first, head - first);
+		events.erase(events.begin() + base, events.begin() + base + (size_t)stale);
+	}
+}
+
+static void write_json_string(std::ostream& os, const std::string& str)
+{
+	os << '"';
+	for (char c : str)
+	{
+		switch (c)
+		{
+		case '"':	os << "\\\""; break;
+		case '\\':	os << "\\\\"; break;
+		default:
+			if ((U8)c < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", (U32)c);
+				os << escaped;
+			}
+			else
+			{
+				os << c;
+			}
+		}
+	}
+	os << '"';
+}
+
+//static
+U32 EventRing::writeChromeTrace(std::ostream& os, F64 seconds)
+{
+	struct ThreadEvents
+	{
+		U32 mID;
+		std::string mName;
+		std::vector<Snapshot> mEvents;
+	};
+	std::vector<ThreadEvents> threads;
+
+	{
+		LLMutexLock lock(&ring_mutex());
+		threads.resize(sRings.size());
+		for (size_t i = 0; i < sRings.size(); ++i)
+		{
+			threads[i].mID = sRings[i]->mID;
+			threads[i].mName = sRings[i]->mThreadName;
+			sRings[i]->copyTo(threads[i].mEvents);
+		}
+	}
+
+	const U64 now = BlockTimer::getCPUClockCount64();
+	const F64 counts_per_usec = (F64)BlockTimer::countsPerSecond() / 1000000.0;
+	const U64 window = (seconds > 0.0) ? (U64)(seconds * 1000000.0 * counts_per_usec) : now;
+	const U64 cutoff = (window < now) ? now - window : 0;
+
+	// timestamps are relative to the oldest event written
+	U64 origin = now;
+	for (const ThreadEvents& thread : threads)
+	{
+		for (const Snapshot& event : thread.mEvents)
+		{
+			if (event.mStart + event.mDuration >= cutoff && event.mTimer)
+			{
+				origin = llmin(origin, event.mStart);
+			}
+		}
+	}
+
+	U32 count = 0;
+	os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	const char* separator = "\n";
+	std::ios_base::fmtflags flags = os.flags();
+	os << std::fixed << std::setprecision(3);
+	for (const ThreadEvents& thread : threads)
+	{
+		os << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.mID
+			<< ",\"args\":{\"name\":";
+		write_json_string(os, thread.mName);
+		os << "}}";
+		separator = ",\n";
+
+		for (const Snapshot& event : thread.mEvents)
+		{
+			if (event.mStart + event.mDuration < cutoff || !event.mTimer)
+			{
+				continue;
+			}
+			os << separator << "{\"name\":";
+			write_json_string(os, event.mTimer->getName());
+			os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.mID
+				<< ",\"ts\":" << (F64)(event.mStart - origin) / counts_per_usec
+				<< ",\"dur\":" << (F64)event.mDuration / counts_per_usec << "}";
+			++count;
+		}
+	}
+	os.flags(flags);
+	os << "\n]}\n";
+	return count;
+}
+
+}
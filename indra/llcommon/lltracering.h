@@ -0,0 +1,122 @@
+/**
+ * @file lltracering.h
+ * @brief Per-thread ring buffers of recent block timer scopes
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTRACERING_H
+#define LL_LLTRACERING_H
+
+#include <atomic>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "llpreprocessor.h"
+#include "stdtypes.h"
+
+namespace LLTrace
+{
+class BlockTimerStatHandle;
+
+//============================================================================
+// EventRing
+//
+// Flight recorder for LL_RECORD_BLOCK_TIME scopes. While enabled, every
+// BlockTimer that ends on a thread with a ThreadRecorder appends one event
+// (timer, start, duration) to that thread's ring. Nothing is aggregated and
+// no lock is taken on that path: each ring has a single writer, and old
+// events are simply overwritten once the ring wraps.
+//
+// writeChromeTrace() copies the newest events of every ring, from any
+// thread, and writes them in the Chrome trace event format understood by
+// chrome://tracing and Perfetto. Entries that were overwritten while being
+// copied are detected and dropped.
+//
+// Rings are never freed while the process runs, not even by cleanupClass(),
+// as a thread can be recording into its ring at any time. The ring of a
+// thread that exits is kept, with its events, until another thread takes
+// it over.
+
+class LL_COMMON_API EventRing
+{
+public:
+	// Enables recording with rings of events_per_thread entries (rounded
+	// up to a power of two), or disables it if events_per_thread is 0.
+	// Rings that already exist keep their size.
+	static void initClass(U32 events_per_thread);
+	static void cleanupClass();
+
+	static bool isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+	// Called by ~BlockTimer while enabled
+	static void record(BlockTimerStatHandle* timer, U64 start, U64 duration);
+
+	// Names the calling thread in exported traces
+	static void setThreadName(const std::string& name);
+	// The calling thread is going away; its ring may be reused
+	static void releaseThread();
+
+	// Writes everything recorded in the last seconds (all of it if
+	// seconds <= 0) as a Chrome trace JSON document. Returns the number of
+	// events written.
+	static U32 writeChromeTrace(std::ostream& os, F64 seconds = 0.0);
+
+private:
+	struct Event
+	{
+		std::atomic<BlockTimerStatHandle*> mTimer;
+		std::atomic<U64> mStart;
+		std::atomic<U64> mDuration;
+	};
+
+	struct Snapshot
+	{
+		BlockTimerStatHandle* mTimer;
+		U64 mStart;
+		U64 mDuration;
+	};
+
+	EventRing(U32 capacity, U32 id);
+	~EventRing();
+
+	void push(BlockTimerStatHandle* timer, U64 start, U64 duration);
+	void copyTo(std::vector<Snapshot>& events) const;
+
+	static EventRing* getThreadRing();
+
+private:
+	Event* mEvents;
+	const U64 mMask;
+	std::atomic<U64> mClaimed;	// index of the slot being written, plus one
+	std::atomic<U64> mHead;		// number of events completely written
+	const U32 mID;
+	std::string mThreadName;
+	bool mInUse;
+
+	static std::atomic<bool> sEnabled;
+};
+
+}
+
+#endif // LL_LLTRACERING_H
@@ -30,6 +30,7 @@
 #include "lltracethreadrecorder.h"
 #include "llfasttimer.h"
 #include "lltrace.h"
+#include "lltracering.h"
 
 namespace LLTrace
 {
@@ -116,6 +117,7 @@ ThreadRecorder::~ThreadRecorder()
 	}
 
 	set_thread_recorder(nullptr);
+	EventRing::releaseThread();
 	delete[] mTimeBlockTreeNodes;
 
 	if (mParentRecorder)
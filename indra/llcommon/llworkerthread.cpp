@@ -36,8 +36,8 @@
 //============================================================================
 // Run on MAIN thread
 
-LLWorkerThread::LLWorkerThread(const std::string& name, bool threaded, bool should_pause) :
-	LLQueuedThread(name, threaded, should_pause)
+LLWorkerThread::LLWorkerThread(const std::string& name, bool threaded, bool should_pause, LLThreadPool* pool, U32 max_pool_tasks) :
+	LLQueuedThread(name, threaded, should_pause, pool, max_pool_tasks)
 {
 	mDeleteMutex = new LLMutex();
 
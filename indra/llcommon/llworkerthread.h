@@ -80,7 +80,8 @@ private:
 	LLMutex* mDeleteMutex;
 	
 public:
-	LLWorkerThread(const std::string& name, bool threaded = true, bool should_pause = false);
+	// With a pool, the work of up to max_pool_tasks workers may be in progress at once (see LLQueuedThread)
+	LLWorkerThread(const std::string& name, bool threaded = true, bool should_pause = false, LLThreadPool* pool = nullptr, U32 max_pool_tasks = 0);
 	~LLWorkerThread();
 
 	/*virtual*/ S32 update(F32 max_time_ms) override;
@@ -36,12 +36,15 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <map>
 #include <algorithm>                // std::sort()
 #include <stdexcept>
 // std headers
 // external library headers
 #include <boost/scoped_ptr.hpp>
 // other Linden headers
+#include "lleventtimer.h"
+#include "lltimer.h"
 #include "../test/lltut.h"
 #include "wrapllerrs.h"
 
@@ -50,6 +53,39 @@ struct Badness: public std::runtime_error
     Badness(const std::string& what): std::runtime_error(what) {}
 };
 
+// Deletes its partner, which may come after it in the snapshot
+// LLEventTimer::updateClass() walks, and optionally starts a new timer,
+// which the allocator is likely to put at the partner's address
+struct DeletingTimer: public LLEventTimer
+{
+    DeletingTimer(bool replace = false):
+        LLEventTimer(0.f),
+        mOther(NULL),
+        mReplacement(NULL),
+        mReplace(replace),
+        mTicks(0)
+    {}
+    BOOL tick()
+    {
+        ++mTicks;
+        if (mOther)
+        {
+            mOther->mOther = NULL;
+            delete mOther;
+            mOther = NULL;
+            if (mReplace)
+            {
+                mReplacement = new DeletingTimer;
+            }
+        }
+        return FALSE;
+    }
+    DeletingTimer* mOther;
+    DeletingTimer* mReplacement;
+    bool mReplace;
+    S32 mTicks;
+};
+
 struct Keyed: public LLInstanceTracker<Keyed, std::string>
 {
     Keyed(const std::string& name):
@@ -74,6 +110,23 @@ struct Unkeyed: public LLInstanceTracker<Unkeyed>
     }
 };
 
+struct HashedKeyed: public LLInstanceTracker<HashedKeyed, std::string,
+                                             LLInstanceTrackerErrorOnCollision,
+                                             LLInstanceTrackerHashed>
+{
+    HashedKeyed(const std::string& name):
+        LLInstanceTracker<HashedKeyed, std::string,
+                          LLInstanceTrackerErrorOnCollision,
+                          LLInstanceTrackerHashed>(name)
+    {}
+};
+
+struct HashedUnkeyed: public LLInstanceTracker<HashedUnkeyed, void,
+                                               LLInstanceTrackerErrorOnCollision,
+                                               LLInstanceTrackerHashed>
+{
+};
+
 /*****************************************************************************
 *   TUT
 *****************************************************************************/
@@ -234,4 +287,166 @@ namespace tut
             ensure("failed to remove instance", existing.find(&*uki) != existing.end());
         }
     }
+
+    template<> template<>
+    void object::test<6>()
+    {
+        set_test_name("LLOpenHashMap against std::map");
+        // Small integer keys collide in long runs, which exercises the
+        // backward shift in erase().
+        LLOpenHashMap<U32, U32> hashed;
+        std::map<U32, U32> reference;
+        U32 seed = 1;
+        for (S32 i = 0; i < 20000; ++i)
+        {
+            seed = seed * 1664525 + 1013904223;
+            U32 key = (seed >> 8) % 512;
+            if (seed & 1)
+            {
+                bool inserted = hashed.insert(std::make_pair(key, i)).second;
+                ensure_equals("insert", inserted, reference.insert(std::make_pair(key, i)).second);
+            }
+            else
+            {
+                ensure_equals("erase", hashed.erase(key), reference.erase(key));
+            }
+        }
+        ensure_equals("size", hashed.size(), reference.size());
+        for (U32 key = 0; key < 512; ++key)
+        {
+            LLOpenHashMap<U32, U32>::const_iterator found = hashed.find(key);
+            std::map<U32, U32>::const_iterator expected = reference.find(key);
+            ensure_equals("presence", found == hashed.end(), expected == reference.end());
+            if (expected != reference.end())
+            {
+                ensure_equals("value", found->second, expected->second);
+            }
+        }
+        size_t visited = 0;
+        for (LLOpenHashMap<U32, U32>::const_iterator it = hashed.begin(); it != hashed.end(); ++it)
+        {
+            ensure("spurious entry", reference.count(it->first));
+            ++visited;
+        }
+        ensure_equals("iteration", visited, reference.size());
+    }
+
+    template<> template<>
+    void object::test<7>()
+    {
+        set_test_name("hashed storage");
+        ensure_equals(HashedKeyed::instanceCount(), 0);
+        {
+            std::vector<HashedKeyed*> keyed;
+            for (S32 i = 0; i < 1000; ++i)
+            {
+                keyed.push_back(new HashedKeyed(llformat("key%d", i)));
+            }
+            ensure_equals(HashedKeyed::instanceCount(), 1000);
+            // drop every other instance, then check the survivors are found
+            for (S32 i = 0; i < 1000; i += 2)
+            {
+                delete keyed[i];
+            }
+            for (S32 i = 0; i < 1000; ++i)
+            {
+                HashedKeyed* found = HashedKeyed::getInstance(llformat("key%d", i));
+                ensure_equals("lookup", found, (i & 1) ? keyed[i] : NULL);
+            }
+            ensure_equals(HashedKeyed::instanceCount(), 500);
+            std::vector<std::string> keys(HashedKeyed::beginKeys(), HashedKeyed::endKeys());
+            ensure_equals(keys.size(), 500);
+            for (S32 i = 1; i < 1000; i += 2)
+            {
+                delete keyed[i];
+            }
+        }
+        ensure_equals(HashedKeyed::instanceCount(), 0);
+
+        HashedUnkeyed* dangling = NULL;
+        {
+            HashedUnkeyed one, two;
+            ensure_equals(HashedUnkeyed::getInstance(&one), &one);
+            ensure_equals(HashedUnkeyed::getInstance(&two), &two);
+            std::set<HashedUnkeyed*> instances;
+            for (HashedUnkeyed::instance_iter ii(HashedUnkeyed::beginInstances()),
+                     iend(HashedUnkeyed::endInstances()); ii != iend; ++ii)
+            {
+                instances.insert(&*ii);
+            }
+            ensure_equals(instances.size(), 2);
+            dangling = &one;
+        }
+        ensure("getInstance(T*) failed to track destruction", ! HashedUnkeyed::getInstance(dangling));
+    }
+
+    template<> template<>
+    void object::test<8>()
+    {
+        set_test_name("snapshot survives insertion");
+        Keyed one("one"), two("two");
+        Unkeyed a, b;
+        std::vector<Keyed*> added;
+        std::set<Keyed*> seen;
+        Keyed::snapshot keyed;
+        ensure_equals(keyed.size(), 2);
+        for (Keyed::snapshot::iterator it = keyed.begin(); it != keyed.end(); ++it)
+        {
+            seen.insert(&*it);
+            // enough insertions to rebalance the map under a live iterator
+            for (S32 i = 0; i < 50; ++i)
+            {
+                added.push_back(new Keyed(it->mName + llformat("%d", i)));
+            }
+        }
+        ensure("snapshot missed an instance", seen.count(&one) && seen.count(&two));
+        ensure_equals(Keyed::instanceCount(), 102);
+        for (std::vector<Keyed*>::iterator it = added.begin(); it != added.end(); ++it)
+        {
+            delete *it;
+        }
+
+        Unkeyed::snapshot unkeyed;
+        Unkeyed c;
+        ensure_equals(unkeyed.size(), 2);
+        ensure_equals(Unkeyed::instanceCount(), 3);
+    }
+
+    template<> template<>
+    void object::test<9>()
+    {
+        set_test_name("event timer deleted by another timer's tick");
+        S32 count = LLEventTimer::instanceCount();
+        DeletingTimer* a = new DeletingTimer;
+        DeletingTimer* b = new DeletingTimer;
+        a->mOther = b;
+        b->mOther = a;
+        ms_sleep(10);
+        LLEventTimer::updateClass();
+        ensure_equals("one timer deleted", LLEventTimer::instanceCount(), count + 1);
+        DeletingTimer* survivor = LLEventTimer::getInstance(a) ? a : b;
+        ensure_equals("survivor ticked once", survivor->mTicks, 1);
+        ensure("survivor forgot its partner", ! survivor->mOther);
+        delete survivor;
+    }
+
+    template<> template<>
+    void object::test<10>()
+    {
+        set_test_name("event timer started by another timer's tick");
+        S32 count = LLEventTimer::instanceCount();
+        DeletingTimer* a = new DeletingTimer(true);
+        DeletingTimer* b = new DeletingTimer(true);
+        a->mOther = b;
+        b->mOther = a;
+        ms_sleep(10);
+        LLEventTimer::updateClass();
+        ensure_equals("one timer replaced", LLEventTimer::instanceCount(), count + 2);
+        DeletingTimer* survivor = LLEventTimer::getInstance(a) ? a : b;
+        ensure("replacement started", survivor->mReplacement);
+        // even if it took the deleted timer's place in memory
+        ensure_equals("replacement not ticked in the same pass", survivor->mReplacement->mTicks, 0);
+        delete survivor->mReplacement;
+        delete survivor;
+    }
 } // namespace tut
@@ -0,0 +1,131 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llinstancetrackerbench_test.cpp
+ * @brief  Ordered vs. hashed LLInstanceTracker storage with 100k instances.
+ *
+ * This isn't a regression test: it doesn't need to be run every build, so it
+ * is only built with BUILD_BENCHMARKS, as BENCHMARK_llinstancetrackerbench, to be run by hand.
+ * It creates 100,000 instances of a tracker with each storage, times
+ * construction, random getInstance() lookups, a snapshot and destruction,
+ * and prints the cost per operation to stdout for human examination.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llinstancetracker.h"
+// STL headers
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+// std headers
+#include <chrono>
+// external library headers
+// other Linden headers
+#include "lluuid.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	const S32 INSTANCES = 100000;
+	const S32 LOOKUPS = 1000000;
+
+	template<typename KEY, EInstanceTrackerStorage STORAGE>
+	struct Tracked: public LLInstanceTracker<Tracked<KEY, STORAGE>, KEY,
+											 LLInstanceTrackerErrorOnCollision, STORAGE>
+	{
+		typedef LLInstanceTracker<Tracked<KEY, STORAGE>, KEY,
+								  LLInstanceTrackerErrorOnCollision, STORAGE> tracker_t;
+		Tracked(const KEY& key): tracker_t(key) {}
+	};
+
+	typedef std::chrono::steady_clock clock_t;
+
+	F64 ns_since(clock_t::time_point start, S32 count)
+	{
+		std::chrono::duration<F64, std::nano> elapsed = clock_t::now() - start;
+		return elapsed.count() / count;
+	}
+
+	volatile size_t sSink = 0;
+
+	template<typename KEY, EInstanceTrackerStorage STORAGE>
+	void run(const char* label, const std::vector<KEY>& keys)
+	{
+		typedef Tracked<KEY, STORAGE> tracked_t;
+		std::vector<tracked_t*> instances;
+		instances.reserve(keys.size());
+
+		clock_t::time_point start = clock_t::now();
+		for (typename std::vector<KEY>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+		{
+			instances.push_back(new tracked_t(*it));
+		}
+		F64 insert = ns_since(start, INSTANCES);
+
+		U32 seed = 1;
+		size_t found = 0;
+		start = clock_t::now();
+		for (S32 i = 0; i < LOOKUPS; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			found += (size_t)tracked_t::getInstance(keys[(seed >> 8) % INSTANCES]);
+		}
+		F64 lookup = ns_since(start, LOOKUPS);
+		sSink = found;
+
+		start = clock_t::now();
+		typename tracked_t::snapshot snapshot;
+		F64 copy = ns_since(start, INSTANCES);
+
+		start = clock_t::now();
+		for (typename std::vector<tracked_t*>::iterator it = instances.begin(); it != instances.end(); ++it)
+		{
+			delete *it;
+		}
+		F64 remove = ns_since(start, INSTANCES);
+
+		std::cout << std::setw(22) << label << std::fixed << std::setprecision(1)
+			<< std::setw(10) << insert << std::setw(10) << lookup
+			<< std::setw(10) << copy << std::setw(10) << remove << std::endl;
+	}
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llinstancetrackerbench_data
+	{
+	};
+	typedef test_group<llinstancetrackerbench_data> llinstancetrackerbench_group;
+	typedef llinstancetrackerbench_group::object object;
+	llinstancetrackerbench_group llinstancetrackerbenchgrp("llinstancetrackerbench");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("100k instances");
+		std::vector<std::string> names;
+		std::vector<LLUUID> ids;
+		for (S32 i = 0; i < INSTANCES; ++i)
+		{
+			names.push_back(llformat("Instance/%08d", i));
+			ids.push_back(LLUUID::generateNewID());
+		}
+
+		std::cout << std::endl << std::setw(22) << "ns per" << std::setw(10) << "insert"
+			<< std::setw(10) << "lookup" << std::setw(10) << "snapshot" << std::setw(10) << "remove" << std::endl;
+		run<std::string, LLInstanceTrackerOrdered>("string ordered", names);
+		run<std::string, LLInstanceTrackerHashed>("string hashed", names);
+		run<LLUUID, LLInstanceTrackerOrdered>("uuid ordered", ids);
+		run<LLUUID, LLInstanceTrackerHashed>("uuid hashed", ids);
+	}
+}
@@ -0,0 +1,186 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   lllockfreequeue_test.cpp
+ * @brief  Test for lllockfreequeue.h.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "lllockfreequeue.h"
+// STL headers
+#include <vector>
+// std headers
+// external library headers
+#include <boost/thread.hpp>
+// other Linden headers
+#include "../test/lltut.h"
+
+namespace
+{
+	const S32 PER_PRODUCER = 100000;
+
+	// Each element encodes its producer and sequence number
+	S32 make_value(S32 producer, S32 seq)
+	{
+		return producer * PER_PRODUCER + seq;
+	}
+
+	// Pop values until count have been seen, checking per-producer order
+	template<typename QUEUE>
+	bool consume(QUEUE& queue, S32 producers, S32 count)
+	{
+		std::vector<S32> next(producers, 0);
+		S32 seen = 0;
+		S32 value;
+		while (seen < count)
+		{
+			if (!queue.tryPop(value))
+			{
+				queue.waitForData();
+				continue;
+			}
+			S32 producer = value / PER_PRODUCER;
+			if (producer >= producers || value % PER_PRODUCER != next[producer]++)
+			{
+				return false;
+			}
+			++seen;
+		}
+		return queue.empty();
+	}
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct lllockfreequeue_data
+	{
+	};
+	typedef test_group<lllockfreequeue_data> lllockfreequeue_group;
+	typedef lllockfreequeue_group::object object;
+	lllockfreequeue_group lllockfreequeuegrp("lllockfreequeue");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("bounded rings report full and empty");
+		LLSPSCQueue<S32> spsc(3);
+		LLMPSCQueue<S32> mpsc(3);
+		ensure_equals("spsc rounded up", spsc.capacity(), size_t(4));
+		ensure_equals("mpsc rounded up", mpsc.capacity(), size_t(4));
+
+		S32 value;
+		ensure("spsc starts empty", spsc.empty() && !spsc.tryPop(value));
+		ensure("mpsc starts empty", mpsc.empty() && !mpsc.tryPop(value));
+		for (S32 i = 0; i < 4; ++i)
+		{
+			ensure("spsc push", spsc.tryPush(i));
+			ensure("mpsc push", mpsc.tryPush(i));
+		}
+		ensure("spsc full", !spsc.tryPush(4));
+		ensure("mpsc full", !mpsc.tryPush(4));
+
+		// Go round the ring a few times
+		for (S32 i = 0; i < 20; ++i)
+		{
+			ensure("spsc pop", spsc.tryPop(value));
+			ensure_equals("spsc order", value, i);
+			ensure("mpsc pop", mpsc.tryPop(value));
+			ensure_equals("mpsc order", value, i);
+			ensure("spsc push again", spsc.tryPush(i + 4));
+			ensure("mpsc push again", mpsc.tryPush(i + 4));
+		}
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("blocking queue overflows in order");
+		LLBlockingQueue<LLSPSCQueue<S32> > queue(4);
+		for (S32 i = 0; i < 100; ++i)
+		{
+			queue.push(i);
+		}
+
+		// Interleave pops and pushes while the overflow list is in use
+		S32 value;
+		for (S32 i = 0; i < 50; ++i)
+		{
+			ensure("pop", queue.tryPop(value));
+			ensure_equals("order", value, i);
+		}
+		queue.push(100);
+
+		std::vector<S32> rest;
+		ensure_equals("popAll count", queue.popAll(rest), size_t(51));
+		for (S32 i = 0; i < 51; ++i)
+		{
+			ensure_equals("popAll order", rest[i], 50 + i);
+		}
+		ensure("drained", queue.empty() && !queue.tryPop(value));
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		set_test_name("single producer thread");
+		LLBlockingQueue<LLSPSCQueue<S32> > queue(64);
+		boost::thread producer([&queue]()
+			{
+				for (S32 i = 0; i < PER_PRODUCER; ++i)
+				{
+					queue.push(make_value(0, i));
+				}
+			});
+		ensure("all values in order", consume(queue, 1, PER_PRODUCER));
+		producer.join();
+	}
+
+	template<> template<>
+	void object::test<4>()
+	{
+		set_test_name("multiple producer threads");
+		const S32 NUM_PRODUCERS = 4;
+		LLBlockingQueue<LLMPSCQueue<S32> > queue(64);
+		std::vector<boost::thread*> producers;
+		for (S32 p = 0; p < NUM_PRODUCERS; ++p)
+		{
+			producers.push_back(new boost::thread([&queue, p]()
+				{
+					for (S32 i = 0; i < PER_PRODUCER; ++i)
+					{
+						queue.push(make_value(p, i));
+					}
+				}));
+		}
+		ensure("all values in producer order", consume(queue, NUM_PRODUCERS, NUM_PRODUCERS * PER_PRODUCER));
+		for (boost::thread* producer : producers)
+		{
+			producer->join();
+			delete producer;
+		}
+	}
+
+	template<> template<>
+	void object::test<5>()
+	{
+		set_test_name("wake releases a waiting consumer");
+		LLBlockingQueue<LLMPSCQueue<S32> > queue(4);
+		boost::thread waker([&queue]()
+			{
+				boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+				queue.wake();
+			});
+		queue.waitForData();	// Hangs the test on failure
+		ensure("still empty", queue.empty());
+		waker.join();
+	}
+}
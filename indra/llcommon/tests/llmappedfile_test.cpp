@@ -0,0 +1,102 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llmappedfile_test.cpp
+ * @brief  Test for llmappedfile.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llmappedfile.h"
+// STL headers
+#include <string>
+// std headers
+// external library headers
+// other Linden headers
+#include "llfile.h"
+#include "lluuid.h"
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llmappedfile_data
+	{
+		llmappedfile_data()
+		:	mFilename(std::string(LLFile::tmpdir()) + "llmappedfile_" + LLUUID::generateNewID().asString())
+		{
+		}
+		~llmappedfile_data()
+		{
+			LLFile::remove(mFilename, ENOENT);
+		}
+
+		S64 fileSize()
+		{
+			llstat status;
+			return LLFile::stat(mFilename, &status) ? -1 : (S64)status.st_size;
+		}
+
+		std::string mFilename;
+	};
+	typedef test_group<llmappedfile_data> llmappedfile_group;
+	typedef llmappedfile_group::object object;
+	llmappedfile_group llmappedfilegrp("llmappedfile");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("writes reach the file");
+		{
+			LLMappedFile file;
+			ensure("create", file.open(mFilename, 8192, true));
+			ensure_equals(file.getSize(), 8192);
+			ensure_equals("new file is zeroed", file.getData()[4096], 0);
+			memcpy(file.getData() + 5000, "mapped", 6);
+			ensure("flush", file.flush(true));
+		}
+		ensure_equals("file grown", fileSize(), 8192);
+
+		// asking for less maps the whole file anyway
+		LLMappedFile file;
+		ensure("reopen", file.open(mFilename, 16, true));
+		ensure_equals(file.getSize(), 8192);
+		ensure_equals(std::string((char*)file.getData() + 5000, 6), "mapped");
+
+		// and asking for more grows it, keeping the contents
+		ensure("grow", file.open(mFilename, 16384, true));
+		ensure_equals(fileSize(), 16384);
+		ensure_equals(std::string((char*)file.getData() + 5000, 6), "mapped");
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("read-only mappings are copy-on-write");
+		LLMappedFile file;
+		ensure("missing file", !file.open(mFilename, 0, false));
+		ensure("not open", !file.isOpen());
+
+		ensure("create", file.open(mFilename, 4096, true));
+		file.getData()[10] = 'a';
+		file.close();
+
+		ensure("too short", !file.open(mFilename, 8192, false));
+		ensure("open read-only", file.open(mFilename, 0, false));
+		ensure("read-only", !file.isWritable());
+		ensure_equals(file.getData()[10], 'a');
+		file.getData()[10] = 'b';
+		ensure_equals("private copy changed", file.getData()[10], 'b');
+		file.close();
+
+		ensure("reopen", file.open(mFilename, 0, false));
+		ensure_equals("file unchanged", file.getData()[10], 'a');
+	}
+}
@@ -0,0 +1,175 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llqueuebench_test.cpp
+ * @brief  Throughput comparison of the inter-thread queues in llcommon.
+ *
+ * This isn't a regression test: it doesn't need to be run every build, so it
+ * is only built with BUILD_BENCHMARKS, as BENCHMARK_llqueuebench, to be run by hand.
+ * Rather it pushes the same stream of shared pointers through
+ *
+ * - LLThreadSafeQueue (apr_queue, mutex and two condition variables),
+ * - a mutex guarded vector with a condition variable, the scheme formerly
+ *   used by LLCore::HttpRequestQueue and LLCore::HttpReplyQueue,
+ * - LLBlockingQueue over LLSPSCQueue and LLMPSCQueue,
+ *
+ * with one consumer and a varying number of producers, and prints elements
+ * per second to stdout for human examination.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "lllockfreequeue.h"
+// STL headers
+#include <iomanip>
+#include <iostream>
+#include <vector>
+// std headers
+#include <chrono>
+// external library headers
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+// other Linden headers
+#include "llthreadsafequeue.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	typedef boost::shared_ptr<S32> element_t;
+
+	const S32 ELEMENTS = 1000000;
+
+	// The old LLCore queue scheme
+	class MutexVectorQueue
+	{
+	public:
+		void push(const element_t& element)
+		{
+			{
+				boost::unique_lock<boost::mutex> lock(mMutex);
+				mQueue.push_back(element);
+			}
+			mCondition.notify_all();
+		}
+
+		void popAll(std::vector<element_t>& out)
+		{
+			boost::unique_lock<boost::mutex> lock(mMutex);
+			while (mQueue.empty())
+			{
+				mCondition.wait(lock);
+			}
+			mQueue.swap(out);
+		}
+
+	private:
+		boost::mutex mMutex;
+		boost::condition_variable mCondition;
+		std::vector<element_t> mQueue;
+	};
+
+	struct ThreadSafeQueueAdapter
+	{
+		ThreadSafeQueueAdapter() : mQueue(nullptr, 1024) {}
+		void push(const element_t& element) { mQueue.pushFront(element); }
+		void popAll(std::vector<element_t>& out) { out.push_back(mQueue.popBack()); }
+		LLThreadSafeQueue<element_t> mQueue;
+	};
+
+	template<typename QUEUE>
+	struct LockFreeAdapter
+	{
+		LockFreeAdapter() : mQueue(1024) {}
+		void push(const element_t& element) { mQueue.push(element); }
+		void popAll(std::vector<element_t>& out)
+		{
+			while (!mQueue.popAll(out))
+			{
+				mQueue.waitForData();
+			}
+		}
+		LLBlockingQueue<QUEUE> mQueue;
+	};
+
+	template<typename ADAPTER>
+	void run(const char* name, S32 producers)
+	{
+		ADAPTER adapter;
+		const S32 per_producer = ELEMENTS / producers;
+		const element_t element(new S32(0));
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::vector<boost::thread*> threads;
+		for (S32 p = 0; p < producers; ++p)
+		{
+			threads.push_back(new boost::thread([&adapter, &element, per_producer]()
+				{
+					for (S32 i = 0; i < per_producer; ++i)
+					{
+						adapter.push(element);
+					}
+				}));
+		}
+
+		S32 received = 0;
+		std::vector<element_t> batch;
+		while (received < per_producer * producers)
+		{
+			adapter.popAll(batch);
+			received += (S32)batch.size();
+			batch.clear();
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		for (boost::thread* thread : threads)
+		{
+			thread->join();
+			delete thread;
+		}
+
+		std::cout << std::setw(28) << std::left << name << " producers " << producers << ": "
+				  << std::fixed << std::setprecision(0) << (received / elapsed.count()) << " elements/s" << std::endl;
+	}
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llqueuebench_data
+	{
+	};
+	typedef test_group<llqueuebench_data> llqueuebench_group;
+	typedef llqueuebench_group::object object;
+	llqueuebench_group llqueuebenchgrp("llqueuebench");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("single producer");
+		std::cout << std::endl;
+		run<ThreadSafeQueueAdapter>("LLThreadSafeQueue", 1);
+		run<MutexVectorQueue>("mutex + vector", 1);
+		run<LockFreeAdapter<LLSPSCQueue<element_t> > >("LLBlockingQueue<LLSPSCQueue>", 1);
+		run<LockFreeAdapter<LLMPSCQueue<element_t> > >("LLBlockingQueue<LLMPSCQueue>", 1);
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("multiple producers");
+		std::cout << std::endl;
+		for (S32 producers = 2; producers <= 8; producers *= 2)
+		{
+			run<ThreadSafeQueueAdapter>("LLThreadSafeQueue", producers);
+			run<MutexVectorQueue>("mutex + vector", producers);
+			run<LockFreeAdapter<LLMPSCQueue<element_t> > >("LLBlockingQueue<LLMPSCQueue>", producers);
+		}
+	}
+}
@@ -0,0 +1,327 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llsdbench_test.cpp
+ * @brief  Binary LLSD parse speed, and LLSD construction cost and memory.
+ *
+ * This isn't a regression test: it doesn't need to be run every build, so it
+ * is only built with BUILD_BENCHMARKS, as BENCHMARK_llsdbench, to be run by hand.
+ * Rather it parses the same binary LLSD payloads with
+ * LLSDSerialize::fromBinary(istream) and LLSDSerialize::fromBinary(buffer)
+ * and prints MB/s for each to stdout for human examination.
+ *
+ * It also builds and parses login sized documents, an inventory skeleton and
+ * an inventory item list, and prints the time, LLSD::Impl allocations and
+ * heap memory each takes. Build once as is and once with
+ * LLSD_COMPACT_STORAGE defined to 1 throughout to compare storage modes.
+ * Heap use is counted by replacing the global operator new and delete, which
+ * doesn't see allocations made inside a Windows DLL build of llcommon.
+ *
+ * Payloads are read from the files listed, comma separated, in the
+ * LL_LLSD_BENCH_FILES environment variable, e.g. mesh headers or inventory
+ * responses captured from a viewer session. Files may start with the
+ * "<? LLSD/Binary ?>" header. Without that variable a synthetic inventory
+ * skeleton is used instead.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Needed for llsd::allocationCount()
+#define LLSD_DEBUG_INFO
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llsdserialize.h"
+// STL headers
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+// std headers
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+// external library headers
+// other Linden headers
+#include "llfile.h"
+#include "llformat.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	// Each block is prefixed with its size, padded to keep the alignment
+	const size_t HEAP_HEADER = 16;
+	std::atomic<S64> sHeapBytes(0);
+	std::atomic<S64> sHeapBlocks(0);
+}
+
+void* operator new(size_t size)
+{
+	char* block = static_cast<char*>(malloc(size + HEAP_HEADER));
+	if (!block)
+	{
+		throw std::bad_alloc();
+	}
+	*reinterpret_cast<size_t*>(block) = size;
+	sHeapBytes += size;
+	++sHeapBlocks;
+	return block + HEAP_HEADER;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (ptr)
+	{
+		char* block = static_cast<char*>(ptr) - HEAP_HEADER;
+		sHeapBytes -= *reinterpret_cast<size_t*>(block);
+		--sHeapBlocks;
+		free(block);
+	}
+}
+
+void* operator new[](size_t size)								{ return operator new(size); }
+void operator delete[](void* ptr) noexcept						{ operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept				{ operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept				{ operator delete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept	{ operator delete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept	{ operator delete(ptr); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return operator new(size);
+	}
+	catch (const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept	{ return operator new(size, tag); }
+
+namespace
+{
+	typedef std::chrono::steady_clock bench_clock;
+
+	struct Payload
+	{
+		std::string mName;
+		std::string mData;
+	};
+
+	LLSD make_inventory_skeleton(S32 folders)
+	{
+		LLSD skeleton = LLSD::emptyArray();
+		for (S32 i = 0; i < folders; ++i)
+		{
+			LLSD folder;
+			LLUUID id;
+			id.generate();
+			folder["folder_id"] = id;
+			folder["parent_id"] = LLUUID::null;
+			folder["name"] = llformat("Folder %d", i);
+			folder["type_default"] = -1;
+			folder["version"] = i;
+			skeleton.append(folder);
+		}
+		return skeleton;
+	}
+
+	LLSD make_inventory_items(S32 items)
+	{
+		LLSD inventory = LLSD::emptyArray();
+		LLUUID owner_id;
+		owner_id.generate();
+		for (S32 i = 0; i < items; ++i)
+		{
+			LLSD item;
+			LLUUID id;
+			id.generate();
+			item["item_id"] = id;
+			item["parent_id"] = id;
+			item["asset_id"] = id;
+			item["name"] = llformat("Item %d", i);
+			item["desc"] = "";
+			item["type"] = i % 20;
+			item["inv_type"] = i % 18;
+			item["flags"] = 0;
+			item["created_at"] = 1500000000 + i;
+
+			LLSD& sale_info = item["sale_info"];
+			sale_info["sale_price"] = 10;
+			sale_info["sale_type"] = 0;
+
+			LLSD& permissions = item["permissions"];
+			permissions["creator_id"] = owner_id;
+			permissions["owner_id"] = owner_id;
+			permissions["last_owner_id"] = owner_id;
+			permissions["group_id"] = LLUUID::null;
+			permissions["is_owner_group"] = false;
+			permissions["base_mask"] = (S32)0x7fffffff;
+			permissions["owner_mask"] = (S32)0x7fffffff;
+			permissions["group_mask"] = 0;
+			permissions["everyone_mask"] = 0;
+			permissions["next_owner_mask"] = (S32)0x82000;
+			inventory.append(item);
+		}
+		return inventory;
+	}
+
+	std::string to_binary(const LLSD& sd)
+	{
+		std::ostringstream out;
+		LLSDSerialize::toBinary(sd, out);
+		return out.str();
+	}
+
+	std::vector<Payload> load_payloads()
+	{
+		std::vector<Payload> payloads;
+		const char* files = getenv("LL_LLSD_BENCH_FILES");
+		if (files)
+		{
+			static const std::string header("<? LLSD/Binary ?>\n");
+			std::istringstream names(files);
+			std::string name;
+			while (std::getline(names, name, ','))
+			{
+				llifstream file(name.c_str(), std::ios::binary);
+				if (!file.is_open())
+				{
+					std::cerr << "Can't open " << name << std::endl;
+					continue;
+				}
+				std::ostringstream contents;
+				contents << file.rdbuf();
+				Payload payload;
+				payload.mName = name;
+				payload.mData = contents.str();
+				if (payload.mData.compare(0, header.size(), header) == 0)
+				{
+					payload.mData.erase(0, header.size());
+				}
+				payloads.push_back(payload);
+			}
+		}
+		if (payloads.empty())
+		{
+			Payload payload;
+			payload.mName = "synthetic inventory skeleton";
+			payload.mData = to_binary(make_inventory_skeleton(20000));
+			payloads.push_back(payload);
+		}
+		return payloads;
+	}
+
+	double mb_per_second(size_t bytes, S32 passes, bench_clock::duration elapsed)
+	{
+		double seconds = std::chrono::duration<double>(elapsed).count();
+		return (double)bytes * passes / (1024.0 * 1024.0) / seconds;
+	}
+
+	template<typename MAKE>
+	void report_documents(const char* name, MAKE make)
+	{
+		const S32 COPIES = 10;
+		std::vector<LLSD> documents;
+		documents.reserve(COPIES);
+
+		U32 impls = llsd::allocationCount();
+		S64 bytes = sHeapBytes;
+		S64 blocks = sHeapBlocks;
+		bench_clock::time_point start = bench_clock::now();
+		for (S32 i = 0; i < COPIES; ++i)
+		{
+			documents.push_back(make());
+		}
+		double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+		std::cout << name << ": "
+				  << std::fixed << std::setprecision(1)
+				  << seconds * 1000.0 / COPIES << " ms, "
+				  << (llsd::allocationCount() - impls) / COPIES << " Impls, "
+				  << (sHeapBlocks - blocks) / COPIES << " blocks, "
+				  << (sHeapBytes - bytes) / 1024 / COPIES << " KB each" << std::endl;
+	}
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llsdbench_data
+	{
+	};
+	typedef test_group<llsdbench_data> llsdbench_group;
+	typedef llsdbench_group::object object;
+	llsdbench_group llsdbenchgrp("llsdbench");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("binary parse speed");
+		const S32 PASSES = 20;
+		std::cout << std::endl;
+		for (const Payload& payload : load_payloads())
+		{
+			const std::string& data = payload.mData;
+
+			bench_clock::time_point start = bench_clock::now();
+			for (S32 i = 0; i < PASSES; ++i)
+			{
+				std::istringstream stream(data);
+				LLSD sd;
+				LLSDSerialize::fromBinary(sd, stream, data.size());
+			}
+			bench_clock::duration stream_time = bench_clock::now() - start;
+
+			start = bench_clock::now();
+			for (S32 i = 0; i < PASSES; ++i)
+			{
+				LLSD sd;
+				LLSDSerialize::fromBinary(sd, (const U8*)data.data(), data.size());
+			}
+			bench_clock::duration buffer_time = bench_clock::now() - start;
+
+			std::cout << payload.mName << " (" << data.size() << " bytes): "
+					  << std::fixed << std::setprecision(1)
+					  << "istream " << mb_per_second(data.size(), PASSES, stream_time) << " MB/s, "
+					  << "buffer " << mb_per_second(data.size(), PASSES, buffer_time) << " MB/s"
+					  << std::endl;
+		}
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("document construction and memory");
+		std::cout << std::endl
+				  << (LLSD_COMPACT_STORAGE ? "compact" : "default") << " storage, "
+				  << "sizeof(LLSD) " << sizeof(LLSD) << std::endl;
+
+		const S32 FOLDERS = 20000;
+		const S32 ITEMS = 20000;
+		report_documents("build skeleton", []() { return make_inventory_skeleton(FOLDERS); });
+		report_documents("build items", []() { return make_inventory_items(ITEMS); });
+
+		const std::string skeleton = to_binary(make_inventory_skeleton(FOLDERS));
+		const std::string items = to_binary(make_inventory_items(ITEMS));
+		report_documents("parse skeleton", [&skeleton]()
+			{
+				LLSD sd;
+				LLSDSerialize::fromBinary(sd, (const U8*)skeleton.data(), skeleton.size());
+				return sd;
+			});
+		report_documents("parse items", [&items]()
+			{
+				LLSD sd;
+				LLSDSerialize::fromBinary(sd, (const U8*)items.data(), items.size());
+				return sd;
+			});
+	}
+}
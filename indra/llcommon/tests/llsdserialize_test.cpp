@@ -253,9 +253,12 @@ namespace tut
 		
 		LLPointer<LLSDFormatter> mFormatter;
 		LLPointer<LLSDParser> mParser;
+		// Also parse binary output with LLSDSerialize::fromBinary(buffer)
+		bool mCheckBinaryBuffer;
 	};
 
 	TestLLSDSerializeData::TestLLSDSerializeData()
+		: mCheckBinaryBuffer(false)
 	{
 	}
 
@@ -282,6 +285,14 @@ namespace tut
 			std::cerr << stream.str() << std::endl;
 			throw;
 		}
+
+		if (mCheckBinaryBuffer)
+		{
+			const std::string serialized(stream.str());
+			LLSD x;
+			LLSDSerialize::fromBinary(x, (const U8*)serialized.data(), serialized.size());
+			ensure_equals(msg + " (buffer)", x, v);
+		}
 	}
 
 	static void fillmap(LLSD& root, U32 width, U32 depth)
@@ -493,6 +504,7 @@ namespace tut
 	{
 		mFormatter = new LLSDBinaryFormatter();
 		mParser = new LLSDBinaryParser();
+		mCheckBinaryBuffer = true;
 		doRoundTripTests("binary serialization");
 	}
 
@@ -715,6 +727,125 @@ namespace tut
 			expected,
 			1);
 	}
+	/**
+	 * @class EventTrace
+	 * @brief LLSDXMLParser::Handler that records the events it receives.
+	 *
+	 * Collects or skips any map or array whose key is "collect" or "skip".
+	 */
+	class EventTrace : public LLSDXMLParser::Handler
+	{
+	public:
+		EAction beginMap() override		{ mTrace += "{ "; return action(); }
+		void endMap() override			{ mTrace += "} "; }
+		EAction beginArray() override	{ mTrace += "[ "; return action(); }
+		void endArray() override		{ mTrace += "] "; }
+		void key(const std::string& key) override
+		{
+			mTrace += key + ": ";
+			mKey = key;
+		}
+		void value(const LLSD& value) override
+		{
+			if (value.isMap() || value.isArray())
+			{
+				mTrace += "<collected> ";
+				mCollected.append(value);
+			}
+			else
+			{
+				mTrace += (value.isUndefined() ? "undef" : value.asString()) + " ";
+			}
+		}
+
+		EAction action()
+		{
+			EAction action = (mKey == "collect") ? COLLECT : (mKey == "skip") ? SKIP : DESCEND;
+			mKey.clear();
+			return action;
+		}
+
+		std::string mTrace;
+		std::string mKey;
+		LLSD mCollected;
+	};
+
+	template<> template<> 
+	void TestLLSDXMLParsingObject::test<5>()
+	{
+		// test event delivery, including the malformed cases above
+		std::istringstream input(
+			"<llsd><map>"
+				"<key>amy</key><integer>23</integer>"
+				"<key>bob</key><bigint>99999999999999999</bigint>"
+				"<html><body>ha ha</body></html>"
+				"<string>no key</string>"
+				"<key>cam</key><array>"
+					"<real>1.5</real>"
+					"<map><key>dan</key><boolean>true</boolean></map>"
+					"<integer><string>nested in scalar</string></integer>"
+				"</array>"
+				"<key>eve</key><undef />"
+			"</map></llsd>");
+		EventTrace trace;
+		S32 count = LLSDSerialize::fromXMLEvents(trace, input);
+		ensure_equals("events",
+			trace.mTrace,
+			"{ amy: 23 bob: undef cam: [ 1.5 { dan: true } 0 ] eve: undef } ");
+		ensure_equals("count", count, 9);
+
+		std::istringstream bad("<llsd><map><key>amy</key><integer>23</integer>");
+		EventTrace partial;
+		ensure_equals("malformed xml",
+			LLSDSerialize::fromXMLEvents(partial, bad, false),
+			LLSDParser::PARSE_FAILURE);
+		ensure_equals("events before failure", partial.mTrace, "{ amy: 23 ");
+	}
+
+	template<> template<> 
+	void TestLLSDXMLParsingObject::test<6>()
+	{
+		// test collecting and skipping subtrees
+		std::istringstream input(
+			"<llsd><map>"
+				"<key>skip</key><map>"
+					"<key>amy</key><integer>1</integer>"
+				"</map>"
+				"<key>collect</key><array>"
+					"<map><key>bob</key><integer>2</integer></map>"
+					"<string>cam</string>"
+				"</array>"
+				"<key>list</key><array>"
+					"<integer>3</integer>"
+				"</array>"
+				"<key>collect</key><map>"
+					"<key>skip</key><array><integer>4</integer></array>"
+				"</map>"
+			"</map></llsd>");
+		EventTrace trace;
+		LLPointer<LLSDXMLParser> parser = new LLSDXMLParser;
+		parser->parseEvents(input, trace);
+		ensure_equals("events",
+			trace.mTrace,
+			"{ skip: { collect: [ <collected> list: [ 3 ] collect: { <collected> } ");
+
+		LLSD first;
+		first[0]["bob"] = 2;
+		first[1] = "cam";
+		LLSD second;
+		second["skip"][0] = 4;
+		ensure_equals("collected array", trace.mCollected[0], first);
+		ensure_equals("collected map", trace.mCollected[1], second);
+		ensure_equals("collected count", trace.mCollected.size(), 2);
+
+		// the same parser can be reused for a tree afterwards
+		std::istringstream again("<llsd><integer>5</integer></llsd>");
+		LLSD result;
+		parser->reset();
+		ensure_equals("reparse", parser->parse(again, result, LLSDSerialize::SIZE_UNLIMITED), 1);
+		ensure_equals("reparse value", result.asInteger(), 5);
+	}
+
 	/*
 	TODO:
 		test XML parsing
@@ -984,6 +1115,30 @@ namespace tut
 	{
 	public:
 		TestLLSDBinaryParsing() {}
+
+		// Every case is also run through the buffer parser, which must agree
+		// with the stream parser.
+		void ensureParse(
+			const std::string& msg,
+			const std::string& in,
+			const LLSD& expected_value,
+			S32 expected_count)
+		{
+			TestLLSDParsing<LLSDBinaryParser>::ensureParse(msg, in, expected_value, expected_count);
+
+			LLSD parsed_result;
+			size_t consumed = 0;
+			S32 parsed_count = LLSDSerialize::fromBinary(
+				parsed_result, (const U8*)in.data(), in.size(), &consumed);
+			std::string buffer_msg(msg);
+			buffer_msg += " (buffer)";
+			ensure_equals(buffer_msg, parsed_result, expected_value);
+			ensure_equals(buffer_msg + " (count)", parsed_count, expected_count);
+			if (parsed_count > 0)
+			{
+				ensure_equals(buffer_msg + " (consumed)", consumed, in.size());
+			}
+		}
 	};
 
 	typedef tut::test_group<TestLLSDBinaryParsing> TestLLSDBinaryParsingGroup;
@@ -0,0 +1,160 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llsdzipbatch_test.cpp
+ * @brief  Test for llsdzipbatch and the buffer based zip functions.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llsdzipbatch.h"
+// STL headers
+#include <sstream>
+// std headers
+// external library headers
+// other Linden headers
+#include "llformat.h"
+#include "llsdserialize.h"
+#include "llthreadpool.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	LLSD make_block(S32 seed, S32 entries)
+	{
+		LLSD block;
+		for (S32 i = 0; i < entries; ++i)
+		{
+			LLSD& entry = block[llformat("entry%d", i)];
+			entry["index"] = seed + i;
+			entry["scale"] = (seed + i) * 0.25;
+			entry["name"] = llformat("block %d entry %d", seed, i);
+			entry["data"] = LLSD::Binary(64, (U8)(seed + i));
+		}
+		return block;
+	}
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llsdzipbatch_data
+	{
+	};
+	typedef test_group<llsdzipbatch_data> llsdzipbatch_group;
+	typedef llsdzipbatch_group::object object;
+	llsdzipbatch_group llsdzipbatchgrp("llsdzipbatch");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("buffer and stream unzip agree");
+		LLSD block = make_block(1, 500);
+		std::string zipped = zip_llsd(block);
+		ensure("zipped", !zipped.empty());
+
+		LLSD from_buffer;
+		ensure("buffer unzip", unzip_llsd(from_buffer, (const U8*)zipped.data(), zipped.size()));
+		ensure_equals("buffer result", from_buffer, block);
+
+		std::istringstream stream(zipped);
+		LLSD from_stream;
+		ensure("stream unzip", unzip_llsd(from_stream, stream, zipped.size()));
+		ensure_equals("stream result", from_stream, block);
+
+		// output smaller than the data has to grow; a larger one is reused
+		std::vector<U8> out;
+		out.reserve(16);
+		ensure("small output", unzip_buffer((const U8*)zipped.data(), zipped.size(), out));
+		size_t size = out.size();
+		out.clear();
+		out.reserve(size * 2);
+		const U8* storage = out.data();
+		ensure("large output", unzip_buffer((const U8*)zipped.data(), zipped.size(), out));
+		ensure_equals("same size", out.size(), size);
+		ensure("no reallocation", out.data() == storage);
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("corrupt input");
+		LLSD block = make_block(2, 50);
+		std::string zipped = zip_llsd(block);
+		std::vector<U8> out;
+		ensure("truncated", !unzip_buffer((const U8*)zipped.data(), zipped.size() / 2, out));
+		ensure("empty", !unzip_buffer((const U8*)zipped.data(), 0, out));
+
+		std::string garbage(zipped);
+		garbage[0] = 0;
+		LLSD result;
+		ensure("bad header", !unzip_llsd(result, (const U8*)garbage.data(), garbage.size()));
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		set_test_name("batch on a pool");
+		LLThreadPool pool("test", 4);
+
+		const S32 BLOCKS = 16;
+		std::vector<LLSD> blocks;
+		LLPointer<LLSDZipBatch> zip = new LLSDZipBatch;
+		for (S32 i = 0; i < BLOCKS; ++i)
+		{
+			blocks.push_back(make_block(i * 100, 200));
+			ensure_equals("zip index", zip->addZip(blocks.back()), (U32)i);
+		}
+		zip->start(&pool);
+		zip->wait();
+		ensure("zip done", zip->isDone());
+
+		LLPointer<LLSDZipBatch> unzip = new LLSDZipBatch;
+		for (S32 i = 0; i < BLOCKS; ++i)
+		{
+			ensure(llformat("zip %d", i), zip->succeeded(i));
+			unzip->addUnzip((const U8*)zip->getZipped(i).data(), zip->getZipped(i).size());
+		}
+		// a corrupt block fails on its own
+		static const U8 bad[] = { 1, 2, 3, 4 };
+		U32 bad_index = unzip->addUnzip(bad, sizeof(bad));
+		unzip->start(&pool);
+		unzip->wait();
+
+		for (S32 i = 0; i < BLOCKS; ++i)
+		{
+			ensure(llformat("unzip %d", i), unzip->succeeded(i));
+			ensure_equals(llformat("block %d", i), unzip->getUnzipped(i), blocks[i]);
+		}
+		ensure("bad block", !unzip->succeeded(bad_index));
+	}
+
+	template<> template<>
+	void object::test<4>()
+	{
+		set_test_name("batch without a pool");
+		LLPointer<LLSDZipBatch> batch = new LLSDZipBatch;
+		LLSD block = make_block(3, 10);
+		batch->addZip(block);
+		if (!LLThreadPool::getShared())
+		{
+			batch->start();
+			ensure("ran inline", batch->isDone());
+		}
+		else
+		{
+			batch->start();
+		}
+		batch->wait();
+		LLSD result;
+		ensure("round trip", unzip_llsd(result, (const U8*)batch->getZipped(0).data(), batch->getZipped(0).size()));
+		ensure_equals("result", result, block);
+	}
+}
@@ -0,0 +1,111 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llstringtable_test.cpp
+ * @brief  Test for llstringtable.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llstringtable.h"
+// STL headers
+#include <string>
+#include <vector>
+// std headers
+// external library headers
+#include <boost/thread.hpp>
+// other Linden headers
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llstringtable_data
+	{
+	};
+	typedef test_group<llstringtable_data> llstringtable_group;
+	typedef llstringtable_group::object object;
+	llstringtable_group llstringtablegrp("llstringtable");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("interning and reference counts");
+		LLStringTable table(64);
+		ensure("empty table", !table.checkString("alpha"));
+
+		std::string alpha("alpha");
+		char* first = table.addString(alpha);
+		ensure_equals("copy of the string", std::string(first), "alpha");
+		ensure("copy, not the argument", first != alpha.c_str());
+		ensure_equals("same string, same copy", table.addString("alpha"), first);
+		ensure("different string", table.addString("beta") != first);
+		ensure_equals("entry", table.checkStringEntry("alpha")->mString, first);
+		ensure_equals(table.mUniqueEntries, 2);
+
+		// added twice, so it survives one removal
+		table.removeString("alpha");
+		ensure_equals("still referenced", table.checkString("alpha"), first);
+		table.removeString("alpha");
+		ensure("released", !table.checkString("alpha"));
+		ensure_equals(table.mUniqueEntries, 1);
+		ensure("other strings untouched", table.checkString("beta"));
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("long strings are truncated");
+		LLStringTable table(64);
+		std::string longest(MAX_STRINGS_LENGTH - 1, 'x');
+		char* stored = table.addString(longest + "yz");
+		ensure_equals("truncated", std::string(stored), longest);
+		ensure_equals("truncation is the same string", table.checkString(longest), stored);
+		ensure_equals(table.mUniqueEntries, 1);
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		set_test_name("threads intern the same strings");
+		LLStringTable table(0);
+		const S32 THREADS = 4;
+		const S32 STRINGS = 2000;
+		std::vector<std::vector<LLStringTableEntry*> > results(THREADS);
+		std::vector<boost::thread*> threads;
+		for (S32 t = 0; t < THREADS; ++t)
+		{
+			std::vector<LLStringTableEntry*>* entries = &results[t];
+			threads.push_back(new boost::thread([&table, entries, STRINGS]()
+				{
+					for (S32 i = 0; i < STRINGS; ++i)
+					{
+						entries->push_back(table.addStringEntry(llformat("string %d", i)));
+					}
+				}));
+		}
+		for (boost::thread* thread : threads)
+		{
+			thread->join();
+			delete thread;
+		}
+
+		ensure_equals(table.mUniqueEntries, STRINGS);
+		for (S32 i = 0; i < STRINGS; ++i)
+		{
+			LLStringTableEntry* entry = table.checkStringEntry(llformat("string %d", i));
+			ensure_equals("reference count", entry->mCount, THREADS);
+			for (S32 t = 0; t < THREADS; ++t)
+			{
+				ensure_equals("one entry per string", results[t][i], entry);
+			}
+		}
+	}
+}
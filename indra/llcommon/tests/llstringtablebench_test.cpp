@@ -0,0 +1,207 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llstringtablebench_test.cpp
+ * @brief  Intern/lookup throughput of LLStringTable against its predecessor.
+ *
+ * This isn't a regression test: it doesn't need to be run every build, so it
+ * is only built with BUILD_BENCHMARKS, as BENCHMARK_llstringtablebench, to be run by hand.
+ * LegacyStringTable below is the list-per-bucket table LLStringTable used to
+ * be, made usable from several threads the only way it could be, with one
+ * lock around the whole table. Both intern and then look up the same set of
+ * names, from 1 to 8 threads, and the throughput goes to stdout for human
+ * examination.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llstringtable.h"
+// STL headers
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+// std headers
+#include <chrono>
+// external library headers
+#include <boost/thread.hpp>
+// other Linden headers
+#include "../test/lltut.h"
+
+namespace
+{
+	const S32 NAMES = 20000;
+	const S32 LOOKUPS_PER_THREAD = 500000;
+
+	class LegacyStringTable
+	{
+	public:
+		LegacyStringTable(U32 tablesize) : mMaxEntries(tablesize), mStringList(tablesize) {}
+		~LegacyStringTable()
+		{
+			for (string_list_t& strlist : mStringList)
+			{
+				for (LLStringTableEntry* entry : strlist)
+				{
+					delete entry;
+				}
+			}
+		}
+
+		LLStringTableEntry* checkStringEntry(const char* str)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			string_list_t& strlist = mStringList[hash_my_string(str)];
+			for (LLStringTableEntry* entry : strlist)
+			{
+				if (!strncmp(entry->mString, str, MAX_STRINGS_LENGTH))
+				{
+					return entry;
+				}
+			}
+			return nullptr;
+		}
+
+		LLStringTableEntry* addStringEntry(const char* str)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			string_list_t& strlist = mStringList[hash_my_string(str)];
+			for (LLStringTableEntry* entry : strlist)
+			{
+				if (!strncmp(entry->mString, str, MAX_STRINGS_LENGTH))
+				{
+					entry->incCount();
+					return entry;
+				}
+			}
+			LLStringTableEntry* entry = new LLStringTableEntry(str);
+			strlist.push_front(entry);
+			return entry;
+		}
+
+	private:
+		U32 hash_my_string(const char* str) const
+		{
+			U32 retval = 0;
+			while (*str)
+			{
+				retval = (retval<<4) + *str;
+				U32 x = (retval & 0xf0000000);
+				if (x) retval = retval ^ (x>>24);
+				retval = retval & (~x);
+				str++;
+			}
+			return (retval & (mMaxEntries-1));
+		}
+
+		typedef std::list<LLStringTableEntry*> string_list_t;
+		U32 mMaxEntries;
+		std::vector<string_list_t> mStringList;
+		std::mutex mMutex;
+	};
+
+	typedef std::chrono::steady_clock clock_t;
+
+	F64 seconds_since(clock_t::time_point start)
+	{
+		return std::chrono::duration<F64>(clock_t::now() - start).count();
+	}
+
+	volatile size_t sSink = 0;
+
+	// Returns millions of operations per second for interning every name
+	// from each thread, then for random lookups from each thread.
+	template<typename TABLE>
+	std::pair<F64, F64> run(const std::vector<std::string>& names, S32 thread_count)
+	{
+		TABLE table(32768);
+		std::vector<boost::thread*> threads;
+
+		clock_t::time_point start = clock_t::now();
+		for (S32 t = 0; t < thread_count; ++t)
+		{
+			threads.push_back(new boost::thread([&table, &names, t]()
+				{
+					// each thread walks the names from a different place
+					for (S32 i = 0; i < NAMES; ++i)
+					{
+						table.addStringEntry(names[(i + t * NAMES / 8) % NAMES].c_str());
+					}
+				}));
+		}
+		for (boost::thread* thread : threads)
+		{
+			thread->join();
+			delete thread;
+		}
+		threads.clear();
+		F64 intern = NAMES * thread_count / seconds_since(start) / 1e6;
+
+		start = clock_t::now();
+		for (S32 t = 0; t < thread_count; ++t)
+		{
+			threads.push_back(new boost::thread([&table, &names, t]()
+				{
+					U32 seed = t + 1;
+					size_t found = 0;
+					for (S32 i = 0; i < LOOKUPS_PER_THREAD; ++i)
+					{
+						seed = seed * 1664525 + 1013904223;
+						found += (size_t)table.checkStringEntry(names[(seed >> 8) % NAMES].c_str());
+					}
+					sSink = found;
+				}));
+		}
+		for (boost::thread* thread : threads)
+		{
+			thread->join();
+			delete thread;
+		}
+		F64 lookup = LOOKUPS_PER_THREAD * thread_count / seconds_since(start) / 1e6;
+		return std::make_pair(intern, lookup);
+	}
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llstringtablebench_data
+	{
+	};
+	typedef test_group<llstringtablebench_data> llstringtablebench_group;
+	typedef llstringtablebench_group::object object;
+	llstringtablebench_group llstringtablebenchgrp("llstringtablebench");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("intern and lookup throughput");
+		// the sort of names LLXMLNode interns
+		std::vector<std::string> names;
+		for (S32 i = 0; i < NAMES; ++i)
+		{
+			names.push_back(llformat("panel_%d.button_%d.label", i / 16, i % 16));
+		}
+
+		std::cout << std::endl << std::setw(8) << "threads" << std::setw(16) << "legacy Mintern/s"
+			<< std::setw(16) << "legacy Mlookup/s" << std::setw(16) << "sharded Mintern/s"
+			<< std::setw(18) << "sharded Mlookup/s" << std::endl;
+		for (S32 thread_count : { 1, 2, 4, 8 })
+		{
+			std::pair<F64, F64> legacy = run<LegacyStringTable>(names, thread_count);
+			std::pair<F64, F64> sharded = run<LLStringTable>(names, thread_count);
+			std::cout << std::setw(8) << thread_count << std::fixed << std::setprecision(2)
+				<< std::setw(16) << legacy.first << std::setw(16) << legacy.second
+				<< std::setw(16) << sharded.first << std::setw(18) << sharded.second << std::endl;
+		}
+	}
+}
@@ -0,0 +1,274 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llthreadpool_test.cpp
+ * @brief  Test for llthreadpool.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llthreadpool.h"
+// STL headers
+// std headers
+// external library headers
+// other Linden headers
+#include "llqueuedthread.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	// Wait up to 10 seconds for counter to reach expected
+	bool wait_for(const LLAtomicS32& counter, S32 expected)
+	{
+		for (S32 i = 0; i < 1000 && counter < expected; ++i)
+		{
+			ms_sleep(10);
+		}
+		return counter == expected;
+	}
+
+	class CountingRequest : public LLQueuedThread::QueuedRequest
+	{
+	public:
+		CountingRequest(LLQueuedThread::handle_t handle, U32 priority, LLAtomicS32& counter, S32 passes):
+			LLQueuedThread::QueuedRequest(handle, priority, LLQueuedThread::FLAG_AUTO_COMPLETE),
+			mCounter(counter),
+			mPasses(passes)
+		{}
+
+		bool processRequest() override
+		{
+			// Report incomplete a few times to exercise re-queueing
+			if (--mPasses > 0)
+			{
+				return false;
+			}
+			++mCounter;
+			return true;
+		}
+
+	private:
+		LLAtomicS32& mCounter;
+		S32 mPasses;
+	};
+
+	// Not done until told so, counts the passes it is given meanwhile
+	class WaitingRequest : public LLQueuedThread::QueuedRequest
+	{
+	public:
+		WaitingRequest(LLQueuedThread::handle_t handle, LLAtomicS32& passes, LLAtomic32<bool>& done):
+			LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_NORMAL, LLQueuedThread::FLAG_AUTO_COMPLETE),
+			mPasses(passes),
+			mDone(done)
+		{}
+
+		bool processRequest() override
+		{
+			++mPasses;
+			return mDone;
+		}
+
+	private:
+		LLAtomicS32& mPasses;
+		LLAtomic32<bool>& mDone;
+	};
+
+	// Counts how many requests of its kind are processed at the same time
+	class OverlappingRequest : public LLQueuedThread::QueuedRequest
+	{
+	public:
+		OverlappingRequest(LLQueuedThread::handle_t handle, LLAtomicS32& running, LLAtomicS32& max_running, LLAtomicS32& counter):
+			LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_NORMAL, LLQueuedThread::FLAG_AUTO_COMPLETE),
+			mRunning(running),
+			mMaxRunning(max_running),
+			mCounter(counter)
+		{}
+
+		bool processRequest() override
+		{
+			S32 running = ++mRunning;
+			S32 max_running = mMaxRunning;
+			while (running > max_running && !mMaxRunning.compare_exchange_weak(max_running, running))
+			{
+			}
+			ms_sleep(2);
+			--mRunning;
+			++mCounter;
+			return true;
+		}
+
+	private:
+		LLAtomicS32& mRunning;
+		LLAtomicS32& mMaxRunning;
+		LLAtomicS32& mCounter;
+	};
+
+	class PooledQueue : public LLQueuedThread
+	{
+	public:
+		PooledQueue(LLThreadPool* pool, U32 max_tasks = 0):
+			LLQueuedThread("pooled", true, false, pool, max_tasks)
+		{}
+
+		void add(LLAtomicS32& counter, S32 passes)
+		{
+			addRequest(new CountingRequest(generateHandle(), PRIORITY_NORMAL, counter, passes));
+		}
+
+		void addWaiting(LLAtomicS32& passes, LLAtomic32<bool>& done)
+		{
+			addRequest(new WaitingRequest(generateHandle(), passes, done));
+		}
+
+		void addOverlapping(LLAtomicS32& running, LLAtomicS32& max_running, LLAtomicS32& counter)
+		{
+			addRequest(new OverlappingRequest(generateHandle(), running, max_running, counter));
+		}
+	};
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llthreadpool_data
+	{
+	};
+	typedef test_group<llthreadpool_data> llthreadpool_group;
+	typedef llthreadpool_group::object object;
+	llthreadpool_group llthreadpoolgrp("llthreadpool");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("every posted task runs");
+		LLThreadPool pool("test", 4);
+		ensure_equals("worker count", pool.getWorkerCount(), 4U);
+
+		LLAtomicS32 counter(0);
+		for (S32 i = 0; i < 1000; ++i)
+		{
+			U32 priority = (i % 2) ? LLQueuedThread::PRIORITY_HIGH : LLQueuedThread::PRIORITY_LOW;
+			ensure("post", pool.post([&counter](){ ++counter; }, priority));
+		}
+		ensure("all tasks ran", wait_for(counter, 1000));
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("tasks posted from a worker");
+		LLThreadPool pool("test", 2);
+
+		LLAtomicS32 counter(0);
+		LLAtomicS32 on_worker(0);
+		for (S32 i = 0; i < 10; ++i)
+		{
+			pool.post([&pool, &counter, &on_worker]()
+				{
+					if (pool.isWorkerThread())
+					{
+						++on_worker;
+					}
+					for (S32 j = 0; j < 10; ++j)
+					{
+						pool.post([&counter](){ ++counter; }, LLQueuedThread::PRIORITY_NORMAL);
+					}
+				},
+				LLQueuedThread::PRIORITY_NORMAL);
+		}
+		ensure("all nested tasks ran", wait_for(counter, 100));
+		ensure_equals("outer tasks ran on workers", (S32)on_worker, 10);
+		ensure("main thread is not a worker", !pool.isWorkerThread());
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		set_test_name("pooled LLQueuedThread");
+		LLThreadPool pool("test", 4);
+		LLAtomicS32 counter(0);
+		{
+			PooledQueue queue(&pool);
+			ensure("pooled queue is threaded", queue.getThreaded());
+			for (S32 i = 0; i < 200; ++i)
+			{
+				queue.add(counter, 1 + (i % 3));
+			}
+			queue.waitOnPending();
+			ensure_equals("all requests completed", (S32)counter, 200);
+			ensure_equals("nothing left pending", queue.getPending(), 0);
+		}
+		ensure_equals("no pool tasks left", pool.getPending(), 0);
+	}
+
+	template<> template<>
+	void object::test<4>()
+	{
+		set_test_name("unfinished requests wait for the next update");
+		LLThreadPool pool("test", 2);
+		LLAtomicS32 passes(0);
+		LLAtomic32<bool> done(false);
+		{
+			PooledQueue queue(&pool);
+			queue.addWaiting(passes, done);
+			ensure("first pass", wait_for(passes, 1));
+			ms_sleep(50);
+			ensure_equals("not reposted without an update", (S32)passes, 1);
+
+			queue.update(0);
+			ensure("second pass after update", wait_for(passes, 2));
+
+			done = true;
+			queue.waitOnPending();
+			ensure_equals("nothing left pending", queue.getPending(), 0);
+		}
+	}
+
+	template<> template<>
+	void object::test<5>()
+	{
+		set_test_name("pooled LLQueuedThread outliving its pool");
+		LLThreadPool pool("test", 1);
+		LLAtomicS32 counter(0);
+		{
+			PooledQueue queue(&pool);
+			for (S32 i = 0; i < 200; ++i)
+			{
+				queue.add(counter, 1);
+			}
+			// Drops whatever has not run yet, the queue must still see
+			// those tasks as finished or its shutdown times out.
+			pool.shutdown();
+		}
+		ensure("no request ran twice", counter <= 200);
+	}
+
+	template<> template<>
+	void object::test<6>()
+	{
+		set_test_name("pooled LLQueuedThread with a task limit");
+		LLThreadPool pool("test", 4);
+		LLAtomicS32 running(0);
+		LLAtomicS32 max_running(0);
+		LLAtomicS32 counter(0);
+		{
+			PooledQueue queue(&pool, 2);
+			ensure_equals("task limit", queue.getMaxPoolTasks(), 2U);
+			for (S32 i = 0; i < 50; ++i)
+			{
+				queue.addOverlapping(running, max_running, counter);
+			}
+			queue.waitOnPending();
+			ensure_equals("all requests completed", (S32)counter, 50);
+		}
+		ensure("never more than the limit at once", max_running <= 2);
+	}
+}
@@ -0,0 +1,143 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   lltracering_test.cpp
+ * @brief  Test for lltracering.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "lltracering.h"
+// STL headers
+#include <sstream>
+// std headers
+// external library headers
+// other Linden headers
+#include "llfasttimer.h"
+#include "llthread.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	LLTrace::BlockTimerStatHandle FTM_RING_OUTER("ring test outer");
+	LLTrace::BlockTimerStatHandle FTM_RING_INNER("ring test inner");
+	LLTrace::BlockTimerStatHandle FTM_RING_WORKER("ring test \"worker\"");
+
+	void timed_scopes(S32 count)
+	{
+		LL_RECORD_BLOCK_TIME(FTM_RING_OUTER);
+		for (S32 i = 0; i < count; ++i)
+		{
+			LL_RECORD_BLOCK_TIME(FTM_RING_INNER);
+		}
+	}
+
+	S32 occurrences(const std::string& text, const std::string& what)
+	{
+		S32 count = 0;
+		for (size_t pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1))
+		{
+			++count;
+		}
+		return count;
+	}
+
+	class TimedThread : public LLThread
+	{
+	public:
+		TimedThread() : LLThread("ring worker") {}
+
+		void run() override
+		{
+			LL_RECORD_BLOCK_TIME(FTM_RING_WORKER);
+		}
+	};
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct lltracering_data
+	{
+		lltracering_data()
+		{
+			LLTrace::EventRing::initClass(1024);
+		}
+		~lltracering_data()
+		{
+			LLTrace::EventRing::cleanupClass();
+		}
+
+		std::string trace(U32* count = nullptr)
+		{
+			std::ostringstream out;
+			U32 written = LLTrace::EventRing::writeChromeTrace(out);
+			if (count)
+			{
+				*count = written;
+			}
+			return out.str();
+		}
+	};
+	typedef test_group<lltracering_data> lltracering_group;
+	typedef lltracering_group::object object;
+	lltracering_group lltracering("lltracering");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("scopes are recorded");
+		timed_scopes(3);
+
+		U32 count = 0;
+		std::string json = trace(&count);
+		ensure_equals("events", count, 4U);
+		ensure_equals("outer", occurrences(json, "\"name\":\"ring test outer\",\"ph\":\"X\""), 1);
+		ensure_equals("inner", occurrences(json, "\"name\":\"ring test inner\",\"ph\":\"X\""), 3);
+		ensure("main thread named", json.find("\"args\":{\"name\":\"main\"}") != std::string::npos);
+		ensure("document", json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+		ensure("closed", json.find("]}") != std::string::npos);
+
+		LLTrace::EventRing::initClass(0);
+		timed_scopes(3);
+		trace(&count);
+		ensure_equals("nothing added while disabled", count, 4U);
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("ring keeps the newest events");
+		timed_scopes(5000);
+
+		U32 count = 0;
+		std::string json = trace(&count);
+		ensure_equals("ring is full", count, 1024U);
+		// the outer scope ended last, so it survived the wrap
+		ensure_equals("outer", occurrences(json, "\"name\":\"ring test outer\""), 1);
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		set_test_name("worker threads");
+		TimedThread* thread = new TimedThread;
+		thread->start();
+		while (!thread->isStopped())
+		{
+			ms_sleep(1);
+		}
+		delete thread;
+
+		std::string json = trace();
+		ensure("worker event, escaped", json.find("\"name\":\"ring test \\\"worker\\\"\",\"ph\":\"X\"") != std::string::npos);
+		ensure("worker named", json.find("\"args\":{\"name\":\"ring worker\"}") != std::string::npos);
+	}
+}
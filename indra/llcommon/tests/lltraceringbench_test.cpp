@@ -0,0 +1,122 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   lltraceringbench_test.cpp
+ * @brief  Cost of recording block timer scopes into LLTrace::EventRing.
+ *
+ * This isn't a regression test: it doesn't need to be run every build, so it
+ * is only built with BUILD_BENCHMARKS, as BENCHMARK_lltraceringbench, to be run by hand.
+ * It times the same nest of LL_RECORD_BLOCK_TIME scopes, each doing a small
+ * amount of work, with event recording off and on, and prints the cost per
+ * scope and the relative overhead to stdout for human examination.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "lltracering.h"
+// STL headers
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+// std headers
+#include <chrono>
+// external library headers
+// other Linden headers
+#include "llfasttimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	LLTrace::BlockTimerStatHandle FTM_BENCH_FRAME("bench frame");
+	LLTrace::BlockTimerStatHandle FTM_BENCH_OUTER("bench outer");
+	LLTrace::BlockTimerStatHandle FTM_BENCH_INNER("bench inner");
+
+	const S32 FRAMES = 200;
+	const S32 OUTER = 100;
+	const S32 INNER = 10;
+	const S32 SCOPES = FRAMES * (1 + OUTER * (1 + INNER));
+
+	volatile U32 sSink = 0;
+
+	// roughly a few hundred nanoseconds of work, the short end of what the
+	// viewer puts in a timed scope
+	void work(U32 iterations)
+	{
+		U32 value = sSink;
+		for (U32 i = 0; i < iterations; ++i)
+		{
+			value = value * 1664525 + 1013904223;
+		}
+		sSink = value;
+	}
+
+	// Returns nanoseconds per scope
+	F64 run(U32 iterations)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (S32 frame = 0; frame < FRAMES; ++frame)
+		{
+			LL_RECORD_BLOCK_TIME(FTM_BENCH_FRAME);
+			for (S32 outer = 0; outer < OUTER; ++outer)
+			{
+				LL_RECORD_BLOCK_TIME(FTM_BENCH_OUTER);
+				for (S32 inner = 0; inner < INNER; ++inner)
+				{
+					LL_RECORD_BLOCK_TIME(FTM_BENCH_INNER);
+					work(iterations);
+				}
+			}
+		}
+		std::chrono::duration<F64, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count() / SCOPES;
+	}
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct lltraceringbench_data
+	{
+	};
+	typedef test_group<lltraceringbench_data> lltraceringbench_group;
+	typedef lltraceringbench_group::object object;
+	lltraceringbench_group lltraceringbenchgrp("lltraceringbench");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("recording overhead");
+		std::cout << std::endl << std::setw(12) << "work" << std::setw(12) << "off ns"
+			<< std::setw(12) << "on ns" << std::setw(12) << "overhead" << std::endl;
+		for (U32 iterations : { 0U, 100U, 400U, 1600U })
+		{
+			F64 off = 0.0, on = 0.0;
+			// best of a few alternating runs, to keep noise out
+			for (S32 pass = 0; pass < 5; ++pass)
+			{
+				LLTrace::EventRing::initClass(0);
+				F64 t = run(iterations);
+				off = pass ? llmin(off, t) : t;
+
+				LLTrace::EventRing::initClass(1 << 16);
+				t = run(iterations);
+				on = pass ? llmin(on, t) : t;
+			}
+			std::cout << std::setw(12) << iterations << std::fixed << std::setprecision(1)
+				<< std::setw(12) << off << std::setw(12) << on
+				<< std::setw(11) << (on - off) * 100.0 / off << "%" << std::endl;
+		}
+
+		std::ostringstream json;
+		U32 events = LLTrace::EventRing::writeChromeTrace(json, 1.0);
+		std::cout << events << " events in the last second, " << json.str().size() / 1024 << " KB of JSON" << std::endl;
+		LLTrace::EventRing::cleanupClass();
+	}
+}
@@ -0,0 +1,209 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file _httpadaptivelimit.cpp
+ * @brief Internal definitions of the adaptive concurrency controller
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "_httpadaptivelimit.h"
+
+#include "_httpinternal.h"
+
+
+namespace LLCore
+{
+
+
+HttpAdaptiveLimit::HttpAdaptiveLimit()
+	: mEnabled(false),
+	  mLimit(0L),
+	  mCeiling(0L),
+	  mIntervalStart(0),
+	  mDecreases(0U),
+	  mProbing(false),
+	  mLimited(false),
+	  mCompletions(0U),
+	  mCongested(0U),
+	  mTimed(0U),
+	  mTimeSum(0.0),
+	  mBytes(0.0),
+	  mThroughput(0.0),
+	  mRequestTime(0.0),
+	  mErrorRate(0.0),
+	  mMinWindowStart(0),
+	  mMinTime(0.0),
+	  mPrevMinTime(0.0)
+{}
+
+
+bool HttpAdaptiveLimit::update(HttpTime now, long start, long ceiling)
+{
+	ceiling = llmax(1L, ceiling);
+	if (! mEnabled)
+	{
+		*this = HttpAdaptiveLimit();
+		mEnabled = true;
+		mLimit = llclamp(start, 1L, ceiling);
+		mCeiling = ceiling;
+		mIntervalStart = now;
+		mMinWindowStart = now;
+		return true;
+	}
+
+	bool changed(false);
+	if (ceiling != mCeiling)
+	{
+		mCeiling = ceiling;
+		mLimit = llmin(mLimit, mCeiling);
+		changed = true;
+	}
+	if (now >= mIntervalStart + HTTP_ADAPTIVE_INTERVAL)
+	{
+		endInterval(now);
+		changed = true;
+	}
+	return changed;
+}
+
+
+void HttpAdaptiveLimit::disable()
+{
+	mEnabled = false;
+}
+
+
+void HttpAdaptiveLimit::addSample(bool congested, F64 secs, F64 bytes)
+{
+	++mCompletions;
+	mBytes += bytes;
+	if (congested)
+	{
+		// Refusals come back quickly and timeouts slowly, neither
+		// says anything about the path.
+		++mCongested;
+	}
+	else if (secs > 0.0)
+	{
+		++mTimed;
+		mTimeSum += secs;
+		if (mMinTime <= 0.0 || secs < mMinTime)
+		{
+			mMinTime = secs;
+		}
+	}
+}
+
+
+void HttpAdaptiveLimit::endInterval(HttpTime now)
+{
+	const F64 secs(F64(now - mIntervalStart) / 1000000.0);
+	const F64 prev_throughput(mThroughput);
+
+	mThroughput = mBytes / secs;
+	mErrorRate = mCompletions ? F64(mCongested) / F64(mCompletions) : 0.0;
+
+	F64 mean_time(0.0);
+	if (mTimed)
+	{
+		mean_time = mTimeSum / F64(mTimed);
+		mRequestTime = (mRequestTime > 0.0
+						? 0.75 * mRequestTime + 0.25 * mean_time
+						: mean_time);
+	}
+
+	const F64 min_time(getMinTime());
+	const long prev_limit(mLimit);
+	if (mCongested)
+	{
+		mLimit = llmax(1L, llmin(mLimit - 1L, long(F64(mLimit) * HTTP_ADAPTIVE_DECREASE)));
+	}
+	else if (mProbing)
+	{
+		// Limit was lowered on purpose, results don't count
+		;
+	}
+	else if (mLimited
+			 && min_time > 0.0
+			 && mean_time > HTTP_ADAPTIVE_DELAY_FACTOR * min_time
+			 && mThroughput <= 1.05 * prev_throughput)
+	{
+		// More in flight only made requests wait longer
+		mLimit = llmax(1L, mLimit - 1L);
+	}
+	else if (mLimited)
+	{
+		mLimit = llmin(mCeiling, mLimit + 1L);
+	}
+	if (mLimit < prev_limit)
+	{
+		++mDecreases;
+	}
+
+	mProbing = false;
+	if (now >= mMinWindowStart + HTTP_ADAPTIVE_MIN_WINDOW)
+	{
+		mPrevMinTime = mMinTime;
+		mMinTime = 0.0;
+		mMinWindowStart = now;
+		mProbing = mLimit > 1L;
+	}
+
+	mIntervalStart = now;
+	mLimited = false;
+	mCompletions = 0U;
+	mCongested = 0U;
+	mTimed = 0U;
+	mTimeSum = 0.0;
+	mBytes = 0.0;
+}
+
+
+F64 HttpAdaptiveLimit::getMinTime() const
+{
+	if (mMinTime <= 0.0)
+	{
+		return mPrevMinTime;
+	}
+	if (mPrevMinTime <= 0.0)
+	{
+		return mMinTime;
+	}
+	return llmin(mMinTime, mPrevMinTime);
+}
+
+
+void HttpAdaptiveLimit::getStats(HttpRequest::AdaptiveStats * stats) const
+{
+	stats->mEnabled = mEnabled;
+	stats->mLimit = mLimit;
+	stats->mCeiling = mCeiling;
+	stats->mThroughput = mThroughput;
+	stats->mRequestTime = mRequestTime;
+	stats->mMinRequestTime = getMinTime();
+	stats->mErrorRate = mErrorRate;
+	stats->mDecreases = mDecreases;
+}
+
+
+}  // end namespace LLCore
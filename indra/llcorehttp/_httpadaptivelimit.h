@@ -0,0 +1,142 @@
+/**
+ * @file _httpadaptivelimit.h
+ * @brief Internal declaration of the adaptive concurrency controller
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef	_LLCORE_HTTP_ADAPTIVE_LIMIT_H_
+#define	_LLCORE_HTTP_ADAPTIVE_LIMIT_H_
+
+
+#include "httpcommon.h"
+#include "httprequest.h"
+
+
+namespace LLCore
+{
+
+
+/// In-flight request limit for a policy class that follows what
+/// completions report, @see HttpRequest::PO_ADAPTIVE_CONCURRENCY.
+///
+/// Completions are accumulated over an interval and the limit is
+/// adjusted once at the end of each:
+///
+/// - Any congestion failure (503, 429, timeout, failed connect)
+///   cuts it by HTTP_ADAPTIVE_DECREASE.  The grid is shedding load.
+/// - Otherwise if the mean time to first byte has grown past
+///   HTTP_ADAPTIVE_DELAY_FACTOR times the lowest seen over the
+///   last HTTP_ADAPTIVE_MIN_WINDOW and throughput didn't grow
+///   along with it, requests are only queueing somewhere on the
+///   path and it drops by one.
+/// - Otherwise if the limit held requests back, it rises by one.
+///
+/// The lowest time to first byte would only ever be seen again with
+/// fewer requests in flight so, as BBR does, every window spends
+/// an interval at a quarter of the limit to refresh it.
+///
+/// Knows nothing of time or queues itself so it can be driven by
+/// a simulation as well as by HttpPolicy.
+///
+/// Threading:  Single-threaded.  Owned by the worker thread,
+/// HttpPolicy publishes snapshots for other threads.
+class HttpAdaptiveLimit
+{
+public:
+	HttpAdaptiveLimit();
+
+	/// Begin or continue adapting.  The first call after
+	/// construction or @disable sets the limit to @start,
+	/// later ones only keep it within [1, @ceiling].  Closes the
+	/// current interval and adjusts the limit if it has run
+	/// its length.
+	///
+	/// @return			True if the limit or the statistics
+	///					changed.
+	bool update(HttpTime now, long start, long ceiling);
+
+	/// Stop adapting.  The next @update starts over.
+	void disable();
+
+	bool isEnabled() const
+		{
+			return mEnabled;
+		}
+
+	long getLimit() const
+		{
+			return mProbing ? llmax(1L, mLimit / 4L) : mLimit;
+		}
+
+	/// Requests were waiting for the limit during this interval.
+	void noteLimited()
+		{
+			mLimited = true;
+		}
+
+	/// Account for a completed request.
+	///
+	/// @param congested	Request failed in a way that points at
+	///						an overloaded server or path.
+	/// @param secs			Time until the first response byte
+	///						arrived, zero if not known.
+	/// @param bytes		Body bytes received.
+	void addSample(bool congested, F64 secs, F64 bytes);
+
+	void getStats(HttpRequest::AdaptiveStats * stats) const;
+
+protected:
+	void endInterval(HttpTime now);
+	F64 getMinTime() const;
+
+protected:
+	bool				mEnabled;
+	long				mLimit;
+	long				mCeiling;
+	HttpTime			mIntervalStart;
+	U32					mDecreases;
+
+	// Current interval
+	bool				mProbing;
+	bool				mLimited;
+	U32					mCompletions;
+	U32					mCongested;
+	U32					mTimed;
+	F64					mTimeSum;
+	F64					mBytes;
+
+	// Results of earlier intervals
+	F64					mThroughput;
+	F64					mRequestTime;
+	F64					mErrorRate;
+
+	// Lowest time to first byte as the lesser of two consecutive
+	// windows so that it can rise again when the path changes
+	HttpTime			mMinWindowStart;
+	F64					mMinTime;
+	F64					mPrevMinTime;
+};  // end class HttpAdaptiveLimit
+
+}  // end namespace LLCore
+
+#endif	// _LLCORE_HTTP_ADAPTIVE_LIMIT_H_
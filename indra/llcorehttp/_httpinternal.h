@@ -150,16 +150,42 @@ const int HTTP_CONNECTION_LIMIT_MAX = 256;
 const long HTTP_PIPELINING_DEFAULT = 0L;
 const long HTTP_PIPELINING_MAX = 20L;
 
+// HTTP/2 streams per connection.  Servers commonly allow 100.
+const long HTTP_HTTP2_STREAMS_DEFAULT = 0L;
+const long HTTP_HTTP2_STREAMS_MAX = 256L;
+
+// Adaptive concurrency.  Limit is re-evaluated every interval,
+// cut by the decrease factor on congestion and lowered when request
+// times exceed the delay factor times the lowest seen over the
+// window.
+const long HTTP_ADAPTIVE_CEILING_MAX = 1024L;
+const HttpTime HTTP_ADAPTIVE_INTERVAL = 1000000;			// 1 S
+const HttpTime HTTP_ADAPTIVE_MIN_WINDOW = 10000000;		// 10 S
+const F64 HTTP_ADAPTIVE_DECREASE = 0.7;
+const F64 HTTP_ADAPTIVE_DELAY_FACTOR = 2.0;
+
 // Miscellaneous defaults
 const bool HTTP_USE_RETRY_AFTER_DEFAULT = true;
 const long HTTP_THROTTLE_RATE_DEFAULT = 0L;
 
+// Largest response body given a single block when contiguous
+// bodies are asked for.  Anything claiming more is collected
+// in the usual blocks.
+const size_t HTTP_CONTIGUOUS_BODY_MAX = 64U * 1024U * 1024U;
+
 // Tuning parameters
 
 // Time worker thread sleeps after a pass through the
-// request, ready and active queues.
+// request, ready and active queues when it can't wait on
+// socket activity instead.
 const int HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS = 2;
 
+// Longest the worker thread waits on socket activity before
+// taking another pass anyway.  Everything that needs a pass
+// should wake it sooner, this only bounds the damage if
+// something doesn't.
+const int HTTP_SERVICE_LOOP_WAIT_MAX_MS = 100;
+
 // Block allocation size (a tuning parameter) is found
 // in bufferarray.h.
 
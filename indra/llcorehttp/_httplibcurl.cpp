@@ -32,8 +32,10 @@
 #include "bufferarray.h"
 #include "_httpoprequest.h"
 #include "_httppolicy.h"
+#include "_httpwakeup.h"
 
 #include "llhttpconstants.h"
+#include "lltimer.h"
 
 namespace
 {
@@ -57,7 +59,8 @@ HttpLibcurl::HttpLibcurl(HttpService * service)
 	  mPolicyCount(0),
 	  mMultiHandles(nullptr),
 	  mActiveHandles(nullptr),
-	  mDirtyPolicy(nullptr)
+	  mDirtyPolicy(nullptr),
+	  mConnectionStats(nullptr)
 {}
 
 
@@ -98,6 +101,21 @@ void HttpLibcurl::shutdown()
 
 		delete [] mDirtyPolicy;
 		mDirtyPolicy = nullptr;
+
+		for (int policy_class(0); policy_class < mPolicyCount; ++policy_class)
+		{
+			const ConnectionStats & stats(mConnectionStats[policy_class]);
+			if (stats.mRequests)
+			{
+				LL_INFOS(LOG_CORE) << "Policy class " << policy_class << " made "
+								   << stats.mRequests << " requests over "
+								   << stats.mNewConnections << " new connections, "
+								   << stats.mHttp2Requests << " of them on HTTP/2."
+								   << LL_ENDL;
+			}
+		}
+		delete [] mConnectionStats;
+		mConnectionStats = nullptr;
 	}
 
 	mPolicyCount = 0;
@@ -113,6 +131,7 @@ void HttpLibcurl::start(int policy_count)
 	mMultiHandles = new CURLM * [mPolicyCount];
 	mActiveHandles = new int [mPolicyCount];
 	mDirtyPolicy = new bool [mPolicyCount];
+	mConnectionStats = new ConnectionStats [mPolicyCount];
 	
 	for (int policy_class(0); policy_class < mPolicyCount; ++policy_class)
 	{
@@ -123,6 +142,7 @@ void HttpLibcurl::start(int policy_count)
 		}
 		mActiveHandles[policy_class] = 0;
 		mDirtyPolicy[policy_class] = false;
+		memset(&mConnectionStats[policy_class], 0, sizeof(ConnectionStats));
 		policyUpdated(policy_class);
 	}
 }
@@ -178,7 +198,7 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 
 				completeRequest(mMultiHandles[policy_class], handle, result);
 				handle = nullptr;					// No longer valid on return
-				ret = HttpService::NORMAL;		// If anything completes, we may have a free slot.
+				ret = HttpService::IMMEDIATE;	// If anything completes, we may have a free slot.
 												// Turning around quickly reduces connection gap by 7-10mS.
 			}
 			else if (CURLMSG_NONE == msg->msg)
@@ -198,12 +218,79 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 
 	if (! mActiveOps.empty())
 	{
-		ret = HttpService::NORMAL;
+		ret = (std::min)(ret, HttpService::NORMAL);
 	}
 	return ret;
 }
 
 
+// Wait in select() on the sockets of every policy class with
+// active requests plus the wakeup descriptor.  libcurl's own
+// timeout for each multi handle (connect timeouts, retransmits
+// of its own, etc.) bounds the wait as well.
+void HttpLibcurl::waitForActivity(HttpWakeup & wakeup, long timeout_ms)
+{
+	fd_set read_fds, write_fds, exc_fds;
+	FD_ZERO(&read_fds);
+	FD_ZERO(&write_fds);
+	FD_ZERO(&exc_fds);
+	int max_fd(-1);
+
+	for (int policy_class(0); policy_class < mPolicyCount; ++policy_class)
+	{
+		if (! mMultiHandles[policy_class] || ! mActiveHandles[policy_class])
+		{
+			continue;
+		}
+
+		int class_max_fd(-1);
+		CURLMcode status(curl_multi_fdset(mMultiHandles[policy_class], &read_fds, &write_fds, &exc_fds, &class_max_fd));
+		if (CURLM_OK != status || class_max_fd < 0)
+		{
+			// libcurl is busy without a socket to show for it (name
+			// resolution, usually), so poll at the old rate.
+			check_curl_multi_code(status);
+			timeout_ms = (std::min)(timeout_ms, long(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS));
+		}
+		max_fd = (std::max)(max_fd, class_max_fd);
+
+		long curl_timeout_ms(-1L);
+		curl_multi_timeout(mMultiHandles[policy_class], &curl_timeout_ms);
+		if (curl_timeout_ms >= 0L)
+		{
+			timeout_ms = (std::min)(timeout_ms, curl_timeout_ms);
+		}
+	}
+
+	if (timeout_ms <= 0L)
+	{
+		return;
+	}
+
+	const curl_socket_t wake_socket(wakeup.getSocket());
+#if ! LL_WINDOWS
+	// An fd_set only has room for descriptors below FD_SETSIZE (Windows
+	// counts sockets instead).  libcurl leaves higher ones out of its
+	// sets, so once descriptors reach the limit select() may not see
+	// them all: poll at the old rate instead.
+	if (max_fd >= FD_SETSIZE - 1 || int(wake_socket) >= FD_SETSIZE)
+	{
+		ms_sleep((std::min)(timeout_ms, long(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS)));
+		return;
+	}
+#endif
+	FD_SET(wake_socket, &read_fds);
+	max_fd = (std::max)(max_fd, int(wake_socket));
+
+	timeval timeout;
+	timeout.tv_sec = timeout_ms / 1000L;
+	timeout.tv_usec = (timeout_ms % 1000L) * 1000L;
+
+	// Errors (EINTR and the like) just end the wait early
+	select(max_fd + 1, &read_fds, &write_fds, &exc_fds, &timeout);
+}
+
+
 // Caller has provided us with a ref count on op.
 void HttpLibcurl::addOp(const HttpOpRequest::ptr_t &op)
 {
@@ -391,6 +478,31 @@ bool HttpLibcurl::completeRequest(CURLM * multi_handle, CURL * handle, CURLcode
         }
 	}
 
+	if (handle)
+	{
+		// Keep the stats for the response, the handle is recycled below
+		HttpResponse::TransferStats::ptr_t stats(new HttpResponse::TransferStats);
+		curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD, &stats->mSizeDownload);
+		curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &stats->mTotalTime);
+		curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME, &stats->mStartTransferTime);
+		curl_easy_getinfo(handle, CURLINFO_SPEED_DOWNLOAD, &stats->mSpeedDownload);
+		curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &stats->mNewConnections);
+#if LIBCURL_VERSION_NUM >= 0x073200
+		long http_version(0);
+		if (CURLE_OK == curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &http_version))
+		{
+			stats->mHttpVersion = (CURL_HTTP_VERSION_2_0 == http_version ? 2L
+								   : (http_version > 0L ? 1L : 0L));
+		}
+#endif
+		op->mReplyStats = stats;
+
+		ConnectionStats & class_stats(mConnectionStats[op->mReqPolicy]);
+		++class_stats.mRequests;
+		class_stats.mNewConnections += stats->mNewConnections;
+		class_stats.mHttp2Requests += (2L == stats->mHttpVersion ? 1U : 0U);
+	}
+
     if (multi_handle && handle)
     {
         // Detach from multi and recycle handle
@@ -469,7 +581,34 @@ void HttpLibcurl::policyUpdated(int policy_class)
 		policy.stallPolicy(policy_class, false);
 		mDirtyPolicy[policy_class] = false;
 		
-		if (options.mPipelining > 1)
+		if (options.mHttp2Streams > 0)
+		{
+#if LIBCURL_VERSION_NUM >= 0x072F00
+			// Multiplex streams over HTTP/2 connections.  libcurl
+			// manages connections with the same limits as for
+			// pipelining and falls back to HTTP/1.1 connections
+			// for servers not offering HTTP/2.
+			code = curl_multi_setopt(multi_handle,
+									 CURLMOPT_PIPELINING,
+									 long(CURLPIPE_MULTIPLEX));
+			check_curl_multi_code(code, CURLMOPT_PIPELINING);
+#if LIBCURL_VERSION_NUM >= 0x074300
+			code = curl_multi_setopt(multi_handle,
+									 CURLMOPT_MAX_CONCURRENT_STREAMS,
+									 long(options.mHttp2Streams));
+			check_curl_multi_code(code, CURLMOPT_MAX_CONCURRENT_STREAMS);
+#endif
+			code = curl_multi_setopt(multi_handle,
+									 CURLMOPT_MAX_HOST_CONNECTIONS,
+									 long(options.mPerHostConnectionLimit));
+			check_curl_multi_code(code, CURLMOPT_MAX_HOST_CONNECTIONS);
+			code = curl_multi_setopt(multi_handle,
+									 CURLMOPT_MAX_TOTAL_CONNECTIONS,
+									 long(options.mConnectionLimit));
+			check_curl_multi_code(code, CURLMOPT_MAX_TOTAL_CONNECTIONS);
+#endif
+		}
+		else if (options.mPipelining > 1)
 		{
 			// We'll try to do pipelining on this multihandle
 			code = curl_multi_setopt(multi_handle,
@@ -517,6 +656,17 @@ void HttpLibcurl::policyUpdated(int policy_class)
 	}
 }
 
+// static
+bool HttpLibcurl::isHttp2Available()
+{
+#if LIBCURL_VERSION_NUM >= 0x072F00
+	const curl_version_info_data * info(curl_version_info(CURLVERSION_NOW));
+	return info && (info->features & CURL_VERSION_HTTP2);
+#else
+	return false;
+#endif
+}
+
 // ---------------------------------------
 // HttpLibcurl::HandleCache
 // ---------------------------------------
@@ -46,6 +46,7 @@ namespace LLCore
 class HttpPolicy;
 class HttpOpRequest;
 class HttpHeaders;
+class HttpWakeup;
 
 
 /// Implements libcurl-based transport for an HttpService instance.
@@ -77,6 +78,13 @@ public:
 	/// Threading:  called by worker thread.
 	HttpService::ELoopSpeed processTransport();
 
+	/// Block until a socket of an active request is ready, @wakeup
+	/// is signalled or @timeout_ms milliseconds have gone by.  Also
+	/// returns early when libcurl wants to be called sooner.
+	///
+	/// Threading:  called by worker thread.
+	void waitForActivity(HttpWakeup & wakeup, long timeout_ms);
+
 	/// Add request to the active list.  Caller is expected to have
 	/// provided us with a reference count on the op to hold the
 	/// request.  (No additional references will be added.)
@@ -126,6 +134,13 @@ public:
 	/// Threading:  called by worker thread.
 	void policyUpdated(int policy_class);
 
+	/// True if the libcurl in use can multiplex requests over
+	/// HTTP/2.  Needs both a new enough libcurl when built and
+	/// one compiled with HTTP/2 support at runtime.
+	///
+	/// Threading:  callable by any thread.
+	static bool isHttp2Available();
+
 	/// Allocate a curl handle for caller.  May be freed using
 	/// either the freeHandle() method or calling curl_easy_cleanup()
 	/// directly.
@@ -215,6 +230,15 @@ protected:
 	CURLM **			mMultiHandles;		// One handle per policy class
 	int *				mActiveHandles;		// Active count per policy class
 	bool *				mDirtyPolicy;		// Dirty policy update waiting for stall (per pc)
+
+	/// Connection reuse counts per policy class, logged at shutdown
+	struct ConnectionStats
+	{
+		U64				mRequests;
+		U64				mNewConnections;
+		U64				mHttp2Requests;
+	};
+	ConnectionStats *	mConnectionStats;
 	
 }; // end class HttpLibcurl
 
@@ -256,12 +256,13 @@ void HttpOpRequest::visitNotifier(HttpRequest * request)
 		response->setContentType(mReplyConType);
 		response->setRetries(mPolicyRetries, mPolicy503Retries);
 		
-		HttpResponse::TransferStats::ptr_t stats = HttpResponse::TransferStats::ptr_t(new HttpResponse::TransferStats);
-
-		curl_easy_getinfo(mCurlHandle, CURLINFO_SIZE_DOWNLOAD, &stats->mSizeDownload);
-		curl_easy_getinfo(mCurlHandle, CURLINFO_TOTAL_TIME, &stats->mTotalTime);
-		curl_easy_getinfo(mCurlHandle, CURLINFO_SPEED_DOWNLOAD, &stats->mSpeedDownload);
-
+		// The libcurl handle is gone by now.  Stats were taken
+		// from it on completion, if the request got that far.
+		HttpResponse::TransferStats::ptr_t stats(mReplyStats);
+		if (! stats)
+		{
+			stats = HttpResponse::TransferStats::ptr_t(new HttpResponse::TransferStats);
+		}
 		response->setTransferStats(stats);
 
 		mUserHandler->onCompleted(this->getHandle(), response);
@@ -473,6 +474,7 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
 	mReplyFullLength = 0;
     mReplyHeaders.reset();
 	mReplyConType.clear();
+	mReplyStats.reset();
 	
 	// *FIXME:  better error handling later
 	HttpStatus status;
@@ -672,9 +674,26 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
 	}
 
 
-    // *TODO: Should this be 'Keep-Alive' ?
-    mCurlHeaders = curl_slist_append(mCurlHeaders, "Connection: keep-alive");
-    mCurlHeaders = curl_slist_append(mCurlHeaders, "Keep-alive: 300");
+	if (cpolicy.mHttp2Streams > 0L)
+	{
+		// Offer HTTP/2 during the TLS handshake and wait for a
+		// connection that can take another stream rather than
+		// opening a new one.  Connection-specific headers are
+		// forbidden in HTTP/2 and keep-alive is the HTTP/1.1
+		// default anyway, so they're left out.
+#if LIBCURL_VERSION_NUM >= 0x072F00
+		code = curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, long(CURL_HTTP_VERSION_2TLS));
+		check_curl_easy_code(code, CURLOPT_HTTP_VERSION);
+		code = curl_easy_setopt(mCurlHandle, CURLOPT_PIPEWAIT, 1L);
+		check_curl_easy_code(code, CURLOPT_PIPEWAIT);
+#endif
+	}
+	else
+	{
+		// *TODO: Should this be 'Keep-Alive' ?
+		mCurlHeaders = curl_slist_append(mCurlHeaders, "Connection: keep-alive");
+		mCurlHeaders = curl_slist_append(mCurlHeaders, "Keep-alive: 300");
+	}
 
 	// Tracing
 	if (mTracing >= HTTP_TRACE_CURL_HEADERS)
@@ -733,8 +752,11 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
 	{
 		xfer_timeout = timeout;
 	}
-	if (cpolicy.mPipelining > 1L)
+	if (cpolicy.mPipelining > 1L || cpolicy.mHttp2Streams > 0L)
 	{
+		// Multiplexed streams share a connection's bandwidth
+		// and have the same transfer timeout concern as below.
+		//
 		// Pipelining affects both connection and transfer timeout values.
 		// Requests that are added to a pipeling immediately have completed
 		// their connection so the connection delay tends to be less than
@@ -805,6 +827,18 @@ size_t HttpOpRequest::writeCallback(void * data, size_t size, size_t nmemb, void
 	if (! op->mReplyBody)
 	{
 		op->mReplyBody = new BufferArray();
+		if (op->mReqOptions && op->mReqOptions->getContiguousBody())
+		{
+			// Headers are in by the first write.  Fall back on
+			// the range asked for when there's no length.
+			double content_length(-1.0);
+			curl_easy_getinfo(op->mCurlHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &content_length);
+			const size_t body_size(content_length > 0.0 ? size_t(content_length) : op->mReqLength);
+			if (body_size && body_size <= HTTP_CONTIGUOUS_BODY_MAX)
+			{
+				op->mReplyBody->reserveContiguous(body_size);
+			}
+		}
 	}
 	const size_t req_size(size * nmemb);
 	const size_t write_size(op->mReplyBody->append(static_cast<char *>(data), req_size));
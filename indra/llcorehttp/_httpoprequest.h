@@ -43,6 +43,7 @@
 
 #include "httpheaders.h"
 #include "httpoptions.h"
+#include "httpresponse.h"
 
 namespace LLCore
 {
@@ -226,6 +227,7 @@ public:
 	HttpHeaders::ptr_t	mReplyHeaders;
 	std::string			mReplyConType;
 	int					mReplyRetryAfter;
+	HttpResponse::TransferStats::ptr_t	mReplyStats;	// Captured before the handle is recycled
 
 	// Policy data
 	int					mPolicyRetries;
@@ -30,6 +30,7 @@
 
 #include "_httppolicy.h"
 
+#include "_httpadaptivelimit.h"
 #include "_httpoprequest.h"
 #include "_httpservice.h"
 #include "_httplibcurl.h"
@@ -42,6 +43,20 @@ namespace
 
 static const char * const LOG_CORE("CoreHttp");
 
+// Failures that say the service, or the path to it, has more
+// than it can handle.
+bool is_congestion(const LLCore::HttpStatus & status)
+{
+	if (status.isHttpStatus())
+	{
+		const LLCore::HttpStatus::type_enum_t code(status.getType());
+		return 503 == code || 429 == code || 504 == code;
+	}
+	return (LLCore::HttpStatus::EXT_CURL_EASY == status.getType()
+			&& (CURLE_OPERATION_TIMEDOUT == status.getStatus()
+				|| CURLE_COULDNT_CONNECT == status.getStatus()));
+}
+
 } // end anonymous namespace
 
 
@@ -63,6 +78,20 @@ public:
 		  mRequestCount(0L),
 		  mStallStaging(false)
 		{}
+
+	// In-flight request limit the options alone give
+	long getStaticLimit() const
+		{
+			if (mOptions.mHttp2Streams > 0L)
+			{
+				return mOptions.mPerHostConnectionLimit * mOptions.mHttp2Streams;
+			}
+			if (mOptions.mPipelining > 1L)
+			{
+				return mOptions.mPerHostConnectionLimit * mOptions.mPipelining;
+			}
+			return mOptions.mConnectionLimit;
+		}
 	
 	HttpReadyQueue		mReadyQueue;
 	HttpRetryQueue		mRetryQueue;
@@ -72,14 +101,17 @@ public:
 	long				mThrottleLeft;
 	long				mRequestCount;
 	bool				mStallStaging;
+	HttpAdaptiveLimit	mAdaptive;
 };
 
 
 HttpPolicy::HttpPolicy(HttpService * service)
-	: mService(service)
+	: mService(service),
+	  mNextDeadline(0)
 {
 	// Create default class
 	mClasses.push_back(new ClassState());
+	mAdaptiveStats.resize(mClasses.size());
 }
 
 
@@ -105,6 +137,9 @@ HttpRequest::policy_t HttpPolicy::createPolicyClass()
 		return HttpRequest::INVALID_POLICY_ID;
 	}
 	mClasses.push_back(new ClassState());
+
+	LLCoreInt::HttpScopedLock lock(mAdaptiveMutex);
+	mAdaptiveStats.resize(mClasses.size());
 	return policy_class;
 }
 
@@ -221,6 +256,7 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 	const HttpTime now(totalTime());
 	HttpService::ELoopSpeed result(HttpService::REQUEST_SLEEP);
 	HttpLibcurl & transport(mService->getTransport());
+	mNextDeadline = 0;
 	
 	for (int policy_class(0); policy_class < mClasses.size(); ++policy_class)
 	{
@@ -228,6 +264,8 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 		HttpRetryQueue & retryq(state.mRetryQueue);
 		HttpReadyQueue & readyq(state.mReadyQueue);
 
+		updateAdaptive(policy_class, now);
+
 		if (state.mStallStaging)
 		{
 			// Stalling but don't sleep.  Need to complete operations
@@ -249,14 +287,14 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 		{
 			// Throttled condition, don't serve this class but don't sleep hard.
 			result = HttpService::NORMAL;
+			updateDeadline(state.mThrottleEnd, now);
 			continue;
 		}
 
 		int active(transport.getActiveCountInClass(policy_class));
-		int active_limit(state.mOptions.mPipelining > 1L
-						 ? (state.mOptions.mPerHostConnectionLimit
-							* state.mOptions.mPipelining)
-						 : state.mOptions.mConnectionLimit);
+		int active_limit(state.mAdaptive.isEnabled()
+						 ? state.mAdaptive.getLimit()
+						 : state.getStaticLimit());
 		int needed(active_limit - active);		// Expect negatives here
 
 		if (needed > 0)
@@ -322,6 +360,11 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 				}
 			}
 		}
+		if (needed <= 0 && ! readyq.empty())
+		{
+			// Work is waiting on the limit
+			state.mAdaptive.noteLimited();
+		}
 
 	throttle_on:
 		
@@ -329,6 +372,21 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 		{
 			// If anything is ready, continue looping...
 			result = HttpService::NORMAL;
+
+			// Requests held back only by a free connection are issued
+			// when a completion frees one.  Those held back by time
+			// need the service thread woken up.
+			if (throttle_enabled && state.mThrottleLeft <= 0)
+			{
+				updateDeadline(state.mThrottleEnd, now);
+			}
+			const HttpRetryQueue::container_type & retries(retryq.get_container());
+			for (HttpRetryQueue::container_type::const_iterator it(retries.begin());
+				 retries.end() != it;
+				 ++it)
+			{
+				updateDeadline((*it)->mPolicyRetryAt, now);
+			}
 		}
 	} // end foreach policy_class
 
@@ -336,6 +394,52 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 }
 
 
+// Start, stop or step a class's adaptive limit and refresh the
+// copy other threads read when it changes.
+void HttpPolicy::updateAdaptive(int policy_class, HttpTime now)
+{
+	ClassState & state(*mClasses[policy_class]);
+	HttpAdaptiveLimit & adaptive(state.mAdaptive);
+	const long prev_limit(adaptive.isEnabled() ? adaptive.getLimit() : 0L);
+	bool changed(false);
+
+	if (state.mOptions.mAdaptiveConcurrency > 0L)
+	{
+		const long start(state.getStaticLimit());
+		changed = adaptive.update(now, start, llmax(start, state.mOptions.mAdaptiveConcurrency));
+	}
+	else if (adaptive.isEnabled())
+	{
+		adaptive.disable();
+		changed = true;
+	}
+
+	if (changed)
+	{
+		if (adaptive.isEnabled() && adaptive.getLimit() != prev_limit)
+		{
+			LL_DEBUGS(LOG_CORE) << "Policy class " << policy_class
+								<< " adaptive limit now " << adaptive.getLimit()
+								<< LL_ENDL;
+		}
+
+		LLCoreInt::HttpScopedLock lock(mAdaptiveMutex);
+		adaptive.getStats(&mAdaptiveStats[policy_class]);
+	}
+}
+
+
+// Deadlines already passed are waiting on a free connection,
+// not on time, so they don't count.
+void HttpPolicy::updateDeadline(HttpTime deadline, HttpTime now)
+{
+	if (deadline > now && (! mNextDeadline || deadline < mNextDeadline))
+	{
+		mNextDeadline = deadline;
+	}
+}
+
+
 bool HttpPolicy::changePriority(HttpHandle handle, HttpRequest::priority_t priority)
 {
 	for (int policy_class(0); policy_class < mClasses.size(); ++policy_class)
@@ -409,6 +513,22 @@ bool HttpPolicy::cancel(HttpHandle handle)
 
 bool HttpPolicy::stageAfterCompletion(const HttpOpRequest::ptr_t &op)
 {
+	// Feed the adaptive limit.  Failures inside the library, like
+	// cancels, say nothing about the service.
+	HttpAdaptiveLimit & adaptive(mClasses[op->mReqPolicy]->mAdaptive);
+	if (adaptive.isEnabled() && HttpStatus::LLCORE != op->mStatus.getType())
+	{
+		F64 secs(0.0), bytes(0.0);
+		if (op->mReplyStats)
+		{
+			// Time to first byte, the body's transfer time grows
+			// with its size and says nothing about queueing
+			secs = op->mReplyStats->mStartTransferTime;
+			bytes = op->mReplyStats->mSizeDownload;
+		}
+		adaptive.addSample(is_congestion(op->mStatus), secs, bytes);
+	}
+
 	// Retry or finalize
 	if (! op->mStatus)
 	{
@@ -473,6 +593,19 @@ int HttpPolicy::getReadyCount(HttpRequest::policy_t policy_class) const
 }
 
 
+HttpStatus HttpPolicy::getAdaptiveStats(HttpRequest::policy_t policy_class,
+										HttpRequest::AdaptiveStats * stats) const
+{
+	LLCoreInt::HttpScopedLock lock(mAdaptiveMutex);
+	if (policy_class >= mAdaptiveStats.size())
+	{
+		return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
+	}
+	*stats = mAdaptiveStats[policy_class];
+	return HttpStatus();
+}
+
+
 bool HttpPolicy::stallPolicy(HttpRequest::policy_t policy_class, bool stall)
 {
 	bool ret(false);
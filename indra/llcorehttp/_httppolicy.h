@@ -35,6 +35,7 @@
 #include "_httppolicyglobal.h"
 #include "_httppolicyclass.h"
 #include "_httpinternal.h"
+#include "_mutex.h"
 
 
 namespace LLCore
@@ -46,9 +47,9 @@ class HttpOpRequest;
 
 /// Implements class-based queuing policies for an HttpService instance.
 ///
-/// Threading:  Single-threaded.  Other than for construction/destruction,
-/// all methods are expected to be invoked in a single thread, typically
-/// a worker thread of some sort.
+/// Threading:  Single-threaded.  Other than for construction/destruction
+/// and @getAdaptiveStats, all methods are expected to be invoked in a
+/// single thread, typically a worker thread of some sort.
 class HttpPolicy
 {
 public:
@@ -89,6 +90,16 @@ public:
 	/// Threading:  called by worker thread
 	HttpService::ELoopSpeed processReadyQueue();
 
+	/// Earliest time at which a request held back by a retry
+	/// delay or a throttle becomes eligible to issue, as of the
+	/// last @processReadyQueue call.  Zero if there is none.
+	///
+	/// Threading:  called by worker thread
+	HttpTime getNextDeadline() const
+		{
+			return mNextDeadline;
+		}
+
 	/// Add request to a ready queue.  Caller is expected to have
 	/// provided us with a reference count to hold the request.  (No
 	/// additional references will be added.)
@@ -167,14 +178,31 @@ public:
 	///
 	/// Threading:  called by worker thread
 	bool stallPolicy(HttpRequest::policy_t policy_class, bool stall);
+
+	/// Get the adaptive concurrency state of a policy class as of
+	/// its last change.
+	///
+	/// Threading:  called by any thread
+	HttpStatus getAdaptiveStats(HttpRequest::policy_t policy_class,
+								HttpRequest::AdaptiveStats * stats) const;
 	
 protected:
+	void updateDeadline(HttpTime deadline, HttpTime now);
+	void updateAdaptive(int policy_class, HttpTime now);
+
 	struct ClassState;
 	typedef std::vector<ClassState *>	class_list_t;
 	
 	HttpPolicyGlobal					mGlobalOptions;
 	class_list_t						mClasses;
 	HttpService *						mService;				// Naked pointer, not refcounted, not owner
+	HttpTime							mNextDeadline;
+
+	// Copies of the adaptive state for other threads
+	typedef std::vector<HttpRequest::AdaptiveStats> adaptive_list_t;
+
+	mutable LLCoreInt::HttpMutex		mAdaptiveMutex;
+	adaptive_list_t						mAdaptiveStats;
 };  // end class HttpPolicy
 
 }  // end namespace LLCore
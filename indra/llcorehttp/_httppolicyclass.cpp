@@ -29,6 +29,7 @@
 #include "_httppolicyclass.h"
 
 #include "_httpinternal.h"
+#include "_httplibcurl.h"
 
 
 namespace LLCore
@@ -39,7 +40,9 @@ HttpPolicyClass::HttpPolicyClass()
 	: mConnectionLimit(HTTP_CONNECTION_LIMIT_DEFAULT),
 	  mPerHostConnectionLimit(HTTP_CONNECTION_LIMIT_DEFAULT),
 	  mPipelining(HTTP_PIPELINING_DEFAULT),
-	  mThrottleRate(HTTP_THROTTLE_RATE_DEFAULT)
+	  mThrottleRate(HTTP_THROTTLE_RATE_DEFAULT),
+	  mHttp2Streams(HTTP_HTTP2_STREAMS_DEFAULT),
+	  mAdaptiveConcurrency(0L)
 {}
 
 
@@ -55,6 +58,8 @@ HttpPolicyClass & HttpPolicyClass::operator=(const HttpPolicyClass & other)
 		mPerHostConnectionLimit = other.mPerHostConnectionLimit;
 		mPipelining = other.mPipelining;
 		mThrottleRate = other.mThrottleRate;
+		mHttp2Streams = other.mHttp2Streams;
+		mAdaptiveConcurrency = other.mAdaptiveConcurrency;
 	}
 	return *this;
 }
@@ -64,7 +69,9 @@ HttpPolicyClass::HttpPolicyClass(const HttpPolicyClass & other)
 	: mConnectionLimit(other.mConnectionLimit),
 	  mPerHostConnectionLimit(other.mPerHostConnectionLimit),
 	  mPipelining(other.mPipelining),
-	  mThrottleRate(other.mThrottleRate)
+	  mThrottleRate(other.mThrottleRate),
+	  mHttp2Streams(other.mHttp2Streams),
+	  mAdaptiveConcurrency(other.mAdaptiveConcurrency)
 {}
 
 
@@ -88,6 +95,16 @@ HttpStatus HttpPolicyClass::set(HttpRequest::EPolicyOption opt, long value)
 		mThrottleRate = llclamp(value, 0L, 1000000L);
 		break;
 
+	case HttpRequest::PO_HTTP2_STREAMS:
+		mHttp2Streams = (HttpLibcurl::isHttp2Available()
+						 ? llclamp(value, 0L, HTTP_HTTP2_STREAMS_MAX)
+						 : 0L);
+		break;
+
+	case HttpRequest::PO_ADAPTIVE_CONCURRENCY:
+		mAdaptiveConcurrency = llclamp(value, 0L, HTTP_ADAPTIVE_CEILING_MAX);
+		break;
+
 	default:
 		return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
 	}
@@ -116,6 +133,14 @@ HttpStatus HttpPolicyClass::get(HttpRequest::EPolicyOption opt, long * value) co
 		*value = mThrottleRate;
 		break;
 
+	case HttpRequest::PO_HTTP2_STREAMS:
+		*value = mHttp2Streams;
+		break;
+
+	case HttpRequest::PO_ADAPTIVE_CONCURRENCY:
+		*value = mAdaptiveConcurrency;
+		break;
+
 	default:
 		return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
 	}
@@ -29,36 +29,28 @@
 #include "_httpreplyqueue.h"
 
 
-#include "_mutex.h"
-#include "_thread.h"
 #include "_httpoperation.h"
 
-using namespace LLCoreInt;
-
 
 namespace LLCore
 {
 
 
 HttpReplyQueue::HttpReplyQueue()
+	: mQueue(QUEUE_CAPACITY)
 {
 }
 
 
 HttpReplyQueue::~HttpReplyQueue()
 {
-    mQueue.clear();
+	// Ring slots release their operations on destruction
 }
 
 
 void HttpReplyQueue::addOp(const HttpReplyQueue::opPtr_t &op)
 {
-	{
-		HttpScopedLock lock(mQueueMutex);
-
-		mQueue.push_back(op);
-	}
-	mQueueCV.notify_all();
+	mQueue.push(op);
 }
 
 
@@ -66,15 +58,7 @@ HttpReplyQueue::opPtr_t HttpReplyQueue::fetchOp()
 {
 	HttpOperation::ptr_t result;
 
-	{
-		HttpScopedLock lock(mQueueMutex);
-
-		if (mQueue.empty())
-            return opPtr_t();
-
-		result = mQueue.front();
-		mQueue.erase(mQueue.begin());
-	}
+	mQueue.tryPop(result);
 
 	// Caller also acquires the reference count
 	return result;
@@ -86,14 +70,7 @@ void HttpReplyQueue::fetchAll(OpContainer & ops)
 	// Not valid putting something back on the queue...
 	llassert_always(ops.empty());
 
-	{
-		HttpScopedLock lock(mQueueMutex);
-
-		if (! mQueue.empty())
-		{
-			mQueue.swap(ops);
-		}
-	}
+	mQueue.popAll(ops);
 }
 
 
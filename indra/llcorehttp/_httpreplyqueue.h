@@ -29,7 +29,7 @@
 
 
 #include "_refcounted.h"
-#include "_mutex.h"
+#include "lllockfreequeue.h"
 
 
 namespace LLCore
@@ -57,6 +57,11 @@ class HttpOperation;
 /// are anticipated.  These are how most application consumers
 /// will be coded anyway so it shouldn't be too much of a
 /// burden.
+///
+/// Replies are only ever added by the service thread and
+/// only ever fetched by the thread owning the HttpRequest,
+/// so the queue is a lock-free single-producer ring (see
+/// lllockfreequeue.h).
 
 class HttpReplyQueue
 {
@@ -81,7 +86,7 @@ public:
 	/// Library also takes possession of one reference count to pass
 	/// through the queue.
 	///
-	/// Threading:  callable by any thread.
+	/// Threading:  callable by the service thread only.
     void addOp(const opPtr_t &op);
 
 	/// Fetch an operation from the head of the queue.  Returns
@@ -89,19 +94,19 @@ public:
 	///
 	/// Caller acquires reference count on returned operation.
 	///
-	/// Threading:  callable by any thread.
+	/// Threading:  callable by the owning HttpRequest's thread only.
     opPtr_t fetchOp();
 
 	/// Caller acquires reference count on each returned operation
 	///
-	/// Threading:  callable by any thread.
+	/// Threading:  callable by the owning HttpRequest's thread only.
 	void fetchAll(OpContainer & ops);
 	
 protected:
+	/// Ring size before addOp() spills into the locked overflow list
+	static const size_t					QUEUE_CAPACITY = 1024;
 
-	OpContainer							mQueue;
-	LLCoreInt::HttpMutex				mQueueMutex;
-	LLCoreInt::HttpConditionVariable	mQueueCV;
+	LLBlockingQueue<LLSPSCQueue<opPtr_t> >	mQueue;
 	
 }; // end class HttpReplyQueue
 
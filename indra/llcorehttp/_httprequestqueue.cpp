@@ -29,10 +29,8 @@
 #include "_httprequestqueue.h"
 
 #include "_httpoperation.h"
-#include "_mutex.h"
 
-
-using namespace LLCoreInt;
+#include <thread>
 
 namespace LLCore
 {
@@ -42,14 +40,17 @@ HttpRequestQueue * HttpRequestQueue::sInstance(nullptr);
 
 HttpRequestQueue::HttpRequestQueue()
 	: RefCounted(true),
-	  mQueueStopped(false)
+	  mQueue(QUEUE_CAPACITY),
+	  mQueueStopped(false),
+	  mAddsInProgress(0),
+	  mWaitingForIO(false)
 {
 }
 
 
 HttpRequestQueue::~HttpRequestQueue()
 {
-    mQueue.clear();
+	// Ring slots release their operations on destruction
 }
 
 
@@ -72,21 +73,24 @@ void HttpRequestQueue::term()
 
 HttpStatus HttpRequestQueue::addOp(const HttpRequestQueue::opPtr_t &op)
 {
-	bool wake(false);
+	// Counted before mQueueStopped is checked, so that stopQueue()
+	// either sees us and waits for the push or we see it stopped.
+	++mAddsInProgress;
+	if (mQueueStopped)
 	{
-		HttpScopedLock lock(mQueueMutex);
-
-		if (mQueueStopped)
-		{
-			// Return op and error to caller
-			return HttpStatus(HttpStatus::LLCORE, HE_SHUTTING_DOWN);
-		}
-		wake = mQueue.empty();
-		mQueue.push_back(op);
+		--mAddsInProgress;
+		// Return op and error to caller
+		return HttpStatus(HttpStatus::LLCORE, HE_SHUTTING_DOWN);
 	}
-	if (wake)
+	mQueue.push(op);
+	--mAddsInProgress;
+
+	// Pairs with the fence in beginIOWait():  either the service
+	// thread sees the operation before waiting or we see it waiting.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (mWaitingForIO.load(std::memory_order_relaxed))
 	{
-		mQueueCV.notify_all();
+		mWakeup.signal();
 	}
 	return HttpStatus();
 }
@@ -96,18 +100,11 @@ HttpRequestQueue::opPtr_t HttpRequestQueue::fetchOp(bool wait)
 {
 	HttpOperation::ptr_t result;
 
+	while (! mQueue.tryPop(result))
 	{
-		HttpScopedLock lock(mQueueMutex);
-
-		while (mQueue.empty())
-		{
-			if (! wait || mQueueStopped)
-                return HttpOperation::ptr_t();
-			mQueueCV.wait(lock);
-		}
-
-		result = mQueue.front();
-		mQueue.erase(mQueue.begin());
+		if (! wait || mQueueStopped)
+			return HttpOperation::ptr_t();
+		mQueue.waitForData();
 	}
 
 	// Caller also acquires the reference count
@@ -120,17 +117,11 @@ void HttpRequestQueue::fetchAll(bool wait, OpContainer & ops)
 	// Not valid putting something back on the queue...
 	llassert_always(ops.empty());
 
+	while (! mQueue.popAll(ops))
 	{
-		HttpScopedLock lock(mQueueMutex);
-
-		while (mQueue.empty())
-		{
-			if (! wait || mQueueStopped)
-				return;
-			mQueueCV.wait(lock);
-		}
-
-		mQueue.swap(ops);
+		if (! wait || mQueueStopped)
+			return;
+		mQueue.waitForData();
 	}
 
 	// Caller also acquires the reference counts on each op.
@@ -140,18 +131,42 @@ void HttpRequestQueue::fetchAll(bool wait, OpContainer & ops)
 
 void HttpRequestQueue::wakeAll()
 {
-	mQueueCV.notify_all();
+	mQueue.wake();
+	mWakeup.signal();
 }
 
 
 void HttpRequestQueue::stopQueue()
 {
+	mQueueStopped = true;
+
+	// Let adds that got past the check finish, or their operations
+	// would land after the final fetchAll() and never be canceled.
+	while (mAddsInProgress > 0)
 	{
-		HttpScopedLock lock(mQueueMutex);
+		std::this_thread::yield();
+	}
+	wakeAll();
+}
+
 
-		mQueueStopped = true;
-		wakeAll();
+bool HttpRequestQueue::beginIOWait()
+{
+	mWaitingForIO.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (mQueueStopped || ! mQueue.empty())
+	{
+		mWaitingForIO.store(false, std::memory_order_relaxed);
+		return false;
 	}
+	return true;
+}
+
+
+void HttpRequestQueue::endIOWait()
+{
+	mWaitingForIO.store(false, std::memory_order_relaxed);
+	mWakeup.drain();
 }
 
 
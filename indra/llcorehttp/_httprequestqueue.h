@@ -28,11 +28,13 @@
 #define	_LLCORE_HTTP_REQUEST_QUEUE_H_
 
 
+#include <atomic>
 #include <vector>
 
 #include "httpcommon.h"
 #include "_refcounted.h"
-#include "_mutex.h"
+#include "_httpwakeup.h"
+#include "lllockfreequeue.h"
 
 
 namespace LLCore
@@ -46,6 +48,13 @@ class HttpOperation;
 /// a simple queue that handles the transfer of operation
 /// requests from all HttpRequest instances into the
 /// singleton HttpService instance.
+///
+/// Any number of threads may add operations but only the
+/// service thread removes them, so the queue is a lock-free
+/// multi-producer ring (see lllockfreequeue.h).  Producers
+/// only take a lock when the ring is full or the service
+/// thread is asleep waiting for work, and only write to the
+/// wakeup descriptor when it is waiting on transport I/O.
 
 class HttpRequestQueue : public LLCoreInt::RefCounted
 {
@@ -96,7 +105,7 @@ public:
 	///
 	/// Caller acquires reference count any returned operation
 	///
-	/// Threading:  callable by any thread.
+	/// Threading:  callable by the consumer (service) thread only.
     opPtr_t fetchOp(bool wait);
 
 	/// Return all queued requests to caller.  The @ops argument
@@ -106,7 +115,7 @@ public:
 	///
 	/// Caller acquires reference count on each returned operation
 	///
-	/// Threading:  callable by any thread.
+	/// Threading:  callable by the consumer (service) thread only.
 	void fetchAll(bool wait, OpContainer & ops);
 
 	/// Wake any sleeping threads.  Normal queuing operations
@@ -121,19 +130,43 @@ public:
 	/// to @fetchAll or @fetchOp will get requests that are on the
 	/// queue but the calls will no longer wait.  Instead they'll
 	/// return immediately.  Also wakes up all sleepers to send
-	/// them on their way.
+	/// them on their way.  An @addOp racing with this call has
+	/// either failed or queued its request by the time it returns,
+	/// so a final @fetchAll sees every accepted request.
 	///
 	/// Threading:  callable by any thread.
 	void stopQueue();
+
+	/// Announce that the service thread is about to block in
+	/// select() on transport sockets and @getWakeup's descriptor
+	/// rather than in @fetchAll.  From then on @addOp signals the
+	/// wakeup.  Returns false, announcing nothing, if requests
+	/// are already waiting or the queue is stopped.  A true
+	/// return must be paired with an @endIOWait call.
+	///
+	/// Threading:  callable by the consumer (service) thread only.
+	bool beginIOWait();
+
+	/// Threading:  callable by the consumer (service) thread only.
+	void endIOWait();
+
+	HttpWakeup & getWakeup()
+		{
+			return mWakeup;
+		}
 	
 protected:
 	static HttpRequestQueue *			sInstance;
 	
 protected:
-	OpContainer							mQueue;
-	LLCoreInt::HttpMutex				mQueueMutex;
-	LLCoreInt::HttpConditionVariable	mQueueCV;
-	bool								mQueueStopped;
+	/// Ring size before addOp() spills into the locked overflow list
+	static const size_t					QUEUE_CAPACITY = 4096;
+
+	LLBlockingQueue<LLMPSCQueue<opPtr_t> >	mQueue;
+	std::atomic<bool>					mQueueStopped;
+	std::atomic<int>					mAddsInProgress;	// @addOp calls past the mQueueStopped check
+	HttpWakeup							mWakeup;
+	std::atomic<bool>					mWaitingForIO;
 	
 }; // end class HttpRequestQueue
 
@@ -34,6 +34,7 @@
 #include "_httplibcurl.h"
 #include "_thread.h"
 #include "_httpinternal.h"
+#include "_httpwakeup.h"
 
 #include "lltimer.h"
 #include "llthread.h"
@@ -61,7 +62,9 @@ const HttpService::OptionDescriptor HttpService::sOptionDesc[] =
 	{	true,		true,		true,		false,		false	},		// PO_TRACE
 	{	true,		true,		false,		true,		false	},		// PO_ENABLE_PIPELINING
 	{	true,		true,		false,		true,		false	},		// PO_THROTTLE_RATE
-	{   false,		false,		true,		false,		true	}		// PO_SSL_VERIFY_CALLBACK
+	{   false,		false,		true,		false,		true	},		// PO_SSL_VERIFY_CALLBACK
+	{	true,		true,		false,		true,		false	},		// PO_HTTP2_STREAMS
+	{	true,		true,		false,		true,		false	}		// PO_ADAPTIVE_CONCURRENCY
 };
 HttpService * HttpService::sInstance(nullptr);
 volatile HttpService::EState HttpService::sState(NOT_INITIALIZED);
@@ -296,8 +299,9 @@ void HttpService::shutdown()
 
 // Working thread loop-forever method.  Gives time to
 // each of the request queue, policy layer and transport
-// layer pieces and then either sleeps for a small time
-// or waits for a request to come in.  Repeats until
+// layer pieces and then either goes around again, waits
+// for something to happen to the work in progress or
+// waits for a request to come in.  Repeats until
 // requested to stop.
 void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 {
@@ -316,10 +320,11 @@ void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 		new_loop = mTransport->processTransport();
 		loop = (std::min)(loop, new_loop);
 		
-		// Determine whether to spin, sleep briefly or sleep for next request
-		if (REQUEST_SLEEP != loop)
+		// Determine whether to spin, wait on the work in progress or
+		// sleep for next request
+		if (NORMAL == loop)
 		{
-			ms_sleep(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+			waitForWork();
 		}
 	}
 
@@ -328,6 +333,33 @@ void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 }
 
 
+void HttpService::waitForWork()
+{
+	HttpWakeup & wakeup(mRequestQueue->getWakeup());
+	if (! wakeup.isValid())
+	{
+		// No way to be woken, fall back to polling
+		ms_sleep(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+		return;
+	}
+
+	long timeout_ms(HTTP_SERVICE_LOOP_WAIT_MAX_MS);
+	const HttpTime deadline(mPolicy->getNextDeadline());
+	if (deadline)
+	{
+		const HttpTime now(totalTime());
+		const HttpTime until(deadline > now ? deadline - now : 0);
+		timeout_ms = (std::min)(timeout_ms, long((until + 999) / 1000));
+	}
+
+	if (mRequestQueue->beginIOWait())
+	{
+		mTransport->waitForActivity(wakeup, timeout_ms);
+		mRequestQueue->endIOWait();
+	}
+}
+
+
 HttpService::ELoopSpeed HttpService::processRequestQueue(ELoopSpeed loop)
 {
 	HttpRequestQueue::OpContainer ops;
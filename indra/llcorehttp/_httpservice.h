@@ -104,7 +104,8 @@ public:
 	// requests.
 	enum ELoopSpeed
 	{
-		NORMAL,					///< continuous polling of request, ready, active queues
+		IMMEDIATE,				///< go around again without waiting
+		NORMAL,					///< wait for socket activity, a request queue write or a policy deadline
 		REQUEST_SLEEP			///< can sleep indefinitely waiting for request queue write
 	};
 
@@ -189,6 +190,11 @@ protected:
 	
 	ELoopSpeed processRequestQueue(ELoopSpeed loop);
 
+	/// Block until an active request has socket activity, a request
+	/// is queued or the policy layer has a retry or throttle window
+	/// coming due, whichever happens first.
+	void waitForWork();
+
 protected:
 	friend class HttpOpSetGet;
 	friend class HttpRequest;
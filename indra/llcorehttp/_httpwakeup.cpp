@@ -0,0 +1,188 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file _httpwakeup.cpp
+ * @brief Internal definitions of the service thread's wakeup socket
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "_httpwakeup.h"
+
+#if LL_WINDOWS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+
+static const char * const LOG_CORE("CoreHttp");
+
+} // end anonymous namespace
+
+
+namespace LLCore
+{
+
+
+#if LL_WINDOWS
+
+HttpWakeup::HttpWakeup()
+	: mReadSocket(CURL_SOCKET_BAD),
+	  mWriteSocket(CURL_SOCKET_BAD),
+	  mSignalled(false)
+{
+	// A UDP socket connected to itself reads what it writes
+	SOCKET sock(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+	if (INVALID_SOCKET == sock)
+	{
+		LL_WARNS(LOG_CORE) << "Unable to create wakeup socket:  " << WSAGetLastError() << LL_ENDL;
+		return;
+	}
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	int addr_len(sizeof(addr));
+	u_long non_blocking(1);
+
+	if (bind(sock, (sockaddr *) &addr, addr_len)
+		|| getsockname(sock, (sockaddr *) &addr, &addr_len)
+		|| connect(sock, (sockaddr *) &addr, addr_len)
+		|| ioctlsocket(sock, FIONBIO, &non_blocking))
+	{
+		LL_WARNS(LOG_CORE) << "Unable to set up wakeup socket:  " << WSAGetLastError() << LL_ENDL;
+		closesocket(sock);
+		return;
+	}
+
+	mReadSocket = sock;
+	mWriteSocket = sock;
+}
+
+
+HttpWakeup::~HttpWakeup()
+{
+	if (CURL_SOCKET_BAD != mReadSocket)
+	{
+		closesocket(mReadSocket);
+	}
+}
+
+
+void HttpWakeup::signal()
+{
+	if (CURL_SOCKET_BAD != mWriteSocket && ! mSignalled.exchange(true))
+	{
+		const char byte(0);
+		send(mWriteSocket, &byte, 1, 0);
+	}
+}
+
+
+void HttpWakeup::drain()
+{
+	if (CURL_SOCKET_BAD != mReadSocket)
+	{
+		char buffer[16];
+		while (recv(mReadSocket, buffer, sizeof(buffer), 0) > 0)
+			;
+
+		// Clear only once empty.  A signal lost in between is one
+		// that came while the service thread was already awake.
+		mSignalled = false;
+	}
+}
+
+#else // ! LL_WINDOWS
+
+HttpWakeup::HttpWakeup()
+	: mReadSocket(CURL_SOCKET_BAD),
+	  mWriteSocket(CURL_SOCKET_BAD),
+	  mSignalled(false)
+{
+	int fds[2];
+	if (pipe(fds))
+	{
+		LL_WARNS(LOG_CORE) << "Unable to create wakeup pipe:  " << errno << LL_ENDL;
+		return;
+	}
+
+	for (int i(0); i < 2; ++i)
+	{
+		fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+		fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+	}
+
+	mReadSocket = fds[0];
+	mWriteSocket = fds[1];
+}
+
+
+HttpWakeup::~HttpWakeup()
+{
+	if (CURL_SOCKET_BAD != mReadSocket)
+	{
+		close(mReadSocket);
+		close(mWriteSocket);
+	}
+}
+
+
+void HttpWakeup::signal()
+{
+	if (CURL_SOCKET_BAD != mWriteSocket && ! mSignalled.exchange(true))
+	{
+		const char byte(0);
+		if (write(mWriteSocket, &byte, 1) < 0)
+		{
+			// Pipe is full, which means it is readable already
+			;
+		}
+	}
+}
+
+
+void HttpWakeup::drain()
+{
+	if (CURL_SOCKET_BAD != mReadSocket)
+	{
+		char buffer[16];
+		while (read(mReadSocket, buffer, sizeof(buffer)) > 0)
+			;
+
+		// Clear only once empty.  A signal lost in between is one
+		// that came while the service thread was already awake.
+		mSignalled = false;
+	}
+}
+
+#endif // LL_WINDOWS
+
+}  // end namespace LLCore
@@ -0,0 +1,99 @@
+/**
+ * @file _httpwakeup.h
+ * @brief Internal declaration of the service thread's wakeup socket
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef	_LLCORE_HTTP_WAKEUP_H_
+#define	_LLCORE_HTTP_WAKEUP_H_
+
+
+#include "linden_common.h"		// Modifies curl/curl.h interfaces
+
+#include <atomic>
+
+#include <curl/curl.h>
+
+
+namespace LLCore
+{
+
+
+/// Descriptor that becomes readable when signalled, so the service
+/// thread can wait in select() on libcurl's sockets and still be
+/// woken by other threads.  A pipe on POSIX systems and a connected
+/// loopback UDP socket on Windows, where select() only takes sockets.
+///
+/// The libcurl we ship predates curl_multi_poll() and
+/// curl_multi_wakeup(), which would otherwise do this job, and
+/// those only wait on a single multi handle anyway.
+///
+/// Threading:  @signal is callable by any thread, everything else
+/// by the service thread only.
+
+class HttpWakeup
+{
+public:
+	HttpWakeup();
+	~HttpWakeup();
+
+private:
+	HttpWakeup(const HttpWakeup &) = delete;				// Not defined
+	HttpWakeup& operator=(const HttpWakeup &) = delete;	// Not defined
+
+public:
+	/// False if the descriptors couldn't be created, in which
+	/// case callers must fall back to polling.
+	bool isValid() const
+		{
+			return CURL_SOCKET_BAD != mReadSocket;
+		}
+
+	/// Descriptor to watch for readability.
+	curl_socket_t getSocket() const
+		{
+			return mReadSocket;
+		}
+
+	/// Make the descriptor readable until the next @drain.
+	/// Signals arriving before then are coalesced.
+	///
+	/// Threading:  callable by any thread.
+	void signal();
+
+	/// Consume pending signals.
+	///
+	/// Threading:  callable by the service thread only.
+	void drain();
+
+protected:
+	curl_socket_t		mReadSocket;
+	curl_socket_t		mWriteSocket;
+	std::atomic<bool>	mSignalled;
+
+}; // end class HttpWakeup
+
+}  // end namespace LLCore
+
+
+#endif	// _LLCORE_HTTP_WAKEUP_H_
@@ -28,11 +28,14 @@
 
 #include "bufferarray.h"
 
+#include "llmemory.h"
+
 
 // BufferArray is a list of chunks, each a BufferArray::Block, of contiguous
 // data presented as a single array.  Chunks are at least BufferArray::BLOCK_ALLOC_SIZE
 // in length and can be larger.  Any chunk may be partially filled or even
-// empty.
+// empty.  A block reserved with reserveContiguous() keeps its data in a
+// separate aligned allocation so that it can be handed over by itself.
 //
 // The BufferArray itself is sharable as a RefCounted entity.  As shared
 // reads don't work with the concept of a current position/seek value,
@@ -59,6 +62,7 @@ public:
 
 protected:
 	Block(size_t len);
+	Block(size_t len, char * buffer);
 
 	Block(const Block &) = delete;						// Not defined
 	Block& operator=(const Block &) = delete;				// Not defined
@@ -68,12 +72,17 @@ protected:
 	void * operator new(size_t len, size_t addl_len);
 	
 public:
-	// Only public entry to get a block.
+	// Only public entries to get a block.
 	static Block * alloc(size_t len);
+	static Block * allocAligned(size_t len);
+
+	// Gives up an aligned block's data, NULL for others.
+	char * detach();
 
 public:
 	size_t mUsed;
 	size_t mAlloced;
+	char * mBuffer;		// mData or a separate aligned allocation
 
 	// *NOTE:  Must be last member of the object.  We'll
 	// overallocate as requested via operator new and index
@@ -124,7 +133,7 @@ size_t BufferArray::append(const void * src, size_t len)
 			// Some will fit...
 			const size_t copy_len((std::min)(len, (last.mAlloced - last.mUsed)));
 
-			memcpy(&last.mData[last.mUsed], c_src, copy_len);
+			memcpy(&last.mBuffer[last.mUsed], c_src, copy_len);
 			last.mUsed += copy_len;
 			llassert_always(last.mUsed <= last.mAlloced);
 			mLen += copy_len;
@@ -143,7 +152,7 @@ size_t BufferArray::append(const void * src, size_t len)
 			mBlocks.reserve(mBlocks.size() + 5);
 		}
 		Block * block = Block::alloc(BLOCK_ALLOC_SIZE);
-		memcpy(block->mData, c_src, copy_len);
+		memcpy(block->mBuffer, c_src, copy_len);
 		block->mUsed = copy_len;
 		llassert_always(block->mUsed <= block->mAlloced);
 		mBlocks.push_back(block);
@@ -166,7 +175,51 @@ void * BufferArray::appendBufferAlloc(size_t len)
 	block->mUsed = len;
 	mBlocks.push_back(block);
 	mLen += len;
-	return block->mData;
+	return block->mBuffer;
+}
+
+
+bool BufferArray::reserveContiguous(size_t len)
+{
+	if (! mBlocks.empty() || ! len)
+	{
+		return false;
+	}
+	Block * block = Block::allocAligned(len);
+	if (! block)
+	{
+		return false;
+	}
+	mBlocks.push_back(block);
+	return true;
+}
+
+
+void * BufferArray::getContiguous()
+{
+	if (1 != mBlocks.size() || ! mLen)
+	{
+		return nullptr;
+	}
+	return mBlocks[0]->mBuffer;
+}
+
+
+void * BufferArray::detachContiguous(size_t * len)
+{
+	if (1 != mBlocks.size() || ! mLen)
+	{
+		return nullptr;
+	}
+	char * data(mBlocks[0]->detach());
+	if (data)
+	{
+		*len = mLen;
+		delete mBlocks[0];
+		mBlocks.clear();
+		mLen = 0;
+	}
+	return data;
 }
 
 
@@ -193,7 +246,7 @@ size_t BufferArray::read(size_t pos, void * dst, size_t len)
 		size_t block_limit_offset(block.mUsed - offset);
 		size_t block_len((std::min)(block_limit_offset, len));
 		
-		memcpy(c_dst, &block.mData[offset], block_len);
+		memcpy(c_dst, &block.mBuffer[offset], block_len);
 		result += block_len;
 		len -= block_len;
 		c_dst += block_len;
@@ -227,7 +280,7 @@ size_t BufferArray::write(size_t pos, const void * src, size_t len)
 			size_t block_limit_offset(block.mUsed - offset);
 			size_t block_len((std::min)(block_limit_offset, len));
 		
-			memcpy(&block.mData[offset], c_src, block_len);
+			memcpy(&block.mBuffer[offset], c_src, block_len);
 			result += block_len;
 			c_src += block_len;
 			len -= block_len;
@@ -247,7 +300,7 @@ size_t BufferArray::write(size_t pos, const void * src, size_t len)
 			// Some will fit...
 			const size_t copy_len((std::min)(len, (last.mAlloced - last.mUsed)));
 
-			memcpy(&last.mData[last.mUsed], c_src, copy_len);
+			memcpy(&last.mBuffer[last.mUsed], c_src, copy_len);
 			last.mUsed += copy_len;
 			result += copy_len;
 			llassert_always(last.mUsed <= last.mAlloced);
@@ -298,8 +351,8 @@ bool BufferArray::getBlockStartEnd(int block, const char ** start, const char **
 	}
 
 	const Block & b(*mBlocks[block]);
-	*start = &b.mData[0];
-	*end = &b.mData[b.mUsed];
+	*start = &b.mBuffer[0];
+	*end = &b.mBuffer[b.mUsed];
 	return true;
 }
 
@@ -311,16 +364,43 @@ bool BufferArray::getBlockStartEnd(int block, const char ** start, const char **
 
 BufferArray::Block::Block(size_t len)
 	: mUsed(0),
-	  mAlloced(len)
+	  mAlloced(len),
+	  mBuffer(mData)
 {
 	memset(mData, 0, len);
 }
+
+
+BufferArray::Block::Block(size_t len, char * buffer)
+	: mUsed(0),
+	  mAlloced(len),
+	  mBuffer(buffer)
+{}
 			
 
 BufferArray::Block::~Block()
 {
+	if (mBuffer != mData)
+	{
+		ll_aligned_free_16(mBuffer);
+	}
+	mBuffer = nullptr;
+	mUsed = 0;
+	mAlloced = 0;
+}
+
+
+char * BufferArray::Block::detach()
+{
+	if (mBuffer == mData)
+	{
+		return nullptr;
+	}
+	char * buffer(mBuffer);
+	mBuffer = mData;
 	mUsed = 0;
 	mAlloced = 0;
+	return buffer;
 }
 
 
@@ -349,6 +429,18 @@ BufferArray::Block * BufferArray::Block::alloc(size_t len)
 	Block * block = new (len) Block(len);
 	return block;
 }
+
+
+BufferArray::Block * BufferArray::Block::allocAligned(size_t len)
+{
+	char * buffer(static_cast<char *>(ll_aligned_malloc_16(len)));
+	if (! buffer)
+	{
+		return nullptr;
+	}
+	Block * block = new (0) Block(len, buffer);
+	return block;
+}
 	
 
 }  // end namespace LLCore
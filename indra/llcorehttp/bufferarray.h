@@ -59,6 +59,11 @@ class BufferArrayStreamBuf;
 /// write and append operations and beyond which the current position
 /// cannot be set.
 ///
+/// When the final size is known up front, @see reserveContiguous()
+/// has the data collected in a single block instead.  Consumers can
+/// then use it in place (@see getContiguous()) or take it over
+/// without a copy (@see detachContiguous()).
+///
 /// Threading:  not thread-safe
 ///
 /// Allocation:  Refcounted, heap only.  Caller of the constructor
@@ -104,6 +109,33 @@ public:
 	///					of BufferArray of 'len' size.
 	void * appendBufferAlloc(size_t len);
 
+	/// Makes room for 'len' bytes in a single 16-byte aligned
+	/// block which following appends fill before any new blocks
+	/// are added.  Only allowed on an empty instance.
+	///
+	/// @return			False if the instance isn't empty or the
+	///					allocation failed, in which case appends
+	///					work as usual.
+	bool reserveContiguous(size_t len);
+
+	/// Pointer to the data when all of it is in one block,
+	/// so it can be used without copying it out.
+	///
+	/// @return			Pointer to size() bytes or NULL if the
+	///					instance is empty or the data is scattered.
+	void * getContiguous();
+
+	/// Hands over the data of an instance holding it all in
+	/// the block made by @see reserveContiguous().  The instance
+	/// is left empty.
+	///
+	/// @param len		Receives the size of the data.
+	/// @return			Pointer to free with ll_aligned_free_16(),
+	///					or NULL if the data is elsewhere, in which
+	///					case nothing changes and @see read() must
+	///					be used.
+	void * detachContiguous(size_t * len);
+
 	/// Current count of bytes in BufferArray instance.
 	size_t size() const
 		{
@@ -46,7 +46,8 @@ HttpOptions::HttpOptions() :
     mVerifyPeer(false),
     mVerifyHost(false),
     mDNSCacheTimeout(-1L),
-    mNoBody(false)
+    mNoBody(false),
+    mContiguousBody(false)
 {}
 
 
@@ -115,4 +116,9 @@ void HttpOptions::setHeadersOnly(bool nobody)
         setWantHeaders(true);
 }
 
+void HttpOptions::setContiguousBody(bool contiguous)
+{
+    mContiguousBody = contiguous;
+}
+
 }   // end namespace LLCore
@@ -159,6 +159,17 @@ public:
     {
         return mNoBody;
     }
+
+    /// Collect the response body in one block sized from the
+    /// Content-Length header (or the requested range) so that
+    /// it can be used or taken over without copying.  See
+    /// BufferArray::getContiguous() and detachContiguous().
+    /// Default: false
+    void                setContiguousBody(bool contiguous);
+    bool                getContiguousBody() const
+    {
+        return mContiguousBody;
+    }
 	
 protected:
 	bool				mWantHeaders;
@@ -172,6 +183,7 @@ protected:
 	bool        		mVerifyHost;
 	int					mDNSCacheTimeout;
     bool                mNoBody;
+    bool                mContiguousBody;
 }; // end class HttpOptions
 
 
@@ -125,6 +125,29 @@ HttpStatus HttpRequest::setStaticPolicyOption(EPolicyOption opt, policy_t pclass
 	return HttpService::instanceOf()->setPolicyOption(opt, pclass, value, ret_value);
 }
 
+
+HttpRequest::AdaptiveStats::AdaptiveStats()
+	: mEnabled(false),
+	  mLimit(0L),
+	  mCeiling(0L),
+	  mThroughput(0.0),
+	  mRequestTime(0.0),
+	  mMinRequestTime(0.0),
+	  mErrorRate(0.0),
+	  mDecreases(0U)
+{}
+
+
+HttpStatus HttpRequest::getAdaptiveStats(policy_t pclass, AdaptiveStats * stats)
+{
+	HttpService * service(HttpService::instanceOf());
+	if (! service || ! stats)
+	{
+		return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
+	}
+	return service->getPolicy().getAdaptiveStats(pclass, stats);
+}
+
 HttpHandle HttpRequest::setPolicyOption(EPolicyOption opt, policy_t pclass,
 										long value, HttpHandler::ptr_t handler)
 {
@@ -233,6 +233,51 @@ public:
 		/// Global only
 		PO_SSL_VERIFY_CALLBACK,
 
+		/// If greater than 0, requests in this class ask for HTTP/2
+		/// and many of them are multiplexed as streams on a single
+		/// connection.  Value gives the maximum number of concurrent
+		/// streams per connection.  Takes precedence over
+		/// PO_PIPELINING_DEPTH.
+		///
+		/// HTTP/2 is negotiated during the TLS handshake so only
+		/// https: requests use it.  Others, and servers that don't
+		/// offer it, fall back to HTTP/1.1 with one request per
+		/// connection as usual.
+		///
+		/// Concurrency is then limited by streams rather than
+		/// connections.  libcurl manages the connections, opening
+		/// at most PO_PER_HOST_CONNECTION_LIMIT to a host (and
+		/// PO_CONNECTION_LIMIT overall) and the in-flight request
+		/// limit becomes PO_PER_HOST_CONNECTION_LIMIT times this
+		/// value.  Requests wait for room on an existing HTTP/2
+		/// connection in preference to opening another, so one
+		/// connection per host is the usual outcome.
+		///
+		/// When the libcurl in use was built without HTTP/2
+		/// support, the effective value is always 0.
+		///
+		/// Per-class only
+		PO_HTTP2_STREAMS,
+
+		/// If greater than 0, the limit on requests in flight in
+		/// this class is adjusted while running from the throughput,
+		/// times to first byte and failures seen on completion.  It starts
+		/// at the limit the options above give and moves between 1
+		/// and the larger of that limit and this value.  Requests
+		/// queue rather than go out when over the current limit.
+		///
+		/// Additive increase and multiplicative decrease:  the limit
+		/// is cut by 30% after an interval with 503 or 429 replies,
+		/// timeouts or failed connects, lowered by one when times to
+		/// first byte grow without throughput growing with them, and
+		/// raised by one when it held requests back.  @see
+		/// getAdaptiveStats() for the current state.
+		///
+		/// A value of zero, the default, keeps the limit static.
+		///
+		/// Per-class only
+		PO_ADAPTIVE_CONCURRENCY,
+
 		PO_LAST  // Always at end
 	};
 
@@ -258,6 +303,31 @@ public:
 	static HttpStatus setStaticPolicyOption(EPolicyOption opt, policy_t pclass,
 											policyCallback_t value, policyCallback_t * ret_value);;
 
+	/// State of a policy class's adaptive concurrency limit
+	/// (@see PO_ADAPTIVE_CONCURRENCY) as of the last adjustment.
+	struct AdaptiveStats
+	{
+		AdaptiveStats();
+
+		bool				mEnabled;
+		long				mLimit;				// Current in-flight request limit
+		long				mCeiling;			// Highest the limit may go
+		F64					mThroughput;		// Bytes per second received
+		F64					mRequestTime;		// Smoothed time to first byte, seconds
+		F64					mMinRequestTime;	// Lowest recent time to first byte, seconds
+		F64					mErrorRate;			// Fraction of completions that were congestion failures
+		U32					mDecreases;			// Number of times the limit was lowered
+	};
+
+	/// Retrieve a snapshot of a class's adaptive concurrency state.
+	/// Callable at any time by any thread.
+	///
+	/// @param pclass		Policy class ID.
+	/// @param stats		Receives the state.
+	/// @return				Standard status code.  HE_INVALID_ARG if
+	///						the class doesn't exist.
+	static HttpStatus getAdaptiveStats(policy_t pclass, AdaptiveStats * stats);
+
 	/// Set a parameter on a class-based policy option.  Calls
 	/// made after the start of the servicing thread are
 	/// not honored and return an error status.
@@ -74,10 +74,16 @@ public:
 	{
 		typedef boost::shared_ptr<TransferStats> ptr_t;
 
-		TransferStats() : mSizeDownload(0.0), mTotalTime(0.0), mSpeedDownload(0.0) {}
+		TransferStats()
+			: mSizeDownload(0.0), mTotalTime(0.0), mStartTransferTime(0.0), mSpeedDownload(0.0),
+			  mNewConnections(0), mHttpVersion(0)
+			{}
 		F64 mSizeDownload;
 		F64 mTotalTime;
+		F64 mStartTransferTime;		// Time until the first response byte arrived
 		F64 mSpeedDownload;
+		long mNewConnections;		// Connections opened for this request, 0 if one was reused
+		long mHttpVersion;			// Major version of the response, 0 if unknown
 	};
 
 
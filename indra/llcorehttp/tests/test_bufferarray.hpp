@@ -30,6 +30,8 @@
 
 #include <iostream>
 
+#include "llmemory.h"
+
 #include "test_allocator.h"
 
 
@@ -426,6 +428,68 @@ void BufferArrayTestObjectType::test<8>()
 	ensure("All memory released", mMemTotal == GetMemTotal());
 }
 
+template <> template <>
+void BufferArrayTestObjectType::test<9>()
+{
+	set_test_name("BufferArray contiguous reservation");
+
+	// record the total amount of dynamically allocated memory
+	mMemTotal = GetMemTotal();
+
+	char str1[] = "abcdefghij";
+	const size_t str1_len(strlen(str1));
+	char buffer[256];
+
+	// Fill exactly what was reserved in several appends
+	BufferArray * ba = new BufferArray();
+	ensure("Reserve on empty", ba->reserveContiguous(3 * str1_len));
+	ensure("No second reserve", ! ba->reserveContiguous(10));
+	ensure("Nothing to see yet", NULL == ba->getContiguous());
+	for (int i(0); i < 3; ++i)
+	{
+		ba->append(str1, str1_len);
+	}
+	ensure("Size correct", 3 * str1_len == ba->size());
+	const char * data(static_cast<const char *>(ba->getContiguous()));
+	ensure("Data in one block", NULL != data);
+	ensure("Content correct", 0 == strncmp(data + 2 * str1_len, str1, str1_len));
+	ensure("Aligned for images", 0 == (reinterpret_cast<uintptr_t>(data) & 0xf));
+
+	size_t len(0);
+	char * taken(static_cast<char *>(ba->detachContiguous(&len)));
+	ensure("Detached the same memory", taken == data);
+	ensure("Detached length correct", 3 * str1_len == len);
+	ensure("Left empty", 0 == ba->size());
+	ensure("Nothing left to read", 0 == ba->read(0, buffer, sizeof(buffer)));
+	ll_aligned_free_16(taken);
+	ba->release();
+
+	// Overflowing the reservation scatters the data, it must
+	// still read back but can't be handed over
+	ba = new BufferArray();
+	ensure("Reserve on empty.2", ba->reserveContiguous(str1_len));
+	ba->append(str1, str1_len);
+	ba->append(str1, str1_len);
+	ensure("Scattered", NULL == ba->getContiguous());
+	ensure("Not detachable", NULL == ba->detachContiguous(&len));
+	memset(buffer, 'X', sizeof(buffer));
+	len = ba->read(0, buffer, sizeof(buffer));
+	ensure("Read length correct", 2 * str1_len == len);
+	ensure("Read content correct", 0 == strncmp(buffer + str1_len, str1, str1_len));
+	ba->release();
+
+	// Ordinary blocks read in place but aren't detachable
+	ba = new BufferArray();
+	ba->append(str1, str1_len);
+	ensure("No reserve after data", ! ba->reserveContiguous(10));
+	ensure("One ordinary block", NULL != ba->getContiguous());
+	ensure("Ordinary block not detachable", NULL == ba->detachContiguous(&len));
+	ba->release();
+
+	// make sure we didn't leak any memory
+	ensure("All memory released", mMemTotal == GetMemTotal());
+}
+
 }  // end namespace tut
 
 
@@ -0,0 +1,186 @@
+/**
+ * @file test_httpadaptivelimit.hpp
+ * @brief unit tests for the LLCore::HttpAdaptiveLimit class
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#ifndef TEST_LLCORE_HTTP_ADAPTIVELIMIT_H_
+#define TEST_LLCORE_HTTP_ADAPTIVELIMIT_H_
+
+#include "_httpadaptivelimit.h"
+#include "_httpinternal.h"
+
+
+using namespace LLCore;
+
+
+namespace
+{
+
+// Simulated service behind a bottleneck link.  Every request
+// takes the base time plus its share of the link.  Requests in
+// flight beyond the server's capacity are refused with 503s.
+struct SimService
+{
+	F64		mLinkRate;			// Bytes per second
+	F64		mBaseTime;			// Seconds
+	F64		mBodySize;			// Bytes
+	long	mServerLimit;		// Requests in flight served
+};
+
+// Drive the controller for a number of intervals with more
+// requests always waiting than the limit allows.  Returns the
+// highest limit seen over the last half of the run.
+long simulate(HttpAdaptiveLimit & limit, const SimService & service, int intervals)
+{
+	static const long start(8L), ceiling(32L);
+	long highest(0L);
+	HttpTime now(HTTP_ADAPTIVE_INTERVAL);
+
+	limit.update(now, start, ceiling);
+	for (int i(0); i < intervals; ++i)
+	{
+		const long in_flight(limit.getLimit());
+		const long served(llmin(in_flight, service.mServerLimit));
+		const F64 secs(service.mBaseTime + F64(served) * service.mBodySize / service.mLinkRate);
+		const int completions(int(F64(served) / secs + 0.5));
+
+		for (int j(0); j < completions; ++j)
+		{
+			limit.addSample(false, secs, service.mBodySize);
+		}
+		for (long j(served); j < in_flight; ++j)
+		{
+			limit.addSample(true, 0.001, 0.0);
+		}
+		limit.noteLimited();
+
+		now += HTTP_ADAPTIVE_INTERVAL;
+		limit.update(now, start, ceiling);
+		if (i >= intervals / 2)
+		{
+			highest = llmax(highest, limit.getLimit());
+		}
+	}
+	return highest;
+}
+
+}  // end anonymous namespace
+
+
+namespace tut
+{
+
+struct HttpAdaptiveLimitTestData
+{
+	// the test objects inherit from this so the member functions and variables
+	// can be referenced directly inside of the test functions.
+};
+
+typedef test_group<HttpAdaptiveLimitTestData> HttpAdaptiveLimitTestGroupType;
+typedef HttpAdaptiveLimitTestGroupType::object HttpAdaptiveLimitTestObjectType;
+HttpAdaptiveLimitTestGroupType HttpAdaptiveLimitTestGroup("HttpAdaptiveLimit Tests");
+
+template <> template <>
+void HttpAdaptiveLimitTestObjectType::test<1>()
+{
+	set_test_name("HttpAdaptiveLimit start and range");
+
+	HttpAdaptiveLimit limit;
+	ensure("Disabled on construction", ! limit.isEnabled());
+
+	limit.update(0, 8L, 32L);
+	ensure("Enabled after update", limit.isEnabled());
+	ensure_equals("Starts at static limit", limit.getLimit(), 8L);
+
+	limit.update(0, 8L, 4L);
+	ensure_equals("Lowered with ceiling", limit.getLimit(), 4L);
+
+	limit.disable();
+	limit.update(0, 0L, 0L);
+	ensure_equals("Never below one", limit.getLimit(), 1L);
+
+	HttpRequest::AdaptiveStats stats;
+	limit.getStats(&stats);
+	ensure("Stats enabled", stats.mEnabled);
+	ensure_equals("Stats limit", stats.mLimit, 1L);
+	ensure_equals("No decreases", stats.mDecreases, 0U);
+}
+
+template <> template <>
+void HttpAdaptiveLimitTestObjectType::test<2>()
+{
+	set_test_name("HttpAdaptiveLimit on a fast link");
+
+	// Plenty of bandwidth, request times barely move.  Should
+	// climb to the ceiling and stay.
+	const SimService service = { 1.0e9, 0.05, 100000.0, 1000L };
+	HttpAdaptiveLimit limit;
+	simulate(limit, service, 60);
+
+	HttpRequest::AdaptiveStats stats;
+	limit.getStats(&stats);
+	ensure_equals("Reached ceiling", stats.mLimit, 32L);
+	ensure_equals("Never lowered", stats.mDecreases, 0U);
+	ensure("Throughput measured", stats.mThroughput > 0.0);
+	ensure("Request time measured", stats.mMinRequestTime > 0.0);
+}
+
+template <> template <>
+void HttpAdaptiveLimitTestObjectType::test<3>()
+{
+	set_test_name("HttpAdaptiveLimit against an overloaded server");
+
+	// Server refuses anything beyond 10 in flight.  Should back
+	// off whenever it goes over and never run far above.
+	const SimService service = { 1.0e9, 0.05, 100000.0, 10L };
+	HttpAdaptiveLimit limit;
+	const long highest(simulate(limit, service, 120));
+
+	HttpRequest::AdaptiveStats stats;
+	limit.getStats(&stats);
+	ensure("Backed off", stats.mDecreases > 0U);
+	ensure("Stays near server limit", highest <= 11L);
+	ensure("Still uses the server", stats.mLimit >= 5L);
+}
+
+template <> template <>
+void HttpAdaptiveLimitTestObjectType::test<4>()
+{
+	set_test_name("HttpAdaptiveLimit on a slow link");
+
+	// 1 MB/S link, each 100 KB body takes 0.1 S of it.  More in
+	// flight only queues so should settle at a few requests.
+	const SimService service = { 1.0e6, 0.1, 100000.0, 1000L };
+	HttpAdaptiveLimit limit;
+	const long highest(simulate(limit, service, 120));
+
+	HttpRequest::AdaptiveStats stats;
+	limit.getStats(&stats);
+	ensure("Backed off", stats.mDecreases > 0U);
+	ensure("Stays well below ceiling", highest <= 6L);
+	ensure("No errors", stats.mErrorRate == 0.0);
+}
+
+}  // end namespace tut
+
+#endif  // TEST_LLCORE_HTTP_ADAPTIVELIMIT_H_
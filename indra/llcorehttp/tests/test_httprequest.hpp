@@ -34,9 +34,12 @@
 #include "httpoptions.h"
 #include "_httpservice.h"
 #include "_httprequestqueue.h"
+#include "_httpinternal.h"
+#include "lltimer.h"
 
 #include <curl/curl.h>
 #include <boost/regex.hpp>
+#include <iostream>
 #include <sstream>
 
 #include "test_allocator.h"
@@ -183,6 +186,32 @@ public:
 	regex_container_t mHeadersDisallowed;
 };
 
+// Sums the connection stats of the responses it sees.
+class TestConnectionHandler : public TestHandler2
+{
+public:
+	TestConnectionHandler(HttpRequestTestData * state,
+						  const std::string & name)
+		: TestHandler2(state, name),
+		  mNewConnections(0),
+		  mHttp2Responses(0)
+		{}
+
+	virtual void onCompleted(HttpHandle handle, HttpResponse * response)
+		{
+			TestHandler2::onCompleted(handle, response);
+
+			HttpResponse::TransferStats::ptr_t stats(response->getTransferStats());
+			ensure("Transfer stats returned", stats != NULL);
+			ensure("Connection count in range", stats->mNewConnections == 0 || stats->mNewConnections == 1);
+			mNewConnections += stats->mNewConnections;
+			mHttp2Responses += (2 == stats->mHttpVersion ? 1 : 0);
+		}
+
+	long mNewConnections;
+	int mHttp2Responses;
+};
+
 typedef test_group<HttpRequestTestData> HttpRequestTestGroupType;
 typedef HttpRequestTestGroupType::object HttpRequestTestObjectType;
 HttpRequestTestGroupType HttpRequestTestGroup("HttpRequest Tests");
@@ -3217,6 +3246,377 @@ void HttpRequestTestObjectType::test<23>()
 }
 
 
+template <> template <>
+void HttpRequestTestObjectType::test<24>()
+{
+	ScopedCurlInit ready;
+
+	set_test_name("HttpRequest GET round-trip latency");
+
+	// Issues GETs one at a time against the test server and
+	// times each from request to handler invocation.  The
+	// service thread waits on its sockets and the request
+	// queue, so this should be the server's time plus thread
+	// wakeups rather than multiples of a polling interval.
+	// Numbers are printed for comparing builds.
+	TestHandler2 handler(this, "handler");
+	LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+	std::string url_base(get_base_url());
+
+	mHandlerCalls = 0;
+
+	HttpRequest * req = NULL;
+
+	try
+	{
+		// Get singletons created
+		HttpRequest::createService();
+		
+		// Start threading early so that thread memory is invariant
+		// over the test.
+		HttpRequest::startThread();
+
+		req = new HttpRequest();
+
+		const int request_count(50);
+		U64 total_usec(0);
+		mStatus = HttpStatus(200);
+		for (int i(0); i < request_count; ++i)
+		{
+			const U64 start(totalTime());
+			HttpHandle handle = req->requestGet(HttpRequest::DEFAULT_POLICY_ID,
+												0U,
+												url_base,
+												HttpOptions::ptr_t(),
+												HttpHeaders::ptr_t(),
+												handlerp);
+			ensure("Valid handle returned for get request", handle != LLCORE_HTTP_HANDLE_INVALID);
+
+			// Spin the notification pump tightly so our own sleeps
+			// don't dominate what's measured.
+			int count(0);
+			int limit(LOOP_COUNT_SHORT * 100);
+			while (count++ < limit && mHandlerCalls <= i)
+			{
+				req->update(0);
+				usleep(100);
+			}
+			ensure("Request executed in reasonable time", count < limit);
+
+			total_usec += totalTime() - start;
+		}
+		ensure("One handler invocation per request", mHandlerCalls == request_count);
+
+		const U64 mean_usec(total_usec / request_count);
+		ensure("Mean round trip well under the service loop's wait limit",
+			   mean_usec < U64(HTTP_SERVICE_LOOP_WAIT_MAX_MS) * 1000U);
+
+		// Okay, request a shutdown of the servicing thread
+		mStatus = HttpStatus();
+		mHandlerCalls = 0;
+		HttpHandle handle = req->requestStopThread(handlerp);
+		ensure("Valid handle returned for second request", handle != LLCORE_HTTP_HANDLE_INVALID);
+	
+		// Run the notification pump again
+		int count(0);
+		int limit(LOOP_COUNT_LONG);
+		while (count++ < limit && mHandlerCalls < 1)
+		{
+			req->update(1000000);
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Second request executed in reasonable time", count < limit);
+		ensure("Second handler invocation", mHandlerCalls == 1);
+
+		// See that we actually shutdown the thread
+		count = 0;
+		limit = LOOP_COUNT_SHORT;
+		while (count++ < limit && ! HttpService::isStopped())
+		{
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Thread actually stopped running", HttpService::isStopped());
+
+		// release the request object
+		delete req;
+		req = NULL;
+
+		// Shut down service
+		HttpRequest::destroyService();
+	}
+	catch (...)
+	{
+		stop_thread(req);
+		delete req;
+		HttpRequest::destroyService();
+		throw;
+	}
+}
+
+
+template <> template <>
+void HttpRequestTestObjectType::test<25>()
+{
+	ScopedCurlInit ready;
+
+	set_test_name("HttpRequest GETs in an HTTP/2 policy class");
+
+	// The test server is plain HTTP/1.0 so this checks the
+	// fallback:  requests in a class asking for HTTP/2 must
+	// still complete, over HTTP/1, within the class's limits,
+	// and come back with connection stats.  When libcurl can't
+	// do HTTP/2 the option reads back as 0 and the class runs
+	// on connection limits instead.
+	TestConnectionHandler handler(this, "handler");
+	LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+	TestHandler2 stop_handler(this, "stop_handler");
+	LLCore::HttpHandler::ptr_t stop_handlerp(&stop_handler, NoOpDeletor);
+	std::string url_base(get_base_url());
+
+	mHandlerCalls = 0;
+
+	HttpRequest * req = NULL;
+
+	try
+	{
+		// Get singletons created
+		HttpRequest::createService();
+
+		// Class-only option
+		HttpStatus status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_STREAMS,
+															   HttpRequest::GLOBAL_POLICY_ID,
+															   32, NULL);
+		ensure("HTTP/2 option refused globally", ! status);
+
+		HttpRequest::policy_t policy_class(HttpRequest::createPolicyClass());
+		ensure("Policy class created", policy_class != HttpRequest::INVALID_POLICY_ID);
+
+		long value(0);
+		status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_CONNECTION_LIMIT,
+													policy_class, 2, &value);
+		ensure("Connection limit set", status && value == 2);
+		status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_PER_HOST_CONNECTION_LIMIT,
+													policy_class, 2, &value);
+		ensure("Per-host connection limit set", status && value == 2);
+		status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_STREAMS,
+													policy_class, 100000, &value);
+		ensure("HTTP/2 streams set", status);
+		ensure("HTTP/2 streams clamped or unavailable",
+			   value == 0 || value == HTTP_HTTP2_STREAMS_MAX);
+		status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_STREAMS,
+													policy_class, 16, &value);
+		ensure("HTTP/2 streams reset", status && (value == 0 || value == 16));
+		
+		// Start threading early so that thread memory is invariant
+		// over the test.
+		HttpRequest::startThread();
+
+		req = new HttpRequest();
+
+		// Queue all at once, more than the connections can carry
+		const int request_count(40);
+		mStatus = HttpStatus(200);
+		for (int i(0); i < request_count; ++i)
+		{
+			HttpHandle handle = req->requestGet(policy_class,
+												0U,
+												url_base,
+												HttpOptions::ptr_t(),
+												HttpHeaders::ptr_t(),
+												handlerp);
+			ensure("Valid handle returned for get request", handle != LLCORE_HTTP_HANDLE_INVALID);
+		}
+
+		// Run the notification pump.
+		int count(0);
+		int limit(LOOP_COUNT_LONG);
+		while (count++ < limit && mHandlerCalls < request_count)
+		{
+			req->update(1000000);
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Requests executed in reasonable time", count < limit);
+		ensure("One handler invocation per request", mHandlerCalls == request_count);
+		ensure("Connections were made", handler.mNewConnections > 0);
+		ensure("No more connections than requests", handler.mNewConnections <= request_count);
+		ensure("HTTP/1 server answered on HTTP/1", handler.mHttp2Responses == 0);
+
+		// Okay, request a shutdown of the servicing thread
+		mStatus = HttpStatus();
+		mHandlerCalls = 0;
+		HttpHandle handle = req->requestStopThread(stop_handlerp);
+		ensure("Valid handle returned for second request", handle != LLCORE_HTTP_HANDLE_INVALID);
+	
+		// Run the notification pump again
+		count = 0;
+		limit = LOOP_COUNT_LONG;
+		while (count++ < limit && mHandlerCalls < 1)
+		{
+			req->update(1000000);
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Second request executed in reasonable time", count < limit);
+		ensure("Second handler invocation", mHandlerCalls == 1);
+
+		// See that we actually shutdown the thread
+		count = 0;
+		limit = LOOP_COUNT_SHORT;
+		while (count++ < limit && ! HttpService::isStopped())
+		{
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Thread actually stopped running", HttpService::isStopped());
+
+		// release the request object
+		delete req;
+		req = NULL;
+
+		// Shut down service
+		HttpRequest::destroyService();
+	}
+	catch (...)
+	{
+		stop_thread(req);
+		delete req;
+		HttpRequest::destroyService();
+		throw;
+	}
+}
+
+
+template <> template <>
+void HttpRequestTestObjectType::test<26>()
+{
+	ScopedCurlInit ready;
+
+	set_test_name("HttpRequest adaptive concurrency against a throttled server");
+
+	// The '/throttle/' path refuses with 503s once it has served
+	// its quota for the second.  Requests must all get through
+	// on retries and the class must have cut its limit on the way.
+	TestHandler2 handler(this, "handler");
+	LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+	std::string url_base(get_base_url() + "/throttle/");
+
+	mHandlerCalls = 0;
+
+	HttpRequest * req = NULL;
+
+	try
+	{
+		// Get singletons created
+		HttpRequest::createService();
+
+		// Class-only option
+		HttpStatus status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_ADAPTIVE_CONCURRENCY,
+															   HttpRequest::GLOBAL_POLICY_ID,
+															   16, NULL);
+		ensure("Adaptive option refused globally", ! status);
+
+		HttpRequest::policy_t policy_class(HttpRequest::createPolicyClass());
+		ensure("Policy class created", policy_class != HttpRequest::INVALID_POLICY_ID);
+
+		long value(0);
+		status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_CONNECTION_LIMIT,
+													policy_class, 8, &value);
+		ensure("Connection limit set", status && value == 8);
+		status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_ADAPTIVE_CONCURRENCY,
+													policy_class, 100000, &value);
+		ensure("Adaptive ceiling clamped", status && value == HTTP_ADAPTIVE_CEILING_MAX);
+		status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_ADAPTIVE_CONCURRENCY,
+													policy_class, 16, &value);
+		ensure("Adaptive ceiling set", status && value == 16);
+
+		HttpRequest::AdaptiveStats stats;
+		status = HttpRequest::getAdaptiveStats(policy_class + 1, &stats);
+		ensure("Unknown class refused", ! status);
+		status = HttpRequest::getAdaptiveStats(policy_class, &stats);
+		ensure("Stats available before start", status && ! stats.mEnabled);
+		
+		// Start threading early so that thread memory is invariant
+		// over the test.
+		HttpRequest::startThread();
+
+		req = new HttpRequest();
+
+		HttpOptions::ptr_t options(new HttpOptions());
+		options->setRetries(10);
+
+		// Queue all at once, a few seconds' worth for the server
+		const int request_count(30);
+		mStatus = HttpStatus(200);
+		for (int i(0); i < request_count; ++i)
+		{
+			HttpHandle handle = req->requestGet(policy_class,
+												0U,
+												url_base,
+												options,
+												HttpHeaders::ptr_t(),
+												handlerp);
+			ensure("Valid handle returned for get request", handle != LLCORE_HTTP_HANDLE_INVALID);
+		}
+
+		// Run the notification pump.
+		int count(0);
+		int limit(LOOP_COUNT_LONG);
+		while (count++ < limit && mHandlerCalls < request_count)
+		{
+			req->update(1000000);
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Requests executed in reasonable time", count < limit);
+		ensure("One handler invocation per request", mHandlerCalls == request_count);
+
+		status = HttpRequest::getAdaptiveStats(policy_class, &stats);
+		ensure("Stats available", status);
+		ensure("Adaptive limit running", stats.mEnabled);
+		ensure("Ceiling from option", stats.mCeiling == 16);
+		ensure("Limit cut after 503s", stats.mDecreases > 0);
+		ensure("Limit within range", stats.mLimit >= 1 && stats.mLimit <= 16);
+
+		// Okay, request a shutdown of the servicing thread
+		mStatus = HttpStatus();
+		mHandlerCalls = 0;
+		HttpHandle handle = req->requestStopThread(handlerp);
+		ensure("Valid handle returned for second request", handle != LLCORE_HTTP_HANDLE_INVALID);
+	
+		// Run the notification pump again
+		count = 0;
+		limit = LOOP_COUNT_LONG;
+		while (count++ < limit && mHandlerCalls < 1)
+		{
+			req->update(1000000);
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Second request executed in reasonable time", count < limit);
+		ensure("Second handler invocation", mHandlerCalls == 1);
+
+		// See that we actually shutdown the thread
+		count = 0;
+		limit = LOOP_COUNT_SHORT;
+		while (count++ < limit && ! HttpService::isStopped())
+		{
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Thread actually stopped running", HttpService::isStopped());
+
+		// release the request object
+		delete req;
+		req = NULL;
+
+		// Shut down service
+		HttpRequest::destroyService();
+	}
+	catch (...)
+	{
+		stop_thread(req);
+		delete req;
+		HttpRequest::destroyService();
+		throw;
+	}
+}
+
+
 }  // end namespace tut
 
 namespace
@@ -33,6 +33,7 @@ import os
 import sys
 import time
 import select
+import threading
 import getopt
 try:
     from cStringIO import StringIO
@@ -79,12 +80,22 @@ class TestHTTPRequestHandler(BaseHTTPRequestHandler):
     -- '/503/4/'            "Retry-After: (*#*(@*(@(")"
     -- '/503/5/'            "Retry-After: aklsjflajfaklsfaklfasfklasdfklasdgahsdhgasdiogaioshdgo"
     -- '/503/6/'            "Retry-After: 1 2 3 4 5 6 7 8 9 10"
+    - '/throttle/'      Overloaded service.  Serves 'throttle_rate'
+                        requests a second, answers any beyond that
+                        with a 503 without 'retry-after'.
 
     Some combinations make no sense, there's no effort to protect
     you from that.
     """
     ignore_exceptions = (Exception,)
 
+    # Times of the requests '/throttle/' served in the last second.
+    # Class-level, so it is locked in case requests are ever handled
+    # on several threads.
+    throttle_rate = 10
+    throttle_served = []
+    throttle_lock = threading.Lock()
+
     def read(self):
         # The following logic is adapted from the library module
         # SimpleXMLRPCServer.py.
@@ -153,6 +164,21 @@ class TestHTTPRequestHandler(BaseHTTPRequestHandler):
         if "/sleep/" in self.path:
             time.sleep(30)
 
+        if "/throttle/" in self.path:
+            with TestHTTPRequestHandler.throttle_lock:
+                now = time.time()
+                served = [t for t in TestHTTPRequestHandler.throttle_served if now - t < 1.0]
+                TestHTTPRequestHandler.throttle_served = served
+                throttled = len(served) >= self.throttle_rate
+                if not throttled:
+                    served.append(now)
+            if throttled:
+                self.send_response(503)
+                self.send_header("Content-type", "text/plain")
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+
         if "/503/" in self.path:
             # Tests for various kinds of 'Retry-After' header parsing
             body = None
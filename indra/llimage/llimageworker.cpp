@@ -30,12 +30,13 @@
 
 #include "llimageworker.h"
 #include "llimagedxt.h"
+#include "llthreadpool.h"
 
 //----------------------------------------------------------------------------
 
 // MAIN THREAD
-LLImageDecodeThread::LLImageDecodeThread(bool threaded)
-	: LLQueuedThread("imagedecode", threaded)
+LLImageDecodeThread::LLImageDecodeThread(bool threaded, U32 num_workers)
+	: LLQueuedThread("imagedecode", threaded, false, num_workers != 1 ? LLThreadPool::getShared() : nullptr, num_workers)
 {
 	mCreationMutex = new LLMutex();
 }
@@ -46,6 +47,16 @@ LLImageDecodeThread::~LLImageDecodeThread()
 	delete mCreationMutex ;
 }
 
+U32 LLImageDecodeThread::getWorkerCount() const
+{
+	if (mPool)
+	{
+		U32 count = mPool->getWorkerCount();
+		return getMaxPoolTasks() ? llmin(count, getMaxPoolTasks()) : count;
+	}
+	return mThreaded ? 1 : 0;
+}
+
 // MAIN THREAD
 // virtual
 S32 LLImageDecodeThread::update(F32 max_time_ms)
@@ -31,6 +31,11 @@
 #include "llpointer.h"
 #include "llworkerthread.h"
 
+// Decodes formatted images into raw images, either on a dedicated thread or,
+// when created with more than one worker and LLThreadPool::initClass() was
+// called, on the shared pool with at most that many decodes in flight. With
+// the pool the highest priority requests are still decoded first, several at
+// a time, and pause() has no effect.
 class LLImageDecodeThread : public LLQueuedThread
 {
 public:
@@ -72,9 +77,12 @@ public:
 	};
 	
 public:
-	LLImageDecodeThread(bool threaded = true);
+	// num_workers == 0 means as many as the shared pool has workers
+	LLImageDecodeThread(bool threaded = true, U32 num_workers = 1);
 	virtual ~LLImageDecodeThread();
 
+	U32 getWorkerCount() const;
+
 	handle_t decodeImage(LLImageFormatted* image,
 						 U32 priority, S32 discard, BOOL needs_aux,
 						 Responder* responder);
@@ -33,6 +33,8 @@
 #include "../llimageworker.h"
 // For timer class
 #include "../llcommon/lltimer.h"
+// For the shared thread pool
+#include "../llcommon/llthreadpool.h"
 // for lltrace class
 #include "../llcommon/lltrace.h"
 // Tut header
@@ -125,6 +127,8 @@ namespace tut
 		~imagedecodethread_test()
 		{
 			delete mThread;
+			// Only after the thread, which may be using it
+			LLThreadPool::cleanupClass();
 		}
 	};
 
@@ -246,6 +250,47 @@ namespace tut
 		ensure("LLImageDecodeThread: threaded work unit not processed", done == true);
 	}
 
+	template<> template<>
+	void imagedecodethread_object_t::test<3>()
+	{
+		// Test an instance decoding on part of the shared pool of workers
+		LLThreadPool::initClass(4);
+		mThread = new LLImageDecodeThread(true, 2);
+		ensure("LLImageDecodeThread: pooled constructor failed", mThread != NULL);
+		ensure("LLImageDecodeThread: shared pool not used", mThread->getThreadPool() == LLThreadPool::getShared());
+		ensure_equals("LLImageDecodeThread: pooled worker count incorrect", mThread->getWorkerCount(), 2U);
+		// Queue several work units so that more than one worker gets some
+		const S32 COUNT = 8;
+		bool done[COUNT];
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			done[i] = false;
+			LLImageDecodeThread::handle_t decodeHandle = mThread->decodeImage(NULL, LLQueuedThread::PRIORITY_NORMAL + i, 0, FALSE, new responder_test(&done[i]));
+			ensure("LLImageDecodeThread: pooled decodeImage(), returned handle is null", decodeHandle != 0);
+		}
+		mThread->update(1);
+		// Wait till the workers have handled every work order, 10 seconds max
+		const U32 INCREMENT_TIME = 500;				// 500 milliseconds
+		const U32 MAX_TIME = 20 * INCREMENT_TIME;
+		U32 total_time = 0;
+		S32 done_count = 0;
+		while (total_time < MAX_TIME)
+		{
+			done_count = 0;
+			for (S32 i = 0; i < COUNT; ++i)
+			{
+				done_count += done[i] ? 1 : 0;
+			}
+			if (done_count == COUNT)
+			{
+				break;
+			}
+			ms_sleep(INCREMENT_TIME);
+			total_time += INCREMENT_TIME;
+		}
+		ensure_equals("LLImageDecodeThread: pooled work units not processed", done_count, COUNT);
+	}
+
 	// ---------------------------------------------------------------------------------------
 	// Test the LLImageDecodeThread::ImageRequest interface
 	// ---------------------------------------------------------------------------------------
@@ -2377,7 +2377,25 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 		LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD, will probably fetch from sim again." << LL_ENDL;
 		return false;
 	}
-	
+
+	return unpackVolumeFaces(mdl);
+}
+
+bool LLVolume::unpackVolumeFaces(const U8* in, S32 size)
+{
+	//decompress straight from the caller's buffer
+	LLSD mdl;
+	if (!unzip_llsd(mdl, in, size))
+	{
+		LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD, will probably fetch from sim again." << LL_ENDL;
+		return false;
+	}
+
+	return unpackVolumeFaces(mdl);
+}
+
+bool LLVolume::unpackVolumeFaces(LLSD& mdl)
+{
 	{
 		U32 face_count = mdl.size();
 
@@ -2690,6 +2708,210 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 }
 
 
+namespace
+{
+	// Block written by LLVolume::packDecodedFaces(): a DecodedFacesHeader,
+	// then for each face a DecodedFaceHeader followed by its vertex buffer
+	// (positions, normals, texture coordinates), its weights if it has any,
+	// and its indices. Every section is padded to 16 bytes.
+	struct DecodedFacesHeader
+	{
+		U32 mFaceCount;
+		U32 mPad[3];
+	};
+
+	struct DecodedFaceHeader
+	{
+		S32 mNumVertices;
+		S32 mNumIndices;
+		U32 mFlags;
+		U32 mPad;
+		F32 mExtents[8];
+		F32 mTexCoordExtents[4];
+	};
+
+	const U32 DECODED_FACE_HAS_WEIGHTS = 0x1;
+
+	U32 decoded_vertex_size(S32 num_verts)
+	{
+		return num_verts * sizeof(LLVector4a) * 2 + ((num_verts * sizeof(LLVector2) + 0xF) & ~0xF);
+	}
+
+	U32 decoded_index_size(S32 num_indices)
+	{
+		return (num_indices * sizeof(U16) + 0xF) & ~0xF;
+	}
+
+	U32 decoded_face_size(const LLVolumeFace& face)
+	{
+		U32 size = sizeof(DecodedFaceHeader) + decoded_vertex_size(face.mNumVertices) + decoded_index_size(face.mNumIndices);
+		if (face.mWeights && face.mNumVertices)
+		{
+			size += face.mNumVertices * sizeof(LLVector4a);
+		}
+		return size;
+	}
+}
+
+U32 LLVolume::getDecodedFacesSize() const
+{
+	U32 size = sizeof(DecodedFacesHeader);
+	for (size_t i = 0; i < mVolumeFaces.size(); ++i)
+	{
+		size += decoded_face_size(mVolumeFaces[i]);
+	}
+	return size;
+}
+
+bool LLVolume::packDecodedFaces(U8* out, U32 size) const
+{
+	if (mVolumeFaces.empty() || size < getDecodedFacesSize())
+	{
+		return false;
+	}
+
+	DecodedFacesHeader header;
+	memset(&header, 0, sizeof(header));
+	header.mFaceCount = mVolumeFaces.size();
+	memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+
+	for (size_t i = 0; i < mVolumeFaces.size(); ++i)
+	{
+		const LLVolumeFace& face = mVolumeFaces[i];
+		bool has_weights = face.mWeights && face.mNumVertices;
+
+		DecodedFaceHeader face_header;
+		memset(&face_header, 0, sizeof(face_header));
+		face_header.mNumVertices = face.mNumVertices;
+		face_header.mNumIndices = face.mNumIndices;
+		face_header.mFlags = has_weights ? DECODED_FACE_HAS_WEIGHTS : 0;
+		memcpy(face_header.mExtents, face.mExtents[0].getF32ptr(), 4 * sizeof(F32));
+		memcpy(face_header.mExtents + 4, face.mExtents[1].getF32ptr(), 4 * sizeof(F32));
+		memcpy(face_header.mTexCoordExtents, face.mTexCoordExtents[0].mV, 2 * sizeof(F32));
+		memcpy(face_header.mTexCoordExtents + 2, face.mTexCoordExtents[1].mV, 2 * sizeof(F32));
+		memcpy(out, &face_header, sizeof(face_header));
+		out += sizeof(face_header);
+
+		// positions, normals and texture coordinates share one allocation
+		U32 vertex_size = decoded_vertex_size(face.mNumVertices);
+		if (vertex_size)
+		{
+			memcpy(out, face.mPositions, vertex_size);
+			out += vertex_size;
+		}
+
+		if (has_weights)
+		{
+			memcpy(out, face.mWeights, face.mNumVertices * sizeof(LLVector4a));
+			out += face.mNumVertices * sizeof(LLVector4a);
+		}
+
+		U32 index_size = decoded_index_size(face.mNumIndices);
+		if (index_size)
+		{
+			memset(out, 0, index_size);
+			memcpy(out, face.mIndices, face.mNumIndices * sizeof(U16));
+			out += index_size;
+		}
+	}
+
+	return true;
+}
+
+bool LLVolume::unpackDecodedFaces(const U8* data, U32 size)
+{
+	const U8* end = data + size;
+
+	DecodedFacesHeader header;
+	if (size < sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+	data += sizeof(header);
+
+	if (header.mFaceCount == 0 || header.mFaceCount > LL_SCULPT_MESH_MAX_FACES)
+	{
+		return false;
+	}
+
+	face_list_t faces(header.mFaceCount);
+
+	for (U32 i = 0; i < header.mFaceCount; ++i)
+	{
+		DecodedFaceHeader face_header;
+		if ((size_t)(end - data) < sizeof(face_header))
+		{
+			return false;
+		}
+		memcpy(&face_header, data, sizeof(face_header));
+		data += sizeof(face_header);
+
+		S32 num_verts = face_header.mNumVertices;
+		S32 num_indices = face_header.mNumIndices;
+		bool has_weights = (face_header.mFlags & DECODED_FACE_HAS_WEIGHTS) != 0;
+		if (num_verts < 0 || num_verts > 65536 || num_indices < 0 || num_indices > 3 * 65536)
+		{
+			return false;
+		}
+
+		U32 vertex_size = decoded_vertex_size(num_verts);
+		U32 weight_size = has_weights ? num_verts * sizeof(LLVector4a) : 0;
+		U32 index_size = decoded_index_size(num_indices);
+		if ((size_t)(end - data) < (size_t)vertex_size + weight_size + index_size)
+		{
+			return false;
+		}
+
+		LLVolumeFace& face = faces[i];
+		face.resizeVertices(num_verts);
+		if (vertex_size)
+		{
+			memcpy((F32*) face.mPositions, data, vertex_size);
+			data += vertex_size;
+		}
+
+		if (has_weights)
+		{
+			face.allocateWeights(num_verts);
+			memcpy((F32*) face.mWeights, data, weight_size);
+			data += weight_size;
+		}
+
+		face.resizeIndices(num_indices);
+		if (index_size)
+		{
+			memcpy(face.mIndices, data, num_indices * sizeof(U16));
+			data += index_size;
+
+			// unpackVolumeFaces() leaves faces with an empty index list
+			// without vertices, keep those as they are
+			for (S32 j = 0; j < num_indices && num_verts > 0; ++j)
+			{
+				if (face.mIndices[j] >= num_verts)
+				{
+					return false;
+				}
+			}
+		}
+
+		face.mExtents[0].loadua(face_header.mExtents);
+		face.mExtents[1].loadua(face_header.mExtents + 4);
+		face.mTexCoordExtents[0].set(face_header.mTexCoordExtents[0], face_header.mTexCoordExtents[1]);
+		face.mTexCoordExtents[1].set(face_header.mTexCoordExtents[2], face_header.mTexCoordExtents[3]);
+
+		// packed after cacheOptimize()
+		face.mOptimized = TRUE;
+	}
+
+	mVolumeFaces.swap(faces);
+	mSculptLevel = 0;
+
+	return true;
+}
+
+
 BOOL LLVolume::isMeshAssetLoaded()
 {
 	return mIsMeshAssetLoaded;
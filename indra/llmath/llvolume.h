@@ -40,6 +40,7 @@ template <class T> class LLOctreeNode;
 class LLVolumeFace;
 class LLVolume;
 class LLVolumeTriangle;
+class LLSD;
 
 #include "lluuid.h"
 #include "v4color.h"
@@ -1075,6 +1076,18 @@ protected:
 	void createVolumeFaces();
 public:
 	virtual bool unpackVolumeFaces(std::istream& is, S32 size);
+	// Same, reading the compressed block from memory without copying it
+	bool unpackVolumeFaces(const U8* in, S32 size);
+protected:
+	bool unpackVolumeFaces(LLSD& mdl);
+public:
+
+	// Flat copy of the decoded faces, laid out the way LLVolumeFace keeps
+	// them in memory, so the result of unpackVolumeFaces() can be cached and
+	// restored without decompressing or parsing the mesh asset again.
+	U32 getDecodedFacesSize() const;
+	bool packDecodedFaces(U8* out, U32 size) const;
+	bool unpackDecodedFaces(const U8* data, U32 size);
 
 	virtual void setMeshAssetLoaded(BOOL loaded);
 	virtual BOOL isMeshAssetLoaded();
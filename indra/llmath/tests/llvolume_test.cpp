@@ -0,0 +1,134 @@
+/**
+ * @file llvolume_test.cpp
+ * @brief LLVolume decoded face cache test cases.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llvolume.h"
+
+#include <vector>
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct volume_data
+	{
+		// A plain box, generated the way the viewer builds prims
+		LLVolume* createBox()
+		{
+			LLVolumeParams params;
+			params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+			params.setBeginAndEndS(0.f, 1.f);
+			params.setBeginAndEndT(0.f, 1.f);
+			params.setRatio(1.f, 1.f);
+			params.setShear(0.f, 0.f);
+			return new LLVolume(params, 1.f);
+		}
+
+		// Bitwise, the unused w components need not hold numbers
+		void ensureVectorsEqual(const std::string& msg, const LLVector4a& a, const LLVector4a& b)
+		{
+			ensure(msg, memcmp(&a, &b, sizeof(LLVector4a)) == 0);
+		}
+
+		void ensureFacesEqual(const LLVolumeFace& a, const LLVolumeFace& b)
+		{
+			ensure_equals("vertex count", a.mNumVertices, b.mNumVertices);
+			ensure_equals("index count", a.mNumIndices, b.mNumIndices);
+			for (S32 i = 0; i < a.mNumVertices; ++i)
+			{
+				ensureVectorsEqual("position", a.mPositions[i], b.mPositions[i]);
+				ensureVectorsEqual("normal", a.mNormals[i], b.mNormals[i]);
+				ensure("texture coordinate", a.mTexCoords[i] == b.mTexCoords[i]);
+			}
+			for (S32 i = 0; i < a.mNumIndices; ++i)
+			{
+				ensure_equals("index", a.mIndices[i], b.mIndices[i]);
+			}
+
+			ensure_equals("weights", a.mWeights != nullptr, b.mWeights != nullptr);
+			for (S32 i = 0; a.mWeights && i < a.mNumVertices; ++i)
+			{
+				ensureVectorsEqual("weight", a.mWeights[i], b.mWeights[i]);
+			}
+
+			ensureVectorsEqual("minimum extent", a.mExtents[0], b.mExtents[0]);
+			ensureVectorsEqual("maximum extent", a.mExtents[1], b.mExtents[1]);
+			ensure("minimum texture coordinate extent", a.mTexCoordExtents[0] == b.mTexCoordExtents[0]);
+			ensure("maximum texture coordinate extent", a.mTexCoordExtents[1] == b.mTexCoordExtents[1]);
+		}
+	};
+	typedef test_group<volume_data> volume_test;
+	typedef volume_test::object volume_object;
+	tut::volume_test volume_testcase("LLVolume");
+
+	template<> template<>
+	void volume_object::test<1>()
+	{
+		set_test_name("decoded faces round trip");
+
+		LLPointer<LLVolume> source = createBox();
+		ensure("box has faces", source->getNumVolumeFaces() > 0);
+
+		// Exercise the weights section on one face
+		LLVolumeFace& weighted = source->getVolumeFace(0);
+		weighted.allocateWeights(weighted.mNumVertices);
+		for (S32 i = 0; i < weighted.mNumVertices; ++i)
+		{
+			weighted.mWeights[i].set(1.f + i, 0.25f, 0.5f, 0.75f);
+		}
+
+		std::vector<U8> buffer(source->getDecodedFacesSize());
+		ensure("packed", source->packDecodedFaces(&buffer[0], buffer.size()));
+
+		LLPointer<LLVolume> restored = createBox();
+		ensure("unpacked", restored->unpackDecodedFaces(&buffer[0], buffer.size()));
+
+		ensure_equals("face count", restored->getNumVolumeFaces(), source->getNumVolumeFaces());
+		for (S32 i = 0; i < source->getNumVolumeFaces(); ++i)
+		{
+			ensureFacesEqual(source->getVolumeFace(i), restored->getVolumeFace(i));
+		}
+	}
+
+	template<> template<>
+	void volume_object::test<2>()
+	{
+		set_test_name("truncated decoded faces rejected");
+
+		LLPointer<LLVolume> source = createBox();
+		std::vector<U8> buffer(source->getDecodedFacesSize());
+		ensure("packed", source->packDecodedFaces(&buffer[0], buffer.size()));
+		ensure("short buffer not packed", !source->packDecodedFaces(&buffer[0], buffer.size() - 1));
+
+		LLPointer<LLVolume> restored = createBox();
+		const S32 face_count = restored->getNumVolumeFaces();
+		const S32 vertex_count = restored->getVolumeFace(0).mNumVertices;
+		ensure("truncated", !restored->unpackDecodedFaces(&buffer[0], buffer.size() - 1));
+		ensure_equals("faces kept", restored->getNumVolumeFaces(), face_count);
+		ensure_equals("vertices kept", restored->getVolumeFace(0).mNumVertices, vertex_count);
+	}
+}
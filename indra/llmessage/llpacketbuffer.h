@@ -42,6 +42,7 @@ public:
 	const char	*getData() const				{ return mData; }
 	LLHost		getHost() const					{ return mHost; }
 	LLHost		getReceivingInterface() const	{ return mReceivingIF; }
+	void		setReceivingInterface(const LLHost &receiving_if)	{ mReceivingIF = receiving_if; }
 	void init(S32 hSocket);
 
 protected:
@@ -0,0 +1,246 @@
+/**
+ * @file llpacketreceiver.cpp
+ * @brief Thread that reads the message system's UDP socket
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llpacketreceiver.h"
+
+#if LL_WINDOWS
+	#include "llwin32headerslean.h"
+#else
+	#include <sys/select.h>
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <errno.h>
+#endif
+
+#include "lltimer.h"
+
+// How long the thread waits on an idle socket before checking
+// whether it should quit.
+static const S32 IDLE_WAIT_USECS = 100000;
+
+LLPacketReceiver::LLPacketReceiver(S32 socket) :
+	LLThread("PacketReceiver"),
+	mSocket(socket),
+	mPool(POOL_SIZE),
+	mReceived(POOL_SIZE),
+	mFree(POOL_SIZE)
+{
+	// Both rings hold the whole pool so a push never fails
+	for (Packet &packet : mPool)
+	{
+		mFree.tryPush(&packet);
+	}
+}
+
+LLPacketReceiver::~LLPacketReceiver()
+{
+	// The thread reads into mPool, stop it before that goes away
+	shutdown();
+}
+
+S32 LLPacketReceiver::receivePacket(char *datap, S32 max_size, LLHost &sender, LLHost &receiving_if)
+{
+	Packet *packetp = nullptr;
+	if (!mReceived.tryPop(packetp))
+	{
+		return 0;
+	}
+
+	const S32 size = llmin(packetp->mSize, max_size);
+	memcpy(datap, packetp->mData, size);	/* Flawfinder: ignore */
+	sender = packetp->mHost;
+	receiving_if = packetp->mReceivingIF;
+
+	mFree.tryPush(packetp);
+	return size;
+}
+
+void LLPacketReceiver::run()
+{
+	// Empty buffers taken from mFree and not yet filled
+	Packet *batch[BATCH_SIZE];
+	S32 batch_count = 0;
+
+	while (!isQuitting())
+	{
+		while (batch_count < BATCH_SIZE && mFree.tryPop(batch[batch_count]))
+		{
+			++batch_count;
+		}
+		if (!batch_count)
+		{
+			// Main thread has every buffer, leave packets in the
+			// socket until it catches up.
+			ms_sleep(1);
+			continue;
+		}
+
+		if (!waitForData())
+		{
+			continue;
+		}
+
+		const S32 received = receiveBatch(batch, batch_count);
+		for (S32 i = 0; i < received; ++i)
+		{
+			mReceived.tryPush(batch[i]);
+		}
+
+		// Keep the unused buffers for the next read
+		for (S32 i = received; i < batch_count; ++i)
+		{
+			batch[i - received] = batch[i];
+		}
+		batch_count -= received;
+	}
+}
+
+bool LLPacketReceiver::waitForData()
+{
+	fd_set readers;
+	FD_ZERO(&readers);
+	FD_SET(mSocket, &readers);
+
+	timeval timeout;
+	timeout.tv_sec = 0;
+	timeout.tv_usec = IDLE_WAIT_USECS;
+
+	return select(mSocket + 1, &readers, nullptr, nullptr, &timeout) > 0;
+}
+
+#if LL_LINUX
+
+S32 LLPacketReceiver::receiveBatch(Packet **packets, S32 count)
+{
+	mmsghdr headers[BATCH_SIZE];
+	iovec iovs[BATCH_SIZE];
+	sockaddr_in senders[BATCH_SIZE];
+	char controls[BATCH_SIZE][CMSG_SPACE(sizeof(in_pktinfo))];
+
+	memset(headers, 0, sizeof(headers));
+	for (S32 i = 0; i < count; ++i)
+	{
+		iovs[i].iov_base = packets[i]->mData;
+		iovs[i].iov_len = sizeof(packets[i]->mData);
+
+		msghdr &msg = headers[i].msg_hdr;
+		msg.msg_name = &senders[i];
+		msg.msg_namelen = sizeof(senders[i]);
+		msg.msg_iov = &iovs[i];
+		msg.msg_iovlen = 1;
+		msg.msg_control = controls[i];
+		msg.msg_controllen = sizeof(controls[i]);
+	}
+
+	const int received = recvmmsg(mSocket, headers, count, MSG_DONTWAIT, nullptr);
+	if (received <= 0)
+	{
+		return 0;
+	}
+
+	S32 kept = 0;
+	for (S32 i = 0; i < received; ++i)
+	{
+		const sockaddr_in &sender = senders[i];
+		if (headers[i].msg_hdr.msg_flags & MSG_TRUNC)
+		{
+			// Larger than any valid message, the rest of it is gone
+			LL_WARNS() << "Dropping truncated datagram from "
+					   << LLHost(sender.sin_addr.s_addr, ntohs(sender.sin_port)) << LL_ENDL;
+			continue;
+		}
+
+		// Keep the packets handed out at the front, the dropped
+		// buffers go back to the caller unused
+		std::swap(packets[kept], packets[i]);
+		Packet *packetp = packets[kept++];
+		packetp->mSize = headers[i].msg_len;
+		packetp->mHost = LLHost(sender.sin_addr.s_addr, ntohs(sender.sin_port));
+
+		// Same as recvfrom_destip() in net.cpp
+		U32 dst_ip = INVALID_HOST_IP_ADDRESS;
+		msghdr *msgp = &headers[i].msg_hdr;
+		for (cmsghdr *cmsgptr = CMSG_FIRSTHDR(msgp); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(msgp, cmsgptr))
+		{
+			if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+			{
+				dst_ip = ((in_pktinfo *)CMSG_DATA(cmsgptr))->ipi_spec_dst.s_addr;
+			}
+		}
+		packetp->mReceivingIF = LLHost(dst_ip, INVALID_PORT);
+	}
+	return kept;
+}
+
+#else // ! LL_LINUX
+
+// No batched receive here, still off the main thread
+S32 LLPacketReceiver::receiveBatch(Packet **packets, S32 count)
+{
+	S32 received = 0;
+	while (received < count)
+	{
+		Packet *packetp = packets[received];
+		sockaddr_in sender;
+#if LL_WINDOWS
+		int addr_size = sizeof(sender);
+#else
+		socklen_t addr_size = sizeof(sender);
+#endif
+		const int size = recvfrom(mSocket, packetp->mData, sizeof(packetp->mData), 0,
+								  (sockaddr *)&sender, &addr_size);
+		if (size < 0)
+		{
+			// Same as receive_packet() in net.cpp: running out of data
+			// and ICMP port unreachable replies to our sends are normal
+#if LL_WINDOWS
+			const int error = WSAGetLastError();
+			if (error != WSAEWOULDBLOCK && error != WSAECONNRESET)
+#else
+			const int error = errno;
+			if (error != EAGAIN && error != EWOULDBLOCK && error != ECONNREFUSED)
+#endif
+			{
+				LL_INFOS() << "receivePacket() failed, Error: " << error << LL_ENDL;
+			}
+			break;
+		}
+		if (size == 0)
+		{
+			break;
+		}
+
+		packetp->mSize = size;
+		packetp->mHost = LLHost(sender.sin_addr.s_addr, ntohs(sender.sin_port));
+		packetp->mReceivingIF = LLHost(INVALID_HOST_IP_ADDRESS, INVALID_PORT);
+		++received;
+	}
+	return received;
+}
+
+#endif // LL_LINUX
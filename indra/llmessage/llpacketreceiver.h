@@ -0,0 +1,90 @@
+/**
+ * @file llpacketreceiver.h
+ * @brief Thread that reads the message system's UDP socket
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPACKETRECEIVER_H
+#define LL_LLPACKETRECEIVER_H
+
+#include <vector>
+
+#include "llhost.h"
+#include "lllockfreequeue.h"
+#include "llproxy.h"		// for SOCKS_HEADER_SIZE
+#include "llthread.h"
+#include "net.h"			// for NET_BUFFER_SIZE
+
+// Drains a UDP socket on its own thread so the main thread only has
+// to pick up packets that are already in memory.
+//
+// Packets are read into a pool of buffers allocated up front, in
+// batches of up to BATCH_SIZE per system call where recvmmsg() is
+// available.  Filled buffers go to the main thread through one
+// lock-free ring and come back empty through another.  When the main
+// thread falls behind and the pool runs dry the thread stops reading
+// and lets the socket's own buffer absorb the backlog, as before.
+class LLPacketReceiver : public LLThread
+{
+public:
+	enum
+	{
+		BATCH_SIZE = 32,	// datagrams per read
+		POOL_SIZE = 256		// buffers waiting for or held by the main thread
+	};
+
+	LLPacketReceiver(S32 socket);
+	~LLPacketReceiver();
+
+	// Main thread only.  Copies the oldest packet into datap, which
+	// must hold max_size bytes, and returns its size, 0 if none are
+	// waiting.
+	S32 receivePacket(char *datap, S32 max_size, LLHost &sender, LLHost &receiving_if);
+
+private:
+	struct Packet
+	{
+		char	mData[NET_BUFFER_SIZE + SOCKS_HEADER_SIZE];	/* Flawfinder : ignore */
+		S32		mSize;
+		LLHost	mHost;
+		LLHost	mReceivingIF;
+	};
+
+	/*virtual*/ void run() override;
+
+	// True once the socket has something to read, false after a
+	// short timeout so the thread notices when it is told to quit.
+	bool waitForData();
+
+	// Fills as many of the given buffers as the socket has packets
+	// for without blocking and returns the number filled. Those are
+	// moved to the front, truncated datagrams are dropped.
+	S32 receiveBatch(Packet **packets, S32 count);
+
+	S32						mSocket;
+	std::vector<Packet>		mPool;
+	LLSPSCQueue<Packet *>	mReceived;	// receive thread -> main thread
+	LLSPSCQueue<Packet *>	mFree;		// main thread -> receive thread
+};
+
+#endif
@@ -46,6 +46,7 @@
 #include "u64.h"
 
 #include "llmessagelog.h"
+#include "llpacketreceiver.h"
 
 ///////////////////////////////////////////////////////////
 LLPacketRing::LLPacketRing () :
@@ -59,7 +60,8 @@ LLPacketRing::LLPacketRing () :
 	mInBufferLength(0),
 	mOutBufferLength(0),
 	mDropPercentage(0.0f),
-	mPacketsToDrop(0x0)
+	mPacketsToDrop(0x0),
+	mReceiver(nullptr)
 {
 }
 
@@ -72,6 +74,8 @@ LLPacketRing::~LLPacketRing ()
 ///////////////////////////////////////////////////////////
 void LLPacketRing::cleanup ()
 {
+	stopReceiveThread();
+
 	LLPacketBuffer *packetp;
 
 	while (!mReceiveQueue.empty())
@@ -120,6 +124,41 @@ void LLPacketRing::setOutBandwidth(const F32 bps)
 {
 	mOutThrottle.setRate(bps);
 }
+
+void LLPacketRing::startReceiveThread(S32 socket)
+{
+	if (!mReceiver)
+	{
+		mReceiver = new LLPacketReceiver(socket);
+		mReceiver->start();
+	}
+}
+
+void LLPacketRing::stopReceiveThread()
+{
+	// Waits for the thread to exit
+	delete mReceiver;
+	mReceiver = nullptr;
+}
+
+///////////////////////////////////////////////////////////
+// Next packet from the receive thread if there is one, or straight
+// from the socket.  Sets mLastSender and mLastReceivingIF.
+S32 LLPacketRing::receiveFromNet(S32 socket, char *datap, S32 max_size)
+{
+	if (mReceiver)
+	{
+		return mReceiver->receivePacket(datap, max_size, mLastSender, mLastReceivingIF);
+	}
+
+	// receive_packet() reads at most NET_BUFFER_SIZE
+	llassert(max_size >= NET_BUFFER_SIZE);
+	S32 packet_size = receive_packet(socket, datap);
+	mLastSender = ::get_sender();
+	mLastReceivingIF = ::get_receiving_interface();
+	return packet_size;
+}
+
 ///////////////////////////////////////////////////////////
 S32 LLPacketRing::receiveFromRing (S32 socket, char *datap)
 {
@@ -171,7 +210,17 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 		while (!done)
 		{
 			LLPacketBuffer *packetp;
-			packetp = new LLPacketBuffer(socket);
+			if (mReceiver)
+			{
+				char buffer[NET_BUFFER_SIZE];	/* Flawfinder: ignore */
+				S32 size = receiveFromNet(socket, buffer, NET_BUFFER_SIZE);
+				packetp = new LLPacketBuffer(mLastSender, buffer, size);
+				packetp->setReceivingInterface(mLastReceivingIF);
+			}
+			else
+			{
+				packetp = new LLPacketBuffer(socket);
+			}
 
 			if (packetp->getSize())
 			{
@@ -231,7 +280,7 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 		if (LLProxy::isSOCKSProxyEnabled())
 		{
 			U8 buffer[NET_BUFFER_SIZE + SOCKS_HEADER_SIZE];
-			packet_size = receive_packet(socket, static_cast<char*>(static_cast<void*>(buffer)));
+			packet_size = receiveFromNet(socket, static_cast<char*>(static_cast<void*>(buffer)), sizeof(buffer));
 			
 			if (packet_size > SOCKS_HEADER_SIZE)
 			{
@@ -250,12 +299,9 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 		}
 		else
 		{
-			packet_size = receive_packet(socket, datap);
-			mLastSender = ::get_sender();
+			packet_size = receiveFromNet(socket, datap, NET_BUFFER_SIZE);
 		}
 
-		mLastReceivingIF = ::get_receiving_interface();
-
 		if (packet_size)  // did we actually get a packet?
 		{
 			if (mDropPercentage && (ll_frand(100.f) < mDropPercentage))
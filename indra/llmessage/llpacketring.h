@@ -36,6 +36,8 @@
 #include "llthrottle.h"
 #include "net.h"
 
+class LLPacketReceiver;
+
 class LLPacketRing
 {
 public:
@@ -55,6 +57,13 @@ public:
 
 	BOOL sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host);
 
+	// Read the socket on a thread of its own from now on, see
+	// LLPacketReceiver.  Stopped again by stopReceiveThread() or
+	// cleanup().
+	void startReceiveThread(S32 socket);
+	void stopReceiveThread();
+	bool isReceiveThreadRunning() const			{ return mReceiver != nullptr; }
+
 	inline LLHost getLastSender();
 	inline LLHost getLastReceivingInterface();
 
@@ -83,7 +92,10 @@ protected:
 	LLHost mLastSender;
 	LLHost mLastReceivingIF;
 
+	LLPacketReceiver *mReceiver;
+
 private:
+	S32 receiveFromNet(S32 socket, char *datap, S32 max_size);
 	BOOL sendPacketImpl(int h_socket, const char * send_buffer, S32 buf_size, LLHost host);
 };
 
@@ -325,6 +325,8 @@ LLMessageSystem::~LLMessageSystem()
 	
 	if (!mbError)
 	{
+		// The receive thread reads mSocket, stop it first
+		mPacketRing.stopReceiveThread();
 		end_net(mSocket);
 	}
 	mSocket = 0;
@@ -2800,6 +2802,19 @@ U32 LLMessageSystem::getListenPort( void ) const
 	return mPort;
 }
 
+void LLMessageSystem::startReceiveThread()
+{
+	if (!mbError)
+	{
+		mPacketRing.startReceiveThread(mSocket);
+	}
+}
+
+void LLMessageSystem::stopReceiveThread()
+{
+	mPacketRing.stopReceiveThread();
+}
+
 // TODO: babbage: remove this horror!
 S32 LLMessageSystem::zeroCodeAdjustCurrentSendTotal()
 {
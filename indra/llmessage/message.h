@@ -662,6 +662,11 @@ public:
 
 	U32		getListenPort( void ) const;
 
+	// Read the socket on a thread of its own, checkMessages() then
+	// only picks up packets that have already arrived.
+	void	startReceiveThread();
+	void	stopReceiveThread();
+
 	void startLogging();					// start verbose  logging
 	void stopLogging();						// flush and close file
 	void summarizeLogs(std::ostream& str);	// log statistics
@@ -0,0 +1,147 @@
+/**
+ * @file llpacketreceiver_test.cpp
+ * @brief LLPacketReceiver test cases.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpacketreceiver.h"
+
+#include "lltimer.h"
+#include "../net.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct packetreceiver_data
+	{
+		packetreceiver_data() :
+			mSocket(0),
+			mPort(NET_USE_OS_ASSIGNED_PORT),
+			mStarted(0 == start_net(mSocket, mPort)),
+			mLoopback(ip_string_to_u32("127.0.0.1"))
+		{
+		}
+
+		~packetreceiver_data()
+		{
+			if (mStarted)
+			{
+				end_net(mSocket);
+			}
+		}
+
+		// Packet i is i + 1 bytes of the value i
+		void sendPackets(S32 count)
+		{
+			char buffer[NET_BUFFER_SIZE];
+			for (S32 i = 0; i < count; ++i)
+			{
+				memset(buffer, i, i + 1);
+				send_packet(mSocket, buffer, i + 1, mLoopback, mPort);
+			}
+		}
+
+		// Wait up to a few seconds for each packet
+		S32 receivePackets(LLPacketReceiver &receiver, S32 count)
+		{
+			char buffer[NET_BUFFER_SIZE];
+			LLHost sender, receiving_if;
+			LLTimer timer;
+			S32 received = 0;
+			while (received < count && timer.getElapsedTimeF32() < 5.f)
+			{
+				S32 size = receiver.receivePacket(buffer, sizeof(buffer), sender, receiving_if);
+				if (!size)
+				{
+					ms_sleep(1);
+					continue;
+				}
+
+				ensure_equals("packets arrive in order", size, received + 1);
+				ensure_equals("contents", (S32)(U8)buffer[size - 1], received);
+				ensure_equals("sender address", sender.getAddress(), mLoopback);
+				ensure_equals("sender port", (S32)sender.getPort(), mPort);
+				++received;
+			}
+			return received;
+		}
+
+		S32 mSocket;
+		S32 mPort;
+		bool mStarted;
+		U32 mLoopback;
+	};
+	typedef test_group<packetreceiver_data> packetreceiver_test;
+	typedef packetreceiver_test::object packetreceiver_object;
+	tut::packetreceiver_test packetreceiver_testcase("LLPacketReceiver");
+
+	template<> template<>
+	void packetreceiver_object::test<1>()
+	{
+		set_test_name("nothing to receive");
+		ensure("socket opened", mStarted);
+
+		LLPacketReceiver receiver(mSocket);
+		receiver.start();
+
+		char buffer[NET_BUFFER_SIZE];
+		LLHost sender, receiving_if;
+		ensure_equals("no packet", receiver.receivePacket(buffer, sizeof(buffer), sender, receiving_if), 0);
+	}
+
+	template<> template<>
+	void packetreceiver_object::test<2>()
+	{
+		set_test_name("packets handed over in order");
+		ensure("socket opened", mStarted);
+
+		LLPacketReceiver receiver(mSocket);
+		receiver.start();
+
+		sendPackets(LLPacketReceiver::BATCH_SIZE * 3);
+		ensure_equals("all received", receivePackets(receiver, LLPacketReceiver::BATCH_SIZE * 3),
+					  (S32)LLPacketReceiver::BATCH_SIZE * 3);
+	}
+
+	template<> template<>
+	void packetreceiver_object::test<3>()
+	{
+		set_test_name("buffers reused");
+		ensure("socket opened", mStarted);
+
+		LLPacketReceiver receiver(mSocket);
+		receiver.start();
+
+		// More than the pool holds, a few at a time so the socket
+		// buffer never overflows
+		const S32 rounds = 2 * LLPacketReceiver::POOL_SIZE / 64;
+		for (S32 i = 0; i < rounds; ++i)
+		{
+			sendPackets(64);
+			ensure_equals("round received", receivePackets(receiver, 64), 64);
+		}
+	}
+}
@@ -32,6 +32,7 @@
 #include "llmemory.h"
 #include "llconvexdecomposition.h"
 #include "llsdserialize.h"
+#include "llsdzipbatch.h"
 #include "llvector4a.h"
 
 #ifdef LL_USESYSTEMLIBS
@@ -927,11 +928,24 @@ LLSD LLModel::writeModelToStream(std::ostream& ostr, LLSD& mdl, BOOL nowrite, BO
 		header["material_list"] = mdl["material_list"];
 	}
 
+	// The blocks are independent, compress them all in parallel
+	LLPointer<LLSDZipBatch> zipped = new LLSDZipBatch;
+	const U32 NOT_ZIPPED = U32_MAX;
+	U32 skin_job = mdl.has("skin") ? zipped->addZip(mdl["skin"]) : NOT_ZIPPED;
+	U32 decomposition_job = mdl.has("physics_convex") ? zipped->addZip(mdl["physics_convex"]) : NOT_ZIPPED;
+	U32 model_jobs[MODEL_NAMES_LENGTH];
+	for (S32 i = 0; i < MODEL_NAMES_LENGTH; i++)
+	{
+		model_jobs[i] = mdl.has(model_names[i]) ? zipped->addZip(mdl[model_names[i]]) : NOT_ZIPPED;
+	}
+	zipped->start();
+	zipped->wait();
+
 	std::string skin;
 
-	if (mdl.has("skin"))
+	if (skin_job != NOT_ZIPPED)
 	{ //write out skin block
-		skin = zip_llsd(mdl["skin"]);
+		skin = zipped->getZipped(skin_job);
 
 		U32 size = skin.size();
 		if (size > 0)
@@ -945,9 +959,9 @@ LLSD LLModel::writeModelToStream(std::ostream& ostr, LLSD& mdl, BOOL nowrite, BO
 
 	std::string decomposition;
 
-	if (mdl.has("physics_convex"))
+	if (decomposition_job != NOT_ZIPPED)
 	{ //write out convex decomposition
-		decomposition = zip_llsd(mdl["physics_convex"]);
+		decomposition = zipped->getZipped(decomposition_job);
 
 		U32 size = decomposition.size();
 		if (size > 0)
@@ -968,9 +982,9 @@ LLSD LLModel::writeModelToStream(std::ostream& ostr, LLSD& mdl, BOOL nowrite, BO
 
 	for (S32 i = 0; i < MODEL_NAMES_LENGTH; i++)
 	{
-		if (mdl.has(model_names[i]))
+		if (model_jobs[i] != NOT_ZIPPED)
 		{
-			out[i] = zip_llsd(mdl[model_names[i]]);
+			out[i] = zipped->getZipped(model_jobs[i]);
 
 			U32 size = out[i].size();
 
@@ -0,0 +1,1328 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file llextentvfs.cpp
+ * @brief Extent allocated VFS with a journaled index and a mapped data file
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llextentvfs.h"
+
+#include <algorithm>
+
+#include "lltimer.h"
+
+namespace
+{
+	const U32 FILE_BLOCK_MASK = 0x000003FF;		// sizes round up to 1KB, as in LLVFS
+	const U32 VFS_CLEANUP_SIZE = 5242880;		// how much space we free up in a single stroke
+	const S32 BLOCK_LENGTH_INVALID = -1;		// mLength for records that only hold locks
+	const U32 BAD_LOCATION = U32_MAX;
+	const U32 DEFAULT_DATA_SIZE = 0x40000000;	// 1GB, like LLVFS without a presize
+
+	const U32 JOURNAL_MAGIC = 0x4a565845;		// "EXVJ"
+	const U32 JOURNAL_VERSION = 1;
+	// Compact once the journal holds this many more records than twice the
+	// number of files
+	const U32 JOURNAL_SLACK = 1024;
+
+	enum EJournalOp
+	{
+		JOURNAL_PUT = 1,
+		JOURNAL_REMOVE = 2
+	};
+
+	struct JournalHeader
+	{
+		U32 mMagic;
+		U32 mVersion;
+		U32 mGeneration;
+		U32 mChecksum;
+	};
+
+	struct JournalRecord
+	{
+		U8 mFileID[UUID_BYTES];
+		S16 mFileType;
+		U16 mOp;
+		U32 mLocation;
+		S32 mLength;
+		S32 mSize;
+		U32 mAccessTime;
+		U32 mChecksum;
+	};
+
+	static_assert(sizeof(JournalHeader) == 16, "journal header layout changed");
+	static_assert(sizeof(JournalRecord) == 40, "journal record layout changed");
+
+	// FNV-1a, seeded with the generation so that records left over from an
+	// older journal in the same file never replay
+	U32 journal_checksum(const void* data, size_t size, U32 generation)
+	{
+		const U8* bytes = (const U8*)data;
+		U32 hash = 2166136261U ^ generation;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ bytes[i]) * 16777619U;
+		}
+		return hash;
+	}
+}
+
+LLExtentVFS::FileRecord::FileRecord()
+:	mLocation(0),
+	mLength(BLOCK_LENGTH_INVALID),
+	mSize(0),
+	mAccessTime(0)
+{
+	for (S32 i = 0; i < VFSLOCK_COUNT; i++)
+	{
+		mLocks[i] = 0;
+	}
+}
+
+LLExtentVFS::LLExtentVFS(const std::string& index_filename, const std::string& data_filename, const BOOL read_only, const U32 presize, const BOOL remove_after_crash)
+:	LLVFS(index_filename, data_filename, read_only, remove_after_crash),
+	mDataSize(0),
+	mSpareIndexFP(nullptr),
+	mGeneration(0),
+	mLastGeneration(0),
+	mJournalRecords(0)
+{
+	LL_INFOS("VFS") << "Attempting to open VFS index file " << mIndexFilename << LL_ENDL;
+	LL_INFOS("VFS") << "Attempting to open VFS data file " << mDataFilename << LL_ENDL;
+
+	// The journals are opened first: their file locks are what keeps another
+	// viewer from using the same data file.
+	const char *file_mode = mReadOnly ? "rb" : "r+b";
+	std::string spare_filename = mIndexFilename + getSpareIndexSuffix();
+	mIndexFP = openAndLock(mIndexFilename, file_mode, mReadOnly);
+	mSpareIndexFP = openAndLock(spare_filename, file_mode, mReadOnly);
+	if (!mReadOnly)
+	{
+		if (!mIndexFP)
+		{
+			mIndexFP = openAndLock(mIndexFilename, "w+b", FALSE);
+		}
+		if (!mSpareIndexFP)
+		{
+			mSpareIndexFP = openAndLock(spare_filename, "w+b", FALSE);
+		}
+	}
+	if (!mIndexFP || !mSpareIndexFP)
+	{
+		if (mReadOnly)
+		{
+			LL_WARNS("VFS") << "Can't find " << mIndexFilename << " to open read-only VFS" << LL_ENDL;
+			mValid = VFSVALID_BAD_CANNOT_OPEN_READONLY;
+		}
+		else
+		{
+			LL_WARNS("VFS") << "Couldn't open an index file for the VFS, probably a sharing violation!" << LL_ENDL;
+			mValid = VFSVALID_BAD_CANNOT_CREATE;
+		}
+		return;
+	}
+
+	if (!mData.open(mDataFilename, mReadOnly ? 0 : (presize ? presize : DEFAULT_DATA_SIZE), !mReadOnly))
+	{
+		if (mReadOnly)
+		{
+			LL_WARNS("VFS") << "Can't find " << mDataFilename << " to open read-only VFS" << LL_ENDL;
+			mValid = VFSVALID_BAD_CANNOT_OPEN_READONLY;
+		}
+		else
+		{
+			LL_WARNS("VFS") << "Couldn't open vfs data file " << mDataFilename << LL_ENDL;
+			mValid = VFSVALID_BAD_CANNOT_CREATE;
+		}
+		return;
+	}
+	mDataSize = (U32)llmin(mData.getSize(), (size_t)U32_MAX);
+
+	// Did we leave this file open for writing last time?
+	// If so, ignore the journal and start over.
+	bool start_over = false;
+	if (!mReadOnly && mRemoveAfterCrash)
+	{
+		llstat marker_info;
+		std::string marker = mDataFilename + ".open";
+		if (!LLFile::stat(marker, &marker_info))
+		{
+			LL_WARNS("VFS") << "VFS: File left open on last run, discarding the contents of " << mDataFilename << LL_ENDL;
+			start_over = true;
+		}
+	}
+
+	// The current journal is the valid one with the highest generation. Both
+	// generations are needed even when starting over, so that the new
+	// journal outranks the old ones.
+	U32 spare_generation = 0;
+	bool have_journal = readJournalHeader(mIndexFP, mGeneration);
+	bool have_spare = readJournalHeader(mSpareIndexFP, spare_generation);
+	if (have_spare && (!have_journal || spare_generation > mGeneration))
+	{
+		std::swap(mIndexFP, mSpareIndexFP);
+		std::swap(mGeneration, spare_generation);
+		have_journal = true;
+	}
+	mLastGeneration = llmax(mGeneration, spare_generation);
+
+	if (mReadOnly && !have_journal)
+	{
+		LL_WARNS("VFS") << "No VFS journal in " << mIndexFilename << " to open read-only VFS" << LL_ENDL;
+		mValid = VFSVALID_BAD_CANNOT_OPEN_READONLY;
+		return;
+	}
+
+	bool compact = true;
+	if (have_journal && !start_over)
+	{
+		mJournalRecords = replayJournal(mIndexFP, mGeneration, mFiles);
+		compact = mJournalRecords > 2 * (U32)mFiles.size() + JOURNAL_SLACK;
+	}
+	if (!buildFreeList())
+	{
+		compact = true;
+	}
+
+	if (compact && !mReadOnly && !compactJournal() && (!have_journal || start_over))
+	{
+		// nothing on disk describes this store
+		mValid = VFSVALID_BAD_CANNOT_CREATE;
+		return;
+	}
+
+	// Open marker file to look for bad shutdowns
+	if (!mReadOnly && mRemoveAfterCrash)
+	{
+		std::string marker = mDataFilename + ".open";
+		LLFILE* marker_fp = LLFile::fopen(marker, "w");	/* Flawfinder: ignore */
+		if (marker_fp)
+		{
+			fclose(marker_fp);
+			marker_fp = nullptr;
+		}
+	}
+
+	LL_INFOS("VFS") << "Using VFS index file " << mIndexFilename << " (generation " << mGeneration
+		<< ", " << mFiles.size() << " files)" << LL_ENDL;
+	LL_INFOS("VFS") << "Using VFS data file " << mDataFilename << LL_ENDL;
+
+	mValid = VFSVALID_OK;
+}
+
+LLExtentVFS::~LLExtentVFS()
+{
+	if (!mPinned.empty())
+	{
+		LL_ERRS("VFS") << "LLExtentVFS destroyed during a read or write" << LL_ENDL;
+	}
+
+	unlockAndClose(mSpareIndexFP);
+	mSpareIndexFP = nullptr;
+	mData.close();
+	// LLVFS closes mIndexFP and removes the crash marker
+}
+
+BOOL LLExtentVFS::getExists(const LLUUID &file_id, const LLAssetType::EType file_type)
+{
+	if (!isValid())
+	{
+		LL_ERRS() << "Attempting to use invalid VFS!" << LL_ENDL;
+	}
+
+	lockData();
+
+	BOOL res = FALSE;
+	file_map_t::iterator it = mFiles.find(LLVFSFileSpecifier(file_id, file_type));
+	if (it != mFiles.end())
+	{
+		it->second.mAccessTime = (U32)time(nullptr);
+		res = it->second.mLength > 0 ? TRUE : FALSE;
+	}
+
+	unlockData();
+
+	return res;
+}
+
+S32 LLExtentVFS::getSize(const LLUUID &file_id, const LLAssetType::EType file_type)
+{
+	if (!isValid())
+	{
+		LL_ERRS() << "Attempting to use invalid VFS!" << LL_ENDL;
+	}
+
+	lockData();
+
+	S32 size = 0;
+	file_map_t::iterator it = mFiles.find(LLVFSFileSpecifier(file_id, file_type));
+	if (it != mFiles.end())
+	{
+		it->second.mAccessTime = (U32)time(nullptr);
+		size = it->second.mSize;
+	}
+
+	unlockData();
+
+	return size;
+}
+
+BOOL LLExtentVFS::checkAvailable(S32 max_size)
+{
+	lockData();
+
+	const BOOL res = max_size <= 0 ||
+		mFreeByLength.lower_bound(std::make_pair((U32)max_size, 0U)) != mFreeByLength.end();
+
+	unlockData();
+
+	return res;
+}
+
+S32 LLExtentVFS::getMaxSize(const LLUUID &file_id, const LLAssetType::EType file_type)
+{
+	if (!isValid())
+	{
+		LL_ERRS() << "Attempting to use invalid VFS!" << LL_ENDL;
+	}
+
+	lockData();
+
+	S32 size = 0;
+	file_map_t::iterator it = mFiles.find(LLVFSFileSpecifier(file_id, file_type));
+	if (it != mFiles.end())
+	{
+		it->second.mAccessTime = (U32)time(nullptr);
+		size = it->second.mLength;
+	}
+
+	unlockData();
+
+	return size;
+}
+
+BOOL LLExtentVFS::setMaxSize(const LLUUID &file_id, const LLAssetType::EType file_type, S32 max_size)
+{
+	if (!isValid())
+	{
+		LL_ERRS() << "Attempting to use invalid VFS!" << LL_ENDL;
+	}
+	if (mReadOnly)
+	{
+		LL_ERRS() << "Attempt to write to read-only VFS" << LL_ENDL;
+	}
+	if (max_size <= 0)
+	{
+		LL_WARNS() << "VFS: Attempt to assign size " << max_size << " to vfile " << file_id << LL_ENDL;
+		return FALSE;
+	}
+
+	// round all sizes upward to KB increments, except textures, whose
+	// pipeline relies on the exact max size
+	if (file_type != LLAssetType::AT_TEXTURE && (max_size & FILE_BLOCK_MASK))
+	{
+		max_size += FILE_BLOCK_MASK;
+		max_size &= ~FILE_BLOCK_MASK;
+	}
+
+	lockData();
+
+	LLVFSFileSpecifier spec(file_id, file_type);
+	file_map_t::iterator it = mFiles.find(spec);
+	if (it == mFiles.end())
+	{
+		it = mFiles.insert(file_map_t::value_type(spec, FileRecord())).first;
+	}
+	FileRecord& record = it->second;
+	record.mAccessTime = (U32)time(nullptr);
+
+	if (record.mLength == max_size)
+	{
+		unlockData();
+		return TRUE;
+	}
+
+	if (record.mLength > max_size)
+	{
+		// this file is shrinking
+		freeExtent(record.mLocation + max_size, record.mLength - max_size);
+		record.mLength = max_size;
+		if (record.mLength < record.mSize)
+		{
+			LL_ERRS() << "Truncating virtual file " << file_id << " to " << record.mLength << " bytes" << LL_ENDL;
+			record.mSize = record.mLength;
+		}
+		appendJournal(spec, &record);
+		unlockData();
+		return TRUE;
+	}
+
+	if (record.mLength > 0)
+	{
+		// this file is growing: first try the free extent that follows it
+		U32 increase = max_size - record.mLength;
+		extent_location_map_t::iterator next = mFreeByLocation.find(record.mLocation + record.mLength);
+		if (next != mFreeByLocation.end() && next->second >= increase)
+		{
+			takeFreeExtent(next, increase);
+			record.mLength = max_size;
+			appendJournal(spec, &record);
+			unlockData();
+			return TRUE;
+		}
+	}
+
+	// allocate() may evict other files, but never this one
+	U32 location = allocate(max_size, spec);
+	if (location == BAD_LOCATION)
+	{
+		if (record.mLength > 0)
+		{
+			LL_WARNS() << "VFS: No space (" << max_size << ") to resize existing vfile " << file_id << LL_ENDL;
+		}
+		else
+		{
+			LL_WARNS() << "VFS: No space (" << max_size << ") for new virtual file " << file_id << LL_ENDL;
+			if (!record.mLocks[VFSLOCK_OPEN] && !record.mLocks[VFSLOCK_READ] && !record.mLocks[VFSLOCK_APPEND])
+			{
+				mFiles.erase(it);
+			}
+		}
+		unlockData();
+		dumpStatistics();
+		return FALSE;
+	}
+
+	if (record.mLength > 0)
+	{
+		// Move the contents. A reader still copying out of the old extent
+		// keeps it pinned, so it stays intact until that copy is done.
+		if (record.mSize > 0)
+		{
+			memcpy(mData.getData() + location, mData.getData() + record.mLocation, record.mSize);
+		}
+		freeExtent(record.mLocation, record.mLength);
+	}
+	else
+	{
+		record.mSize = 0;
+	}
+	record.mLocation = location;
+	record.mLength = max_size;
+	appendJournal(spec, &record);
+
+	unlockData();
+	return TRUE;
+}
+
+// As in LLVFS the file takes its locks along, and anything already at the
+// destination is removed.
+void LLExtentVFS::renameFile(const LLUUID &file_id, const LLAssetType::EType file_type,
+							 const LLUUID &new_id, const LLAssetType::EType &new_type)
+{
+	if (!isValid())
+	{
+		LL_ERRS() << "Attempting to use invalid VFS!" << LL_ENDL;
+	}
+	if (mReadOnly)
+	{
+		LL_ERRS() << "Attempt to write to read-only VFS" << LL_ENDL;
+	}
+
+	lockData();
+
+	LLVFSFileSpecifier old_spec(file_id, file_type);
+	LLVFSFileSpecifier new_spec(new_id, new_type);
+	file_map_t::iterator it = mFiles.find(old_spec);
+	if (it != mFiles.end())
+	{
+		file_map_t::iterator dest = mFiles.find(new_spec);
+		if (dest != mFiles.end())
+		{
+			for (S32 i = 0; i < (S32)VFSLOCK_COUNT; i++)
+			{
+				if (dest->second.mLocks[i])
+				{
+					LL_ERRS() << "Renaming VFS block to a locked file." << LL_ENDL;
+				}
+			}
+			removeRecord(dest);
+			mFiles.erase(dest);
+		}
+
+		// Update the map before journaling: a compaction triggered by either
+		// record must not see the file under both names.
+		FileRecord record = it->second;
+		record.mAccessTime = (U32)time(nullptr);
+		mFiles.erase(it);
+		if (record.mLength > 0)
+		{
+			appendJournal(old_spec, nullptr);
+		}
+		FileRecord& renamed = mFiles[new_spec];
+		renamed = record;
+		if (renamed.mLength > 0)
+		{
+			appendJournal(new_spec, &renamed);
+		}
+	}
+	else
+	{
+		LL_WARNS() << "VFS: Attempt to rename nonexistent vfile " << file_id << ":" << file_type << LL_ENDL;
+	}
+
+	unlockData();
+}
+
+void LLExtentVFS::removeFile(const LLUUID &file_id, const LLAssetType::EType file_type)
+{
+	if (!isValid())
+	{
+		LL_ERRS() << "Attempting to use invalid VFS!" << LL_ENDL;
+	}
+	if (mReadOnly)
+	{
+		LL_ERRS() << "Attempt to write to read-only VFS" << LL_ENDL;
+	}
+
+	lockData();
+
+	file_map_t::iterator it = mFiles.find(LLVFSFileSpecifier(file_id, file_type));
+	if (it != mFiles.end())
+	{
+		removeRecord(it);
+	}
+	else
+	{
+		LL_WARNS() << "VFS: attempting to remove nonexistent file " << file_id << " type " << file_type << LL_ENDL;
+	}
+
+	unlockData();
+}
+
+S32 LLExtentVFS::getData(const LLUUID &file_id, const LLAssetType::EType file_type, U8 *buffer, S32 location, S32 length)
+{
+	if (!isValid())
+	{
+		LL_ERRS() << "Attempting to use invalid VFS!" << LL_ENDL;
+	}
+	llassert(location >= 0);
+	llassert(length >= 0);
+
+	S32 bytesread = 0;
+
+	lockData();
+
+	file_map_t::iterator it = mFiles.find(LLVFSFileSpecifier(file_id, file_type));
+	if (it != mFiles.end())
+	{
+		FileRecord& record = it->second;
+		record.mAccessTime = (U32)time(nullptr);
+
+		if (location > record.mSize)
+		{
+			LL_WARNS() << "VFS: Attempt to read location " << location << " in file " << file_id << " of length " << record.mSize << LL_ENDL;
+		}
+		else
+		{
+			if (length > record.mSize - location)
+			{
+				length = record.mSize - location;
+			}
+			if (length > 0)
+			{
+				U32 data_location = record.mLocation + location;
+				pin(data_location, length);
+				unlockData();
+
+				memcpy(buffer, mData.getData() + data_location, length);
+
+				lockData();
+				unpin(data_location, length);
+				bytesread = length;
+			}
+		}
+	}
+
+	unlockData();
+
+	return bytesread;
+}
+
+S32 LLExtentVFS::storeData(const LLUUID &file_id, const LLAssetType::EType file_type, const U8 *buffer, S32 location, S32 length)
+{
+	if (!isValid())
+	{
+		LL_ERRS() << "Attempting to use invalid VFS!" << LL_ENDL;
+	}
+	if (mReadOnly)
+	{
+		LL_ERRS() << "Attempt to write to read-only VFS" << LL_ENDL;
+	}
+
+	llassert(length > 0);
+
+	lockData();
+
+	LLVFSFileSpecifier spec(file_id, file_type);
+	file_map_t::iterator it = mFiles.find(spec);
+	if (it == mFiles.end())
+	{
+		unlockData();
+		return 0;
+	}
+
+	FileRecord* record = &it->second;
+	S32 in_loc = location;
+	if (location == -1)
+	{
+		location = record->mSize;
+	}
+	llassert(location >= 0);
+
+	record->mAccessTime = (U32)time(nullptr);
+
+	if (record->mLength == BLOCK_LENGTH_INVALID)
+	{
+		// File was removed, ignore write
+		LL_WARNS() << "VFS: Attempt to write to invalid block"
+				<< " in file " << file_id
+				<< " location: " << in_loc
+				<< " bytes: " << length
+				<< LL_ENDL;
+		unlockData();
+		return length;
+	}
+	if (location > record->mLength)
+	{
+		LL_WARNS() << "VFS: Attempt to write to location " << location
+				<< " in file " << file_id
+				<< " type " << S32(file_type)
+				<< " of size " << record->mSize
+				<< " block length " << record->mLength
+				<< LL_ENDL;
+		unlockData();
+		return length;
+	}
+	if (length > record->mLength - location)
+	{
+		LL_WARNS() << "VFS: Truncating write to virtual file " << file_id << " type " << S32(file_type) << LL_ENDL;
+		length = record->mLength - location;
+	}
+
+	const U32 file_location = record->mLocation;
+	if (length > 0)
+	{
+		pin(file_location + location, length);
+		unlockData();
+
+		memcpy(mData.getData() + file_location + location, buffer, length);
+
+		lockData();
+		unpin(file_location + location, length);
+	}
+
+	// The file may have been moved, truncated or removed during the copy
+	it = mFiles.find(spec);
+	if (it == mFiles.end() || it->second.mLength == BLOCK_LENGTH_INVALID || location > it->second.mLength)
+	{
+		unlockData();
+		return length;
+	}
+	record = &it->second;
+	if (record->mLocation != file_location)
+	{
+		// It grew into a new extent; the move copied the old contents
+		// without this write, so write again.
+		length = llmin(length, record->mLength - location);
+		memcpy(mData.getData() + record->mLocation + location, buffer, length);
+	}
+	if (location + length > record->mSize)
+	{
+		record->mSize = location + length;
+		appendJournal(spec, record);
+	}
+
+	unlockData();
+
+	return length;
+}
+
+void LLExtentVFS::incLock(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock)
+{
+	lockData();
+
+	LLVFSFileSpecifier spec(file_id, file_type);
+	file_map_t::iterator it = mFiles.find(spec);
+	if (it == mFiles.end())
+	{
+		// Create a record which isn't saved, to hold the lock
+		it = mFiles.insert(file_map_t::value_type(spec, FileRecord())).first;
+		it->second.mAccessTime = (U32)time(nullptr);
+	}
+
+	it->second.mLocks[lock]++;
+	mLockCounts[lock]++;
+
+	unlockData();
+}
+
+void LLExtentVFS::decLock(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock)
+{
+	lockData();
+
+	file_map_t::iterator it = mFiles.find(LLVFSFileSpecifier(file_id, file_type));
+	if (it != mFiles.end())
+	{
+		FileRecord& record = it->second;
+		if (record.mLocks[lock] > 0)
+		{
+			record.mLocks[lock]--;
+		}
+		else
+		{
+			LL_WARNS() << "VFS: Decrementing zero-value lock " << lock << LL_ENDL;
+		}
+		mLockCounts[lock]--;
+	}
+
+	unlockData();
+}
+
+BOOL LLExtentVFS::isLocked(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock)
+{
+	lockData();
+
+	BOOL res = FALSE;
+	file_map_t::iterator it = mFiles.find(LLVFSFileSpecifier(file_id, file_type));
+	if (it != mFiles.end())
+	{
+		res = (it->second.mLocks[lock] > 0);
+	}
+
+	unlockData();
+
+	return res;
+}
+
+void LLExtentVFS::pokeFiles()
+{
+	if (!isValid())
+	{
+		LL_ERRS() << "Attempting to use invalid VFS!" << LL_ENDL;
+	}
+
+	// Fault in the start of the data, and push out anything the journal
+	// still has buffered.
+	lockData();
+	volatile U8 first = mData.getData()[0];
+	(void)first;
+	fflush(mIndexFP);
+	unlockData();
+}
+
+void LLExtentVFS::audit()
+{
+	lockData();
+
+	file_map_t on_disk;
+	U32 records = replayJournal(mIndexFP, mGeneration, on_disk);
+	S32 errors = 0;
+	if (records != mJournalRecords)
+	{
+		LL_WARNS() << "VFS: Journal holds " << records << " records, expected " << mJournalRecords << LL_ENDL;
+		errors++;
+	}
+
+	for (file_map_t::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+	{
+		if (it->second.mLength <= 0)
+		{
+			continue;
+		}
+		file_map_t::iterator disk_it = on_disk.find(it->first);
+		if (disk_it == on_disk.end())
+		{
+			LL_WARNS() << "VFS: " << it->first.mFileID << ":" << it->first.mFileType << " missing from the journal" << LL_ENDL;
+			errors++;
+			continue;
+		}
+		const FileRecord& record = it->second;
+		const FileRecord& disk = disk_it->second;
+		if (record.mLocation != disk.mLocation || record.mLength != disk.mLength || record.mSize != disk.mSize)
+		{
+			LL_WARNS() << "VFS: " << it->first.mFileID << ":" << it->first.mFileType
+				<< " location " << record.mLocation << "/" << disk.mLocation
+				<< " length " << record.mLength << "/" << disk.mLength
+				<< " size " << record.mSize << "/" << disk.mSize
+				<< " (memory/journal)" << LL_ENDL;
+			errors++;
+		}
+		on_disk.erase(disk_it);
+	}
+	for (file_map_t::iterator it = on_disk.begin(); it != on_disk.end(); ++it)
+	{
+		LL_WARNS() << "VFS: " << it->first.mFileID << ":" << it->first.mFileType << " in the journal but not in memory" << LL_ENDL;
+		errors++;
+	}
+
+	unlockData();
+
+	if (errors)
+	{
+		LL_WARNS() << "VFS: audit found " << errors << " errors" << LL_ENDL;
+	}
+	else
+	{
+		LL_INFOS() << "VFS: audit OK" << LL_ENDL;
+	}
+}
+
+void LLExtentVFS::checkMem()
+{
+	lockData();
+
+	extent_list_t extents(mDeferredFree);
+	for (file_map_t::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+	{
+		if (it->second.mLength > 0)
+		{
+			extents.push_back(std::make_pair(it->second.mLocation, (U32)it->second.mLength));
+		}
+	}
+	for (extent_location_map_t::iterator it = mFreeByLocation.begin(); it != mFreeByLocation.end(); ++it)
+	{
+		if (!mFreeByLength.count(std::make_pair(it->second, it->first)))
+		{
+			LL_WARNS() << "VFS: free extent " << it->first << " missing from the length index" << LL_ENDL;
+		}
+		extents.push_back(*it);
+	}
+	if (mFreeByLength.size() != mFreeByLocation.size())
+	{
+		LL_WARNS() << "VFS: free extent indexes differ in size" << LL_ENDL;
+	}
+	std::sort(extents.begin(), extents.end());
+
+	U32 end = 0;
+	for (extent_list_t::iterator it = extents.begin(); it != extents.end(); ++it)
+	{
+		if (it->first < end)
+		{
+			LL_WARNS() << "VFS: overlapping extents at " << it->first << LL_ENDL;
+		}
+		else if (it->first > end)
+		{
+			LL_WARNS() << "VFS: unaccounted space at " << end << " length " << it->first - end << LL_ENDL;
+		}
+		end = llmax(end, it->first + it->second);
+	}
+	if (end != mDataSize)
+	{
+		LL_WARNS() << "VFS: extents end at " << end << ", data file is " << mDataSize << " bytes" << LL_ENDL;
+	}
+
+	unlockData();
+}
+
+void LLExtentVFS::dumpMap()
+{
+	LL_INFOS() << "Files:" << LL_ENDL;
+	for (file_map_t::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+	{
+		const FileRecord& record = it->second;
+		LL_INFOS() << "Location: " << record.mLocation << "\tLength: " << record.mLength << "\t" << it->first.mFileID << "\t" << it->first.mFileType << LL_ENDL;
+	}
+
+	LL_INFOS() << "Free Extents:" << LL_ENDL;
+	for (extent_location_map_t::iterator it = mFreeByLocation.begin(); it != mFreeByLocation.end(); ++it)
+	{
+		LL_INFOS() << "Location: " << it->first << "\tLength: " << it->second << LL_ENDL;
+	}
+}
+
+void LLExtentVFS::dumpStatistics()
+{
+	lockData();
+
+	S32 file_count = 0;
+	S32 lock_only_count = 0;
+	U64 total_file_length = 0;
+	U64 total_file_size = 0;
+	std::map<LLAssetType::EType, std::pair<S32, U64> > filetype_counts;
+	for (file_map_t::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+	{
+		const FileRecord& record = it->second;
+		if (record.mLength <= 0)
+		{
+			lock_only_count++;
+			continue;
+		}
+		file_count++;
+		total_file_length += record.mLength;
+		total_file_size += record.mSize;
+		filetype_counts[it->first.mFileType].first++;
+		filetype_counts[it->first.mFileType].second += record.mLength;
+	}
+
+	U64 total_free = 0;
+	for (extent_location_map_t::iterator it = mFreeByLocation.begin(); it != mFreeByLocation.end(); ++it)
+	{
+		total_free += it->second;
+	}
+	U32 max_free = mFreeByLength.empty() ? 0 : mFreeByLength.rbegin()->first;
+
+	LL_INFOS() << "Data size: " << mDataSize << LL_ENDL;
+	LL_INFOS() << "Files: " << file_count << " using " << total_file_length << " bytes, " << total_file_size << " of them written" << LL_ENDL;
+	LL_INFOS() << "Lock-only records: " << lock_only_count << LL_ENDL;
+	LL_INFOS() << "Free extents: " << mFreeByLocation.size() << " totalling " << total_free << " bytes, largest " << max_free << LL_ENDL;
+	LL_INFOS() << "Pinned ranges: " << mPinned.size() << ", deferred frees: " << mDeferredFree.size() << LL_ENDL;
+	LL_INFOS() << "Journal generation " << mGeneration << ", " << mJournalRecords << " records" << LL_ENDL;
+	for (std::map<LLAssetType::EType, std::pair<S32, U64> >::iterator it = filetype_counts.begin(); it != filetype_counts.end(); ++it)
+	{
+		LL_INFOS() << "Type: " << LLAssetType::getDesc(it->first)
+			<< " Count: " << it->second.first
+			<< " Bytes: " << (it->second.second >> 20) << " MB" << LL_ENDL;
+	}
+
+	unlockData();
+}
+
+void LLExtentVFS::listFiles()
+{
+	lockData();
+
+	for (file_map_t::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+	{
+		const FileRecord& record = it->second;
+		if (record.mLength != BLOCK_LENGTH_INVALID && record.mSize > 0)
+		{
+			LL_INFOS() << " File: " << it->first.mFileID
+					<< " Type: " << LLAssetType::getDesc(it->first.mFileType)
+					<< " Size: " << record.mSize
+					<< LL_ENDL;
+		}
+	}
+
+	unlockData();
+}
+
+void LLExtentVFS::dumpFiles()
+{
+	std::vector<std::pair<LLVFSFileSpecifier, S32> > files;
+	lockData();
+	for (file_map_t::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+	{
+		if (it->second.mLength != BLOCK_LENGTH_INVALID && it->second.mSize > 0)
+		{
+			files.push_back(std::make_pair(it->first, it->second.mSize));
+		}
+	}
+	unlockData();
+
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		extractFile(files[i].first, files[i].second);
+	}
+
+	LL_INFOS() << "Extracted " << files.size() << " files" << LL_ENDL;
+}
+
+//============================================================================
+// private
+//============================================================================
+
+bool LLExtentVFS::readJournalHeader(LLFILE* fp, U32& generation) const
+{
+	JournalHeader header;
+	if (fseek(fp, 0, SEEK_SET) || fread(&header, sizeof(header), 1, fp) != 1)
+	{
+		return false;
+	}
+	if (header.mMagic != JOURNAL_MAGIC ||
+		header.mVersion != JOURNAL_VERSION ||
+		header.mChecksum != journal_checksum(&header, offsetof(JournalHeader, mChecksum), 0))
+	{
+		return false;
+	}
+	generation = header.mGeneration;
+	return true;
+}
+
+U32 LLExtentVFS::replayJournal(LLFILE* fp, U32 generation, file_map_t& files) const
+{
+	U32 records = 0;
+	JournalRecord journal_record;
+	fseek(fp, sizeof(JournalHeader), SEEK_SET);
+	while (fread(&journal_record, sizeof(journal_record), 1, fp) == 1)
+	{
+		if (journal_record.mChecksum != journal_checksum(&journal_record, offsetof(JournalRecord, mChecksum), generation))
+		{
+			// the end of the journal, or where a crash cut it short
+			break;
+		}
+
+		LLVFSFileSpecifier spec;
+		memcpy(spec.mFileID.mData, journal_record.mFileID, UUID_BYTES);
+		spec.mFileType = (LLAssetType::EType)journal_record.mFileType;
+		if (journal_record.mOp == JOURNAL_REMOVE)
+		{
+			files.erase(spec);
+		}
+		else if (journal_record.mOp == JOURNAL_PUT &&
+				 journal_record.mLength > 0 &&
+				 (U32)journal_record.mLength <= mDataSize &&
+				 journal_record.mLocation <= mDataSize - (U32)journal_record.mLength &&
+				 journal_record.mSize >= 0 &&
+				 journal_record.mSize <= journal_record.mLength &&
+				 spec.mFileType >= LLAssetType::AT_NONE &&
+				 spec.mFileType < LLAssetType::AT_COUNT)
+		{
+			FileRecord& record = files[spec];
+			record.mLocation = journal_record.mLocation;
+			record.mLength = journal_record.mLength;
+			record.mSize = journal_record.mSize;
+			record.mAccessTime = journal_record.mAccessTime;
+		}
+		else
+		{
+			LL_WARNS("VFS") << "VFS: Discarding bad journal record for " << spec.mFileID << " at location "
+				<< journal_record.mLocation << " length " << journal_record.mLength << LL_ENDL;
+			files.erase(spec);
+		}
+		records++;
+	}
+	return records;
+}
+
+bool LLExtentVFS::buildFreeList()
+{
+	std::vector<std::pair<U32, file_map_t::iterator> > by_location;
+	by_location.reserve(mFiles.size());
+	for (file_map_t::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+	{
+		by_location.push_back(std::make_pair(it->second.mLocation, it));
+	}
+	std::sort(by_location.begin(), by_location.end(),
+		[](const std::pair<U32, file_map_t::iterator>& lhs, const std::pair<U32, file_map_t::iterator>& rhs)
+		{
+			return lhs.first < rhs.first;
+		});
+
+	bool clean = true;
+	U32 end = 0;
+	for (size_t i = 0; i < by_location.size(); ++i)
+	{
+		file_map_t::iterator it = by_location[i].second;
+		if (it->second.mLocation < end)
+		{
+			LL_WARNS("VFS") << "VFS corruption: " << it->first.mFileID << " (" << it->first.mFileType
+				<< ") overlaps the previous file, removing it" << LL_ENDL;
+			mFiles.erase(it);
+			clean = false;
+			continue;
+		}
+		freeExtent(end, it->second.mLocation - end);
+		end = it->second.mLocation + it->second.mLength;
+	}
+	freeExtent(end, mDataSize - end);
+	return clean;
+}
+
+void LLExtentVFS::appendJournal(const LLVFSFileSpecifier& spec, const FileRecord* record)
+{
+	JournalRecord journal_record;
+	memset(&journal_record, 0, sizeof(journal_record));
+	memcpy(journal_record.mFileID, spec.mFileID.mData, UUID_BYTES);
+	journal_record.mFileType = (S16)spec.mFileType;
+	if (record)
+	{
+		journal_record.mOp = JOURNAL_PUT;
+		journal_record.mLocation = record->mLocation;
+		journal_record.mLength = record->mLength;
+		journal_record.mSize = record->mSize;
+		journal_record.mAccessTime = record->mAccessTime;
+	}
+	else
+	{
+		journal_record.mOp = JOURNAL_REMOVE;
+	}
+	journal_record.mChecksum = journal_checksum(&journal_record, offsetof(JournalRecord, mChecksum), mGeneration);
+
+	fseek(mIndexFP, (long)(sizeof(JournalHeader) + mJournalRecords * sizeof(JournalRecord)), SEEK_SET);
+	if (fwrite(&journal_record, sizeof(journal_record), 1, mIndexFP) != 1 || fflush(mIndexFP))
+	{
+		LL_WARNS("VFS") << "Couldn't write to the VFS journal " << mIndexFilename << LL_ENDL;
+		return;
+	}
+	mJournalRecords++;
+
+	if (mJournalRecords > 2 * (U32)mFiles.size() + JOURNAL_SLACK)
+	{
+		compactJournal();
+	}
+}
+
+bool LLExtentVFS::compactJournal()
+{
+	// Each attempt gets a new generation, so a failed one can't leave valid
+	// looking records behind for the next.
+	U32 generation = ++mLastGeneration;
+
+	U32 records = 0;
+	bool ok = !fseek(mSpareIndexFP, sizeof(JournalHeader), SEEK_SET);
+	for (file_map_t::iterator it = mFiles.begin(); ok && it != mFiles.end(); ++it)
+	{
+		const FileRecord& record = it->second;
+		if (record.mLength <= 0)
+		{
+			continue;
+		}
+		JournalRecord journal_record;
+		memset(&journal_record, 0, sizeof(journal_record));
+		memcpy(journal_record.mFileID, it->first.mFileID.mData, UUID_BYTES);
+		journal_record.mFileType = (S16)it->first.mFileType;
+		journal_record.mOp = JOURNAL_PUT;
+		journal_record.mLocation = record.mLocation;
+		journal_record.mLength = record.mLength;
+		journal_record.mSize = record.mSize;
+		journal_record.mAccessTime = record.mAccessTime;
+		journal_record.mChecksum = journal_checksum(&journal_record, offsetof(JournalRecord, mChecksum), generation);
+		ok = fwrite(&journal_record, sizeof(journal_record), 1, mSpareIndexFP) == 1;
+		records++;
+	}
+	ok = ok && !fflush(mSpareIndexFP);
+
+	// The header goes last: until it is written the current journal wins.
+	if (ok)
+	{
+		JournalHeader header;
+		header.mMagic = JOURNAL_MAGIC;
+		header.mVersion = JOURNAL_VERSION;
+		header.mGeneration = generation;
+		header.mChecksum = journal_checksum(&header, offsetof(JournalHeader, mChecksum), 0);
+		ok = !fseek(mSpareIndexFP, 0, SEEK_SET) &&
+			fwrite(&header, sizeof(header), 1, mSpareIndexFP) == 1 &&
+			!fflush(mSpareIndexFP);
+	}
+	if (!ok)
+	{
+		LL_WARNS("VFS") << "Couldn't compact the VFS journal into " << mIndexFilename << getSpareIndexSuffix() << LL_ENDL;
+		return false;
+	}
+
+	std::swap(mIndexFP, mSpareIndexFP);
+	mGeneration = generation;
+	mJournalRecords = records;
+	return true;
+}
+
+U32 LLExtentVFS::allocate(U32 size, const LLVFSFileSpecifier& immune)
+{
+	LLTimer timer;
+
+	U32 location = BAD_LOCATION;
+	while (true)
+	{
+		// best fit: the shortest extent that is long enough, lowest first
+		extent_length_set_t::iterator it = mFreeByLength.lower_bound(std::make_pair(size, 0U));
+		if (it != mFreeByLength.end())
+		{
+			location = it->second;
+			takeFreeExtent(mFreeByLocation.find(location), size);
+			break;
+		}
+		if (!evictFor(size, immune))
+		{
+			LL_WARNS() << "VFS: Can't make " << size << " bytes of free space in VFS, giving up" << LL_ENDL;
+			break;
+		}
+	}
+
+	F32 time = timer.getElapsedTimeF32();
+	if (time > 0.5f)
+	{
+		LL_WARNS() << "VFS: Spent " << time << " seconds in allocate!" << LL_ENDL;
+	}
+
+	return location;
+}
+
+// Removes least recently used files, the same way LLVFS::findFreeBlock()
+// does: the oldest file alone if it is big enough, otherwise the oldest
+// VFS_CLEANUP_SIZE bytes or size, whichever is larger.
+bool LLExtentVFS::evictFor(U32 size, const LLVFSFileSpecifier& immune)
+{
+	std::vector<file_map_t::iterator> lru;
+	for (file_map_t::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+	{
+		const FileRecord& record = it->second;
+		if (record.mLength > 0 &&
+			!record.mLocks[VFSLOCK_READ] &&
+			!record.mLocks[VFSLOCK_APPEND] &&
+			!record.mLocks[VFSLOCK_OPEN] &&
+			!(it->first == immune) &&
+			!isPinned(record.mLocation, record.mLength))
+		{
+			lru.push_back(it);
+		}
+	}
+	if (lru.empty())
+	{
+		return false;
+	}
+	std::sort(lru.begin(), lru.end(),
+		[](const file_map_t::iterator& lhs, const file_map_t::iterator& rhs)
+		{
+			return lhs->second.mAccessTime < rhs->second.mAccessTime;
+		});
+
+	if ((U32)lru.front()->second.mLength >= size)
+	{
+		LL_INFOS() << "LRU: Removing " << lru.front()->first.mFileID << ":" << lru.front()->first.mFileType << LL_ENDL;
+		removeRecord(lru.front());
+		return true;
+	}
+
+	LL_INFOS() << "VFS: LRU: Aggressive: " << (S32)lru.size() << " files remain" << LL_ENDL;
+	dumpLockCounts();
+
+	U32 cleanup_target = llmax(size, VFS_CLEANUP_SIZE);
+	U32 cleaned_up = 0;
+	for (size_t i = 0; i < lru.size() && cleaned_up < cleanup_target; ++i)
+	{
+		cleaned_up += lru[i]->second.mLength;
+		removeRecord(lru[i]);
+	}
+	return true;
+}
+
+void LLExtentVFS::takeFreeExtent(extent_location_map_t::iterator it, U32 size)
+{
+	U32 location = it->first;
+	U32 length = it->second;
+	llassert(length >= size);
+	mFreeByLength.erase(std::make_pair(length, location));
+	mFreeByLocation.erase(it);
+	if (length > size)
+	{
+		mFreeByLocation[location + size] = length - size;
+		mFreeByLength.insert(std::make_pair(length - size, location + size));
+	}
+}
+
+void LLExtentVFS::freeExtent(U32 location, U32 length)
+{
+	if (!length)
+	{
+		return;
+	}
+	if (isPinned(location, length))
+	{
+		// released by unpin()
+		mDeferredFree.push_back(std::make_pair(location, length));
+		return;
+	}
+
+	// merge with the free extents on either side
+	extent_location_map_t::iterator next = mFreeByLocation.find(location + length);
+	if (next != mFreeByLocation.end())
+	{
+		length += next->second;
+		mFreeByLength.erase(std::make_pair(next->second, next->first));
+		mFreeByLocation.erase(next);
+	}
+	extent_location_map_t::iterator prev = mFreeByLocation.lower_bound(location);
+	if (prev != mFreeByLocation.begin())
+	{
+		--prev;
+		if (prev->first + prev->second == location)
+		{
+			location = prev->first;
+			length += prev->second;
+			mFreeByLength.erase(std::make_pair(prev->second, prev->first));
+			mFreeByLocation.erase(prev);
+		}
+	}
+
+	mFreeByLocation[location] = length;
+	mFreeByLength.insert(std::make_pair(length, location));
+}
+
+// Like LLVFS::removeFileBlock(), keeps the record so that its locks survive
+void LLExtentVFS::removeRecord(file_map_t::iterator it)
+{
+	FileRecord& record = it->second;
+	if (record.mLength == BLOCK_LENGTH_INVALID)
+	{
+		return;
+	}
+
+	freeExtent(record.mLocation, record.mLength);
+	record.mLocation = 0;
+	record.mSize = 0;
+	record.mLength = BLOCK_LENGTH_INVALID;
+	appendJournal(it->first, nullptr);
+}
+
+bool LLExtentVFS::isPinned(U32 location, U32 length) const
+{
+	for (extent_list_t::const_iterator it = mPinned.begin(); it != mPinned.end(); ++it)
+	{
+		if (it->first < location + length && location < it->first + it->second)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void LLExtentVFS::pin(U32 location, U32 length)
+{
+	mPinned.push_back(std::make_pair(location, length));
+}
+
+void LLExtentVFS::unpin(U32 location, U32 length)
+{
+	extent_list_t::iterator it = std::find(mPinned.begin(), mPinned.end(), std::make_pair(location, length));
+	llassert(it != mPinned.end());
+	if (it != mPinned.end())
+	{
+		mPinned.erase(it);
+	}
+
+	if (!mDeferredFree.empty())
+	{
+		// anything still pinned by another copy is deferred again
+		extent_list_t deferred;
+		deferred.swap(mDeferredFree);
+		for (extent_list_t::iterator free_it = deferred.begin(); free_it != deferred.end(); ++free_it)
+		{
+			freeExtent(free_it->first, free_it->second);
+		}
+	}
+}
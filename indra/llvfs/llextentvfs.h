@@ -0,0 +1,162 @@
+/**
+ * @file llextentvfs.h
+ * @brief Extent allocated VFS with a journaled index and a mapped data file
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLEXTENTVFS_H
+#define LL_LLEXTENTVFS_H
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "llmappedfile.h"
+#include "llvfs.h"
+
+// A VFS backend with the same interface and eviction rules as LLVFS, built
+// for concurrent readers:
+//
+// - The data file is mapped into memory, and getData()/storeData() copy to
+//   and from the mapping outside mDataMutex. The lock is only held to look up
+//   the file and to pin the byte range being copied, so several threads can
+//   read different files at once. A pinned range is never handed to another
+//   file: extents freed while pinned are released when the copy finishes.
+//
+// - Free space is a set of extents indexed by location and by length, so
+//   allocation is a best-fit lookup and freed extents merge with their
+//   neighbours immediately.
+//
+// - The index is a journal of fixed-size checksummed records, one per change,
+//   appended and flushed as the change happens. On open the journal is
+//   replayed up to the first damaged record, which is all a crash can leave
+//   behind. Once the journal has grown well past the number of live files it
+//   is compacted into the second index file (index_filename plus
+//   getSpareIndexSuffix()); the header, which carries the generation that
+//   decides which of the two files is current, is written last, so a crash
+//   during compaction leaves the previous journal in charge.
+class LLExtentVFS : public LLVFS
+{
+public:
+	// Pass 0 as presize for a 1GB data file
+	LLExtentVFS(const std::string& index_filename,
+			const std::string& data_filename,
+			const BOOL read_only,
+			const U32 presize,
+			const BOOL remove_after_crash);
+	~LLExtentVFS();
+
+	// The index file that holds alternate generations of the journal
+	static const char* getSpareIndexSuffix() { return ".1"; }
+
+	// ---------- The following fucntions lock/unlock mDataMutex ----------
+	BOOL getExists(const LLUUID &file_id, const LLAssetType::EType file_type) override;
+	S32	 getSize(const LLUUID &file_id, const LLAssetType::EType file_type) override;
+
+	BOOL checkAvailable(S32 max_size) override;
+
+	S32  getMaxSize(const LLUUID &file_id, const LLAssetType::EType file_type) override;
+	BOOL setMaxSize(const LLUUID &file_id, const LLAssetType::EType file_type, S32 max_size) override;
+
+	void renameFile(const LLUUID &file_id, const LLAssetType::EType file_type,
+		const LLUUID &new_id, const LLAssetType::EType &new_type) override;
+	void removeFile(const LLUUID &file_id, const LLAssetType::EType file_type) override;
+
+	S32 getData(const LLUUID &file_id, const LLAssetType::EType file_type, U8 *buffer, S32 location, S32 length) override;
+	S32 storeData(const LLUUID &file_id, const LLAssetType::EType file_type, const U8 *buffer, S32 location, S32 length) override;
+
+	void incLock(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock) override;
+	void decLock(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock) override;
+	BOOL isLocked(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock) override;
+	// ----------------------------------------------------------------
+
+	void pokeFiles() override;
+
+	// Replays the journal on disk and compares it with the in-memory index
+	void audit() override;
+	// Checks that files and free extents cover the data file exactly once
+	void checkMem() override;
+	void dumpMap() override;
+	void dumpStatistics() override;
+	void listFiles() override;
+	void dumpFiles() override;
+
+	// Number of records in the current journal, for tests
+	U32 getJournalRecords() const { return mJournalRecords; }
+
+private:
+	struct FileRecord
+	{
+		FileRecord();
+
+		U32 mLocation;
+		S32 mLength;	// BLOCK_LENGTH_INVALID for a record that only holds locks
+		S32 mSize;
+		U32 mAccessTime;
+		S32 mLocks[VFSLOCK_COUNT];
+	};
+	typedef std::map<LLVFSFileSpecifier, FileRecord> file_map_t;
+
+	// Free extents, location -> length and (length, location)
+	typedef std::map<U32, U32> extent_location_map_t;
+	typedef std::set<std::pair<U32, U32> > extent_length_set_t;
+	typedef std::vector<std::pair<U32, U32> > extent_list_t;
+
+	bool readJournalHeader(LLFILE* fp, U32& generation) const;
+	// Returns the number of intact records applied to files
+	U32 replayJournal(LLFILE* fp, U32 generation, file_map_t& files) const;
+	// Returns false if overlapping files had to be dropped
+	bool buildFreeList();
+
+	// mDataMutex must be LOCKED before calling these
+	// A null record journals a removal
+	void appendJournal(const LLVFSFileSpecifier& spec, const FileRecord* record);
+	bool compactJournal();
+	// Returns BAD_LOCATION if even evicting every other unlocked file
+	// doesn't make room
+	U32 allocate(U32 size, const LLVFSFileSpecifier& immune);
+	bool evictFor(U32 size, const LLVFSFileSpecifier& immune);
+	void takeFreeExtent(extent_location_map_t::iterator it, U32 size);
+	void freeExtent(U32 location, U32 length);
+	void removeRecord(file_map_t::iterator it);
+	bool isPinned(U32 location, U32 length) const;
+	void pin(U32 location, U32 length);
+	void unpin(U32 location, U32 length);
+
+	file_map_t mFiles;
+	extent_location_map_t mFreeByLocation;
+	extent_length_set_t mFreeByLength;
+	extent_list_t mPinned;			// ranges being copied outside mDataMutex
+	extent_list_t mDeferredFree;	// freed while pinned
+
+	LLMappedFile mData;
+	U32 mDataSize;
+
+	// mIndexFP holds the current journal
+	LLFILE* mSpareIndexFP;
+	U32 mGeneration;
+	U32 mLastGeneration;	// highest generation either file has used
+	U32 mJournalRecords;
+};
+
+#endif
@@ -0,0 +1,409 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file llioring.cpp
+ * @brief Asynchronous file reads and writes through a Linux io_uring
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llioring.h"
+#include "lltimer.h"
+
+// The kernel interface is used directly rather than through liburing, so
+// only the kernel headers are needed to build it
+#if LL_LINUX && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define LL_IO_URING 1
+#endif
+#endif
+
+#if LL_IO_URING
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+namespace
+{
+	int io_uring_setup(U32 entries, io_uring_params* params)
+	{
+		return (int)syscall(__NR_io_uring_setup, entries, params);
+	}
+
+	int io_uring_enter(int fd, U32 to_submit, U32 min_complete, U32 flags)
+	{
+		return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+	}
+
+	// Ring indices are shared with the kernel
+	U32 load_acquire(const U32* p)
+	{
+		return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+	}
+
+	void store_release(U32* p, U32 value)
+	{
+		__atomic_store_n(p, value, __ATOMIC_RELEASE);
+	}
+}
+#endif
+
+// One submitted operation. The iovec has to stay put until the kernel is
+// done with it.
+struct LLIORing::Pending
+{
+#if LL_IO_URING
+	struct iovec mIOV;
+#endif
+	int mFD;
+	Operation* mOperation;
+};
+
+//============================================================================
+
+//static
+bool LLIORing::isSupported()
+{
+#if LL_IO_URING
+	static const bool supported = []()
+	{
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+		int fd = io_uring_setup(1, &params);
+		if (fd < 0)
+		{
+			LL_INFOS() << "io_uring is not available, errno " << errno << LL_ENDL;
+			return false;
+		}
+		close(fd);
+		return true;
+	}();
+	return supported;
+#else
+	return false;
+#endif
+}
+
+LLIORing::LLIORing(U32 depth) :
+	mRingFD(-1),
+	mDepth(0),
+	mInFlight(0),
+	mQuitting(false),
+	mCompletionThread(nullptr),
+	mSQMap(nullptr),
+	mSQMapSize(0),
+	mCQMap(nullptr),
+	mCQMapSize(0),
+	mSQEs(nullptr),
+	mSQEsSize(0),
+	mSQHead(nullptr),
+	mSQTail(nullptr),
+	mSQMask(nullptr),
+	mSQArray(nullptr),
+	mCQHead(nullptr),
+	mCQTail(nullptr),
+	mCQMask(nullptr),
+	mCQEs(nullptr)
+{
+#if LL_IO_URING
+	if (!isSupported())
+	{
+		return;
+	}
+
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	// one extra entry for the wakeup on shutdown
+	int fd = io_uring_setup(depth + 1, &params);
+	if (fd < 0)
+	{
+		LL_WARNS() << "Unable to create an io_uring of depth " << depth << ", errno " << errno << LL_ENDL;
+		return;
+	}
+
+	mSQMapSize = params.sq_off.array + params.sq_entries * sizeof(U32);
+	mCQMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		mSQMapSize = mCQMapSize = llmax(mSQMapSize, mCQMapSize);
+	}
+	mSQMap = mmap(NULL, mSQMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (mSQMap == MAP_FAILED)
+	{
+		mSQMap = nullptr;
+	}
+	else if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		mCQMap = mSQMap;
+	}
+	else
+	{
+		mCQMap = mmap(NULL, mCQMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (mCQMap == MAP_FAILED)
+		{
+			mCQMap = nullptr;
+		}
+	}
+	mSQEsSize = params.sq_entries * sizeof(io_uring_sqe);
+	mSQEs = mmap(NULL, mSQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (mSQEs == MAP_FAILED)
+	{
+		mSQEs = nullptr;
+	}
+	if (!mSQMap || !mCQMap || !mSQEs)
+	{
+		LL_WARNS() << "Unable to map io_uring queues, errno " << errno << LL_ENDL;
+		if (mSQEs)
+		{
+			munmap(mSQEs, mSQEsSize);
+			mSQEs = nullptr;
+		}
+		if (mCQMap && mCQMap != mSQMap)
+		{
+			munmap(mCQMap, mCQMapSize);
+		}
+		if (mSQMap)
+		{
+			munmap(mSQMap, mSQMapSize);
+		}
+		mSQMap = mCQMap = nullptr;
+		close(fd);
+		return;
+	}
+
+	U8* sq = (U8*)mSQMap;
+	mSQHead = (U32*)(sq + params.sq_off.head);
+	mSQTail = (U32*)(sq + params.sq_off.tail);
+	mSQMask = (U32*)(sq + params.sq_off.ring_mask);
+	mSQArray = (U32*)(sq + params.sq_off.array);
+	U8* cq = (U8*)mCQMap;
+	mCQHead = (U32*)(cq + params.cq_off.head);
+	mCQTail = (U32*)(cq + params.cq_off.tail);
+	mCQMask = (U32*)(cq + params.cq_off.ring_mask);
+	mCQEs = cq + params.cq_off.cqes;
+
+	mRingFD = fd;
+	mDepth = depth;
+	mCompletionThread = new CompletionThread(*this);
+	mCompletionThread->start();
+	LL_INFOS() << "Created an io_uring of depth " << depth << LL_ENDL;
+#endif
+}
+
+LLIORing::~LLIORing()
+{
+	if (!isValid())
+	{
+		return;
+	}
+
+	mSlotCondition.lock();
+	mQuitting = true;
+	while (mInFlight > 0)
+	{
+		mSlotCondition.wait();
+	}
+	mSlotCondition.unlock();
+
+	wake();
+	mCompletionThread->shutdown();
+	delete mCompletionThread;
+	mCompletionThread = nullptr;
+
+#if LL_IO_URING
+	munmap(mSQEs, mSQEsSize);
+	if (mCQMap != mSQMap)
+	{
+		munmap(mCQMap, mCQMapSize);
+	}
+	munmap(mSQMap, mSQMapSize);
+	close(mRingFD);
+#endif
+	mRingFD = -1;
+}
+
+bool LLIORing::read(const std::string& filename, U8* buffer, S32 bytes, S32 offset, Operation* op)
+{
+#if LL_IO_URING
+	if (!isValid())
+	{
+		return false;
+	}
+	llassert(offset >= 0);
+	int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return false;
+	}
+	Pending* pending = new Pending;
+	pending->mIOV.iov_base = buffer;
+	pending->mIOV.iov_len = llmax(bytes, 0);
+	pending->mFD = fd;
+	pending->mOperation = op;
+	return submit(IORING_OP_READV, pending, llmax(offset, 0));
+#else
+	return false;
+#endif
+}
+
+bool LLIORing::write(const std::string& filename, const U8* buffer, S32 bytes, S32 offset, Operation* op)
+{
+#if LL_IO_URING
+	if (!isValid())
+	{
+		return false;
+	}
+	// an O_APPEND write ignores the offset
+	int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (offset < 0 ? O_APPEND : 0), 0666);
+	if (fd < 0)
+	{
+		return false;
+	}
+	Pending* pending = new Pending;
+	pending->mIOV.iov_base = (void*)buffer;
+	pending->mIOV.iov_len = llmax(bytes, 0);
+	pending->mFD = fd;
+	pending->mOperation = op;
+	return submit(IORING_OP_WRITEV, pending, llmax(offset, 0));
+#else
+	return false;
+#endif
+}
+
+bool LLIORing::submit(U8 opcode, Pending* pending, S64 offset)
+{
+#if LL_IO_URING
+	LLMutexLock lock(&mSlotCondition);
+	while (mInFlight >= (S32)mDepth && !mQuitting)
+	{
+		mSlotCondition.wait();
+	}
+	if (mQuitting && pending)
+	{
+		// too late, the completion thread may be gone
+		close(pending->mFD);
+		pending->mOperation->completed(-ECANCELED);
+		delete pending->mOperation;
+		delete pending;
+		return true;
+	}
+
+	U32 tail = *mSQTail;
+	U32 index = tail & *mSQMask;
+	io_uring_sqe* sqe = (io_uring_sqe*)mSQEs + index;
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	sqe->opcode = opcode;
+	if (pending)
+	{
+		sqe->fd = pending->mFD;
+		sqe->off = offset;
+		sqe->addr = (U64)(uintptr_t)&pending->mIOV;
+		sqe->len = 1;
+		++mInFlight;
+	}
+	sqe->user_data = (U64)(uintptr_t)pending;
+	mSQArray[index] = index;
+	store_release(mSQTail, tail + 1);
+
+	S32 result;
+	do
+	{
+		result = io_uring_enter(mRingFD, 1, 0, 0);
+	} while (result < 0 && errno == EINTR);
+	if (result < 0 && pending)
+	{
+		// The kernel didn't take it. Take the entry back, as nothing else
+		// has been queued behind it while we hold the lock.
+		S32 error = errno;
+		store_release(mSQTail, tail);
+		--mInFlight;
+		close(pending->mFD);
+		pending->mOperation->completed(-error);
+		delete pending->mOperation;
+		delete pending;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Queues a no-op to get the completion thread out of its wait
+void LLIORing::wake()
+{
+#if LL_IO_URING
+	submit(IORING_OP_NOP, nullptr, 0);
+#endif
+}
+
+void LLIORing::reap()
+{
+#if LL_IO_URING
+	while (true)
+	{
+		S32 result = io_uring_enter(mRingFD, 0, 1, IORING_ENTER_GETEVENTS);
+		if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+		{
+			LL_WARNS() << "io_uring wait failed, errno " << errno << LL_ENDL;
+			ms_sleep(1);
+		}
+
+		bool woken = false;
+		S32 completed = 0;
+		U32 head = *mCQHead;
+		U32 tail = load_acquire(mCQTail);
+		for (; head != tail; ++head)
+		{
+			const io_uring_cqe* cqe = (const io_uring_cqe*)mCQEs + (head & *mCQMask);
+			Pending* pending = (Pending*)(uintptr_t)cqe->user_data;
+			if (!pending)
+			{
+				woken = true;
+				continue;
+			}
+			close(pending->mFD);
+			pending->mOperation->completed(cqe->res);
+			delete pending->mOperation;
+			delete pending;
+			++completed;
+		}
+		store_release(mCQHead, head);
+
+		if (completed)
+		{
+			LLMutexLock lock(&mSlotCondition);
+			mInFlight -= completed;
+			mSlotCondition.broadcast();
+		}
+		if (woken && mQuitting)
+		{
+			break;
+		}
+	}
+#endif
+}
@@ -0,0 +1,116 @@
+/**
+ * @file llioring.h
+ * @brief Asynchronous file reads and writes through a Linux io_uring
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIORING_H
+#define LL_LLIORING_H
+
+#include <string>
+
+#include "llatomic.h"
+#include "llthread.h"
+
+// Keeps up to getDepth() file reads and writes in flight at once, so the disk
+// sees a real queue instead of one blocking request at a time. Any thread may
+// submit. Operations complete on the ring's own thread, in whatever order the
+// disk finishes them.
+//
+// Only Linux kernels 5.1 and later have io_uring, and containers often filter
+// it out: check isSupported() first. Elsewhere the ring is never valid and
+// nothing can be submitted.
+class LLIORing
+{
+public:
+	class Operation
+	{
+	public:
+		virtual ~Operation() {}
+		// bytes transferred, or -errno. Called on the completion thread, after
+		// which the ring deletes the operation.
+		virtual void completed(S32 result) = 0;
+	};
+
+	// Submitting more than depth operations waits for one to complete
+	explicit LLIORing(U32 depth = 64);
+	// Waits for every operation in flight
+	~LLIORing();
+
+	static bool isSupported();
+	bool isValid() const { return mRingFD >= 0; }
+
+	// Open filename and queue the transfer, taking ownership of op. A write
+	// creates the file if needed and appends if offset is negative. Returns
+	// false, leaving op to the caller, if the file can't be opened.
+	bool read(const std::string& filename, U8* buffer, S32 bytes, S32 offset, Operation* op);
+	bool write(const std::string& filename, const U8* buffer, S32 bytes, S32 offset, Operation* op);
+
+	S32 getInFlight() const { return mInFlight; }
+	U32 getDepth() const { return mDepth; }
+
+private:
+	LLIORing(const LLIORing&);
+	LLIORing& operator=(const LLIORing&);
+
+	struct Pending;
+
+	class CompletionThread : public LLThread
+	{
+	public:
+		CompletionThread(LLIORing& ring) : LLThread("IO Ring"), mRing(ring) {}
+	private:
+		void run(void) override { mRing.reap(); }
+		LLIORing& mRing;
+	};
+
+	bool submit(U8 opcode, Pending* pending, S64 offset);
+	void wake();
+	// Runs on the completion thread until the ring is destroyed
+	void reap();
+
+	int mRingFD;
+	U32 mDepth;
+	LLAtomicS32 mInFlight;
+	LLAtomic32<bool> mQuitting;
+	LLCondition mSlotCondition;	// submission queue and a free slot in it
+	CompletionThread* mCompletionThread;
+
+	// Shared with the kernel
+	void* mSQMap;
+	size_t mSQMapSize;
+	void* mCQMap;
+	size_t mCQMapSize;
+	void* mSQEs;
+	size_t mSQEsSize;
+	U32* mSQHead;
+	U32* mSQTail;
+	U32* mSQMask;
+	U32* mSQArray;
+	U32* mCQHead;
+	U32* mCQTail;
+	U32* mCQMask;
+	void* mCQEs;
+};
+
+#endif // LL_LLIORING_H
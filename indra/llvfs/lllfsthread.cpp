@@ -28,8 +28,74 @@
 
 #include "linden_common.h"
 #include "lllfsthread.h"
+#include "llioring.h"
 #include "llstl.h"
 #include "llapr.h"
+#include "llthreadpool.h"
+
+// Most transfers in flight on the ring at once
+static const U32 LFS_RING_DEPTH = 64;
+
+namespace
+{
+	// A transfer handed to the ring, which completes the responder
+	class RingOperation : public LLIORing::Operation
+	{
+	public:
+		RingOperation(LLLFSThread::Responder* responder, const std::string& filename, bool write) :
+			mResponder(responder), mFileName(filename), mWrite(write) {}
+
+		void completed(S32 result) override
+		{
+			if (result < 0)
+			{
+				LL_WARNS() << "LLLFS: Unable to " << (mWrite ? "write" : "read") << " file: " << mFileName
+					<< " errno " << -result << LL_ENDL;
+			}
+			if (mResponder.notNull())
+			{
+				mResponder->completed(llmax(result, 0));
+			}
+		}
+
+	private:
+		LLPointer<LLLFSThread::Responder> mResponder;
+		std::string mFileName;
+		bool mWrite;
+	};
+
+	// The ring for a thread asking for backend, nullptr if it won't use one
+	LLIORing* create_ring(LLLFSThread::backend_t backend)
+	{
+		if (LLLFSThread::getAvailableBackend(backend) != LLLFSThread::BACKEND_URING)
+		{
+			return nullptr;
+		}
+		LLIORing* ring = new LLIORing(LFS_RING_DEPTH);
+		if (!ring->isValid())
+		{
+			LL_WARNS() << "Unable to set up an io_uring for the LFS thread" << LL_ENDL;
+			delete ring;
+			ring = nullptr;
+		}
+		return ring;
+	}
+
+	// Like getAvailableBackend(), but a ring that could not be set up falls
+	// back to the pool just as missing kernel support does
+	LLLFSThread::backend_t select_backend(LLLFSThread::backend_t backend, const LLIORing* ring)
+	{
+		if (ring)
+		{
+			return LLLFSThread::BACKEND_URING;
+		}
+		if (backend == LLLFSThread::BACKEND_URING)
+		{
+			backend = LLLFSThread::BACKEND_POOL;
+		}
+		return LLLFSThread::getAvailableBackend(backend);
+	}
+}
 
 //============================================================================
 
@@ -38,17 +104,17 @@
 //============================================================================
 // Run on MAIN thread
 //static
-void LLLFSThread::initClass(bool local_is_threaded)
+void LLLFSThread::initClass(bool local_is_threaded, backend_t backend)
 {
 	llassert(sLocal == NULL);
-	sLocal = new LLLFSThread(local_is_threaded);
+	sLocal = new LLLFSThread(local_is_threaded, backend);
 }
 
 //static
 S32 LLLFSThread::updateClass(U32 ms_elapsed)
 {
 	sLocal->update((F32)ms_elapsed);
-	return sLocal->getPending();
+	return sLocal->getPendingIO();
 }
 
 //static
@@ -59,27 +125,63 @@ void LLLFSThread::cleanupClass()
 	{
 		sLocal->update(0);
 	}
-	delete sLocal;
+	delete sLocal; // waits for the ring
 	sLocal = nullptr;
 }
 
+//static
+LLLFSThread::backend_t LLLFSThread::getAvailableBackend(backend_t backend)
+{
+	if (backend == BACKEND_URING && !LLIORing::isSupported())
+	{
+		backend = BACKEND_POOL;
+	}
+	if (backend == BACKEND_POOL && !LLThreadPool::getShared())
+	{
+		backend = BACKEND_QUEUED;
+	}
+	return backend;
+}
+
 //----------------------------------------------------------------------------
 
-LLLFSThread::LLLFSThread(bool threaded) :
-	LLQueuedThread("LFS", threaded),
-	mPriorityCounter(PRIORITY_LOWBITS)
+LLLFSThread::LLLFSThread(bool threaded, backend_t backend) :
+	LLLFSThread(threaded, backend, create_ring(backend))
+{
+}
+
+LLLFSThread::LLLFSThread(bool threaded, backend_t backend, LLIORing* ring) :
+	LLQueuedThread("LFS", threaded || select_backend(backend, ring) == BACKEND_POOL, false,
+				   select_backend(backend, ring) == BACKEND_POOL ? LLThreadPool::getShared() : nullptr),
+	mPriorityCounter(PRIORITY_LOWBITS),
+	mBackend(select_backend(backend, ring)),
+	mRing(ring)
 {
 	if(!mLocalAPRFilePoolp)
 	{
 		mLocalAPRFilePoolp = new LLVolatileAPRPool() ;
 	}
+	static const char* backend_names[] = { "queued", "thread pool", "io_uring" };
+	if (mBackend != backend)
+	{
+		LL_INFOS() << "LFS backend " << backend_names[backend] << " unavailable" << LL_ENDL;
+	}
+	LL_INFOS() << "LFS using " << backend_names[mBackend] << " file I/O" << LL_ENDL;
 }
 
 LLLFSThread::~LLLFSThread()
 {
+	// No more submissions to the ring once the queue is shut down
+	shutdown();
+	delete mRing;
 	// ~LLQueuedThread() will be called here
 }
 
+S32 LLLFSThread::getPendingIO()
+{
+	return getPending() + (mRing ? mRing->getInFlight() : 0);
+}
+
 //----------------------------------------------------------------------------
 
 LLLFSThread::handle_t LLLFSThread::read(const std::string& filename,	/* Flawfinder: ignore */ 
@@ -178,14 +280,37 @@ void LLLFSThread::Request::deleteRequest()
 	LLQueuedThread::QueuedRequest::deleteRequest();
 }
 
+// Completes, as far as the queue is concerned, once the ring has the transfer
+bool LLLFSThread::Request::submitToRing()
+{
+	bool write = mOperation == FILE_WRITE;
+	RingOperation* op = new RingOperation(mResponder, mFileName, write);
+	bool submitted = write ? mThread->mRing->write(mFileName, mBuffer, mBytes, mOffset, op)
+		: mThread->mRing->read(mFileName, mBuffer, mBytes, mOffset, op);
+	if (!submitted)
+	{
+		LL_WARNS() << "LLLFS: Unable to " << (write ? "write" : "read") << " file: " << mFileName << LL_ENDL;
+		delete op;
+		mBytesRead = 0; // fail
+		return true;
+	}
+	// the ring completes the responder
+	mResponder = nullptr;
+	return true;
+}
+
 bool LLLFSThread::Request::processRequest()
 {
 	bool complete = false;
+	if (mThread->mRing && (mOperation == FILE_READ || mOperation == FILE_WRITE))
+	{
+		return submitToRing();
+	}
 	if (mOperation ==  FILE_READ)
 	{
 		llassert(mOffset >= 0);
 		LLAPRFile infile ; // auto-closes
-		infile.open(mFileName, LL_APR_RB, mThread->getLocalAPRFilePool());
+		infile.open(mFileName, LL_APR_RB, mThread->getFilePool());
 		if (!infile.getFileHandle())
 		{
 			LL_WARNS() << "LLLFS: Unable to read file: " << mFileName << LL_ENDL;
@@ -208,7 +333,7 @@ bool LLLFSThread::Request::processRequest()
 		if (mOffset < 0)
 			flags |= APR_APPEND;
 		LLAPRFile outfile ; // auto-closes
-		outfile.open(mFileName, flags, mThread->getLocalAPRFilePool());
+		outfile.open(mFileName, flags, mThread->getFilePool());
 		if (!outfile.getFileHandle())
 		{
 			LL_WARNS() << "LLLFS: Unable to write file: " << mFileName << LL_ENDL;
@@ -30,6 +30,8 @@
 #include "llpointer.h"
 #include "llqueuedthread.h"
 
+class LLIORing;
+
 //============================================================================
 // Threaded Local File System
 //============================================================================
@@ -45,6 +47,13 @@ public:
 		FILE_REMOVE
 	};
 
+	// How reads and writes reach the disk
+	enum backend_t {
+		BACKEND_QUEUED,	// one request at a time, on our thread or in update()
+		BACKEND_POOL,	// on the shared LLThreadPool, one request per free worker
+		BACKEND_URING	// through an LLIORing, many requests in flight (Linux only)
+	};
+
 	//------------------------------------------------------------------------
 public:
 
@@ -94,6 +103,9 @@ public:
 		/*virtual*/ void deleteRequest() override;
 		
 	private:
+		// Hands the transfer and the responder to the ring
+		bool submitToRing();
+
 		LLLFSThread* mThread;
 		operation_t mOperation;
 		
@@ -109,7 +121,8 @@ public:
 
 	//------------------------------------------------------------------------
 public:
-	LLLFSThread(bool threaded = TRUE);
+	// backend falls back to the closest available one, see getBackend()
+	LLLFSThread(bool threaded = TRUE, backend_t backend = BACKEND_QUEUED);
 	~LLLFSThread();	
 
 	// Return a Request handle
@@ -122,15 +135,29 @@ public:
 	
 	// Misc
 	U32 priorityCounter() { return mPriorityCounter-- & PRIORITY_LOWBITS; } // Use to order IO operations
+	backend_t getBackend() const { return mBackend; }
+	// Queued requests plus transfers still in flight on the ring
+	S32 getPendingIO();
 	
 	// static initializers
-	static void initClass(bool local_is_threaded = TRUE); // Setup sLocal
+	static void initClass(bool local_is_threaded = TRUE, backend_t backend = BACKEND_QUEUED); // Setup sLocal
 	static S32 updateClass(U32 ms_elapsed);
 	static void cleanupClass();		// Delete sLocal
 
+	// The backend a new LLLFSThread would get when asking for backend:
+	// BACKEND_URING needs kernel support, BACKEND_POOL the shared pool
+	static backend_t getAvailableBackend(backend_t backend);
 	
 private:
+	// ring is the one mBackend == BACKEND_URING uses, nullptr if not
+	LLLFSThread(bool threaded, backend_t backend, LLIORing* ring);
+
+	// Pool workers share the global (locked) APR file pool
+	LLVolatileAPRPool* getFilePool() { return mPool ? nullptr : getLocalAPRFilePool(); }
+
 	U32 mPriorityCounter;
+	backend_t mBackend;
+	LLIORing* mRing;
 	
 public:
 	static LLLFSThread* sLocal;		// Default local file thread
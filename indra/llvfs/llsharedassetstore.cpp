@@ -0,0 +1,800 @@
+/**
+ * @file llsharedassetstore.cpp
+ * @brief Content addressed asset store shared between viewer installs
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llsharedassetstore.h"
+
+#include <algorithm>
+#include <ctime>
+
+#include "llapp.h"
+#include "lldir.h"
+#include "lldiriterator.h"
+#include "llfile.h"
+#include "llmd5.h"
+
+LLSharedAssetStore* gSharedAssetStore = NULL;
+
+namespace
+{
+	const U32 ALIAS_JOURNAL_MAGIC = 0x4a414853;	// "SHAJ"
+	const U32 ALIAS_JOURNAL_VERSION = 1;
+	// Compact once the journal holds this many more records than twice the
+	// number of aliases
+	const U32 ALIAS_JOURNAL_SLACK = 1024;
+	// Rewrite an alias's access time when it is read at least this long
+	// after the last time, so eviction follows use without a record per read
+	const U32 ALIAS_TOUCH_INTERVAL = 24 * 60 * 60;
+	// Blobs without an alias are only removed once they are this old, since
+	// another viewer may have written one and not yet recorded its alias
+	const U32 STRAY_BLOB_AGE = 60 * 60;
+
+	enum EAliasOp
+	{
+		ALIAS_PUT = 1,
+		ALIAS_REMOVE = 2
+	};
+
+	struct AliasJournalHeader
+	{
+		U32 mMagic;
+		U32 mVersion;
+		U32 mGeneration;
+		U32 mChecksum;
+	};
+
+	struct AliasRecord
+	{
+		U8 mNamespace[UUID_BYTES];
+		U8 mID[UUID_BYTES];
+		U8 mHash[UUID_BYTES];
+		S16 mType;
+		U16 mOp;
+		S32 mSize;
+		U32 mTime;
+		U32 mChecksum;
+	};
+
+	static_assert(sizeof(AliasJournalHeader) == 16, "alias journal header layout changed");
+	static_assert(sizeof(AliasRecord) == 64, "alias record layout changed");
+
+	// FNV-1a, seeded with the generation so that a journal another viewer
+	// has just replaced never replays as this one
+	U32 alias_checksum(const void* data, size_t size, U32 generation)
+	{
+		const U8* bytes = (const U8*)data;
+		U32 hash = 2166136261U ^ generation;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ bytes[i]) * 16777619U;
+		}
+		return hash;
+	}
+
+	bool read_alias_header(LLFILE* fp, U32& generation)
+	{
+		AliasJournalHeader header;
+		if (fseek(fp, 0, SEEK_SET) || fread(&header, sizeof(header), 1, fp) != 1)
+		{
+			return false;
+		}
+		if (header.mMagic != ALIAS_JOURNAL_MAGIC ||
+			header.mVersion != ALIAS_JOURNAL_VERSION ||
+			header.mChecksum != alias_checksum(&header, offsetof(AliasJournalHeader, mChecksum), 0))
+		{
+			return false;
+		}
+		generation = header.mGeneration;
+		return true;
+	}
+
+	bool write_alias_header(LLFILE* fp, U32 generation)
+	{
+		AliasJournalHeader header;
+		header.mMagic = ALIAS_JOURNAL_MAGIC;
+		header.mVersion = ALIAS_JOURNAL_VERSION;
+		header.mGeneration = generation;
+		header.mChecksum = alias_checksum(&header, offsetof(AliasJournalHeader, mChecksum), 0);
+		return fwrite(&header, sizeof(header), 1, fp) == 1;
+	}
+
+	U32 now()
+	{
+		return (U32)time(NULL);
+	}
+}
+
+//============================================================================
+
+LLSharedAssetStore::Stats::Stats()
+:	mAliases(0),
+	mBlobs(0),
+	mAliasBytes(0),
+	mBlobBytes(0)
+{
+}
+
+F32 LLSharedAssetStore::Stats::getDedupeRatio() const
+{
+	return mBlobBytes ? (F32)((F64)mAliasBytes / (F64)mBlobBytes) : 1.f;
+}
+
+bool LLSharedAssetStore::AliasKey::operator<(const AliasKey& rhs) const
+{
+	if (mID != rhs.mID)
+	{
+		return mID < rhs.mID;
+	}
+	if (mType != rhs.mType)
+	{
+		return mType < rhs.mType;
+	}
+	return mNamespace < rhs.mNamespace;
+}
+
+//============================================================================
+
+LLSharedAssetStore::LLSharedAssetStore()
+:	mMaxBytes(0),
+	mReadOnly(true),
+	mJournalFP(NULL),
+	mGeneration(0),
+	mJournalRecords(0),
+	mJournalOffset(0),
+	mAliasBytes(0),
+	mBlobBytes(0)
+{
+}
+
+LLSharedAssetStore::~LLSharedAssetStore()
+{
+	close();
+}
+
+// static
+LLUUID LLSharedAssetStore::makeNamespace(const std::string& name)
+{
+	LLUUID ns;
+	ns.generate(name);
+	return ns;
+}
+
+bool LLSharedAssetStore::open(const std::string& dir, U64 max_bytes, bool read_only)
+{
+	LLMutexLock lock(&mMutex);
+
+	if (mJournalFP)
+	{
+		return false;
+	}
+
+	mDir = dir;
+	mJournalFilename = gDirUtilp->add(dir, "aliases.journal");
+	mMaxBytes = max_bytes;
+	mReadOnly = read_only;
+
+	if (!mReadOnly)
+	{
+		LLFile::mkdir(mDir);
+		LLFile::mkdir(gDirUtilp->add(mDir, "blobs"));
+	}
+
+	if (!openJournal())
+	{
+		LL_WARNS("AssetCache") << "Couldn't open the shared asset store in " << mDir << LL_ENDL;
+		return false;
+	}
+
+	if (!mReadOnly)
+	{
+		if (mBlobBytes > mMaxBytes)
+		{
+			evict();
+		}
+		removeStrayBlobs();
+	}
+
+	Stats stats = getStats();
+	LL_INFOS("AssetCache") << "Shared asset store " << mDir << ": " << stats.mAliases << " assets in "
+		<< stats.mBlobs << " blobs, " << (stats.mBlobBytes >> 20) << " MB, dedupe ratio "
+		<< stats.getDedupeRatio() << LL_ENDL;
+	return true;
+}
+
+void LLSharedAssetStore::close()
+{
+	LLMutexLock lock(&mMutex);
+
+	if (mJournalFP)
+	{
+		fclose(mJournalFP);
+		mJournalFP = NULL;
+	}
+	mAliases.clear();
+	mBlobs.clear();
+	mAliasBytes = 0;
+	mBlobBytes = 0;
+}
+
+bool LLSharedAssetStore::read(const LLUUID& ns, const LLUUID& id, LLAssetType::EType type, std::vector<U8>& data)
+{
+	LLMutexLock lock(&mMutex);
+
+	if (!mJournalFP)
+	{
+		return false;
+	}
+
+	AliasKey key;
+	key.mNamespace = ns;
+	key.mID = id;
+	key.mType = (S16)type;
+
+	alias_map_t::iterator it = mAliases.find(key);
+	if (it == mAliases.end())
+	{
+		// another viewer may have stored it since
+		refresh();
+		it = mAliases.find(key);
+		if (it == mAliases.end())
+		{
+			return false;
+		}
+	}
+
+	Alias alias = it->second;
+	bool ok = false;
+	LLFILE* fp = LLFile::fopen(getBlobFilename(alias.mHash), "rb");
+	if (fp)
+	{
+		data.resize(alias.mSize);
+		ok = alias.mSize > 0 && fread(&data[0], alias.mSize, 1, fp) == 1 && fgetc(fp) == EOF;
+		fclose(fp);
+	}
+
+	if (!ok)
+	{
+		LL_DEBUGS("AssetCache") << "Dropping shared asset " << id << " with a missing or bad blob" << LL_ENDL;
+		data.clear();
+		if (!mReadOnly)
+		{
+			LLUUID unreferenced;
+			appendJournal(key, NULL);
+			if (removeAlias(key, unreferenced))
+			{
+				deleteBlob(unreferenced);
+			}
+		}
+		return false;
+	}
+
+	if (!mReadOnly && now() - alias.mTime > ALIAS_TOUCH_INTERVAL)
+	{
+		alias.mTime = now();
+		appendJournal(key, &alias);
+		addAlias(key, alias);
+	}
+
+	return true;
+}
+
+bool LLSharedAssetStore::store(const LLUUID& ns, const LLUUID& id, LLAssetType::EType type, const U8* data, S32 size)
+{
+	if (size <= 0)
+	{
+		return false;
+	}
+
+	// hash outside the lock, it is the slow part
+	LLMD5 md5;
+	md5.update(data, size);
+	md5.finalize();
+	Alias alias;
+	md5.raw_digest(alias.mHash.mData);
+	alias.mSize = size;
+	alias.mTime = now();
+
+	LLMutexLock lock(&mMutex);
+
+	if (!mJournalFP || mReadOnly)
+	{
+		return false;
+	}
+
+	AliasKey key;
+	key.mNamespace = ns;
+	key.mID = id;
+	key.mType = (S16)type;
+
+	alias_map_t::iterator it = mAliases.find(key);
+	if (it != mAliases.end() && it->second.mHash == alias.mHash)
+	{
+		return true;
+	}
+
+	std::string filename = getBlobFilename(alias.mHash);
+	blob_map_t::iterator blob_it = mBlobs.find(alias.mHash);
+	llstat stat_data;
+	if (blob_it == mBlobs.end() || LLFile::stat(filename, &stat_data) != 0 || stat_data.st_size != size)
+	{
+		LLFile::mkdir(gDirUtilp->getDirName(filename));
+
+		std::string tmp_filename = filename + llformat(".%u.tmp", LLApp::getPid());
+		LLFILE* fp = LLFile::fopen(tmp_filename, "wb");
+		if (!fp)
+		{
+			return false;
+		}
+		bool written = fwrite(data, size, 1, fp) == 1;
+		written = fclose(fp) == 0 && written;
+		if (written)
+		{
+			LLFile::remove(filename, ENOENT);
+			written = LLFile::rename(tmp_filename, filename) == 0;
+		}
+		if (!written)
+		{
+			LLFile::remove(tmp_filename, ENOENT);
+			return false;
+		}
+	}
+
+	appendJournal(key, &alias);
+	LLUUID unreferenced;
+	if (removeAlias(key, unreferenced))
+	{
+		deleteBlob(unreferenced);
+	}
+	addAlias(key, alias);
+
+	if (mBlobBytes > mMaxBytes)
+	{
+		evict();
+	}
+	return true;
+}
+
+void LLSharedAssetStore::remove(const LLUUID& ns, const LLUUID& id, LLAssetType::EType type)
+{
+	LLMutexLock lock(&mMutex);
+
+	if (!mJournalFP || mReadOnly)
+	{
+		return;
+	}
+
+	AliasKey key;
+	key.mNamespace = ns;
+	key.mID = id;
+	key.mType = (S16)type;
+
+	if (mAliases.find(key) != mAliases.end())
+	{
+		appendJournal(key, NULL);
+		LLUUID unreferenced;
+		if (removeAlias(key, unreferenced))
+		{
+			deleteBlob(unreferenced);
+		}
+	}
+}
+
+LLSharedAssetStore::Stats LLSharedAssetStore::getStats() const
+{
+	LLMutexLock lock(&mMutex);
+
+	Stats stats;
+	stats.mAliases = mAliases.size();
+	stats.mBlobs = mBlobs.size();
+	stats.mAliasBytes = mAliasBytes;
+	stats.mBlobBytes = mBlobBytes;
+	return stats;
+}
+
+void LLSharedAssetStore::dumpStats() const
+{
+	LLMutexLock lock(&mMutex);
+
+	std::map<S16, std::pair<U32, U64> > by_type;
+	for (alias_map_t::const_iterator it = mAliases.begin(); it != mAliases.end(); ++it)
+	{
+		std::pair<U32, U64>& entry = by_type[it->first.mType];
+		entry.first++;
+		entry.second += it->second.mSize;
+	}
+
+	Stats stats = getStats();
+	LL_INFOS("AssetCache") << "Shared asset store: " << stats.mAliases << " assets, " << (stats.mAliasBytes >> 10)
+		<< " KB stored as " << stats.mBlobs << " blobs, " << (stats.mBlobBytes >> 10)
+		<< " KB, dedupe ratio " << stats.getDedupeRatio() << LL_ENDL;
+	for (std::map<S16, std::pair<U32, U64> >::iterator it = by_type.begin(); it != by_type.end(); ++it)
+	{
+		LL_INFOS("AssetCache") << "  " << LLAssetType::lookup((LLAssetType::EType)it->first) << ": "
+			<< it->second.first << " assets, " << (it->second.second >> 10) << " KB" << LL_ENDL;
+	}
+}
+
+//============================================================================
+// private
+//============================================================================
+
+std::string LLSharedAssetStore::getBlobFilename(const LLUUID& hash) const
+{
+	std::string name = hash.asString();
+	return gDirUtilp->add(gDirUtilp->add(mDir, "blobs"), name.substr(0, 2)) + gDirUtilp->getDirDelimiter() + name;
+}
+
+bool LLSharedAssetStore::createJournal(U32 generation)
+{
+	std::string tmp_filename = mJournalFilename + llformat(".%u.tmp", LLApp::getPid());
+	LLFILE* fp = LLFile::fopen(tmp_filename, "wb");
+	if (!fp)
+	{
+		return false;
+	}
+	bool ok = write_alias_header(fp, generation);
+	ok = fclose(fp) == 0 && ok;
+	if (ok)
+	{
+		LLFile::remove(mJournalFilename, ENOENT);
+		ok = LLFile::rename(tmp_filename, mJournalFilename) == 0;
+	}
+	if (!ok)
+	{
+		LLFile::remove(tmp_filename, ENOENT);
+	}
+	return ok;
+}
+
+bool LLSharedAssetStore::openJournal()
+{
+	if (mJournalFP)
+	{
+		fclose(mJournalFP);
+		mJournalFP = NULL;
+	}
+	mAliases.clear();
+	mBlobs.clear();
+	mAliasBytes = 0;
+	mBlobBytes = 0;
+
+	// appending, so records written by several viewers never overlap
+	const char* mode = mReadOnly ? "rb" : "a+b";
+	mJournalFP = LLFile::fopen(mJournalFilename, mode);
+	if (!mJournalFP || !read_alias_header(mJournalFP, mGeneration))
+	{
+		if (mJournalFP)
+		{
+			fclose(mJournalFP);
+			mJournalFP = NULL;
+		}
+		if (mReadOnly || !createJournal(now()))
+		{
+			return false;
+		}
+		mJournalFP = LLFile::fopen(mJournalFilename, mode);
+		if (!mJournalFP || !read_alias_header(mJournalFP, mGeneration))
+		{
+			if (mJournalFP)
+			{
+				fclose(mJournalFP);
+				mJournalFP = NULL;
+			}
+			return false;
+		}
+	}
+
+	mJournalOffset = sizeof(AliasJournalHeader);
+	mJournalRecords = 0;
+	refresh();
+
+	if (!mReadOnly)
+	{
+		// a damaged record hides everything after it from every viewer
+		bool damaged = !fseek(mJournalFP, 0, SEEK_END) && ftell(mJournalFP) > mJournalOffset;
+		if (damaged || mJournalRecords > 2 * (U32)mAliases.size() + ALIAS_JOURNAL_SLACK)
+		{
+			compactJournal();
+		}
+	}
+	return mJournalFP != NULL;
+}
+
+void LLSharedAssetStore::refresh()
+{
+	// Another viewer compacting the journal renames a new file over it,
+	// which only shows up when the file is opened by name again.
+	U32 generation = 0;
+	LLFILE* fp = LLFile::fopen(mJournalFilename, "rb");
+	if (!fp)
+	{
+		return;
+	}
+	if (!read_alias_header(fp, generation))
+	{
+		fclose(fp);
+		return;
+	}
+	if (generation != mGeneration)
+	{
+		fclose(fp);
+		openJournal();
+		return;
+	}
+
+	AliasRecord record;
+	fseek(fp, mJournalOffset, SEEK_SET);
+	while (fread(&record, sizeof(record), 1, fp) == 1)
+	{
+		if (record.mChecksum != alias_checksum(&record, offsetof(AliasRecord, mChecksum), mGeneration))
+		{
+			// the end of the journal, a record still being written, or damage
+			break;
+		}
+
+		AliasKey key;
+		memcpy(key.mNamespace.mData, record.mNamespace, UUID_BYTES);
+		memcpy(key.mID.mData, record.mID, UUID_BYTES);
+		key.mType = record.mType;
+
+		LLUUID unreferenced;
+		if (record.mOp == ALIAS_PUT && record.mSize > 0)
+		{
+			Alias alias;
+			memcpy(alias.mHash.mData, record.mHash, UUID_BYTES);
+			alias.mSize = record.mSize;
+			alias.mTime = record.mTime;
+
+			alias_map_t::iterator it = mAliases.find(key);
+			if (it == mAliases.end() || it->second.mHash != alias.mHash)
+			{
+				removeAlias(key, unreferenced);
+			}
+			addAlias(key, alias);
+		}
+		else
+		{
+			// whoever wrote the record deletes the blob
+			removeAlias(key, unreferenced);
+		}
+
+		mJournalOffset += sizeof(record);
+		mJournalRecords++;
+	}
+	fclose(fp);
+}
+
+void LLSharedAssetStore::appendJournal(const AliasKey& key, const Alias* alias)
+{
+	// pick up a compaction by another viewer first, or the record would go
+	// to the replaced file
+	refresh();
+	if (!mJournalFP)
+	{
+		return;
+	}
+
+	AliasRecord record;
+	memset(&record, 0, sizeof(record));
+	memcpy(record.mNamespace, key.mNamespace.mData, UUID_BYTES);
+	memcpy(record.mID, key.mID.mData, UUID_BYTES);
+	record.mType = key.mType;
+	if (alias)
+	{
+		record.mOp = ALIAS_PUT;
+		memcpy(record.mHash, alias->mHash.mData, UUID_BYTES);
+		record.mSize = alias->mSize;
+		record.mTime = alias->mTime;
+	}
+	else
+	{
+		record.mOp = ALIAS_REMOVE;
+	}
+	record.mChecksum = alias_checksum(&record, offsetof(AliasRecord, mChecksum), mGeneration);
+
+	if (fwrite(&record, sizeof(record), 1, mJournalFP) != 1 || fflush(mJournalFP))
+	{
+		LL_WARNS("AssetCache") << "Couldn't write to the shared asset journal " << mJournalFilename << LL_ENDL;
+		return;
+	}
+
+	// The record is replayed with everyone else's on the next refresh, which
+	// changes nothing since the caller applies it too.
+	if (mJournalRecords > 2 * (U32)mAliases.size() + ALIAS_JOURNAL_SLACK)
+	{
+		compactJournal();
+	}
+}
+
+bool LLSharedAssetStore::compactJournal()
+{
+	U32 generation = mGeneration + 1;
+	std::string tmp_filename = mJournalFilename + llformat(".%u.tmp", LLApp::getPid());
+	LLFILE* fp = LLFile::fopen(tmp_filename, "wb");
+	if (!fp)
+	{
+		return false;
+	}
+
+	bool ok = write_alias_header(fp, generation);
+	U32 records = 0;
+	for (alias_map_t::iterator it = mAliases.begin(); ok && it != mAliases.end(); ++it)
+	{
+		AliasRecord record;
+		memset(&record, 0, sizeof(record));
+		memcpy(record.mNamespace, it->first.mNamespace.mData, UUID_BYTES);
+		memcpy(record.mID, it->first.mID.mData, UUID_BYTES);
+		record.mType = it->first.mType;
+		record.mOp = ALIAS_PUT;
+		memcpy(record.mHash, it->second.mHash.mData, UUID_BYTES);
+		record.mSize = it->second.mSize;
+		record.mTime = it->second.mTime;
+		record.mChecksum = alias_checksum(&record, offsetof(AliasRecord, mChecksum), generation);
+		ok = fwrite(&record, sizeof(record), 1, fp) == 1;
+		records++;
+	}
+	ok = fclose(fp) == 0 && ok;
+
+	// Windows refuses while another viewer has the journal open, which
+	// leaves the current journal in use
+	if (ok)
+	{
+		LLFile::remove(mJournalFilename, ENOENT);
+		ok = LLFile::rename(tmp_filename, mJournalFilename) == 0;
+	}
+	if (!ok)
+	{
+		LLFile::remove(tmp_filename, ENOENT);
+		return false;
+	}
+
+	fclose(mJournalFP);
+	mJournalFP = LLFile::fopen(mJournalFilename, "a+b");
+	mGeneration = generation;
+	mJournalRecords = records;
+	mJournalOffset = (long)(sizeof(AliasJournalHeader) + records * sizeof(AliasRecord));
+	return mJournalFP != NULL;
+}
+
+void LLSharedAssetStore::addAlias(const AliasKey& key, const Alias& alias)
+{
+	std::pair<alias_map_t::iterator, bool> result = mAliases.insert(std::make_pair(key, alias));
+	if (!result.second)
+	{
+		// same blob, newer access time
+		result.first->second.mTime = llmax(result.first->second.mTime, alias.mTime);
+		return;
+	}
+	mAliasBytes += alias.mSize;
+
+	Blob& blob = mBlobs[alias.mHash];
+	if (blob.mRefs++ == 0)
+	{
+		blob.mSize = alias.mSize;
+		mBlobBytes += alias.mSize;
+	}
+}
+
+bool LLSharedAssetStore::removeAlias(const AliasKey& key, LLUUID& unreferenced)
+{
+	alias_map_t::iterator it = mAliases.find(key);
+	if (it == mAliases.end())
+	{
+		return false;
+	}
+	LLUUID hash = it->second.mHash;
+	mAliasBytes -= it->second.mSize;
+	mAliases.erase(it);
+
+	blob_map_t::iterator blob_it = mBlobs.find(hash);
+	if (blob_it == mBlobs.end() || --blob_it->second.mRefs > 0)
+	{
+		return false;
+	}
+	mBlobBytes -= blob_it->second.mSize;
+	mBlobs.erase(blob_it);
+	unreferenced = hash;
+	return true;
+}
+
+void LLSharedAssetStore::deleteBlob(const LLUUID& hash)
+{
+	LLFile::remove(getBlobFilename(hash), ENOENT);
+}
+
+void LLSharedAssetStore::evict()
+{
+	std::vector<std::pair<U32, AliasKey> > by_time;
+	by_time.reserve(mAliases.size());
+	for (alias_map_t::iterator it = mAliases.begin(); it != mAliases.end(); ++it)
+	{
+		by_time.push_back(std::make_pair(it->second.mTime, it->first));
+	}
+	std::sort(by_time.begin(), by_time.end(),
+		[](const std::pair<U32, AliasKey>& lhs, const std::pair<U32, AliasKey>& rhs)
+		{
+			return lhs.first < rhs.first;
+		});
+
+	U64 target = mMaxBytes / 4 * 3;
+	U32 evicted = 0;
+	for (size_t i = 0; i < by_time.size() && mBlobBytes > target; ++i)
+	{
+		appendJournal(by_time[i].second, NULL);
+		LLUUID unreferenced;
+		if (removeAlias(by_time[i].second, unreferenced))
+		{
+			deleteBlob(unreferenced);
+		}
+		evicted++;
+	}
+
+	LL_INFOS("AssetCache") << "Evicted " << evicted << " shared assets, " << (mBlobBytes >> 20) << " MB left" << LL_ENDL;
+}
+
+void LLSharedAssetStore::removeStrayBlobs()
+{
+	// blobs whose alias was lost, for instance to a race with another viewer
+	std::string blob_dir = gDirUtilp->add(mDir, "blobs");
+	U32 removed = 0;
+	U32 oldest = now() - STRAY_BLOB_AGE;
+
+	LLDirIterator dir_iter(blob_dir, "*");
+	std::string sub_dir;
+	while (dir_iter.next(sub_dir))
+	{
+		std::string sub_path = gDirUtilp->add(blob_dir, sub_dir);
+		if (!LLFile::isdir(sub_path))
+		{
+			continue;
+		}
+
+		LLDirIterator file_iter(sub_path, "*");
+		std::string name;
+		while (file_iter.next(name))
+		{
+			std::string path = gDirUtilp->add(sub_path, name);
+			llstat stat_data;
+			if (LLFile::stat(path, &stat_data) != 0 || (U32)stat_data.st_mtime > oldest)
+			{
+				continue;
+			}
+
+			LLUUID hash;
+			if (!LLUUID::validate(name) || !hash.set(name, FALSE) || mBlobs.find(hash) == mBlobs.end())
+			{
+				LLFile::remove(path, ENOENT);
+				removed++;
+			}
+		}
+	}
+
+	if (removed)
+	{
+		LL_INFOS("AssetCache") << "Removed " << removed << " unreferenced shared asset blobs" << LL_ENDL;
+	}
+}
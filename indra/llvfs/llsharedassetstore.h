@@ -0,0 +1,159 @@
+/**
+ * @file llsharedassetstore.h
+ * @brief Content addressed asset store shared between viewer installs
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSHAREDASSETSTORE_H
+#define LL_LLSHAREDASSETSTORE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "llassettype.h"
+#include "llmutex.h"
+#include "lluuid.h"
+
+// An asset cache that lives outside any one install's cache directory, so
+// it is kept when the per-install caches are purged or moved, and can be
+// shared by viewers logged in to different accounts or grids.
+//
+// Asset bodies are stored once per distinct content, as blob files named
+// after the MD5 of their contents. Assets are found through aliases: a
+// namespace (normally the grid, see makeNamespace()), an asset id and a
+// type, each pointing at a blob. A blob is counted as referenced once per
+// alias and deleted with its last alias, so the same texture uploaded
+// under different ids, or copied between grids, takes its space only once.
+//
+// The aliases are kept in a journal of fixed-size checksummed records that
+// each viewer appends to, like LLExtentVFS's index. A lookup that misses
+// first picks up records appended by other viewers since the last one.
+// Blobs are immutable and written under a temporary name before being
+// renamed into place, so several viewers can use the store at once. The
+// worst a race between them can do is lose an alias or a blob, which is a
+// cache miss.
+class LLSharedAssetStore
+{
+public:
+	struct Stats
+	{
+		Stats();
+
+		U32 mAliases;
+		U32 mBlobs;
+		U64 mAliasBytes;	// size of the assets as seen through their aliases
+		U64 mBlobBytes;		// size actually stored
+
+		// mAliasBytes / mBlobBytes: 1 means nothing was deduplicated
+		F32 getDedupeRatio() const;
+	};
+
+	LLSharedAssetStore();
+	~LLSharedAssetStore();
+
+	// Opens or creates the store in dir. A read-only store never writes,
+	// which lets a second viewer instance use it. max_bytes limits the blob
+	// bytes, oldest aliases being dropped first.
+	bool open(const std::string& dir, U64 max_bytes, bool read_only);
+	void close();
+	bool isOpen() const { return mJournalFP != NULL; }
+
+	// Namespace for the assets of the grid (or anything else) called name.
+	static LLUUID makeNamespace(const std::string& name);
+
+	bool read(const LLUUID& ns, const LLUUID& id, LLAssetType::EType type, std::vector<U8>& data);
+	bool store(const LLUUID& ns, const LLUUID& id, LLAssetType::EType type, const U8* data, S32 size);
+	void remove(const LLUUID& ns, const LLUUID& id, LLAssetType::EType type);
+
+	Stats getStats() const;
+	void dumpStats() const;
+
+private:
+	LLSharedAssetStore(const LLSharedAssetStore&);
+	LLSharedAssetStore& operator=(const LLSharedAssetStore&);
+
+	struct AliasKey
+	{
+		LLUUID mNamespace;
+		LLUUID mID;
+		S16 mType;
+
+		bool operator<(const AliasKey& rhs) const;
+	};
+
+	struct Alias
+	{
+		LLUUID mHash;
+		S32 mSize;
+		U32 mTime;
+	};
+
+	struct Blob
+	{
+		S32 mSize;
+		U32 mRefs;
+	};
+
+	typedef std::map<AliasKey, Alias> alias_map_t;
+	typedef std::map<LLUUID, Blob> blob_map_t;
+
+	std::string getBlobFilename(const LLUUID& hash) const;
+
+	bool createJournal(U32 generation);
+	bool openJournal();
+	// Replays records from mJournalOffset on, starting over if another
+	// viewer has compacted the journal meanwhile.
+	void refresh();
+	void appendJournal(const AliasKey& key, const Alias* alias);
+	bool compactJournal();
+
+	void addAlias(const AliasKey& key, const Alias& alias);
+	// Returns the blob the alias pointed at if that lost its last reference.
+	bool removeAlias(const AliasKey& key, LLUUID& unreferenced);
+	void deleteBlob(const LLUUID& hash);
+
+	void evict();
+	void removeStrayBlobs();
+
+	std::string mDir;
+	std::string mJournalFilename;
+	U64 mMaxBytes;
+	bool mReadOnly;
+
+	LLFILE* mJournalFP;
+	U32 mGeneration;
+	U32 mJournalRecords;
+	long mJournalOffset;
+
+	alias_map_t mAliases;
+	blob_map_t mBlobs;
+	U64 mAliasBytes;
+	U64 mBlobBytes;
+
+	mutable LLMutex mMutex;
+};
+
+extern LLSharedAssetStore* gSharedAssetStore;
+
+#endif // LL_LLSHAREDASSETSTORE_H
@@ -38,6 +38,7 @@
 #endif
     
 #include "llapr.h"
+#include "llextentvfs.h"
 #include "llstl.h"
 #include "lltimer.h"
     
@@ -554,6 +555,22 @@ LLVFS::LLVFS(const std::string& index_filename, const std::string& data_filename
 
 	mValid = VFSVALID_OK;
 }
+
+LLVFS::LLVFS(const std::string& index_filename, const std::string& data_filename, const BOOL read_only, const BOOL remove_after_crash)
+:	mDataMutex(new LLMutex()),
+	mDataFP(nullptr),
+	mIndexFP(nullptr),
+	mIndexFilename(index_filename),
+	mDataFilename(data_filename),
+	mReadOnly(read_only),
+	mValid(VFSVALID_UNKNOWN),
+	mRemoveAfterCrash(remove_after_crash)
+{
+	for (S32 i = 0; i < VFSLOCK_COUNT; i++)
+	{
+		mLockCounts[i] = 0;
+	}
+}
     
 LLVFS::~LLVFS()
 {
@@ -598,37 +615,72 @@ LLVFS * LLVFS::createLLVFS(const std::string& index_filename,
 		const std::string& data_filename, 
 		const BOOL read_only, 
 		const U32 presize, 
-		const BOOL remove_after_crash)
+		const BOOL remove_after_crash,
+		const EVFSBackend backend)
 {
-	LLVFS * new_vfs = new LLVFS(index_filename, data_filename, read_only, presize, remove_after_crash);
-
-	if( !new_vfs->isValid() )
-	{	// First name failed, retry with new names
-		std::string retry_vfs_index_name;
-		std::string retry_vfs_data_name;
-		S32 count = 0;
-		while (!new_vfs->isValid() &&
-				count < 256)
-		{	// Append '.<number>' to end of filenames
-			retry_vfs_index_name = index_filename + llformat(".%u",count);
-			retry_vfs_data_name = data_filename + llformat(".%u", count);
-
-			delete new_vfs;	// Delete bad VFS and try again
-			new_vfs = new LLVFS(retry_vfs_index_name, retry_vfs_data_name, read_only, presize, remove_after_crash);
-
-			count++;
+	// A failed open may already have created and presized its files. Remove
+	// those before trying the next names so that each attempt doesn't leave
+	// a large data file behind. Files that were there before are left alone,
+	// they may belong to another viewer.
+	auto open_vfs = [=](const std::string& index_name, const std::string& data_name) -> LLVFS*
+	{
+		const std::string spare_index_name = index_name + LLExtentVFS::getSpareIndexSuffix();
+		const bool index_existed = LLFile::isfile(index_name);
+		const bool data_existed = LLFile::isfile(data_name);
+		const bool spare_index_existed = LLFile::isfile(spare_index_name);
+
+		LLVFS * vfs = create(index_name, data_name, read_only, presize, remove_after_crash, backend);
+		if (vfs->isValid())
+		{
+			return vfs;
 		}
-	}
 
-	if( !new_vfs->isValid() )
-	{
-		delete new_vfs;		// Delete bad VFS
-		new_vfs = nullptr;		// Total failure
+		delete vfs;		// closes the files so they can be removed
+		if (!read_only)
+		{
+			if (!data_existed)
+			{
+				LLFile::remove(data_name, ENOENT);
+			}
+			if (!index_existed)
+			{
+				LLFile::remove(index_name, ENOENT);
+			}
+			if (backend == VFSBACKEND_EXTENT && !spare_index_existed)
+			{
+				LLFile::remove(spare_index_name, ENOENT);
+			}
+		}
+		return nullptr;
+	};
+
+	LLVFS * new_vfs = open_vfs(index_filename, data_filename);
+
+	// First name failed, retry with new names
+	for (S32 count = 0; !new_vfs && count < 256; count++)
+	{	// Append '.<number>' to end of filenames
+		new_vfs = open_vfs(index_filename + llformat(".%u", count), data_filename + llformat(".%u", count));
 	}
 
+	// nullptr on total failure
 	return new_vfs;
 }
 
+// static
+LLVFS * LLVFS::create(const std::string& index_filename, 
+		const std::string& data_filename, 
+		const BOOL read_only, 
+		const U32 presize, 
+		const BOOL remove_after_crash,
+		const EVFSBackend backend)
+{
+	if (backend == VFSBACKEND_EXTENT)
+	{
+		return new LLExtentVFS(index_filename, data_filename, read_only, presize, remove_after_crash);
+	}
+	return new LLVFS(index_filename, data_filename, read_only, presize, remove_after_crash);
+}
+
 
 
 void LLVFS::presizeDataFile(const U32 size)
@@ -2084,22 +2136,9 @@ void LLVFS::dumpFiles()
 		apr_size_t size = (apr_size_t)file_block->mSize;
 		if (length != BLOCK_LENGTH_INVALID && size > 0)
 		{
-			LLUUID id = file_spec.mFileID;
-			LLAssetType::EType type = file_spec.mFileType;
-			std::vector<U8> buffer(size);
-
 			unlockData();
-			getData(id, type, &buffer[0], 0, size);
+			extractFile(file_spec, (S32)size);
 			lockData();
-			
-			std::string extension = get_extension(type);
-			std::string filename = id.asString() + extension;
-			LL_INFOS() << " Writing " << filename << LL_ENDL;
-			
-			LLAPRFile outfile;
-			outfile.open(filename, LL_APR_WB);
-			outfile.write(&buffer[0], size);
-			outfile.close();
 
 			files_extracted++;
 		}
@@ -2110,6 +2149,23 @@ void LLVFS::dumpFiles()
 	LL_INFOS() << "Extracted " << files_extracted << " files out of " << mFileBlocks.size() << LL_ENDL;
 }
 
+// Debug Only!
+// Writes one file to the working directory, named after its id and type
+void LLVFS::extractFile(const LLVFSFileSpecifier& file_spec, S32 size)
+{
+	std::vector<U8> buffer(size);
+	getData(file_spec.mFileID, file_spec.mFileType, &buffer[0], 0, size);
+
+	std::string extension = get_extension(file_spec.mFileType);
+	std::string filename = file_spec.mFileID.asString() + extension;
+	LL_INFOS() << " Writing " << filename << LL_ENDL;
+
+	LLAPRFile outfile;
+	outfile.open(filename, LL_APR_WB);
+	outfile.write(&buffer[0], size);
+	outfile.close();
+}
+
 time_t LLVFS::creationTime()
 {
     llstat data_file_stat;
@@ -52,6 +52,13 @@ enum EVFSLock
 	VFSLOCK_COUNT = 3
 };
 
+// On-disk layouts createLLVFS() can open
+enum EVFSBackend
+{
+	VFSBACKEND_BLOCK = 0,	// LLVFS itself: block list index, stdio data file
+	VFSBACKEND_EXTENT = 1	// LLExtentVFS: journaled extent index, mapped data file
+};
+
 // internal classes
 class LLVFSBlock;
 class LLVFSFileBlock;
@@ -78,8 +85,15 @@ private:
 			const BOOL read_only, 
 			const U32 presize, 
 			const BOOL remove_after_crash);
+protected:
+	// For other backends: sets up the members shared by all of them, and
+	// leaves the data and index files to the subclass.
+	LLVFS(const std::string& index_filename,
+			const std::string& data_filename,
+			const BOOL read_only,
+			const BOOL remove_after_crash);
 public:
-	~LLVFS();
+	virtual ~LLVFS();
 
 	// Use this function normally to create LLVFS files
 	// Pass 0 to not presize
@@ -87,46 +101,47 @@ public:
 			const std::string& data_filename, 
 			const BOOL read_only, 
 			const U32 presize, 
-			const BOOL remove_after_crash);
+			const BOOL remove_after_crash,
+			const EVFSBackend backend = VFSBACKEND_BLOCK);
 
 	BOOL isValid() const			{ return (VFSVALID_OK == mValid); }
 	EVFSValid getValidState() const	{ return mValid; }
 
 	// ---------- The following fucntions lock/unlock mDataMutex ----------
-	BOOL getExists(const LLUUID &file_id, const LLAssetType::EType file_type);
-	S32	 getSize(const LLUUID &file_id, const LLAssetType::EType file_type);
+	virtual BOOL getExists(const LLUUID &file_id, const LLAssetType::EType file_type);
+	virtual S32	 getSize(const LLUUID &file_id, const LLAssetType::EType file_type);
 
-	BOOL checkAvailable(S32 max_size);
+	virtual BOOL checkAvailable(S32 max_size);
 	
-	S32  getMaxSize(const LLUUID &file_id, const LLAssetType::EType file_type);
-	BOOL setMaxSize(const LLUUID &file_id, const LLAssetType::EType file_type, S32 max_size);
+	virtual S32  getMaxSize(const LLUUID &file_id, const LLAssetType::EType file_type);
+	virtual BOOL setMaxSize(const LLUUID &file_id, const LLAssetType::EType file_type, S32 max_size);
 
-	void renameFile(const LLUUID &file_id, const LLAssetType::EType file_type,
+	virtual void renameFile(const LLUUID &file_id, const LLAssetType::EType file_type,
 		const LLUUID &new_id, const LLAssetType::EType &new_type);
-	void removeFile(const LLUUID &file_id, const LLAssetType::EType file_type);
+	virtual void removeFile(const LLUUID &file_id, const LLAssetType::EType file_type);
 
-	S32 getData(const LLUUID &file_id, const LLAssetType::EType file_type, U8 *buffer, S32 location, S32 length);
-	S32 storeData(const LLUUID &file_id, const LLAssetType::EType file_type, const U8 *buffer, S32 location, S32 length);
+	virtual S32 getData(const LLUUID &file_id, const LLAssetType::EType file_type, U8 *buffer, S32 location, S32 length);
+	virtual S32 storeData(const LLUUID &file_id, const LLAssetType::EType file_type, const U8 *buffer, S32 location, S32 length);
 
-	void incLock(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock);
-	void decLock(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock);
-	BOOL isLocked(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock);
+	virtual void incLock(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock);
+	virtual void decLock(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock);
+	virtual BOOL isLocked(const LLUUID &file_id, const LLAssetType::EType file_type, EVFSLock lock);
 	// ----------------------------------------------------------------
 
 	// Used to trigger evil WinXP behavior of "preloading" entire file into memory.
-	void pokeFiles();
+	virtual void pokeFiles();
 
 	// Verify that the index file contents match the in-memory file structure
 	// Very slow, do not call routinely. JC
-	void audit();
+	virtual void audit();
 	// Check for uninitialized blocks.  Slow, do not call in release. JC
-	void checkMem();
+	virtual void checkMem();
 	// for debugging, prints a map of the vfs
-	void dumpMap();
+	virtual void dumpMap();
 	void dumpLockCounts();
-	void dumpStatistics();
-	void listFiles();
-	void dumpFiles();
+	virtual void dumpStatistics();
+	virtual void listFiles();
+	virtual void dumpFiles();
 	time_t creationTime();
 
 protected:
@@ -139,6 +154,14 @@ protected:
 	void useFreeSpace(LLVFSBlock *free_block, S32 length);
 	void sync(LLVFSFileBlock *block, BOOL remove = FALSE);
 	void presizeDataFile(const U32 size);
+	void extractFile(const LLVFSFileSpecifier& file_spec, S32 size);
+
+	static LLVFS * create(const std::string& index_filename, 
+			const std::string& data_filename, 
+			const BOOL read_only, 
+			const U32 presize, 
+			const BOOL remove_after_crash,
+			const EVFSBackend backend);
 
 	static LLFILE *openAndLock(const std::string& filename, const char* mode, BOOL read_lock);
 	static void unlockAndClose(LLFILE *fp);
@@ -0,0 +1,280 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llextentvfs_test.cpp
+ * @brief  Test for llextentvfs.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../llextentvfs.h"
+// STL headers
+#include <memory>
+#include <string>
+#include <vector>
+// std headers
+// external library headers
+#include <boost/thread.hpp>
+// other Linden headers
+#include "llfile.h"
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llextentvfs_data
+	{
+		llextentvfs_data()
+		:	mBase(std::string(LLFile::tmpdir()) + "llextentvfs_" + LLUUID::generateNewID().asString()),
+			mIndexFilename(mBase + ".index"),
+			mDataFilename(mBase + ".data")
+		{
+		}
+		~llextentvfs_data()
+		{
+			LLFile::remove(mIndexFilename, ENOENT);
+			LLFile::remove(mIndexFilename + LLExtentVFS::getSpareIndexSuffix(), ENOENT);
+			LLFile::remove(mDataFilename, ENOENT);
+			LLFile::remove(mDataFilename + ".open", ENOENT);
+		}
+
+		LLExtentVFS* open(U32 presize = 1024 * 1024)
+		{
+			return new LLExtentVFS(mIndexFilename, mDataFilename, FALSE, presize, FALSE);
+		}
+
+		static std::vector<U8> pattern(S32 size, U8 seed)
+		{
+			std::vector<U8> data(size);
+			for (S32 i = 0; i < size; ++i)
+			{
+				data[i] = (U8)(seed + i * 7);
+			}
+			return data;
+		}
+
+		static bool contains(LLVFS* vfs, const LLUUID& id, const std::vector<U8>& expected)
+		{
+			std::vector<U8> data(expected.size() + 16);
+			S32 read = vfs->getData(id, LLAssetType::AT_OBJECT, &data[0], 0, (S32)data.size());
+			data.resize(llmax(read, 0));
+			return data == expected;
+		}
+
+		static void store(LLVFS* vfs, const LLUUID& id, const std::vector<U8>& data)
+		{
+			ensure("allocate", vfs->setMaxSize(id, LLAssetType::AT_OBJECT, (S32)data.size()));
+			ensure_equals("store", vfs->storeData(id, LLAssetType::AT_OBJECT, &data[0], 0, (S32)data.size()), (S32)data.size());
+		}
+
+		std::string mBase;
+		std::string mIndexFilename;
+		std::string mDataFilename;
+	};
+	typedef test_group<llextentvfs_data> llextentvfs_group;
+	typedef llextentvfs_group::object object;
+	llextentvfs_group llextentvfsgrp("llextentvfs");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("files survive reopening");
+		LLUUID first(LLUUID::generateNewID());
+		LLUUID second(LLUUID::generateNewID());
+		std::vector<U8> first_data(pattern(3000, 1));
+		std::vector<U8> second_data(pattern(100, 2));
+		{
+			std::unique_ptr<LLExtentVFS> vfs(open());
+			ensure("valid", vfs->isValid());
+			ensure("empty", !vfs->getExists(first, LLAssetType::AT_OBJECT));
+
+			store(vfs.get(), first, first_data);
+			ensure_equals("rounded to 1KB", vfs->getMaxSize(first, LLAssetType::AT_OBJECT), 3072);
+			ensure_equals(vfs->getSize(first, LLAssetType::AT_OBJECT), 3000);
+
+			// appends go at the end of what has been written
+			ensure("allocate", vfs->setMaxSize(second, LLAssetType::AT_OBJECT, 100));
+			vfs->storeData(second, LLAssetType::AT_OBJECT, &second_data[0], 0, 60);
+			vfs->storeData(second, LLAssetType::AT_OBJECT, &second_data[60], -1, 40);
+			ensure("contents", contains(vfs.get(), second, second_data));
+
+			// and writes past the end are truncated
+			ensure_equals("truncated", vfs->storeData(second, LLAssetType::AT_OBJECT, &first_data[0], 1000, 100), 24);
+		}
+
+		std::unique_ptr<LLExtentVFS> vfs(open());
+		ensure("reopened", vfs->isValid());
+		ensure("first", contains(vfs.get(), first, first_data));
+		std::vector<U8> data(4);
+		ensure_equals(vfs->getData(second, LLAssetType::AT_OBJECT, &data[0], 1020, 100), 4);
+		ensure("second", data == std::vector<U8>(first_data.begin() + 20, first_data.begin() + 24));
+		vfs->audit();
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("resize, rename and remove");
+		LLUUID id(LLUUID::generateNewID());
+		LLUUID blocker(LLUUID::generateNewID());
+		LLUUID renamed(LLUUID::generateNewID());
+		std::vector<U8> data(pattern(2048, 3));
+		{
+			std::unique_ptr<LLExtentVFS> vfs(open());
+			store(vfs.get(), id, data);
+			// something right behind it, so growing has to move it
+			store(vfs.get(), blocker, pattern(1024, 4));
+			ensure("grow", vfs->setMaxSize(id, LLAssetType::AT_OBJECT, 8192));
+			ensure_equals(vfs->getMaxSize(id, LLAssetType::AT_OBJECT), 8192);
+			ensure("moved with its contents", contains(vfs.get(), id, data));
+			ensure("blocker untouched", contains(vfs.get(), blocker, pattern(1024, 4)));
+
+			// renaming over an existing file replaces it
+			vfs->renameFile(id, LLAssetType::AT_OBJECT, blocker, LLAssetType::AT_OBJECT);
+			ensure("old name gone", !vfs->getExists(id, LLAssetType::AT_OBJECT));
+			ensure("replaced", contains(vfs.get(), blocker, data));
+			vfs->renameFile(blocker, LLAssetType::AT_OBJECT, renamed, LLAssetType::AT_OBJECT);
+			vfs->checkMem();
+		}
+		{
+			std::unique_ptr<LLExtentVFS> vfs(open());
+			ensure("renamed", contains(vfs.get(), renamed, data));
+			ensure("other names gone", !vfs->getExists(blocker, LLAssetType::AT_OBJECT) && !vfs->getExists(id, LLAssetType::AT_OBJECT));
+			vfs->removeFile(renamed, LLAssetType::AT_OBJECT);
+			ensure("removed", !vfs->getExists(renamed, LLAssetType::AT_OBJECT));
+			ensure_equals(vfs->getData(renamed, LLAssetType::AT_OBJECT, &data[0], 0, 10), 0);
+		}
+		std::unique_ptr<LLExtentVFS> vfs(open());
+		ensure("still removed", !vfs->getExists(renamed, LLAssetType::AT_OBJECT));
+		ensure("all space free", vfs->checkAvailable(1024 * 1024));
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		set_test_name("least recently used unlocked files are evicted");
+		std::unique_ptr<LLExtentVFS> vfs(open(64 * 1024));
+		std::vector<LLUUID> ids;
+		for (S32 i = 0; i < 4; ++i)
+		{
+			ids.push_back(LLUUID::generateNewID());
+			store(vfs.get(), ids.back(), pattern(16 * 1024, (U8)i));
+		}
+		ensure("full", !vfs->checkAvailable(1));
+
+		vfs->incLock(ids[0], LLAssetType::AT_OBJECT, VFSLOCK_OPEN);
+		LLUUID extra(LLUUID::generateNewID());
+		ensure("made room", vfs->setMaxSize(extra, LLAssetType::AT_OBJECT, 16 * 1024));
+		ensure("locked file kept", vfs->getExists(ids[0], LLAssetType::AT_OBJECT));
+		ensure("locked", vfs->isLocked(ids[0], LLAssetType::AT_OBJECT, VFSLOCK_OPEN));
+		S32 remaining = 0;
+		for (S32 i = 1; i < 4; ++i)
+		{
+			remaining += vfs->getExists(ids[i], LLAssetType::AT_OBJECT) ? 1 : 0;
+		}
+		ensure_equals("one evicted", remaining, 2);
+		vfs->decLock(ids[0], LLAssetType::AT_OBJECT, VFSLOCK_OPEN);
+
+		ensure("too big for the store", !vfs->setMaxSize(LLUUID::generateNewID(), LLAssetType::AT_OBJECT, 128 * 1024));
+		vfs->checkMem();
+	}
+
+	template<> template<>
+	void object::test<4>()
+	{
+		set_test_name("journal compaction and torn records");
+		LLUUID id(LLUUID::generateNewID());
+		std::vector<U8> data(pattern(1024, 5));
+		U32 records = 0;
+		{
+			std::unique_ptr<LLExtentVFS> vfs(open());
+			store(vfs.get(), id, data);
+			records = vfs->getJournalRecords();
+		}
+
+		// A new store starts by compacting its empty journal into the spare
+		// file, so that is where these records are. Leave a partial record
+		// behind, as a crash in the middle of an append would.
+		LLFILE* fp = LLFile::fopen(mIndexFilename + LLExtentVFS::getSpareIndexSuffix(), "ab");
+		ensure("journal", fp != NULL);
+		ensure_equals("journal length", ftell(fp), (long)(16 + records * 40));
+		fwrite("torn", 1, 4, fp);
+		fclose(fp);
+
+		{
+			std::unique_ptr<LLExtentVFS> vfs(open());
+			ensure("valid", vfs->isValid());
+			ensure_equals("intact records replayed", vfs->getJournalRecords(), records);
+			ensure("contents", contains(vfs.get(), id, data));
+
+			// rewriting the same file only ever leaves one live record
+			for (S32 i = 0; i < 3000; ++i)
+			{
+				vfs->setMaxSize(id, LLAssetType::AT_OBJECT, (i & 1) ? 1024 : 2048);
+			}
+			records = vfs->getJournalRecords();
+			ensure("compacted", records < 2000);
+			vfs->audit();
+		}
+
+		std::unique_ptr<LLExtentVFS> vfs(open());
+		ensure_equals("compacted journal replayed", vfs->getJournalRecords(), records);
+		ensure_equals(vfs->getMaxSize(id, LLAssetType::AT_OBJECT), 1024);
+		ensure("contents", contains(vfs.get(), id, data));
+	}
+
+	template<> template<>
+	void object::test<5>()
+	{
+		set_test_name("concurrent readers and writers");
+		std::unique_ptr<LLExtentVFS> vfs(open(4 * 1024 * 1024));
+		const S32 FILES = 32;
+		const S32 SIZE = 8192;
+		std::vector<LLUUID> ids;
+		for (S32 i = 0; i < FILES; ++i)
+		{
+			ids.push_back(LLUUID::generateNewID());
+			store(vfs.get(), ids.back(), pattern(SIZE, (U8)i));
+		}
+
+		LLExtentVFS* vfsp = vfs.get();
+		volatile bool failed = false;
+		std::vector<boost::thread*> threads;
+		for (S32 t = 0; t < 4; ++t)
+		{
+			threads.push_back(new boost::thread([vfsp, &ids, &failed, t, FILES, SIZE]()
+				{
+					for (S32 i = 0; i < 2000; ++i)
+					{
+						S32 file = (i * 5 + t) % FILES;
+						if (t == 0)
+						{
+							// keep moving files while the others read them
+							vfsp->setMaxSize(ids[file], LLAssetType::AT_OBJECT, (i & 1) ? SIZE : SIZE * 2);
+							std::vector<U8> data(pattern(SIZE, (U8)file));
+							vfsp->storeData(ids[file], LLAssetType::AT_OBJECT, &data[0], 0, SIZE);
+						}
+						else if (!contains(vfsp, ids[file], pattern(SIZE, (U8)file)))
+						{
+							failed = true;
+						}
+					}
+				}));
+		}
+		for (boost::thread* thread : threads)
+		{
+			thread->join();
+			delete thread;
+		}
+		ensure("every read saw whole files", !failed);
+		vfs->checkMem();
+		vfs->audit();
+	}
+}
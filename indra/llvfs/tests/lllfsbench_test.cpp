@@ -0,0 +1,179 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   lllfsbench_test.cpp
+ * @brief  Read throughput of the LLLFSThread backends.
+ *
+ * This isn't a regression test: it doesn't need to be run every build, so it
+ * is only built with BUILD_BENCHMARKS, as BENCHMARK_lllfsbench, to be run by hand.
+ * The workload looks like the texture cache reading bodies: a few thousand
+ * files of texture-like sizes, read whole in random order, with every read
+ * queued at once. On Linux the files are dropped from the page cache before
+ * each pass so the disk, not memcpy, is measured. The numbers go to stdout
+ * for human examination.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../lllfsthread.h"
+// STL headers
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+// std headers
+#include <chrono>
+#if LL_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+// external library headers
+// other Linden headers
+#include "llfile.h"
+#include "llthreadpool.h"
+#include "lltimer.h"
+#include "lluuid.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	const S32 FILES = 4000;
+	const S32 PASSES = 3;
+
+	typedef std::chrono::steady_clock clock_t;
+
+	// Mostly small bodies with a long tail, like the texture cache
+	S32 file_size(U32& seed)
+	{
+		seed = seed * 1664525 + 1013904223;
+		S32 size = 1024 + (seed >> 8) % (32 * 1024);
+		if ((seed & 0x7) == 0)
+		{
+			size *= 8;
+		}
+		return size;
+	}
+
+	void drop_cached(const std::string& filename)
+	{
+#if LL_LINUX
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd >= 0)
+		{
+			fdatasync(fd);
+			posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+			close(fd);
+		}
+#endif
+	}
+
+	class CountingResponder : public LLLFSThread::Responder
+	{
+	public:
+		CountingResponder(LLAtomicS32& done, LLAtomicS32& bytes) : mDone(done), mBytes(bytes) {}
+		void completed(S32 bytes) override
+		{
+			mBytes += bytes;
+			++mDone;
+		}
+	private:
+		LLAtomicS32& mDone;
+		LLAtomicS32& mBytes;
+	};
+
+	// Returns MB/s over every pass
+	F64 run(LLLFSThread::backend_t backend, const std::vector<std::string>& names, const std::vector<S32>& sizes,
+			std::vector<std::vector<U8> >& buffers)
+	{
+		LLLFSThread* lfs = new LLLFSThread(false, backend);
+		F64 elapsed = 0.0;
+		F64 total = 0.0;
+		U32 seed = 7;
+		for (S32 pass = 0; pass < PASSES; ++pass)
+		{
+			for (const std::string& name : names)
+			{
+				drop_cached(name);
+			}
+
+			LLAtomicS32 done(0);
+			LLAtomicS32 bytes(0);
+			clock_t::time_point start = clock_t::now();
+			for (S32 i = 0; i < FILES; ++i)
+			{
+				seed = seed * 1664525 + 1013904223;
+				S32 file = (seed >> 8) % FILES;
+				lfs->read(names[file], &buffers[i][0], 0, sizes[file], new CountingResponder(done, bytes));
+			}
+			while (done < FILES)
+			{
+				lfs->update(0);
+				LLThread::yield();
+			}
+			elapsed += std::chrono::duration<F64>(clock_t::now() - start).count();
+			total += bytes;
+		}
+		delete lfs;
+		return total / elapsed / (1024 * 1024);
+	}
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct lllfsbench_data
+	{
+	};
+	typedef test_group<lllfsbench_data> lllfsbench_group;
+	typedef lllfsbench_group::object object;
+	lllfsbench_group lllfsbenchgrp("lllfsbench");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("texture cache read throughput");
+		LLThreadPool::initClass();
+		std::string base = std::string(LLFile::tmpdir()) + "lllfsbench_" + LLUUID::generateNewID().asString();
+
+		std::vector<std::string> names;
+		std::vector<S32> sizes;
+		std::vector<U8> data(512 * 1024, 0x5a);
+		U32 seed = 1;
+		for (S32 i = 0; i < FILES; ++i)
+		{
+			names.push_back(base + llformat("_%d", i));
+			sizes.push_back(file_size(seed));
+			LLFILE* fp = LLFile::fopen(names.back(), "wb");
+			ensure("create", fp != NULL);
+			fwrite(&data[0], 1, sizes.back(), fp);
+			fclose(fp);
+		}
+		std::vector<std::vector<U8> > buffers(FILES, std::vector<U8>(512 * 1024));
+
+		static const char* backend_names[] = { "queued", "thread pool", "io_uring" };
+		std::cout << std::endl << std::fixed << std::setprecision(1);
+		for (S32 backend = LLLFSThread::BACKEND_QUEUED; backend <= LLLFSThread::BACKEND_URING; ++backend)
+		{
+			if (LLLFSThread::getAvailableBackend((LLLFSThread::backend_t)backend) != backend)
+			{
+				std::cout << std::setw(16) << backend_names[backend] << "   unavailable" << std::endl;
+				continue;
+			}
+			F64 mbps = run((LLLFSThread::backend_t)backend, names, sizes, buffers);
+			std::cout << std::setw(16) << backend_names[backend] << std::setw(12) << mbps << " MB/s" << std::endl;
+		}
+
+		for (const std::string& name : names)
+		{
+			LLFile::remove(name);
+		}
+		LLThreadPool::cleanupClass();
+	}
+}
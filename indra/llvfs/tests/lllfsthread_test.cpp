@@ -0,0 +1,185 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   lllfsthread_test.cpp
+ * @brief  Test for lllfsthread.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../lllfsthread.h"
+// STL headers
+#include <string>
+#include <vector>
+// std headers
+// external library headers
+// other Linden headers
+#include "llfile.h"
+#include "llioring.h"
+#include "llthreadpool.h"
+#include "lltimer.h"
+#include "lluuid.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	class CountingResponder : public LLLFSThread::Responder
+	{
+	public:
+		CountingResponder(LLAtomicS32& done, LLAtomicS32& bytes) : mDone(done), mBytes(bytes) {}
+		void completed(S32 bytes) override
+		{
+			mBytes += bytes;
+			++mDone;
+		}
+	private:
+		LLAtomicS32& mDone;
+		LLAtomicS32& mBytes;
+	};
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct lllfsthread_data
+	{
+		lllfsthread_data()
+		:	mBase(std::string(LLFile::tmpdir()) + "lllfsthread_" + LLUUID::generateNewID().asString())
+		{
+			LLThreadPool::initClass(4);
+		}
+		~lllfsthread_data()
+		{
+			for (const std::string& filename : mFiles)
+			{
+				LLFile::remove(filename, ENOENT);
+			}
+			LLThreadPool::cleanupClass();
+		}
+
+		std::string filename(S32 i)
+		{
+			std::string name = mBase + llformat("_%d", i);
+			mFiles.push_back(name);
+			return name;
+		}
+
+		static std::vector<U8> pattern(S32 size, U8 seed)
+		{
+			std::vector<U8> data(size);
+			for (S32 i = 0; i < size; ++i)
+			{
+				data[i] = (U8)(seed + i * 13);
+			}
+			return data;
+		}
+
+		// Writes, appends to and reads back files through a queue with the
+		// given backend, the way the texture cache and the audio decoder do
+		void roundTrip(LLLFSThread::backend_t backend)
+		{
+			const S32 FILES = 200;
+			const S32 SIZE = 3000;
+			LLLFSThread* lfs = new LLLFSThread(false, backend);
+			ensure_equals("backend", lfs->getBackend(), backend);
+
+			std::vector<std::string> names;
+			std::vector<std::vector<U8> > contents;
+			LLAtomicS32 done(0);
+			LLAtomicS32 bytes(0);
+			for (S32 i = 0; i < FILES; ++i)
+			{
+				names.push_back(filename(i));
+				contents.push_back(pattern(SIZE, (U8)i));
+				lfs->write(names[i], &contents[i][0], 0, SIZE - 1000, new CountingResponder(done, bytes));
+			}
+			wait(lfs, done, FILES);
+			ensure_equals("written", (S32)bytes, FILES * (SIZE - 1000));
+
+			done = 0;
+			bytes = 0;
+			for (S32 i = 0; i < FILES; ++i)
+			{
+				lfs->write(names[i], &contents[i][SIZE - 1000], -1, 1000, new CountingResponder(done, bytes));
+			}
+			wait(lfs, done, FILES);
+			ensure_equals("appended", (S32)bytes, FILES * 1000);
+
+			done = 0;
+			bytes = 0;
+			std::vector<std::vector<U8> > read_back(FILES, std::vector<U8>(SIZE + 100));
+			for (S32 i = 0; i < FILES; ++i)
+			{
+				// asking for more than there is gets what there is
+				lfs->read(names[i], &read_back[i][0], 10, SIZE + 100, new CountingResponder(done, bytes));
+			}
+			wait(lfs, done, FILES);
+			ensure_equals("read", (S32)bytes, FILES * (SIZE - 10));
+			for (S32 i = 0; i < FILES; ++i)
+			{
+				ensure("contents", std::equal(contents[i].begin() + 10, contents[i].end(), read_back[i].begin()));
+			}
+
+			// a missing file completes with nothing read
+			done = 0;
+			bytes = 0;
+			lfs->read(mBase + "_missing", &read_back[0][0], 0, 10, new CountingResponder(done, bytes));
+			wait(lfs, done, 1);
+			ensure_equals("missing", (S32)bytes, 0);
+
+			delete lfs;
+		}
+
+		void wait(LLLFSThread* lfs, LLAtomicS32& done, S32 count)
+		{
+			LLTimer timer;
+			while ((done < count || lfs->getPendingIO()) && timer.getElapsedTimeF32() < 30.f)
+			{
+				lfs->update(0);
+				ms_sleep(1);
+			}
+			ensure_equals("completed", (S32)done, count);
+			ensure_equals("nothing pending", lfs->getPendingIO(), 0);
+		}
+
+		std::string mBase;
+		std::vector<std::string> mFiles;
+	};
+	typedef test_group<lllfsthread_data> lllfsthread_group;
+	typedef lllfsthread_group::object object;
+	lllfsthread_group lllfsthreadgrp("lllfsthread");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("queued backend");
+		roundTrip(LLLFSThread::BACKEND_QUEUED);
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("thread pool backend");
+		roundTrip(LLLFSThread::BACKEND_POOL);
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		set_test_name("io_uring backend");
+		if (!LLIORing::isSupported())
+		{
+			ensure_equals("falls back to the pool", LLLFSThread::getAvailableBackend(LLLFSThread::BACKEND_URING),
+						  LLLFSThread::BACKEND_POOL);
+			return; // nothing else to test here
+		}
+		roundTrip(LLLFSThread::BACKEND_URING);
+	}
+}
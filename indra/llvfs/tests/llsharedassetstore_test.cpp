@@ -0,0 +1,176 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llsharedassetstore_test.cpp
+ * @brief  Test for llsharedassetstore.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../llsharedassetstore.h"
+// STL headers
+#include <string>
+#include <vector>
+// std headers
+// external library headers
+// other Linden headers
+#include "lldir.h"
+#include "llfile.h"
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llsharedassetstore_data
+	{
+		llsharedassetstore_data()
+		:	mDir(std::string(LLFile::tmpdir()) + "llsharedassetstore_" + LLUUID::generateNewID().asString()),
+			mGrid(LLSharedAssetStore::makeNamespace("grid.example.com")),
+			mOtherGrid(LLSharedAssetStore::makeNamespace("other.example.com"))
+		{
+		}
+		~llsharedassetstore_data()
+		{
+			gDirUtilp->deleteDirAndContents(mDir);
+		}
+
+		static std::vector<U8> pattern(S32 size, U8 seed)
+		{
+			std::vector<U8> data(size);
+			for (S32 i = 0; i < size; ++i)
+			{
+				data[i] = (U8)(seed + i * 7);
+			}
+			return data;
+		}
+
+		static bool contains(LLSharedAssetStore& store, const LLUUID& ns, const LLUUID& id, const std::vector<U8>& expected)
+		{
+			std::vector<U8> data;
+			return store.read(ns, id, LLAssetType::AT_SOUND, data) && data == expected;
+		}
+
+		static void store(LLSharedAssetStore& store, const LLUUID& ns, const LLUUID& id, const std::vector<U8>& data)
+		{
+			ensure("store", store.store(ns, id, LLAssetType::AT_SOUND, &data[0], (S32)data.size()));
+		}
+
+		std::string mDir;
+		LLUUID mGrid;
+		LLUUID mOtherGrid;
+	};
+	typedef test_group<llsharedassetstore_data> llsharedassetstore_group;
+	typedef llsharedassetstore_group::object object;
+	llsharedassetstore_group llsharedassetstoregrp("llsharedassetstore");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("identical assets are stored once");
+		LLUUID first(LLUUID::generateNewID());
+		LLUUID second(LLUUID::generateNewID());
+		std::vector<U8> data(pattern(3000, 1));
+		{
+			LLSharedAssetStore assets;
+			ensure("open", assets.open(mDir, 1024 * 1024, false));
+			store(assets, mGrid, first, data);
+			store(assets, mGrid, second, data);
+			store(assets, mOtherGrid, first, data);
+			store(assets, mGrid, LLUUID::generateNewID(), pattern(1000, 2));
+
+			LLSharedAssetStore::Stats stats = assets.getStats();
+			ensure_equals("aliases", stats.mAliases, 4U);
+			ensure_equals("blobs", stats.mBlobs, 2U);
+			ensure_equals("blob bytes", stats.mBlobBytes, (U64)4000);
+			ensure_equals("dedupe ratio", stats.getDedupeRatio(), 10000.f / 4000.f);
+			ensure("type is part of the key", !assets.read(mGrid, first, LLAssetType::AT_ANIMATION, data));
+		}
+
+		LLSharedAssetStore assets;
+		ensure("reopen", assets.open(mDir, 1024 * 1024, false));
+		ensure("first", contains(assets, mGrid, first, data));
+		ensure("second", contains(assets, mGrid, second, data));
+		ensure("other grid", contains(assets, mOtherGrid, first, data));
+		ensure_equals("blobs", assets.getStats().mBlobs, 2U);
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		set_test_name("blobs go with their last alias");
+		LLUUID first(LLUUID::generateNewID());
+		LLUUID second(LLUUID::generateNewID());
+		std::vector<U8> data(pattern(2048, 3));
+
+		LLSharedAssetStore assets;
+		ensure("open", assets.open(mDir, 1024 * 1024, false));
+		store(assets, mGrid, first, data);
+		store(assets, mGrid, second, data);
+
+		assets.remove(mGrid, first, LLAssetType::AT_SOUND);
+		ensure("removed", !contains(assets, mGrid, first, data));
+		ensure("shared blob kept", contains(assets, mGrid, second, data));
+
+		// storing new contents under an id moves the alias
+		store(assets, mGrid, second, pattern(2048, 4));
+		ensure("replaced", contains(assets, mGrid, second, pattern(2048, 4)));
+		LLSharedAssetStore::Stats stats = assets.getStats();
+		ensure_equals("one blob", stats.mBlobs, 1U);
+		ensure_equals("bytes", stats.mBlobBytes, (U64)2048);
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		set_test_name("oldest assets are evicted");
+		LLSharedAssetStore assets;
+		ensure("open", assets.open(mDir, 64 * 1024, false));
+		std::vector<LLUUID> ids;
+		for (S32 i = 0; i < 8; ++i)
+		{
+			ids.push_back(LLUUID::generateNewID());
+			store(assets, mGrid, ids.back(), pattern(16 * 1024, (U8)i));
+		}
+		LLSharedAssetStore::Stats stats = assets.getStats();
+		ensure("under the limit", stats.mBlobBytes <= 64 * 1024);
+		ensure("not emptied", stats.mAliases > 0);
+
+		U32 readable = 0;
+		for (S32 i = 0; i < 8; ++i)
+		{
+			readable += contains(assets, mGrid, ids[i], pattern(16 * 1024, (U8)i)) ? 1 : 0;
+		}
+		ensure_equals("evicted blobs deleted", readable, stats.mAliases);
+	}
+
+	template<> template<>
+	void object::test<4>()
+	{
+		set_test_name("stores opened twice see each other");
+		LLUUID id(LLUUID::generateNewID());
+		std::vector<U8> data(pattern(5000, 5));
+
+		LLSharedAssetStore first;
+		LLSharedAssetStore second;
+		LLSharedAssetStore reader;
+		ensure("open first", first.open(mDir, 1024 * 1024, false));
+		ensure("open second", second.open(mDir, 1024 * 1024, false));
+		ensure("open reader", reader.open(mDir, 1024 * 1024, true));
+
+		store(first, mGrid, id, data);
+		ensure("second", contains(second, mGrid, id, data));
+		ensure("reader", contains(reader, mGrid, id, data));
+		ensure("reader can't store", !reader.store(mGrid, LLUUID::generateNewID(), LLAssetType::AT_SOUND, &data[0], 100));
+
+		second.remove(mGrid, id, LLAssetType::AT_SOUND);
+		std::vector<U8> read_data;
+		ensure("gone for the first", !first.read(mGrid, id, LLAssetType::AT_SOUND, read_data));
+	}
+}
@@ -0,0 +1,183 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+/**
+ * @file   llvfsbench_test.cpp
+ * @brief  Throughput of LLExtentVFS against the block based LLVFS.
+ *
+ * This isn't a regression test: it doesn't need to be run every build, so it
+ * is only built with BUILD_BENCHMARKS, as BENCHMARK_llvfsbench, to be run by hand.
+ * Both backends get the same cache-like workload: fill the store with files
+ * of asset-like sizes, churn it with replacements that force LRU eviction,
+ * then read random files from 1 to 8 threads. The numbers go to stdout for
+ * human examination.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../llextentvfs.h"
+// STL headers
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+// std headers
+#include <chrono>
+// external library headers
+#include <boost/thread.hpp>
+// other Linden headers
+#include "llfile.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	const U32 STORE_SIZE = 256 * 1024 * 1024;
+	const S32 FILES = 8000;
+	const S32 CHURN = 8000;
+	const S32 READS_PER_THREAD = 20000;
+
+	typedef std::chrono::steady_clock clock_t;
+
+	F64 seconds_since(clock_t::time_point start)
+	{
+		return std::chrono::duration<F64>(clock_t::now() - start).count();
+	}
+
+	// Mostly small files with a long tail, roughly what the VFS holds
+	S32 file_size(U32& seed)
+	{
+		seed = seed * 1664525 + 1013904223;
+		S32 size = 512 + (seed >> 8) % (16 * 1024);
+		if ((seed & 0xf) == 0)
+		{
+			size *= 16;
+		}
+		return size;
+	}
+
+	volatile size_t sSink = 0;
+
+	struct Result
+	{
+		F64 mFillMBps;
+		F64 mChurnOpsps;
+		std::vector<F64> mReadMBps;
+	};
+
+	Result run(EVFSBackend backend, const std::string& base)
+	{
+		std::string index_filename = base + ".index";
+		std::string data_filename = base + ".data";
+		LLVFS* vfs = LLVFS::createLLVFS(index_filename, data_filename, FALSE, STORE_SIZE, FALSE, backend);
+		Result result;
+
+		std::vector<LLUUID> ids;
+		std::vector<U8> buffer(512 * 1024, 0x5a);
+		U32 seed = 1;
+		U64 bytes = 0;
+		clock_t::time_point start = clock_t::now();
+		for (S32 i = 0; i < FILES; ++i)
+		{
+			ids.push_back(LLUUID::generateNewID());
+			S32 size = file_size(seed);
+			vfs->setMaxSize(ids.back(), LLAssetType::AT_TEXTURE, size);
+			vfs->storeData(ids.back(), LLAssetType::AT_TEXTURE, &buffer[0], 0, size);
+			bytes += size;
+		}
+		result.mFillMBps = bytes / seconds_since(start) / (1024 * 1024);
+
+		// replace files with new ones of a different size, as the cache does
+		// once it is full
+		start = clock_t::now();
+		for (S32 i = 0; i < CHURN; ++i)
+		{
+			LLUUID& id = ids[(seed >> 8) % FILES];
+			vfs->removeFile(id, LLAssetType::AT_TEXTURE);
+			id.generate();
+			S32 size = file_size(seed);
+			vfs->setMaxSize(id, LLAssetType::AT_TEXTURE, size);
+			vfs->storeData(id, LLAssetType::AT_TEXTURE, &buffer[0], 0, size);
+		}
+		result.mChurnOpsps = CHURN / seconds_since(start);
+
+		for (S32 thread_count : { 1, 2, 4, 8 })
+		{
+			std::vector<boost::thread*> threads;
+			std::vector<U64> thread_bytes(thread_count, 0);
+			start = clock_t::now();
+			for (S32 t = 0; t < thread_count; ++t)
+			{
+				U64* read_bytes = &thread_bytes[t];
+				threads.push_back(new boost::thread([vfs, &ids, read_bytes, t]()
+					{
+						std::vector<U8> data(512 * 1024);
+						U32 read_seed = t + 1;
+						size_t sum = 0;
+						for (S32 i = 0; i < READS_PER_THREAD; ++i)
+						{
+							read_seed = read_seed * 1664525 + 1013904223;
+							S32 read = vfs->getData(ids[(read_seed >> 8) % FILES], LLAssetType::AT_TEXTURE, &data[0], 0, (S32)data.size());
+							*read_bytes += read;
+							sum += data[0];
+						}
+						sSink = sum;
+					}));
+			}
+			for (boost::thread* thread : threads)
+			{
+				thread->join();
+				delete thread;
+			}
+			F64 elapsed = seconds_since(start);
+			U64 total = 0;
+			for (U64 read_bytes : thread_bytes)
+			{
+				total += read_bytes;
+			}
+			result.mReadMBps.push_back(total / elapsed / (1024 * 1024));
+		}
+
+		delete vfs;
+		LLFile::remove(index_filename, ENOENT);
+		LLFile::remove(index_filename + LLExtentVFS::getSpareIndexSuffix(), ENOENT);
+		LLFile::remove(data_filename, ENOENT);
+		return result;
+	}
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+	struct llvfsbench_data
+	{
+	};
+	typedef test_group<llvfsbench_data> llvfsbench_group;
+	typedef llvfsbench_group::object object;
+	llvfsbench_group llvfsbenchgrp("llvfsbench");
+
+	template<> template<>
+	void object::test<1>()
+	{
+		set_test_name("fill, churn and read throughput");
+		std::string base = std::string(LLFile::tmpdir()) + "llvfsbench_" + LLUUID::generateNewID().asString();
+		Result block = run(VFSBACKEND_BLOCK, base + "_block");
+		Result extent = run(VFSBACKEND_EXTENT, base + "_extent");
+
+		std::cout << std::endl << std::fixed << std::setprecision(1)
+			<< std::setw(24) << "" << std::setw(12) << "block" << std::setw(12) << "extent" << std::endl
+			<< std::setw(24) << "fill MB/s" << std::setw(12) << block.mFillMBps << std::setw(12) << extent.mFillMBps << std::endl
+			<< std::setw(24) << "churn replacements/s" << std::setw(12) << block.mChurnOpsps << std::setw(12) << extent.mChurnOpsps << std::endl;
+		S32 thread_count = 1;
+		for (size_t i = 0; i < block.mReadMBps.size(); ++i, thread_count *= 2)
+		{
+			std::cout << std::setw(16) << thread_count << " readers" << std::setw(12) << block.mReadMBps[i]
+				<< std::setw(12) << extent.mReadMBps[i] << " MB/s" << std::endl;
+		}
+	}
+}
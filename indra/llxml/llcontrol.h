@@ -285,15 +285,18 @@ public:
 //! without have to manually create and bind a listener to a local
 //! object.
 template <class T>
-class LLControlCache : public LLRefCount, public LLInstanceTracker<LLControlCache<T>, std::string>
+class LLControlCache : public LLRefCount,
+	public LLInstanceTracker<LLControlCache<T>, std::string, LLInstanceTrackerErrorOnCollision, LLInstanceTrackerHashed>
 {
+	// every LLCachedControl constructed looks its cache up by name
+	typedef LLInstanceTracker<LLControlCache<T>, std::string, LLInstanceTrackerErrorOnCollision, LLInstanceTrackerHashed> instance_tracker_t;
 public:
 	// This constructor will declare a control if it doesn't exist in the contol group
 	LLControlCache(LLControlGroup& group,
 					const std::string& name, 
 					const T& default_value, 
 					const std::string& comment)
-	:	LLInstanceTracker<LLControlCache<T>, std::string >(name)
+	:	instance_tracker_t(name)
 	{
 		if(!group.controlExists(name))
 		{
@@ -308,7 +311,7 @@ public:
 
 	LLControlCache(LLControlGroup& group,
 					const std::string& name)
-	:	LLInstanceTracker<LLControlCache<T>, std::string >(name)
+	:	instance_tracker_t(name)
 	{
 		if(!group.controlExists(name))
 		{
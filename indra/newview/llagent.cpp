@@ -39,6 +39,7 @@
 #include "llagentui.h"
 #include "llappearancemgr.h"
 #include "llanimationstates.h"
+#include "llassetprefetch.h"
 #include "llcallingcard.h"
 #include "llchannelmanager.h"
 #include "llchatutilities.h"
@@ -970,6 +971,9 @@ void LLAgent::setRegion(LLViewerRegion *regionp)
 	U64 handle = regionp->getHandle();
 	mRegionsVisited.insert(handle);
 
+	// the regions we might walk into next
+	LLWorld::getInstance()->prefetchObjectCaches(handle);
+
 	LLSelectMgr::getInstance()->updateSelectionCenter();
 
 	LLFloaterMove::sUpdateFlyingStatus();
@@ -4113,6 +4117,11 @@ void LLAgent::teleportRequest(
 		bool is_local = (region_handle == regionp->getHandle());
 		if (teleportCore(is_local))
 		{
+			if (!is_local)
+			{
+				LLAssetPrefetch::getInstance()->prefetchRegion(region_handle);
+			}
+
 			LLFloaterProgressView* pProgFloater = LLFloaterReg::getTypedInstance<LLFloaterProgressView>("progress_view");
 			LLSimInfo* info = LLWorldMap::getInstance()->simInfoFromHandle(region_handle);
 			pProgFloater->setRegion(info ? info->getName() : LLStringUtil::null);
@@ -4160,6 +4169,8 @@ void LLAgent::doTeleportViaLandmark(const LLUUID& landmark_asset_id)
 		msg->addUUIDFast(_PREHASH_SessionID, getSessionID());
 		msg->addUUIDFast(_PREHASH_LandmarkID, landmark_asset_id);
 		sendReliableMessage();
+
+		LLAssetPrefetch::getInstance()->prefetchLandmarkAsset(landmark_asset_id);
 	}
 }
 
@@ -4290,6 +4301,8 @@ void LLAgent::doTeleportViaLocation(const LLVector3d& pos_global)
 		pos.mV[VX] += 1;
 		msg->addVector3Fast(_PREHASH_LookAt, pos);
 		sendReliableMessage();
+
+		LLAssetPrefetch::getInstance()->prefetchLocation(pos_global);
 	}
 }
 
@@ -33,6 +33,7 @@
 #include "llappviewer.h"
 #include "llviewercontrol.h"
 #include "llexception.h"
+#include "lltrace.h"
 #include "stringize.h"
 
 #include <openssl/x509_vfy.h>
@@ -121,13 +122,63 @@ static const struct
 	}
 };
 
+// Classes whose concurrency adapts to the network when
+// 'HttpAdaptiveConcurrency' is set, with their statistics.  The
+// limit may go as high as the maximum of the class's setting.
+static struct
+{
+	LLAppCoreHttp::EAppPolicy					mPolicy;
+	LLTrace::SampleStatHandle<>					mLimit;
+	LLTrace::SampleStatHandle<F64Kilobytes>		mThroughput;
+	LLTrace::SampleStatHandle<F64Milliseconds>	mRequestTime;
+	LLTrace::SampleStatHandle<F32Percent>		mErrorRate;
+} adaptive_data[] =
+{
+	{
+		LLAppCoreHttp::AP_ASSET,
+		{ "httpassetlimit", "Asset fetch requests allowed in flight" },
+		{ "httpassetthroughput", "Asset fetch data received per second" },
+		{ "httpassettime", "Smoothed asset fetch request time" },
+		{ "httpasseterrors", "Asset fetches refused or timed out" }
+	},
+	{
+		LLAppCoreHttp::AP_TEXTURE,
+		{ "httptexturelimit", "Texture fetch requests allowed in flight" },
+		{ "httptexturethroughput", "Texture fetch data received per second" },
+		{ "httptexturetime", "Smoothed texture fetch request time" },
+		{ "httptextureerrors", "Texture fetches refused or timed out" }
+	},
+	{
+		LLAppCoreHttp::AP_MESH1,
+		{ "httpmeshlimit", "Mesh fetch requests allowed in flight" },
+		{ "httpmeshthroughput", "Mesh fetch data received per second" },
+		{ "httpmeshtime", "Smoothed mesh fetch request time" },
+		{ "httpmesherrors", "Mesh fetches refused or timed out" }
+	},
+	{
+		LLAppCoreHttp::AP_MESH2,
+		{ "httpmesh2limit", "Mesh2 fetch requests allowed in flight" },
+		{ "httpmesh2throughput", "Mesh2 fetch data received per second" },
+		{ "httpmesh2time", "Smoothed mesh2 fetch request time" },
+		{ "httpmesh2errors", "Mesh2 fetches refused or timed out" }
+	},
+	{
+		LLAppCoreHttp::AP_INVENTORY,
+		{ "httpinventorylimit", "Inventory requests allowed in flight" },
+		{ "httpinventorythroughput", "Inventory data received per second" },
+		{ "httpinventorytime", "Smoothed inventory request time" },
+		{ "httpinventoryerrors", "Inventory requests refused or timed out" }
+	}
+};
+
 static void setting_changed();
 
 
 LLAppCoreHttp::HttpClass::HttpClass()
 	: mPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
 	  mConnLimit(0U),
-	  mPipelined(false)
+	  mPipelined(false),
+	  mHttp2Streams(0L)
 {}
 
 
@@ -136,7 +187,9 @@ LLAppCoreHttp::LLAppCoreHttp()
 	  mStopHandle(LLCORE_HTTP_HANDLE_INVALID),
 	  mStopRequested(0.0),
 	  mStopped(false),
-	  mPipelined(true)
+	  mPipelined(true),
+	  mHttp2Streams(0L),
+	  mAdaptive(false)
 {}
 
 
@@ -265,6 +318,38 @@ void LLAppCoreHttp::init()
 		}
 	}
 
+	// Signal for HTTP/2 preference from settings
+	static const std::string http_http2_streams("HttpHttp2Streams");
+	if (gSavedSettings.controlExists(http_http2_streams))
+	{
+		LLPointer<LLControlVariable> cntrl_ptr = gSavedSettings.getControl(http_http2_streams);
+		if (cntrl_ptr.isNull())
+		{
+			LL_WARNS("Init") << "Unable to set signal on global setting '" << http_http2_streams
+							 << "'" << LL_ENDL;
+		}
+		else
+		{
+			mHttp2Signal = cntrl_ptr->getCommitSignal()->connect(boost::bind(&setting_changed));
+		}
+	}
+
+	// Signal for adaptive concurrency preference from settings
+	static const std::string http_adaptive("HttpAdaptiveConcurrency");
+	if (gSavedSettings.controlExists(http_adaptive))
+	{
+		LLPointer<LLControlVariable> cntrl_ptr = gSavedSettings.getControl(http_adaptive);
+		if (cntrl_ptr.isNull())
+		{
+			LL_WARNS("Init") << "Unable to set signal on global setting '" << http_adaptive
+							 << "'" << LL_ENDL;
+		}
+		else
+		{
+			mAdaptiveSignal = cntrl_ptr->getCommitSignal()->connect(boost::bind(&setting_changed));
+		}
+	}
+
 	// Register signals for settings and state changes
 	for (int i(0); i < LL_ARRAY_SIZE(init_data); ++i)
 	{
@@ -350,6 +435,8 @@ void LLAppCoreHttp::cleanup()
 		mHttpClasses[i].mSettingsSignal.disconnect();
 	}
 	mPipelinedSignal.disconnect();
+	mHttp2Signal.disconnect();
+	mAdaptiveSignal.disconnect();
 	
 	delete mRequest;
 	mRequest = nullptr;
@@ -384,6 +471,32 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 		}
         LL_INFOS("Init") << "HTTP Pipelining " << (mPipelined ? "enabled" : "disabled") << "!" << LL_ENDL;
 	}
+
+	// Global HTTP/2 setting, streams per connection or 0 for off
+	bool http2_changed(false);
+	static const std::string http_http2_streams("HttpHttp2Streams");
+	if (gSavedSettings.controlExists(http_http2_streams))
+	{
+		const long streams(long(gSavedSettings.getU32(http_http2_streams)));
+		if (streams != mHttp2Streams)
+		{
+			mHttp2Streams = streams;
+			http2_changed = true;
+		}
+	}
+
+	// Global adaptive concurrency setting
+	bool adaptive_changed(false);
+	static const std::string http_adaptive("HttpAdaptiveConcurrency");
+	if (gSavedSettings.controlExists(http_adaptive))
+	{
+		const bool adaptive(gSavedSettings.getBOOL(http_adaptive));
+		if (adaptive != mAdaptive)
+		{
+			mAdaptive = adaptive;
+			adaptive_changed = true;
+		}
+	}
 	
 	for (int i(0); i < LL_ARRAY_SIZE(init_data); ++i)
 	{
@@ -444,6 +557,35 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 			}
 		}
 		
+		// HTTP/2 changes.  Only for the classes that would pipeline,
+		// the others don't talk to CDNs.
+		if (initial || http2_changed)
+		{
+			const long to_streams(init_data[i].mPipelined ? mHttp2Streams : 0L);
+			if (to_streams != mHttpClasses[app_policy].mHttp2Streams)
+			{
+				LLCore::HttpHandle handle;
+				handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_HTTP2_STREAMS,
+												   mHttpClasses[app_policy].mPolicy,
+												   to_streams,
+												   LLCore::HttpHandler::ptr_t());
+				if (LLCORE_HTTP_HANDLE_INVALID == handle)
+				{
+					status = mRequest->getStatus();
+					LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
+									 << " HTTP/2 streams.  Reason:  " << status.toString()
+									 << LL_ENDL;
+				}
+				else
+				{
+					LL_DEBUGS("Init") << "Changed " << init_data[i].mUsage
+									  << " HTTP/2 streams.  New value:  " << to_streams
+									  << LL_ENDL;
+					mHttpClasses[app_policy].mHttp2Streams = to_streams;
+				}
+			}
+		}
+
 		// Get target connection concurrency value
 		U32 setting(init_data[i].mDefault);
 		if (! init_data[i].mKey.empty() && gSavedSettings.controlExists(init_data[i].mKey))
@@ -513,6 +655,59 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 			}
 		}
 	}
+
+	// Adaptive concurrency changes
+	if (initial || adaptive_changed)
+	{
+		for (int i(0); i < LL_ARRAY_SIZE(adaptive_data); ++i)
+		{
+			const EAppPolicy app_policy(adaptive_data[i].mPolicy);
+			const long ceiling(mAdaptive ? long(init_data[app_policy].mMax) : 0L);
+
+			LLCore::HttpHandle handle;
+			handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_ADAPTIVE_CONCURRENCY,
+											   mHttpClasses[app_policy].mPolicy,
+											   ceiling,
+											   LLCore::HttpHandler::ptr_t());
+			if (LLCORE_HTTP_HANDLE_INVALID == handle)
+			{
+				status = mRequest->getStatus();
+				LL_WARNS("Init") << "Unable to set " << init_data[app_policy].mUsage
+								 << " adaptive concurrency.  Reason:  " << status.toString()
+								 << LL_ENDL;
+			}
+			else
+			{
+				LL_DEBUGS("Init") << "Changed " << init_data[app_policy].mUsage
+								  << " adaptive concurrency.  New ceiling:  " << ceiling
+								  << LL_ENDL;
+			}
+		}
+	}
+}
+
+
+void LLAppCoreHttp::sampleStats()
+{
+	if (! mAdaptive || mStatsTimer.getElapsedTimeF32() < 1.f)
+	{
+		return;
+	}
+	mStatsTimer.reset();
+
+	for (int i(0); i < LL_ARRAY_SIZE(adaptive_data); ++i)
+	{
+		LLCore::HttpRequest::AdaptiveStats stats;
+		LLCore::HttpStatus status(LLCore::HttpRequest::getAdaptiveStats(mHttpClasses[adaptive_data[i].mPolicy].mPolicy,
+																		&stats));
+		if (status && stats.mEnabled)
+		{
+			sample(adaptive_data[i].mLimit, F64(stats.mLimit));
+			sample(adaptive_data[i].mThroughput, F64Bytes(stats.mThroughput));
+			sample(adaptive_data[i].mRequestTime, F64Seconds(stats.mRequestTime));
+			sample(adaptive_data[i].mErrorRate, F32Percent(F32(stats.mErrorRate * 100.0)));
+		}
+	}
 }
 
 LLCore::HttpStatus LLAppCoreHttp::sslVerify(const std::string &url, 
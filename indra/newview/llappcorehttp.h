@@ -31,6 +31,7 @@
 #include "httprequest.h"
 #include "httphandler.h"
 #include "httpresponse.h"
+#include "llframetimer.h"
 
 
 // This class manages the lifecyle of the core http library.
@@ -244,6 +245,11 @@ public:
 
 	// Apply initial or new settings from the environment.
 	void refreshSettings(bool initial);
+
+	// Record the adaptive concurrency state of the classes that
+	// have it in the viewer statistics.  Called every frame,
+	// samples once a second.
+	void sampleStats();
 	
 private:
 	static const F64			MAX_THREAD_WAIT_TIME;
@@ -260,6 +266,7 @@ private:
 		policy_t					mPolicy;			// Policy class id for the class
 		U32							mConnLimit;
 		bool						mPipelined;
+		long						mHttp2Streams;
 		boost::signals2::connection mSettingsSignal;	// Signal to global setting that affect this class (if any)
 	};
 		
@@ -270,6 +277,11 @@ private:
 	HttpClass					mHttpClasses[AP_COUNT];
 	bool						mPipelined;				// Global setting
 	boost::signals2::connection	mPipelinedSignal;		// Signal for 'HttpPipelining' setting
+	long						mHttp2Streams;			// Global setting
+	boost::signals2::connection	mHttp2Signal;			// Signal for 'HttpHttp2Streams' setting
+	bool						mAdaptive;				// Global setting
+	boost::signals2::connection	mAdaptiveSignal;		// Signal for 'HttpAdaptiveConcurrency' setting
+	LLFrameTimer				mStatsTimer;
 
 	static LLCore::HttpStatus	sslVerify(const std::string &uri, const LLCore::HttpHandler::ptr_t &handler, void *appdata);
 };
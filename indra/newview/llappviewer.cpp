@@ -66,6 +66,7 @@
 #include "lltexturestats.h"
 #include "lltrace.h"
 #include "lltracethreadrecorder.h"
+#include "lltracering.h"
 #include "llviewerwindow.h"
 #include "llviewerdisplay.h"
 #include "llviewermedia.h"
@@ -114,7 +115,9 @@
 #include "llurlaction.h"
 #include "llurlentry.h"
 #include "llvfile.h"
+#include "llsharedassetstore.h"
 #include "llvfsthread.h"
+#include "llextentvfs.h"
 #include "llvolumemgr.h"
 #include "llxfermanager.h"
 #include "llphysicsextensions.h"
@@ -151,6 +154,7 @@
 #include "llviewerkeyboard.h"
 #include "lllfsthread.h"
 #include "llworkerthread.h"
+#include "llthreadpool.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
 #include "llimageworker.h"
@@ -161,6 +165,7 @@
 #include "llworldmap.h"
 #include "llhudmanager.h"
 #include "lltoolmgr.h"
+#include "llassetprefetch.h"
 #include "llassetstorage.h"
 #include "llpolymesh.h"
 #include "llproxy.h"
@@ -443,6 +448,8 @@ void init_default_trans_args()
 // File scope definitons
 const char *VFS_DATA_FILE_BASE = "data.db2.x.";
 const char *VFS_INDEX_FILE_BASE = "index.db2.x.";
+const char *EXTENT_VFS_DATA_FILE_BASE = "data.db3.x.";
+const char *EXTENT_VFS_INDEX_FILE_BASE = "index.db3.x.";
 
 
 struct SettingsFile : public LLInitParam::Block<SettingsFile>
@@ -1756,6 +1763,12 @@ bool LLAppViewer::cleanup()
 
 	LL_INFOS() << "Cleaning Up" << LL_ENDL;
 
+	// let go of prefetched meshes before the volume manager goes away
+	if (LLAssetPrefetch::instanceExists())
+	{
+		LLAssetPrefetch::getInstance()->shutdown();
+	}
+
 	// shut down mesh streamer
 	gMeshRepo.shutdown();
 
@@ -2071,6 +2084,7 @@ bool LLAppViewer::cleanup()
 	SUBSYSTEM_CLEANUP(LLImage);
 	SUBSYSTEM_CLEANUP(LLVFSThread);
 	SUBSYSTEM_CLEANUP(LLLFSThread);
+	SUBSYSTEM_CLEANUP(LLThreadPool);
 
 #ifndef LL_RELEASE_FOR_DOWNLOAD
 	LL_INFOS() << "Auditing VFS" << LL_ENDL;
@@ -2088,6 +2102,13 @@ bool LLAppViewer::cleanup()
 	gStaticVFS = nullptr;
 	delete gVFS;
 	gVFS = nullptr;
+
+	if (gSharedAssetStore)
+	{
+		gSharedAssetStore->dumpStats();
+		delete gSharedAssetStore;
+		gSharedAssetStore = nullptr;
+	}
 	
 	gSavedSettings.cleanup();
 	LLUIColorTable::instance().clear();
@@ -2120,6 +2141,8 @@ bool LLAppViewer::cleanup()
 
 	LLMainLoopRepeater::instance().stop();
 
+	SUBSYSTEM_CLEANUP(LLTrace::EventRing);
+
 	ll_close_fail_log();
 
 	LLError::LLCallStacks::cleanup();
@@ -2186,11 +2209,20 @@ bool LLAppViewer::initThreads()
 	LLImage::initClass(gSavedSettings.getBOOL("TextureNewByteRange"),gSavedSettings.getS32("TextureReverseByteRange"));
 
 	LLVFSThread::initClass(enable_threads && false);
-	LLLFSThread::initClass(enable_threads && false);
+
+	// Recent block timer scopes of every thread, see Advanced > Dump Trace Events
+	LLTrace::EventRing::initClass(gSavedSettings.getU32("TraceRingEvents"));
+
+	// Shared workers for queued threads that do not need a thread of their own
+	LLThreadPool::initClass(gSavedSettings.getU32("ThreadPoolWorkers"));
+
+	// Local file I/O, which may run on the shared pool
+	LLLFSThread::initClass(enable_threads && false,
+						   (LLLFSThread::backend_t)llclamp(gSavedSettings.getU32("LocalFileIOBackend"), (U32)LLLFSThread::BACKEND_QUEUED, (U32)LLLFSThread::BACKEND_URING));
 
 	// Image decoding
-	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
-	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
+	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true, gSavedSettings.getU32("ImageDecodeThreads"));
+	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true, gSavedSettings.getU32("TextureCacheThreads"));
 	LLAppViewer::sTextureFetch = new LLTextureFetch(LLAppViewer::getTextureCache(),
 													sImageDecodeThread,
 													enable_threads && true,
@@ -4433,7 +4465,7 @@ U32 LLAppViewer::getObjectCacheVersion()
 {
 	// Viewer object cache version, change if object update
 	// format changes. JC
-	const U32 INDRA_OBJECT_CACHE_VERSION = 14;
+	const U32 INDRA_OBJECT_CACHE_VERSION = 15;
 
 	return INDRA_OBJECT_CACHE_VERSION;
 }
@@ -4562,7 +4594,19 @@ bool LLAppViewer::initCache()
 		} while(new_salt == old_salt);
 	}
 
-	old_vfs_data_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, VFS_DATA_FILE_BASE) + llformat("%u", old_salt);
+	// The two VFS backends keep their files under different names
+	const bool extent_vfs = gSavedSettings.getBOOL("VFSExtentStore");
+	const char* vfs_data_file_base = extent_vfs ? EXTENT_VFS_DATA_FILE_BASE : VFS_DATA_FILE_BASE;
+	const char* vfs_index_file_base = extent_vfs ? EXTENT_VFS_INDEX_FILE_BASE : VFS_INDEX_FILE_BASE;
+	if (!gSavedSettings.getBOOL("AllowMultipleViewers"))
+	{
+		// nothing else can be using the other backend's files, and they can be large
+		std::string dir = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "");
+		gDirUtilp->deleteFilesInDir(dir, std::string(extent_vfs ? VFS_DATA_FILE_BASE : EXTENT_VFS_DATA_FILE_BASE) + "*");
+		gDirUtilp->deleteFilesInDir(dir, std::string(extent_vfs ? VFS_INDEX_FILE_BASE : EXTENT_VFS_INDEX_FILE_BASE) + "*");
+	}
+
+	old_vfs_data_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, vfs_data_file_base) + llformat("%u", old_salt);
 
 	// make sure this file exists
 	llstat s;
@@ -4571,7 +4615,7 @@ bool LLAppViewer::initCache()
 	{
 		// doesn't exist, look for a data file
 		std::string mask;
-		mask = VFS_DATA_FILE_BASE;
+		mask = vfs_data_file_base;
 		mask += "*";
 
 		std::string dir;
@@ -4592,7 +4636,7 @@ bool LLAppViewer::initCache()
 		}
 	}
 
-	old_vfs_index_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, VFS_INDEX_FILE_BASE) + llformat("%u", old_salt);
+	old_vfs_index_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, vfs_index_file_base) + llformat("%u", old_salt);
 
 	stat_result = LLFile::stat(old_vfs_index_file, &s);
 	if (stat_result)
@@ -4608,19 +4652,19 @@ bool LLAppViewer::initCache()
 		dir = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "");
 
 		std::string mask;
-		mask = VFS_DATA_FILE_BASE;
+		mask = vfs_data_file_base;
 		mask += "*";
 
 		gDirUtilp->deleteFilesInDir(dir, mask);
 
-		mask = VFS_INDEX_FILE_BASE;
+		mask = vfs_index_file_base;
 		mask += "*";
 
 		gDirUtilp->deleteFilesInDir(dir, mask);
 	}
 
-	new_vfs_data_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, VFS_DATA_FILE_BASE) + llformat("%u", new_salt);
-	new_vfs_index_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, VFS_INDEX_FILE_BASE) + llformat("%u", new_salt);
+	new_vfs_data_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, vfs_data_file_base) + llformat("%u", new_salt);
+	new_vfs_index_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, vfs_index_file_base) + llformat("%u", new_salt);
 
 	static_vfs_data_file = gDirUtilp->getExpandedFilename(LL_PATH_APP_SETTINGS, "static_data.db2");
 	static_vfs_index_file = gDirUtilp->getExpandedFilename(LL_PATH_APP_SETTINGS, "static_index.db2");
@@ -4631,6 +4675,7 @@ bool LLAppViewer::initCache()
 		
 		LLFile::remove(old_vfs_data_file);
 		LLFile::remove(old_vfs_index_file);
+		LLFile::remove(old_vfs_index_file + LLExtentVFS::getSpareIndexSuffix(), ENOENT);
 	}
 	else if (old_salt != new_salt)
 	{
@@ -4639,13 +4684,29 @@ bool LLAppViewer::initCache()
 		LL_DEBUGS("AppCache") << "Renaming " << old_vfs_index_file << " to " << new_vfs_index_file << LL_ENDL;
 		LLFile::rename(old_vfs_data_file, new_vfs_data_file);
 		LLFile::rename(old_vfs_index_file, new_vfs_index_file);
+		if (extent_vfs)
+		{
+			// the journal alternates between both index files
+			LLFile::rename(old_vfs_index_file + LLExtentVFS::getSpareIndexSuffix(),
+						   new_vfs_index_file + LLExtentVFS::getSpareIndexSuffix());
+		}
 	}
 
 	// Startup the VFS...
 	gSavedSettings.setU32("VFSSalt", new_salt);
 
 	// Don't remove VFS after viewer crashes.  If user has corrupt data, they can reinstall. JC
-	gVFS = LLVFS::createLLVFS(new_vfs_index_file, new_vfs_data_file, false, vfs_size_u32, false);
+	gVFS = LLVFS::createLLVFS(new_vfs_index_file, new_vfs_data_file, false, vfs_size_u32, false,
+							  extent_vfs ? VFSBACKEND_EXTENT : VFSBACKEND_BLOCK);
+	if (!gVFS && extent_vfs)
+	{
+		// e.g. no room to map the data file; the block store works without.
+		// It has its own file names, the two formats can't share files.
+		LL_WARNS("AppCache") << "Unable to open the extent VFS, falling back to the block VFS" << LL_ENDL;
+		new_vfs_data_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, VFS_DATA_FILE_BASE) + llformat("%u", new_salt);
+		new_vfs_index_file = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, VFS_INDEX_FILE_BASE) + llformat("%u", new_salt);
+		gVFS = LLVFS::createLLVFS(new_vfs_index_file, new_vfs_data_file, false, vfs_size_u32, false);
+	}
 	if (!gVFS)
 	{
 		return false;
@@ -4666,6 +4727,27 @@ bool LLAppViewer::initCache()
 	{
 		LLVFile::initClass();
 
+		// Lives outside this install's cache so it survives purges and is
+		// shared with other installs, accounts and grids
+		U32 shared_cache_size = gSavedSettings.getU32("SharedAssetCacheSize");
+		if (shared_cache_size > 0)
+		{
+			std::string shared_cache_dir = gSavedSettings.getString("SharedAssetCacheLocation");
+			if (shared_cache_dir.empty())
+			{
+				const std::string& os_cache_dir = gDirUtilp->getOSCacheDir();
+				shared_cache_dir = os_cache_dir.empty() ?
+					gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "sharedassets") :
+					gDirUtilp->add(os_cache_dir, "SharedAssetCache");
+			}
+			gSharedAssetStore = new LLSharedAssetStore();
+			if (!gSharedAssetStore->open(shared_cache_dir, (U64)shared_cache_size * MB, false))
+			{
+				delete gSharedAssetStore;
+				gSharedAssetStore = nullptr;
+			}
+		}
+
 #ifndef LL_RELEASE_FOR_DOWNLOAD
 		if (gSavedSettings.getBOOL("DumpVFSCaches"))
 		{
@@ -4687,6 +4769,7 @@ void LLAppViewer::purgeCache()
 	LL_INFOS("AppCache") << "Purging Cache and Texture Cache..." << LL_ENDL;
 	LLAppViewer::getTextureCache()->purgeCache(LL_PATH_CACHE);
 	LLVOCache::getInstance()->removeCache(LL_PATH_CACHE);
+	LLMeshDecodeCache::removeCache();
 	std::string browser_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "cef_cache");
 	if (LLFile::isdir(browser_cache))
 	{
@@ -0,0 +1,504 @@
+/**
+ * @file llassetprefetch.cpp
+ * @brief Warms the texture and mesh caches for teleport destinations.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+#include "llassetprefetch.h"
+
+#include "llagent.h"
+#include "llappviewer.h"
+#include "llcallbacklist.h"
+#include "lldir.h"
+#include "llfile.h"
+#include "lllandmark.h"
+#include "lllandmarkactions.h"
+#include "lllandmarklist.h"
+#include "llmaterial.h"
+#include "llmeshrepository.h"
+#include "llregionhandle.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+#include "lltexturecache.h"
+#include "llviewercontrol.h"
+#include "llviewerobject.h"
+#include "llviewerobjectlist.h"
+#include "llviewerregion.h"
+#include "llviewertexture.h"
+#include "llvfs.h"
+#include "llvolumemgr.h"
+#include "llvovolume.h"
+#include "llworldmap.h"
+
+#include <algorithm>
+
+namespace
+{
+	const std::string PREFETCH_FILENAME("asset_prefetch.llsd");
+
+	const U32 MAX_REGIONS = 64;
+	const U32 MAX_REGION_TEXTURES = 512;
+	const U32 MAX_REGION_MESHES = 256;
+
+	// How often the agent's region is recorded, so that it is known even if
+	// the agent leaves it in a way that can't be seen coming.
+	const F32 RECORD_INTERVAL = 60.f;
+
+	// Virtual size the held textures ask for: enough to get a usable
+	// discard level decoded without competing with anything on screen.
+	const F32 PREFETCH_TEXTURE_VIRTUAL_SIZE = 64.f * 64.f;
+
+	typedef std::pair<LLUUID, U32> texture_count_t;
+	typedef std::pair<LLVolumeParams, std::pair<S32, U32> > mesh_count_t;
+
+	bool compare_texture_count(const texture_count_t& lhs, const texture_count_t& rhs)
+	{
+		return lhs.second > rhs.second;
+	}
+
+	bool compare_mesh_count(const mesh_count_t& lhs, const mesh_count_t& rhs)
+	{
+		return lhs.second.second > rhs.second.second;
+	}
+
+	U64 location_region_handle(const LLVector3d& pos_global)
+	{
+		LLSimInfo* info = LLWorldMap::getInstance()->simInfoFromPosGlobal(pos_global);
+		return info ? info->getHandle() : to_region_handle(pos_global);
+	}
+}
+
+LLAssetPrefetch::LLAssetPrefetch()
+:	mHeldHandle(0),
+	mHeldCachedOnly(false),
+	mShutdown(false)
+{
+}
+
+LLAssetPrefetch::~LLAssetPrefetch()
+{
+	mRegionChangedConnection.disconnect();
+	gIdleCallbacks.deleteFunction(onIdle, this);
+}
+
+void LLAssetPrefetch::initSingleton()
+{
+	load();
+
+	mRegionChangedConnection = gAgent.addRegionChangedCallback(boost::bind(&LLAssetPrefetch::onRegionChanged, this));
+	gIdleCallbacks.addFunction(onIdle, this);
+	mRecordTimer.reset();
+}
+
+void LLAssetPrefetch::shutdown()
+{
+	if (mShutdown)
+	{
+		return;
+	}
+	mShutdown = true;
+
+	recordRegion(gAgent.getRegion());
+	save();
+	releaseHeld();
+
+	mRegionChangedConnection.disconnect();
+	gIdleCallbacks.deleteFunction(onIdle, this);
+}
+
+//static
+void LLAssetPrefetch::onIdle(void* user_data)
+{
+	LLAssetPrefetch* self = (LLAssetPrefetch*)user_data;
+
+	if (self->mRecordTimer.getElapsedTimeF32() > RECORD_INTERVAL)
+	{
+		self->recordRegion(gAgent.getRegion());
+		self->mRecordTimer.reset();
+	}
+
+	if (self->mHeldHandle == 0)
+	{
+		return;
+	}
+
+	// the arrival region's objects have taken over whatever they use by now
+	if (self->mHoldTimer.getElapsedTimeF32() > gSavedSettings.getF32("AssetPrefetchHoldTime"))
+	{
+		self->releaseHeld();
+		return;
+	}
+
+	// texture stats are cleared every frame, so keep asking
+	for (std::vector<LLPointer<LLViewerFetchedTexture> >::iterator iter = self->mHeldTextures.begin();
+		 iter != self->mHeldTextures.end(); ++iter)
+	{
+		(*iter)->addTextureStats(PREFETCH_TEXTURE_VIRTUAL_SIZE);
+	}
+}
+
+void LLAssetPrefetch::onRegionChanged()
+{
+	// covers the arrivals nothing announced, such as lures and teleports
+	// home, and picks the assets up before the objects are rezzed
+	LLViewerRegion* regionp = gAgent.getRegion();
+	if (regionp)
+	{
+		prefetchRegion(regionp->getHandle());
+	}
+}
+
+void LLAssetPrefetch::prefetchLocation(const LLVector3d& pos_global)
+{
+	prefetchRegion(location_region_handle(pos_global));
+}
+
+void LLAssetPrefetch::prefetchLandmark(const LLUUID& landmark_item_id)
+{
+	// called for every tooltip, so no object list scan and no downloads
+	LLVector3d pos_global;
+	if (LLLandmarkActions::getLandmarkGlobalPos(landmark_item_id, pos_global))
+	{
+		startPrefetch(location_region_handle(pos_global), true);
+	}
+}
+
+void LLAssetPrefetch::prefetchLandmarkAsset(const LLUUID& landmark_asset_id)
+{
+	LLLandmark* landmark = gLandmarkList.getAsset(landmark_asset_id);
+	LLVector3d pos_global;
+	if (landmark && landmark->getGlobalPos(pos_global))
+	{
+		prefetchLocation(pos_global);
+	}
+}
+
+void LLAssetPrefetch::prefetchRegion(U64 region_handle)
+{
+	if (mShutdown || !gSavedSettings.getBOOL("AssetPrefetchEnabled"))
+	{
+		return;
+	}
+
+	if (region_handle != mHeldHandle || mHeldCachedOnly)
+	{
+		// the region being left is the one most likely to be returned to
+		LLViewerRegion* regionp = gAgent.getRegion();
+		if (regionp && regionp->getHandle() != region_handle)
+		{
+			recordRegion(regionp);
+		}
+	}
+
+	startPrefetch(region_handle, false);
+}
+
+void LLAssetPrefetch::startPrefetch(U64 region_handle, bool cached_only)
+{
+	if (mShutdown || !gSavedSettings.getBOOL("AssetPrefetchEnabled"))
+	{
+		return;
+	}
+
+	if (region_handle == mHeldHandle && (cached_only || !mHeldCachedOnly))
+	{
+		// hovering the same landmark again, or arriving where the teleport
+		// was prefetched for
+		mHoldTimer.reset();
+		return;
+	}
+
+	region_map_t::iterator found = mRegions.find(region_handle);
+	if (found == mRegions.end())
+	{
+		return;
+	}
+
+	releaseHeld();
+	mHeldHandle = region_handle;
+	mHeldCachedOnly = cached_only;
+	mHoldTimer.reset();
+
+	const RegionAssets& assets = found->second;
+	LLTextureCache* texture_cache = LLAppViewer::getTextureCache();
+
+	mHeldTextures.reserve(assets.mTextures.size());
+	for (uuid_vec_t::const_iterator iter = assets.mTextures.begin(); iter != assets.mTextures.end(); ++iter)
+	{
+		// the small size asked for is covered by what the cache keeps
+		if (cached_only && !(texture_cache && texture_cache->isInCache(*iter)))
+		{
+			continue;
+		}
+
+		LLViewerFetchedTexture* texture = LLViewerTextureManager::getFetchedTexture(*iter, FTT_DEFAULT, TRUE, LLGLTexture::BOOST_NONE, LLViewerTexture::LOD_TEXTURE);
+		if (texture)
+		{
+			texture->addTextureStats(PREFETCH_TEXTURE_VIRTUAL_SIZE);
+			mHeldTextures.push_back(texture);
+		}
+	}
+
+	U32 queued_meshes = 0;
+	mHeldVolumes.reserve(assets.mMeshes.size());
+	for (std::vector<MeshEntry>::const_iterator iter = assets.mMeshes.begin(); iter != assets.mMeshes.end(); ++iter)
+	{
+		if (cached_only && !gVFS->getExists(iter->mParams.getSculptID(), LLAssetType::AT_MESH))
+		{
+			continue;
+		}
+
+		// holding the system volume keeps the LOD decoded until the
+		// objects using it show up
+		LLVolume* volume = LLPrimitive::getVolumeManager()->refVolume(iter->mParams, iter->mLOD);
+		if (!volume)
+		{
+			continue;
+		}
+		mHeldVolumes.push_back(volume);
+
+		if (!volume->isMeshAssetLoaded() && gMeshRepo.prefetchMesh(iter->mParams, iter->mLOD))
+		{
+			++queued_meshes;
+		}
+	}
+
+	LL_DEBUGS("AssetPrefetch") << "Prefetching " << mHeldTextures.size() << " textures and "
+							   << queued_meshes << " meshes for region " << region_handle << LL_ENDL;
+}
+
+void LLAssetPrefetch::releaseHeld()
+{
+	mHeldTextures.clear();
+
+	LLVolumeMgr* volume_mgr = LLPrimitive::getVolumeManager();
+	if (volume_mgr)
+	{
+		for (std::vector<LLVolume*>::iterator iter = mHeldVolumes.begin(); iter != mHeldVolumes.end(); ++iter)
+		{
+			volume_mgr->unrefVolume(*iter);
+		}
+	}
+	mHeldVolumes.clear();
+
+	mHeldHandle = 0;
+	mHeldCachedOnly = false;
+}
+
+void LLAssetPrefetch::recordRegion(LLViewerRegion* regionp)
+{
+	if (!regionp || mShutdown || !gSavedSettings.getBOOL("AssetPrefetchEnabled"))
+	{
+		return;
+	}
+
+	std::map<LLUUID, U32> texture_counts;
+	std::map<LLVolumeParams, std::pair<S32, U32> > mesh_counts;
+
+	S32 num_objects = gObjectList.getNumObjects();
+	for (S32 i = 0; i < num_objects; ++i)
+	{
+		LLViewerObject* objectp = gObjectList.getObject(i);
+		if (!objectp || objectp->isDead() || objectp->getRegion() != regionp
+			|| objectp->getPCode() != LL_PCODE_VOLUME || objectp->isAttachment())
+		{
+			continue;
+		}
+
+		for (U8 te = 0; te < objectp->getNumTEs(); ++te)
+		{
+			const LLTextureEntry* entry = objectp->getTE(te);
+			if (!entry)
+			{
+				continue;
+			}
+			if (entry->getID().notNull())
+			{
+				++texture_counts[entry->getID()];
+			}
+			const LLMaterialPtr material = entry->getMaterialParams();
+			if (material.notNull())
+			{
+				if (material->getNormalID().notNull())
+				{
+					++texture_counts[material->getNormalID()];
+				}
+				if (material->getSpecularID().notNull())
+				{
+					++texture_counts[material->getSpecularID()];
+				}
+			}
+		}
+
+		LLVOVolume* volobjp = (LLVOVolume*)objectp;
+		LLVolume* volume = volobjp->getVolume();
+		if (volume && volobjp->isMesh())
+		{
+			std::pair<S32, U32>& mesh = mesh_counts[volume->getParams()];
+			mesh.first = llmax(mesh.first, volobjp->getLOD());
+			++mesh.second;
+		}
+	}
+
+	if (texture_counts.empty() && mesh_counts.empty())
+	{
+		// nothing rezzed yet, keep what was there before
+		return;
+	}
+
+	std::vector<texture_count_t> textures(texture_counts.begin(), texture_counts.end());
+	std::sort(textures.begin(), textures.end(), compare_texture_count);
+
+	std::vector<mesh_count_t> meshes(mesh_counts.begin(), mesh_counts.end());
+	std::sort(meshes.begin(), meshes.end(), compare_mesh_count);
+
+	RegionAssets& assets = mRegions[regionp->getHandle()];
+	RegionAssets previous;
+	previous.mTextures.swap(assets.mTextures);
+	previous.mMeshes.swap(assets.mMeshes);
+	assets.mLastVisit = (U32)time(NULL);
+
+	// what is in view now comes first, then what was seen on earlier
+	// visits and may just not have been rezzed this time
+	std::set<LLUUID> seen_textures;
+	for (U32 i = 0; i < textures.size() && assets.mTextures.size() < MAX_REGION_TEXTURES; ++i)
+	{
+		assets.mTextures.push_back(textures[i].first);
+		seen_textures.insert(textures[i].first);
+	}
+	for (U32 i = 0; i < previous.mTextures.size() && assets.mTextures.size() < MAX_REGION_TEXTURES; ++i)
+	{
+		if (seen_textures.insert(previous.mTextures[i]).second)
+		{
+			assets.mTextures.push_back(previous.mTextures[i]);
+		}
+	}
+
+	for (U32 i = 0; i < meshes.size() && assets.mMeshes.size() < MAX_REGION_MESHES; ++i)
+	{
+		MeshEntry entry;
+		entry.mParams = meshes[i].first;
+		entry.mLOD = meshes[i].second.first;
+		assets.mMeshes.push_back(entry);
+	}
+	for (U32 i = 0; i < previous.mMeshes.size() && assets.mMeshes.size() < MAX_REGION_MESHES; ++i)
+	{
+		if (mesh_counts.find(previous.mMeshes[i].mParams) == mesh_counts.end())
+		{
+			assets.mMeshes.push_back(previous.mMeshes[i]);
+		}
+	}
+
+	while (mRegions.size() > MAX_REGIONS)
+	{
+		region_map_t::iterator oldest = mRegions.begin();
+		for (region_map_t::iterator iter = mRegions.begin(); iter != mRegions.end(); ++iter)
+		{
+			if (iter->second.mLastVisit < oldest->second.mLastVisit)
+			{
+				oldest = iter;
+			}
+		}
+		mRegions.erase(oldest);
+	}
+}
+
+void LLAssetPrefetch::load()
+{
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_PER_SL_ACCOUNT, PREFETCH_FILENAME);
+	llifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	LLSD data;
+	if (LLSDSerialize::fromBinary(data, file, LLSDSerialize::SIZE_UNLIMITED) == LLSDParser::PARSE_FAILURE)
+	{
+		LL_WARNS() << "Ignoring unreadable " << filename << LL_ENDL;
+		return;
+	}
+
+	for (LLSD::array_iterator region_iter = data.beginArray(); region_iter != data.endArray(); ++region_iter)
+	{
+		LLSD& region = *region_iter;
+		RegionAssets& assets = mRegions[ll_U64_from_sd(region["handle"])];
+		assets.mLastVisit = (U32)region["last_visit"].asInteger();
+
+		for (LLSD::array_iterator iter = region["textures"].beginArray(); iter != region["textures"].endArray(); ++iter)
+		{
+			assets.mTextures.push_back(iter->asUUID());
+		}
+		for (LLSD::array_iterator iter = region["meshes"].beginArray(); iter != region["meshes"].endArray(); ++iter)
+		{
+			MeshEntry entry;
+			if (entry.mParams.fromLLSD((*iter)["params"]))
+			{
+				entry.mLOD = llclamp((*iter)["lod"].asInteger(), 0, 3);
+				assets.mMeshes.push_back(entry);
+			}
+		}
+	}
+}
+
+void LLAssetPrefetch::save() const
+{
+	LLSD data = LLSD::emptyArray();
+	for (region_map_t::const_iterator region_iter = mRegions.begin(); region_iter != mRegions.end(); ++region_iter)
+	{
+		const RegionAssets& assets = region_iter->second;
+
+		LLSD region;
+		region["handle"] = ll_sd_from_U64(region_iter->first);
+		region["last_visit"] = (LLSD::Integer)assets.mLastVisit;
+
+		LLSD textures = LLSD::emptyArray();
+		for (uuid_vec_t::const_iterator iter = assets.mTextures.begin(); iter != assets.mTextures.end(); ++iter)
+		{
+			textures.append(*iter);
+		}
+		region["textures"] = textures;
+
+		LLSD meshes = LLSD::emptyArray();
+		for (std::vector<MeshEntry>::const_iterator iter = assets.mMeshes.begin(); iter != assets.mMeshes.end(); ++iter)
+		{
+			LLSD mesh;
+			mesh["params"] = iter->mParams.asLLSD();
+			mesh["lod"] = iter->mLOD;
+			meshes.append(mesh);
+		}
+		region["meshes"] = meshes;
+
+		data.append(region);
+	}
+
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_PER_SL_ACCOUNT, PREFETCH_FILENAME);
+	llofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+	if (!file.is_open())
+	{
+		LL_WARNS() << "Can't write " << filename << LL_ENDL;
+		return;
+	}
+	LLSDSerialize::toBinary(data, file);
+}
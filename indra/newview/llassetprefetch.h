@@ -0,0 +1,121 @@
+/**
+ * @file llassetprefetch.h
+ * @brief Warms the texture and mesh caches for teleport destinations.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLASSETPREFETCH_H
+#define LL_LLASSETPREFETCH_H
+
+#include "llframetimer.h"
+#include "llpointer.h"
+#include "llsingleton.h"
+#include "lluuid.h"
+#include "llvolume.h"
+
+#include <boost/signals2.hpp>
+#include <map>
+#include <vector>
+
+class LLViewerFetchedTexture;
+class LLViewerRegion;
+class LLVector3d;
+
+// Remembers which textures and meshes each visited region showed, and when
+// the agent is about to go back there (a teleport is requested) starts
+// loading them, so they come out of the caches while the teleport is under
+// way instead of after arrival. Hovering a landmark to the region only warms
+// up what the caches hold.
+//
+// Textures are requested at a small virtual size, which keeps them behind
+// anything on screen. Mesh LODs are queued through
+// LLMeshRepository::prefetchMesh(), which sorts them after the LODs objects
+// are waiting for. Both are held until a while after the teleport, long
+// enough for the region's objects to take them over.
+class LLAssetPrefetch : public LLSingleton<LLAssetPrefetch>
+{
+	LLSINGLETON(LLAssetPrefetch);
+	~LLAssetPrefetch();
+	LOG_CLASS(LLAssetPrefetch);
+
+public:
+	// Starts loading what was last seen in the region, if anything.
+	void prefetchRegion(U64 region_handle);
+	void prefetchLocation(const LLVector3d& pos_global);
+	// For a hovered landmark, so it only reads and decodes what the local
+	// caches already hold: nothing is downloaded and the current region is
+	// not recorded. Landmarks whose asset isn't loaded yet are ignored.
+	void prefetchLandmark(const LLUUID& landmark_item_id);
+	void prefetchLandmarkAsset(const LLUUID& landmark_asset_id);
+
+	// Remembers the textures and meshes of the region's objects.
+	void recordRegion(LLViewerRegion* regionp);
+
+	// Saves the recorded regions and lets go of everything held. Must be
+	// called before the volume manager goes away.
+	void shutdown();
+
+private:
+	void initSingleton() override;
+
+	static void onIdle(void* user_data);
+	void onRegionChanged();
+
+	// cached_only leaves out the assets that would have to be downloaded
+	void startPrefetch(U64 region_handle, bool cached_only);
+	void releaseHeld();
+
+	void load();
+	void save() const;
+
+	struct MeshEntry
+	{
+		LLVolumeParams mParams;
+		S32 mLOD;
+	};
+
+	struct RegionAssets
+	{
+		RegionAssets() : mLastVisit(0) {}
+
+		uuid_vec_t mTextures;			// most used first
+		std::vector<MeshEntry> mMeshes;	// most used first
+		U32 mLastVisit;
+	};
+
+	typedef std::map<U64, RegionAssets> region_map_t;
+	region_map_t mRegions;
+
+	// what the last prefetch is keeping loaded
+	U64 mHeldHandle;
+	bool mHeldCachedOnly;
+	std::vector<LLPointer<LLViewerFetchedTexture> > mHeldTextures;
+	std::vector<LLVolume*> mHeldVolumes;
+	LLFrameTimer mHoldTimer;
+
+	LLFrameTimer mRecordTimer;
+	boost::signals2::connection mRegionChangedConnection;
+	bool mShutdown;
+};
+
+#endif // LL_LLASSETPREFETCH_H
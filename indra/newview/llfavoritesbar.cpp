@@ -29,6 +29,7 @@
 #include "llviewerprecompiledheaders.h"
 #include "llfavoritesbar.h"
 
+#include "llassetprefetch.h"
 #include "llfloaterreg.h"
 #include "llfocusmgr.h"
 #include "llinventory.h"
@@ -162,6 +163,9 @@ public:
 
 	BOOL handleToolTip(S32 x, S32 y, MASK mask)
 	{
+		// a hovered favorite is a likely teleport destination
+		LLAssetPrefetch::getInstance()->prefetchLandmark(mLandmarkInfoGetter.getLandmarkId());
+
 		std::string region_name = mLandmarkInfoGetter.getName();
 		
 		if (!region_name.empty())
@@ -226,6 +230,8 @@ class LLFavoriteLandmarkMenuItem : public LLMenuItemCallGL
 public:
 	BOOL handleToolTip(S32 x, S32 y, MASK mask)
 	{
+		LLAssetPrefetch::getInstance()->prefetchLandmark(mLandmarkInfoGetter.getLandmarkId());
+
 		std::string region_name = mLandmarkInfoGetter.getName();
 		if (!region_name.empty())
 		{
@@ -33,6 +33,7 @@
 #include "llbutton.h"
 #include "llspinctrl.h"
 
+#include "lldir.h"
 #include "llmath.h"
 #include "llviewerwindow.h"
 #include "llappviewer.h"
@@ -50,6 +51,8 @@ LLFloaterTextureFetchDebugger::LLFloaterTextureFetchDebugger(const LLSD& key)
 	mCommitCallbackRegistrar.add("TexFetchDebugger.Start",	boost::bind(&LLFloaterTextureFetchDebugger::onClickStart, this));
 	mCommitCallbackRegistrar.add("TexFetchDebugger.Clear",	boost::bind(&LLFloaterTextureFetchDebugger::onClickClear, this));
 	mCommitCallbackRegistrar.add("TexFetchDebugger.Close",	boost::bind(&LLFloaterTextureFetchDebugger::onClickClose, this));
+	mCommitCallbackRegistrar.add("TexFetchDebugger.SaveTrace",	boost::bind(&LLFloaterTextureFetchDebugger::onClickSaveTrace, this));
+	mCommitCallbackRegistrar.add("TexFetchDebugger.LoadTrace",	boost::bind(&LLFloaterTextureFetchDebugger::onClickLoadTrace, this));
 
 	mCommitCallbackRegistrar.add("TexFetchDebugger.CacheRead",	boost::bind(&LLFloaterTextureFetchDebugger::onClickCacheRead, this));
 	mCommitCallbackRegistrar.add("TexFetchDebugger.CacheWrite",	boost::bind(&LLFloaterTextureFetchDebugger::onClickCacheWrite, this));
@@ -73,6 +76,8 @@ BOOL LLFloaterTextureFetchDebugger::postBuild(void)
 	mButtonStateMap["start_btn"] = true;
 	mButtonStateMap["close_btn"] = true;
 	mButtonStateMap["clear_btn"] = true;
+	mButtonStateMap["savetrace_btn"] = true;
+	mButtonStateMap["loadtrace_btn"] = true;
 	mButtonStateMap["cacheread_btn"] = false;
 	mButtonStateMap["cachewrite_btn"] = false;
 	mButtonStateMap["http_btn"] = false;
@@ -116,6 +121,8 @@ void LLFloaterTextureFetchDebugger::disableButtons()
 {
 	childDisable("start_btn");
 	childDisable("clear_btn");
+	childDisable("savetrace_btn");
+	childDisable("loadtrace_btn");
 	childDisable("cacheread_btn");
 	childDisable("cachewrite_btn");
 	childDisable("http_btn");
@@ -228,6 +235,29 @@ void LLFloaterTextureFetchDebugger::onClickClose()
 	delete this;
 }
 
+//static
+std::string LLFloaterTextureFetchDebugger::getTraceFilename()
+{
+	return gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "texture_fetch_trace.xml");
+}
+
+void LLFloaterTextureFetchDebugger::onClickSaveTrace()
+{
+	mDebugger->saveTrace(getTraceFilename());
+}
+
+// A loaded trace can be replayed against the cache right away
+void LLFloaterTextureFetchDebugger::onClickLoadTrace()
+{
+	if (mDebugger->loadTrace(getTraceFilename()))
+	{
+		mButtonStateMap["cacheread_btn"] = true;
+		mButtonStateMap["decode_btn"] = false;
+		mButtonStateMap["gl_btn"] = false;
+		updateButtons();
+	}
+}
+
 void LLFloaterTextureFetchDebugger::onClickClear()
 {
 	mButtonStateMap["start_btn"] = true;
@@ -44,6 +44,8 @@ public:
 	void onClickStart();
 	void onClickClear();
 	void onClickClose();
+	void onClickSaveTrace();
+	void onClickLoadTrace();
 
 	void onClickCacheRead();
 	void onClickCacheWrite();
@@ -67,6 +69,7 @@ private:
 
 	void setStartStatus(S32 status);
 	bool idleStart();
+	static std::string getTraceFilename();
 private:	
 	LLTextureFetchDebugger* mDebugger;
 	std::map<std::string, bool> mButtonStateMap;
@@ -58,6 +58,7 @@
 #include "llcallbacklist.h"
 #include "llvoavatarself.h"
 #include "llgesturemgr.h"
+#include "llsdserialize.h"
 #include "llsdutil.h"
 #include "bufferarray.h"
 #include "bufferstream.h"
@@ -2013,46 +2014,133 @@ bool LLInventoryModel::loadSkeleton(
 {
 	LL_DEBUGS(LOG_INV) << "importing inventory skeleton for " << owner_id << LL_ENDL;
 
-	typedef std::set<LLPointer<LLViewerInventoryCategory>, InventoryIDPtrLess> cat_set_t;
-	cat_set_t temp_cats;
+	cat_array_t folders;
+	folders.reserve(options.size());
 	bool rv = true;
 
 	for(LLSD::array_const_iterator it = options.beginArray(),
 		    end = options.endArray(); it != end; ++it)
 	{
-		LLSD name = (*it)["name"];
-		LLSD folder_id = (*it)["folder_id"];
-		LLSD parent_id = (*it)["parent_id"];
-		LLSD version = (*it)["version"];
-		if(name.isDefined()
-			&& folder_id.isDefined()
-			&& parent_id.isDefined()
-			&& version.isDefined()
-			&& folder_id.asUUID().notNull() // if an id is null, it locks the viewer.
-		) 		
-		{
-			LLPointer<LLViewerInventoryCategory> cat = new LLViewerInventoryCategory(owner_id);
-			cat->rename(name.asString());
-			cat->setUUID(folder_id.asUUID());
-			cat->setParent(parent_id.asUUID());
-
-			LLFolderType::EType preferred_type = LLFolderType::FT_NONE;
-			LLSD type_default = (*it)["type_default"];
-			if(type_default.isDefined())
-			{
-				preferred_type = (LLFolderType::EType)type_default.asInteger();
-			}
-			cat->setPreferredType(preferred_type);
-			cat->setVersion(version.asInteger());
-			temp_cats.insert(cat);
-		}
-		else
+		if (!addSkeletonFolder(*it, owner_id, folders))
 		{
-			LL_WARNS(LOG_INV) << "Unable to import near " << name.asString() << LL_ENDL;
 			rv = false;
 		}
 	}
 
+	loadSkeletonCache(folders, owner_id);
+	return rv;
+}
+
+// Hands each folder map of a skeleton array to addSkeletonFolder() as soon
+// as it has been read, so only one folder is ever held as LLSD.
+class LLInventoryModel::SkeletonReader : public LLSDXMLParser::Handler
+{
+public:
+	SkeletonReader(const LLUUID& owner_id, cat_array_t& folders)
+	:	mOwnerID(owner_id),
+		mFolders(folders),
+		mDepth(0),
+		mValid(true)
+	{}
+
+	EAction beginArray() override
+	{
+		// only the outer array holds folders
+		if (mDepth > 0)
+		{
+			return SKIP;
+		}
+		++mDepth;
+		return DESCEND;
+	}
+	void endArray() override
+	{
+		--mDepth;
+	}
+	EAction beginMap() override
+	{
+		return (mDepth == 1) ? COLLECT : SKIP;
+	}
+	void value(const LLSD& folder) override
+	{
+		if (mDepth == 1 && !addSkeletonFolder(folder, mOwnerID, mFolders))
+		{
+			mValid = false;
+		}
+	}
+
+	bool isValid() const { return mValid; }
+
+private:
+	const LLUUID& mOwnerID;
+	cat_array_t& mFolders;
+	S32 mDepth;
+	bool mValid;
+};
+
+bool LLInventoryModel::loadSkeleton(
+	std::istream& skeleton_xml,
+	const LLUUID& owner_id)
+{
+	LL_DEBUGS(LOG_INV) << "streaming inventory skeleton for " << owner_id << LL_ENDL;
+
+	cat_array_t folders;
+	SkeletonReader reader(owner_id, folders);
+	if (LLSDSerialize::fromXMLEvents(reader, skeleton_xml) == LLSDParser::PARSE_FAILURE)
+	{
+		LL_WARNS(LOG_INV) << "Unable to parse inventory skeleton for " << owner_id << LL_ENDL;
+		return false;
+	}
+
+	loadSkeletonCache(folders, owner_id);
+	return reader.isValid();
+}
+
+// static
+bool LLInventoryModel::addSkeletonFolder(
+	const LLSD& folder,
+	const LLUUID& owner_id,
+	cat_array_t& folders)
+{
+	LLSD name = folder["name"];
+	LLSD folder_id = folder["folder_id"];
+	LLSD parent_id = folder["parent_id"];
+	LLSD version = folder["version"];
+	if(name.isDefined()
+		&& folder_id.isDefined()
+		&& parent_id.isDefined()
+		&& version.isDefined()
+		&& folder_id.asUUID().notNull() // if an id is null, it locks the viewer.
+	) 		
+	{
+		LLPointer<LLViewerInventoryCategory> cat = new LLViewerInventoryCategory(owner_id);
+		cat->rename(name.asString());
+		cat->setUUID(folder_id.asUUID());
+		cat->setParent(parent_id.asUUID());
+
+		LLFolderType::EType preferred_type = LLFolderType::FT_NONE;
+		LLSD type_default = folder["type_default"];
+		if(type_default.isDefined())
+		{
+			preferred_type = (LLFolderType::EType)type_default.asInteger();
+		}
+		cat->setPreferredType(preferred_type);
+		cat->setVersion(version.asInteger());
+		folders.push_back(cat);
+		return true;
+	}
+
+	LL_WARNS(LOG_INV) << "Unable to import near " << name.asString() << LL_ENDL;
+	return false;
+}
+
+void LLInventoryModel::loadSkeletonCache(
+	const cat_array_t& folders,
+	const LLUUID& owner_id)
+{
+	typedef std::set<LLPointer<LLViewerInventoryCategory>, InventoryIDPtrLess> cat_set_t;
+	cat_set_t temp_cats(folders.begin(), folders.end());
+
 	S32 cached_category_count = 0;
 	S32 cached_item_count = 0;
 	if(!temp_cats.empty())
@@ -2280,8 +2368,6 @@ bool LLInventoryModel::loadSkeleton(
 	LL_INFOS(LOG_INV) << "Successfully loaded " << cached_category_count
 		<< " categories and " << cached_item_count << " items from cache."
 		<< LL_ENDL;
-
-	return rv;
 }
 
 // This is a brute force method to rebuild the entire parent-child
@@ -153,6 +153,9 @@ public:
 	// Methods to load up inventory skeleton & meat. These are used
 	// during authentication. Returns true if everything parsed.
 	bool loadSkeleton(const LLSD& options, const LLUUID& owner_id);
+	// Same, but reads the skeleton array from an LLSD XML document one
+	// folder at a time instead of from an already parsed LLSD.
+	bool loadSkeleton(std::istream& skeleton_xml, const LLUUID& owner_id);
 	void buildParentChildMap(); // brute force method to rebuild the entire parent-child relations
 	void createCommonSystemCategories();
 
@@ -161,6 +164,13 @@ public:
 	// Call on logout to save a terse representation.
 	void cache(const LLUUID& parent_folder_id, const LLUUID& agent_id);
 private:
+	// Adds one skeleton folder to folders; returns false if it was malformed.
+	static bool addSkeletonFolder(const LLSD& folder, const LLUUID& owner_id, cat_array_t& folders);
+	// Adds the skeleton folders to the model, along with whatever the
+	// local inventory cache still has for them.
+	void loadSkeletonCache(const cat_array_t& folders, const LLUUID& owner_id);
+	class SkeletonReader;
+
 	// Information for tracking the actual inventory. We index this
 	// information in a lot of different ways so we can access
 	// the inventory using several different identifiers.
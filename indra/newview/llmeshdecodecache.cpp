@@ -0,0 +1,275 @@
+/**
+ * @file llmeshdecodecache.cpp
+ * @brief On-disk cache of decoded mesh LODs.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+#include "llmeshdecodecache.h"
+
+#include "lldir.h"
+#include "lldiriterator.h"
+#include "llfile.h"
+#include "llmappedfile.h"
+#include "llvolume.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+namespace
+{
+	const U32 MESH_DECODE_CACHE_MAGIC = 0x4344454d; // "MEDC"
+
+	// Bump whenever the layout written by LLVolume::packDecodedFaces() or
+	// the decoding in LLVolume::unpackVolumeFaces() changes.
+	const U32 MESH_DECODE_CACHE_VERSION = 1;
+
+	// Sized so the packed faces that follow stay 16-byte aligned.
+	struct LLMeshDecodeCacheHeader
+	{
+		U32 mMagic;
+		U32 mVersion;
+		U8 mMeshID[UUID_BYTES];
+		S32 mLOD;
+		U32 mSculptFlags;
+		S32 mSourceSize;
+		U32 mDataSize;
+		U32 mPad[2];
+	};
+
+	struct LLMeshDecodeCacheFile
+	{
+		std::string mName;
+		time_t mTime;
+		U64 mSize;
+
+		bool operator<(const LLMeshDecodeCacheFile& rhs) const
+		{
+			return mTime < rhs.mTime;
+		}
+	};
+}
+
+LLMeshDecodeCache::LLMeshDecodeCache()
+:	mMaxBytes(0),
+	mBytes(0)
+{
+}
+
+//static
+std::string LLMeshDecodeCache::getCacheDir()
+{
+	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "meshdecode");
+}
+
+//static
+void LLMeshDecodeCache::removeCache()
+{
+	std::string dir = getCacheDir();
+	if (LLFile::isdir(dir))
+	{
+		gDirUtilp->deleteDirAndContents(dir);
+	}
+}
+
+void LLMeshDecodeCache::init()
+{
+	if (!isEnabled())
+	{
+		return;
+	}
+
+	mDir = getCacheDir();
+	if (!LLFile::isdir(mDir))
+	{
+		LLFile::mkdir(mDir);
+	}
+
+	// leftovers of writes that were interrupted
+	gDirUtilp->deleteFilesInDir(mDir, "*.tmp");
+
+	trim();
+}
+
+std::string LLMeshDecodeCache::getFilename(const LLVolumeParams& mesh_params, S32 lod) const
+{
+	U32 flags = mesh_params.getSculptType() & LL_SCULPT_FLAG_MASK;
+	return mDir + gDirUtilp->getDirDelimiter() + mesh_params.getSculptID().asString() + llformat("_%d_%u.mdc", lod, flags);
+}
+
+bool LLMeshDecodeCache::read(const LLVolumeParams& mesh_params, S32 lod, S32 source_size, LLVolume* volume)
+{
+	if (!isEnabled() || mDir.empty())
+	{
+		return false;
+	}
+
+	std::string filename = getFilename(mesh_params, lod);
+	if (!LLFile::isfile(filename))
+	{
+		return false;
+	}
+
+	LLMappedFile file;
+	if (!file.open(filename, sizeof(LLMeshDecodeCacheHeader), false))
+	{
+		return false;
+	}
+
+	LLMeshDecodeCacheHeader header;
+	memcpy(&header, file.getData(), sizeof(header));
+
+	bool valid = header.mMagic == MESH_DECODE_CACHE_MAGIC
+		&& header.mVersion == MESH_DECODE_CACHE_VERSION
+		&& !memcmp(header.mMeshID, mesh_params.getSculptID().mData, UUID_BYTES)
+		&& header.mLOD == lod
+		&& header.mSculptFlags == (U32)(mesh_params.getSculptType() & LL_SCULPT_FLAG_MASK)
+		&& header.mSourceSize == source_size
+		&& header.mDataSize <= file.getSize() - sizeof(header);
+
+	if (valid)
+	{
+		valid = volume->unpackDecodedFaces(file.getData() + sizeof(header), header.mDataSize);
+	}
+	file.close();
+
+	if (!valid)
+	{
+		LL_DEBUGS("Mesh") << "Discarding stale decoded mesh " << filename << LL_ENDL;
+		LLFile::remove(filename);
+	}
+	else
+	{
+		// trim() goes by modification time, bump it so entries still in use
+		// are the last to go
+		boost::system::error_code ec;
+#ifndef LL_WINDOWS
+		boost::filesystem::last_write_time(boost::filesystem::path(filename), time(NULL), ec);
+#else
+		boost::filesystem::last_write_time(boost::filesystem::path(utf8str_to_utf16str(filename)), time(NULL), ec);
+#endif
+	}
+
+	return valid;
+}
+
+void LLMeshDecodeCache::write(const LLVolumeParams& mesh_params, S32 lod, S32 source_size, const LLVolume* volume)
+{
+	if (!isEnabled() || mDir.empty())
+	{
+		return;
+	}
+
+	U32 data_size = volume->getDecodedFacesSize();
+
+	std::vector<U8> buffer(sizeof(LLMeshDecodeCacheHeader) + data_size);
+
+	LLMeshDecodeCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.mMagic = MESH_DECODE_CACHE_MAGIC;
+	header.mVersion = MESH_DECODE_CACHE_VERSION;
+	memcpy(header.mMeshID, mesh_params.getSculptID().mData, UUID_BYTES);
+	header.mLOD = lod;
+	header.mSculptFlags = mesh_params.getSculptType() & LL_SCULPT_FLAG_MASK;
+	header.mSourceSize = source_size;
+	header.mDataSize = data_size;
+	memcpy(&buffer[0], &header, sizeof(header));
+
+	if (!volume->packDecodedFaces(&buffer[sizeof(header)], data_size))
+	{
+		return;
+	}
+
+	// write next to the entry and rename over it, so a reader never maps a
+	// partly written file
+	std::string filename = getFilename(mesh_params, lod);
+	std::string tmp_filename = filename + ".tmp";
+
+	LLFILE* fp = LLFile::fopen(tmp_filename, "wb");
+	if (!fp)
+	{
+		return;
+	}
+	bool written = fwrite(&buffer[0], 1, buffer.size(), fp) == buffer.size();
+	written = fclose(fp) == 0 && written;
+
+	if (written)
+	{
+		LLFile::remove(filename, ENOENT);
+		written = LLFile::rename(tmp_filename, filename) == 0;
+	}
+	if (!written)
+	{
+		LLFile::remove(tmp_filename);
+		return;
+	}
+
+	mBytes += buffer.size();
+	if (mBytes > mMaxBytes)
+	{
+		trim();
+	}
+}
+
+void LLMeshDecodeCache::trim()
+{
+	std::vector<LLMeshDecodeCacheFile> files;
+	mBytes = 0;
+
+	LLDirIterator iter(mDir, "*.mdc");
+	std::string name;
+	while (iter.next(name))
+	{
+		LLMeshDecodeCacheFile file;
+		file.mName = mDir + gDirUtilp->getDirDelimiter() + name;
+
+		llstat stat_data;
+		if (LLFile::stat(file.mName, &stat_data) == 0)
+		{
+			file.mTime = stat_data.st_mtime;
+			file.mSize = stat_data.st_size;
+			mBytes += file.mSize;
+			files.push_back(file);
+		}
+	}
+
+	if (mBytes <= mMaxBytes)
+	{
+		return;
+	}
+
+	std::sort(files.begin(), files.end());
+
+	U64 target = mMaxBytes / 4 * 3;
+	for (size_t i = 0; i < files.size() && mBytes > target; ++i)
+	{
+		if (LLFile::remove(files[i].mName) == 0)
+		{
+			mBytes -= files[i].mSize;
+		}
+	}
+
+	LL_INFOS("Mesh") << "Trimmed decoded mesh cache to " << (mBytes >> 20) << " MB" << LL_ENDL;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file llmeshdecodecache.h
+ * @brief On-disk cache of decoded mesh LODs.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESHDECODECACHE_H
+#define LL_LLMESHDECODECACHE_H
+
+#include "stdtypes.h"
+
+#include <string>
+
+class LLVolume;
+class LLVolumeParams;
+
+// Keeps the faces of decoded mesh LODs on disk, one file per mesh, LOD and
+// mirror/invert flags, so a LOD that was seen before is restored without
+// running unzip_llsd() and LLVolume::unpackVolumeFaces() again. Files are
+// versioned and read through a memory mapping. Each entry remembers the size
+// of the LOD block it was decoded from and is ignored if the mesh header
+// now names a different size.
+//
+// Only used from the mesh repo thread.
+class LLMeshDecodeCache
+{
+public:
+	LLMeshDecodeCache();
+
+	// A limit of zero turns the cache off.
+	void setMaxBytes(U64 max_bytes) { mMaxBytes = max_bytes; }
+	bool isEnabled() const { return mMaxBytes > 0; }
+
+	// Creates the cache directory and trims it to the size limit.
+	void init();
+
+	bool read(const LLVolumeParams& mesh_params, S32 lod, S32 source_size, LLVolume* volume);
+	void write(const LLVolumeParams& mesh_params, S32 lod, S32 source_size, const LLVolume* volume);
+
+	static void removeCache();
+
+private:
+	static std::string getCacheDir();
+	std::string getFilename(const LLVolumeParams& mesh_params, S32 lod) const;
+
+	// Removes the least recently used entries (read() touches the files it
+	// hits) until the cache is back under 3/4 of the limit.
+	void trim();
+
+	std::string mDir;
+	U64 mMaxBytes;
+	U64 mBytes;
+};
+
+#endif // LL_LLMESHDECODECACHE_H
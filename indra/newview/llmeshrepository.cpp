@@ -220,6 +220,8 @@
 //     sCacheBytesWritten              "
 //     sCacheReads                     "
 //     sCacheWrites                    "
+//     sDecodeCacheReads               "
+//     sDecodeCacheWrites              "
 //     mLoadingMeshes                  mMeshMutex [4]  rw.main.none, rw.any.mMeshMutex
 //     mSkinMap                        none            rw.main.none
 //     mDecompositionMap               none            rw.main.none
@@ -384,6 +386,8 @@ U32 LLMeshRepository::sCacheBytesRead = 0;
 U32 LLMeshRepository::sCacheBytesWritten = 0;
 U32 LLMeshRepository::sCacheReads = 0;
 U32 LLMeshRepository::sCacheWrites = 0;
+U32 LLMeshRepository::sDecodeCacheReads = 0;
+U32 LLMeshRepository::sDecodeCacheWrites = 0;
 U32 LLMeshRepository::sMaxLockHoldoffs = 0;
 	
 LLDeadmanTimer LLMeshRepository::sQuiescentTimer(15.0, false);	// true -> gather cpu metrics
@@ -818,14 +822,17 @@ LLMeshRepoThread::LLMeshRepoThread()
 	mHttpOptions = boost::make_shared<LLCore::HttpOptions>();
 	mHttpOptions->setTransferTimeout(SMALL_MESH_XFER_TIMEOUT);
 	mHttpOptions->setUseRetryAfter(gSavedSettings.getBOOL("MeshUseHttpRetryAfter"));
+	mHttpOptions->setContiguousBody(true);
 	mHttpLargeOptions = boost::make_shared<LLCore::HttpOptions>();
 	mHttpLargeOptions->setTransferTimeout(LARGE_MESH_XFER_TIMEOUT);
 	mHttpLargeOptions->setUseRetryAfter(gSavedSettings.getBOOL("MeshUseHttpRetryAfter"));
+	mHttpLargeOptions->setContiguousBody(true);
 	mHttpHeaders = boost::make_shared<LLCore::HttpHeaders>();
 	mHttpHeaders->append(HTTP_OUT_HEADER_ACCEPT, HTTP_CONTENT_VND_LL_MESH);
 	mHttpPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_MESH2);
 	mHttpLegacyPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_MESH1);
 	mHttpLargePolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_LARGE_MESH);
+	mDecodeCache.setMaxBytes((U64)gSavedSettings.getU32("MeshDecodeCacheSize") << 20);
 }
 
 
@@ -857,6 +864,8 @@ void LLMeshRepoThread::run()
 		LL_WARNS(LOG_MESH) << "Convex decomposition unable to be loaded.  Expect severe problems." << LL_ENDL;
 	}
 
+	mDecodeCache.init();
+
 	while (!LLApp::isQuitting())
 	{
 		// *TODO:  Revise sleep/wake strategy and try to move away
@@ -1605,6 +1614,19 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 				
 		if (version <= MAX_MESH_VERSION && offset >= 0 && size > 0)
 		{
+			//check for a copy of this LOD decoded in an earlier session
+			if (mDecodeCache.isEnabled())
+			{
+				LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
+				if (mDecodeCache.read(mesh_params, lod, size, volume) && volume->getNumFaces() > 0)
+				{
+					++LLMeshRepository::sDecodeCacheReads;
+					LoadedMesh mesh(volume, mesh_params, lod);
+					LLMutexLock lock(mMutex);
+					mLoadedQ.push(mesh);
+					return true;
+				}
+			}
 
 			//check VFS for mesh asset
 			LLVFile file(gVFS, mesh_id, LLAssetType::AT_MESH);
@@ -1685,27 +1707,23 @@ bool LLMeshRepoThread::headerReceived(const LLVolumeParams& mesh_params, U8* dat
 	U32 header_size = 0;
 	if (data_size > 0)
 	{
-		std::string res_str((char*) data, data_size);
+		static const std::string deprecated_header("<? LLSD/Binary ?>");
 
-		std::string deprecated_header("<? LLSD/Binary ?>");
-
-		if (res_str.substr(0, deprecated_header.size()) == deprecated_header)
+		if (data_size >= (S32)deprecated_header.size()
+			&& !memcmp(data, deprecated_header.data(), deprecated_header.size()))
 		{
-			res_str = res_str.substr(deprecated_header.size()+1, data_size);
-			header_size = deprecated_header.size()+1;
+			header_size = llmin((S32)deprecated_header.size() + 1, data_size);
 		}
-		data_size = res_str.size();
-
-		std::istringstream stream(res_str);
 
-		if (!LLSDSerialize::fromBinary(header, stream, data_size))
+		size_t consumed = 0;
+		if (!LLSDSerialize::fromBinary(header, data + header_size, data_size - header_size, &consumed))
 		{
 			LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
 							   << LL_ENDL;
 			return false;
 		}
 
-		header_size += stream.tellg();
+		header_size += (U32)consumed;
 	}
 	else
 	{
@@ -1750,13 +1768,17 @@ bool LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_params, S32 lod, U
 	}
 
 	LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
-	std::string mesh_string((char*) data, data_size);
-	std::istringstream stream(mesh_string);
 
-	if (volume->unpackVolumeFaces(stream, data_size))
+	if (volume->unpackVolumeFaces(data, data_size))
 	{
 		if (volume->getNumFaces() > 0)
 		{
+			if (mDecodeCache.isEnabled())
+			{
+				mDecodeCache.write(mesh_params, lod, data_size, volume);
+				++LLMeshRepository::sDecodeCacheWrites;
+			}
+
 			LoadedMesh mesh(volume, mesh_params, lod);
 			{
 				LLMutexLock lock(mMutex);
@@ -1775,11 +1797,7 @@ bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 dat
 
 	if (data_size > 0)
 	{
-		std::string res_str((char*) data, data_size);
-
-		std::istringstream stream(res_str);
-
-		if (!unzip_llsd(skin, stream, data_size))
+		if (!unzip_llsd(skin, data, data_size))
 		{
 			LL_WARNS(LOG_MESH) << "Mesh skin info parse error.  Not a valid mesh asset!  ID:  " << mesh_id
 							   << LL_ENDL;
@@ -1807,11 +1825,7 @@ bool LLMeshRepoThread::decompositionReceived(const LLUUID& mesh_id, U8* data, S3
 
 	if (data_size > 0)
 	{ 
-		std::string res_str((char*) data, data_size);
-
-		std::istringstream stream(res_str);
-
-		if (!unzip_llsd(decomp, stream, data_size))
+		if (!unzip_llsd(decomp, data, data_size))
 		{
 			LL_WARNS(LOG_MESH) << "Mesh decomposition parse error.  Not a valid mesh asset!  ID:  " << mesh_id
 							   << LL_ENDL;
@@ -2884,6 +2898,7 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 		LLCore::BufferArray * body(response->getBody());
 		S32 body_offset(0);
 		U8 * data(nullptr);
+		bool copied(false);
 		S32 data_size(body ? body->size() : 0);
 
 		if (data_size > 0)
@@ -2936,19 +2951,29 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 				goto common_exit;
 			}
 			
-			// *TODO: Try to get rid of data copying and add interfaces
-			// that support BufferArray directly.  Introduce a two-phase
-			// handler, optional first that takes a body, fallback second
-			// that requires a temporary allocation and data copy.
+			// Bodies collected in one block are parsed in place,
+			// only scattered ones need a temporary copy.
 			body_offset = mOffset - offset;
-			data = new U8[data_size - body_offset];
-			body->read(body_offset, (char *) data, data_size - body_offset);
+			U8 * contiguous((U8 *) body->getContiguous());
+			if (contiguous)
+			{
+				data = contiguous + body_offset;
+			}
+			else
+			{
+				data = new U8[data_size - body_offset];
+				body->read(body_offset, (char *) data, data_size - body_offset);
+				copied = true;
+			}
 			LLMeshRepository::sBytesReceived += data_size;
 		}
 
 		processData(body, body_offset, data, data_size - body_offset);
 
-		delete [] data;
+		if (copied)
+		{
+			delete [] data;
+		}
 	}
 
 	// Release handler
@@ -3461,6 +3486,28 @@ S32 LLMeshRepository::loadMesh(LLVOVolume* vobj, const LLVolumeParams& mesh_para
 	return detail;
 }
 
+bool LLMeshRepository::prefetchMesh(const LLVolumeParams& mesh_params, S32 detail)
+{
+	if (detail < 0 || detail >= 4)
+	{
+		return false;
+	}
+
+	LLMutexLock lock(mMeshMutex);
+	if (mLoadingMeshes[detail].find(mesh_params) != mLoadingMeshes[detail].end())
+	{
+		return false;
+	}
+
+	// an empty set of waiting objects scores the request lowest in
+	// notifyLoadedMeshes(), and objects asking for it later join the set
+	mLoadingMeshes[detail][mesh_params];
+	mPendingRequests.push_back(LLMeshRepoThread::LODRequest(mesh_params, detail));
+	LLMeshRepository::sLODPending++;
+
+	return true;
+}
+
 void LLMeshRepository::notifyLoadedMeshes()
 { //called from main thread
 	LL_RECORD_BLOCK_TIME(FTM_MESH_FETCH);
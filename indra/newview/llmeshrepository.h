@@ -39,6 +39,7 @@
 #include "httpheaders.h"
 #include "httphandler.h"
 #include "llthread.h"
+#include "llmeshdecodecache.h"
 
 #include <boost/unordered_map.hpp> // <alchemy/>
 
@@ -293,6 +294,8 @@ public:
 	int mLegacyGetMeshVersion;
 	std::string mGetMeshCapability;
 
+	LLMeshDecodeCache mDecodeCache;
+
 	LLMeshRepoThread();
 	~LLMeshRepoThread();
 
@@ -474,6 +477,8 @@ public:
 	static U32 sCacheBytesWritten;
 	static U32 sCacheReads;						
 	static U32 sCacheWrites;
+	static U32 sDecodeCacheReads;				// LODs restored from the decoded mesh cache
+	static U32 sDecodeCacheWrites;
 	static U32 sMaxLockHoldoffs;				// Maximum sequential locking failures
 	
 	static LLDeadmanTimer sQuiescentTimer;		// Time-to-complete-mesh-downloads after significant events
@@ -489,6 +494,9 @@ public:
 
 	//mesh management functions
 	S32 loadMesh(LLVOVolume* volume, const LLVolumeParams& mesh_params, S32 detail = 0, S32 last_lod = -1);
+	// Requests a LOD no object is waiting for yet. It is sent after the
+	// LODs objects are waiting for. Returns false if it is already loading.
+	bool prefetchMesh(const LLVolumeParams& mesh_params, S32 detail);
 	
 	void notifyLoadedMeshes();
 	void notifyMeshLoaded(const LLVolumeParams& mesh_params, LLVolume* volume);
@@ -90,6 +90,7 @@
 #include "llagentpicksinfo.h"
 #include "llagentwearables.h"
 #include "llagentpilot.h"
+#include "llassetprefetch.h"
 #include "llfloateravatarpicker.h"
 #include "llcallbacklist.h"
 #include "llcallingcard.h"
@@ -582,6 +583,12 @@ bool idle_startup()
 				msg->mPacketRing.setUseOutThrottle(TRUE);
 				msg->mPacketRing.setOutBandwidth(outBandwidth);
 			}
+
+			if (gSavedSettings.getBOOL("MessageReceiveThread"))
+			{
+				LL_INFOS("AppInit") << "Starting message receive thread" << LL_ENDL;
+				msg->startReceiveThread();
+			}
 		}
 
 		// <polarity> Save and restore logging level
@@ -2175,6 +2182,10 @@ bool idle_startup()
 		// (just accessing this the first time will fetch it,
 		// then the data is cached for the viewer's lifetime)
 		LLProductInfoRequestManager::instance();
+
+		// Start remembering what regions show, for warming the caches
+		// before teleports back to them
+		LLAssetPrefetch::instance();
 		
 		// *FIX:Mani - What do I do here?
 		// Need we really clear the Auth response data?
@@ -34,6 +34,8 @@
 #include "lldir.h"
 #include "llimage.h"
 #include "lllfsthread.h"
+#include "llthreadpool.h"
+#include "lltrace.h"
 #include "llviewercontrol.h"
 
 // Included to allow LLTextureCache::purgeTextures() to pause watchdog timeout
@@ -47,13 +49,41 @@
 //  First TEXTURE_CACHE_ENTRY_SIZE bytes of each texture in texture.entries in same order
 // cache/textures/[0-F]/UUID.texture
 //  Actual texture body files
+// cache/texturecache/FastCache<N>.cache
+//  Decoded images of at most NxN pixels, one slot per FastCacheEntry
 
 //note: there is no good to define 1024 for TEXTURE_CACHE_ENTRY_SIZE while FIRST_PACKET_SIZE is 600 on sim side.
 const S32 TEXTURE_CACHE_ENTRY_SIZE = FIRST_PACKET_SIZE;//1024;
 const F32 TEXTURE_CACHE_PURGE_AMOUNT = .20f; // % amount to reduce the cache by when it exceeds its limit
 const F32 TEXTURE_CACHE_LRU_SIZE = .10f; // % amount for LRU list (low overhead to regenerate)
-const S32 TEXTURE_FAST_CACHE_ENTRY_OVERHEAD = sizeof(S32) * 4; //w, h, c, level
-const S32 TEXTURE_FAST_CACHE_ENTRY_SIZE = 16 * 16 * 4 + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD;
+
+// Header of a fast cache slot, followed by the image data
+struct FastCacheEntry
+{
+	S32 mWidth;
+	S32 mHeight;
+	S32 mComponents;
+	S32 mDiscardLevel;
+	LLUUID mID;	// slots of the larger tiers are shared
+};
+const S32 TEXTURE_FAST_CACHE_ENTRY_OVERHEAD = sizeof(FastCacheEntry);
+// Largest image, in pixels per side, stored by each tier
+const S32 TEXTURE_FAST_CACHE_TIER_DIMENSIONS[] = { 16, 64, 256 };
+const S32 TEXTURE_FAST_CACHE_MAX_COMPONENTS = 4;
+// Tier 0, which has a slot for every header entry
+const S32 TEXTURE_FAST_CACHE_ENTRY_SIZE = 16 * 16 * TEXTURE_FAST_CACHE_MAX_COMPONENTS + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD;
+// Share of the large tier budget given to each tier past the first
+const F32 TEXTURE_FAST_CACHE_TIER_SHARE[] = { 0.f, .25f, .75f };
+
+static S32 get_fast_cache_data_size(S32 tier)
+{
+	return TEXTURE_FAST_CACHE_TIER_DIMENSIONS[tier] * TEXTURE_FAST_CACHE_TIER_DIMENSIONS[tier] * TEXTURE_FAST_CACHE_MAX_COMPONENTS;
+}
+
+static LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > sFastCacheHitRate("texture_fast_cache_hits", "Textures found in the fast cache");
+static LLTrace::CountStatHandle<> sFastCacheTier0Hits("texture_fast_cache_16_hits", "Fast cache hits of at most 16x16");
+static LLTrace::CountStatHandle<> sFastCacheTier1Hits("texture_fast_cache_64_hits", "Fast cache hits of at most 64x64");
+static LLTrace::CountStatHandle<> sFastCacheTier2Hits("texture_fast_cache_256_hits", "Fast cache hits of at most 256x256");
 
 class LLTextureCacheWorker : public LLWorkerClass
 {
@@ -181,7 +211,7 @@ private:
 
 bool LLTextureCacheLocalFileWorker::doRead()
 {
-	S32 local_size = LLAPRFile::size(mFileName, mCache->getLocalAPRFilePool());
+	S32 local_size = LLAPRFile::size(mFileName, mCache->getFilePool());
 
 	if (local_size > 0 && mFileName.size() > 4)
 	{
@@ -255,7 +285,7 @@ bool LLTextureCacheLocalFileWorker::doRead()
 	}
 	mReadData = (U8*)ll_aligned_malloc_16(mDataSize);
 	
-	S32 bytes_read = LLAPRFile::readEx(mFileName, mReadData, mOffset, mDataSize, mCache->getLocalAPRFilePool());	
+	S32 bytes_read = LLAPRFile::readEx(mFileName, mReadData, mOffset, mDataSize, mCache->getFilePool());	
 
 	if (bytes_read != mDataSize)
 	{
@@ -341,7 +371,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 		// Is it a JPEG2000 file? 
 		{
 			local_filename = filename + ".j2c";
-			local_size = LLAPRFile::size(local_filename, mCache->getLocalAPRFilePool());
+			local_size = LLAPRFile::size(local_filename, mCache->getFilePool());
 			if (local_size > 0)
 			{
 				mImageFormat = IMG_CODEC_J2C;
@@ -351,7 +381,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 		if (local_size == 0)
 		{
 			local_filename = filename + ".jpg";
-			local_size = LLAPRFile::size(local_filename, mCache->getLocalAPRFilePool());
+			local_size = LLAPRFile::size(local_filename, mCache->getFilePool());
 			if (local_size > 0)
 			{
 				mImageFormat = IMG_CODEC_JPEG;
@@ -362,7 +392,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 		if (local_size == 0)
 		{
 			local_filename = filename + ".tga";
-			local_size = LLAPRFile::size(local_filename, mCache->getLocalAPRFilePool());
+			local_size = LLAPRFile::size(local_filename, mCache->getFilePool());
 			if (local_size > 0)
 			{
 				mImageFormat = IMG_CODEC_TGA;
@@ -389,7 +419,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 		// Allocate read buffer
 		mReadData = (U8*)ll_aligned_malloc_16(mDataSize);
 		S32 bytes_read = LLAPRFile::readEx(local_filename, 
-											 mReadData, mOffset, mDataSize, mCache->getLocalAPRFilePool());
+											 mReadData, mOffset, mDataSize, mCache->getFilePool());
 		if (bytes_read != mDataSize)
 		{
  			LL_WARNS() << "Error reading file from local cache: " << local_filename
@@ -441,7 +471,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 		// Allocate the read buffer
 		mReadData = (U8*)ll_aligned_malloc_16(size);
 		S32 bytes_read = LLAPRFile::readEx(mCache->mHeaderDataFileName, 
-											 mReadData, offset, size, mCache->getLocalAPRFilePool());
+											 mReadData, offset, size, mCache->getFilePool());
 		if (bytes_read != size)
 		{
 			LL_WARNS() << "LLTextureCacheWorker: "  << mID
@@ -467,7 +497,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 	if (!done && (mState == BODY))
 	{
 		std::string filename = mCache->getTextureFileName(mID);
-		S32 filesize = LLAPRFile::size(filename, mCache->getLocalAPRFilePool());
+		S32 filesize = LLAPRFile::size(filename, mCache->getFilePool());
 
 		if (filesize && (filesize + TEXTURE_CACHE_ENTRY_SIZE) > mOffset)
 		{
@@ -510,7 +540,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 			S32 bytes_read = LLAPRFile::readEx(filename, 
 											 mReadData + data_offset,
 											 file_offset, file_size,
-											 mCache->getLocalAPRFilePool());
+											 mCache->getFilePool());
 			if (bytes_read != file_size)
 			{
 				LL_WARNS() << "LLTextureCacheWorker: "  << mID
@@ -581,7 +611,7 @@ bool LLTextureCacheRemoteWorker::doWrite()
 				// (almost always) write to the fast cache.
 				if (mRawImage->getDataSize())
 				{
-					if(!mCache->writeToFastCache(idx, mRawImage, mRawDiscardLevel))
+					if(!mCache->writeToFastCache(idx, mID, mRawImage, mRawDiscardLevel))
 					{
 						LL_WARNS() << "writeToFastCache failed" << LL_ENDL;
 						mDataSize = -1; // failed
@@ -593,6 +623,11 @@ bool LLTextureCacheRemoteWorker::doWrite()
 		else
 		{
 			alreadyCached = mCache->updateEntry(idx, entry, mImageSize, mDataSize); // update the existing entry.
+			// more of the texture arrived, which may fill a larger tier
+			if (idx >= 0 && mRawImage.notNull() && mRawImage->getDataSize())
+			{
+				mCache->writeToFastCache(idx, mID, mRawImage, mRawDiscardLevel);
+			}
 		}
 
 		if (!done)
@@ -643,13 +678,13 @@ bool LLTextureCacheRemoteWorker::doWrite()
 				U8* padBuffer = (U8*) ll_aligned_malloc_16(TEXTURE_CACHE_ENTRY_SIZE);
 				memset(padBuffer, 0, TEXTURE_CACHE_ENTRY_SIZE);		// Init with zeros
 				memcpy(padBuffer, mWriteData, mDataSize);			// Copy the write buffer
-				bytes_written = LLAPRFile::writeEx(mCache->mHeaderDataFileName, padBuffer, offset, size, mCache->getLocalAPRFilePool());
+				bytes_written = LLAPRFile::writeEx(mCache->mHeaderDataFileName, padBuffer, offset, size, mCache->getFilePool());
 				ll_aligned_free_16(padBuffer);
 			}
 			else
 			{
 				// Write the header record (== first TEXTURE_CACHE_ENTRY_SIZE bytes of the raw file) in the header file
-				bytes_written = LLAPRFile::writeEx(mCache->mHeaderDataFileName, mWriteData, offset, size, mCache->getLocalAPRFilePool());
+				bytes_written = LLAPRFile::writeEx(mCache->mHeaderDataFileName, mWriteData, offset, size, mCache->getFilePool());
 			}
 
 			if (bytes_written <= 0)
@@ -693,7 +728,7 @@ bool LLTextureCacheRemoteWorker::doWrite()
 				S32 bytes_written = LLAPRFile::writeEx(filename,
 													   mWriteData + TEXTURE_CACHE_ENTRY_SIZE,
 													   0, file_size,
-													   mCache->getLocalAPRFilePool());
+													   mCache->getFilePool());
 				if (bytes_written <= 0)
 				{
 					LL_WARNS() << "LLTextureCacheWorker: " << mID
@@ -790,29 +825,40 @@ void LLTextureCacheWorker::endWork(S32 param, bool aborted)
 
 //////////////////////////////////////////////////////////////////////////////
 
-LLTextureCache::LLTextureCache(bool threaded)
-	: LLWorkerThread("TextureCache", threaded),
+LLTextureCache::LLTextureCache(bool threaded, U32 num_threads)
+	: LLWorkerThread("TextureCache", threaded, false, num_threads != 1 ? LLThreadPool::getShared() : nullptr, num_threads),
 	  mWorkersMutex(),
-	  mHeaderMutex(),
+	  mFreeListMutex(),
 	  mListMutex(),
-	  mFastCacheMutex(),
-	  mHeaderAPRFile(NULL),
 	  mReadOnly(TRUE), //do not allow to change the texture cache until setReadOnly() is called.
+	  mCacheCorrupted(false),
 	  mTexturesSizeTotal(0),
-	  mDoPurge(false),
-	  mFastCachep(NULL),
-	  mFastCachePoolp(NULL),
-	  mFastCachePadBuffer(NULL)
+	  mDoPurge(false)
 {
+	for (S32 i = 0; i < NUM_FAST_CACHE_TIERS; ++i)
+	{
+		mFastCacheTiers[i].mSlots = 0;
+	}
 }
 
 LLTextureCache::~LLTextureCache()
 {
+	// Pool workers may still be running our requests, wait for them
+	// before taking the cache apart
+	shutdown();
 	clearDeleteList() ;
 	writeUpdatedEntries() ;
-	delete mFastCachep;
-	delete mFastCachePoolp;
-	ll_aligned_free_16(mFastCachePadBuffer);
+	closeFastCache();
+}
+
+U32 LLTextureCache::getThreadCount() const
+{
+	if (mPool)
+	{
+		U32 count = mPool->getWorkerCount();
+		return getMaxPoolTasks() ? llmin(count, getMaxPoolTasks()) : count;
+	}
+	return mThreaded ? 1 : 0;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -889,10 +935,11 @@ std::string LLTextureCache::getTextureFileName(const LLUUID& id)
 //debug
 BOOL LLTextureCache::isInCache(const LLUUID& id) 
 {
-	LLMutexLock lock(&mHeaderMutex);
-	id_map_t::const_iterator iter = mHeaderIDMap.find(id);
+	HeaderShard& shard = getShard(id);
+	LLMutexLock lock(&shard.mMutex);
+	id_map_t::const_iterator iter = shard.mHeaderIDMap.find(id);
 	
-	return (iter != mHeaderIDMap.end()) ;
+	return (iter != shard.mHeaderIDMap.end()) ;
 }
 
 //debug
@@ -905,7 +952,7 @@ BOOL LLTextureCache::isInLocal(const LLUUID& id)
 	// Is it a JPEG2000 file? 
 	{
 		local_filename = filename + ".j2c";
-		local_size = LLAPRFile::size(local_filename, getLocalAPRFilePool());
+		local_size = LLAPRFile::size(local_filename, getFilePool());
 		if (local_size > 0)
 		{
 			return TRUE ;
@@ -915,7 +962,7 @@ BOOL LLTextureCache::isInLocal(const LLUUID& id)
 	// If not, is it a jpeg file?		
 	{
 		local_filename = filename + ".jpg";
-		local_size = LLAPRFile::size(local_filename, getLocalAPRFilePool());
+		local_size = LLAPRFile::size(local_filename, getFilePool());
 		if (local_size > 0)
 		{
 			return TRUE ;
@@ -925,7 +972,7 @@ BOOL LLTextureCache::isInLocal(const LLUUID& id)
 	// Hmm... What about a targa file? (used for UI texture mostly)		
 	{
 		local_filename = filename + ".tga";
-		local_size = LLAPRFile::size(local_filename, getLocalAPRFilePool());
+		local_size = LLAPRFile::size(local_filename, getFilePool());
 		if (local_size > 0)
 		{
 			return TRUE ;
@@ -945,24 +992,27 @@ const char* cache_filename = "texture.cache";
 const char* old_textures_dirname = "textures";
 //change the location of the texture cache to prevent from being deleted by old version viewers.
 const char* textures_dirname = "texturecache";
-const char* fast_cache_filename = "FastCache.cache";
+const char* old_fast_cache_filename = "FastCache.cache";
 
 void LLTextureCache::setDirNames(ELLPath location)
 {
 	mHeaderEntriesFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, entries_filename);
 	mHeaderDataFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, cache_filename);
 	mTexturesDirName = gDirUtilp->getExpandedFilename(location, textures_dirname);
-	mFastCacheFileName =  gDirUtilp->getExpandedFilename(location, textures_dirname, fast_cache_filename);
+	for (S32 i = 0; i < NUM_FAST_CACHE_TIERS; ++i)
+	{
+		mFastCacheTiers[i].mFileName = gDirUtilp->getExpandedFilename(location, textures_dirname,
+			llformat("FastCache%d.cache", TEXTURE_FAST_CACHE_TIER_DIMENSIONS[i]));
+	}
 }
 
 void LLTextureCache::purgeCache(ELLPath location, bool remove_dir)
 {
-	LLMutexLock lock(&mHeaderMutex);
+	HeadersLock lock(this);
 
 	if (!mReadOnly)
 	{
 		setDirNames(location);
-		llassert_always(mHeaderAPRFile == NULL);
 
 		//remove the legacy cache if exists
 		std::string texture_dir = mTexturesDirName ;
@@ -970,10 +1020,10 @@ void LLTextureCache::purgeCache(ELLPath location, bool remove_dir)
 		if(LLFile::isdir(mTexturesDirName))
 		{
 			std::string file_name = gDirUtilp->getExpandedFilename(location, entries_filename);
-			LLAPRFile::remove(file_name, getLocalAPRFilePool());
+			LLAPRFile::remove(file_name, getFilePool());
 
 			file_name = gDirUtilp->getExpandedFilename(location, cache_filename);
-			LLAPRFile::remove(file_name, getLocalAPRFilePool());
+			LLAPRFile::remove(file_name, getFilePool());
 
 			purgeAllTextures(true);
 		}
@@ -995,10 +1045,14 @@ U64 LLTextureCache::initCache(ELLPath location, U64 max_size, BOOL texture_cache
 {
 	llassert_always(getPending() == 0) ; //should not start accessing the texture cache before initialized.
 
+	// the larger fast cache tiers come out of the cache size too
+	U64 large_tiers_size = llmin((U64)gSavedSettings.getU32("FastCacheLargeTierSize") * 1024 * 1024, max_size / 4);
+	max_size -= large_tiers_size;
+
 	U64 header_size = (max_size / 100) * 36; //0.36 * max_size
 	U32 max_entries = header_size / (TEXTURE_CACHE_ENTRY_SIZE + TEXTURE_FAST_CACHE_ENTRY_SIZE);
 	sCacheMaxEntries = (llmin(sCacheMaxEntries, max_entries));
-	header_size = sCacheMaxEntries * TEXTURE_CACHE_ENTRY_SIZE;
+	header_size = sCacheMaxEntries * (TEXTURE_CACHE_ENTRY_SIZE + TEXTURE_FAST_CACHE_ENTRY_SIZE);
 	max_size -= header_size;
 	if (sCacheMaxTexturesSize > 0)
 		sCacheMaxTexturesSize = (U32)llmin((U64)sCacheMaxTexturesSize, max_size);
@@ -1038,45 +1092,71 @@ U64 LLTextureCache::initCache(ELLPath location, U64 max_size, BOOL texture_cache
 	purgeTextures(true); // calc mTexturesSize and make some room in the texture cache if we need it
 
 	llassert_always(getPending() == 0) ; //should not start accessing the texture cache before initialized.
-	openFastCache(true);
+	openFastCache(large_tiers_size);
 
 	return max_size; // unused cache space
 }
 
-//----------------------------------------------------------------------------
-// mHeaderMutex must be locked for the following functions!
+// Locks every header shard, always in the same order. Never call this while
+// holding a single shard lock.
+void LLTextureCache::lockHeaders()
+{
+	for (S32 i = 0; i < NUM_HEADER_SHARDS; ++i)
+	{
+		mHeaderShards[i].mMutex.lock();
+	}
+}
 
-LLAPRFile* LLTextureCache::openHeaderEntriesFile(bool readonly, S32 offset)
+void LLTextureCache::unlockHeaders()
 {
-	llassert_always(mHeaderAPRFile == NULL);
-	apr_int32_t flags = readonly ? APR_READ|APR_BINARY : APR_READ|APR_WRITE|APR_BINARY;
-	mHeaderAPRFile = new LLAPRFile(mHeaderEntriesFileName, flags, getLocalAPRFilePool());
-	if(offset > 0)
+	for (S32 i = NUM_HEADER_SHARDS - 1; i >= 0; --i)
 	{
-		mHeaderAPRFile->seek(APR_SET, offset);
+		mHeaderShards[i].mMutex.unlock();
 	}
-	return mHeaderAPRFile;
 }
 
-void LLTextureCache::closeHeaderEntriesFile()
+//----------------------------------------------------------------------------
+// lockHeaders() must be called for the following functions unless noted!
+
+// The entries file is mapped once and then read and written in place, so
+// looking up or updating an entry only touches the page it lives on. A
+// writable file is sized for sCacheMaxEntries up front; a read-only one is
+// mapped copy-on-write at whatever size it has.
+bool LLTextureCache::openHeaderEntriesFile()
 {
-	if(!mHeaderAPRFile)
+	if (mHeaderEntriesFile.isOpen())
 	{
-		return ;
+		return true;
 	}
+	size_t size = mReadOnly ? 0 : sizeof(EntriesInfo) + (size_t)sCacheMaxEntries * sizeof(Entry);
+	return mHeaderEntriesFile.open(mHeaderEntriesFileName, size, !mReadOnly)
+		&& mHeaderEntriesFile.getSize() >= sizeof(EntriesInfo);
+}
 
-	delete mHeaderAPRFile;
-	mHeaderAPRFile = NULL;
+void LLTextureCache::closeHeaderEntriesFile()
+{
+	mHeaderEntriesFile.close();
+}
+
+// Any lock.
+U32 LLTextureCache::getMappedEntryCount() const
+{
+	size_t size = mHeaderEntriesFile.getSize();
+	return size < sizeof(EntriesInfo) ? 0 : (U32)((size - sizeof(EntriesInfo)) / sizeof(Entry));
+}
+
+// Any lock.
+LLTextureCache::Entry* LLTextureCache::getMappedEntry(S32 idx)
+{
+	return (Entry*)(mHeaderEntriesFile.getData() + sizeof(EntriesInfo)) + idx;
 }
 
 void LLTextureCache::readEntriesHeader()
 {
 	// mHeaderEntriesInfo initializes to default values so safe not to read it
-	llassert_always(mHeaderAPRFile == NULL);
-	if (LLAPRFile::isExist(mHeaderEntriesFileName, getLocalAPRFilePool()))
+	if (LLFile::isfile(mHeaderEntriesFileName) && openHeaderEntriesFile())
 	{
-		LLAPRFile::readEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
-						  getLocalAPRFilePool());
+		memcpy(&mHeaderEntriesInfo, mHeaderEntriesFile.getData(), sizeof(EntriesInfo));
 	}
 	else //create an empty entries header.
 	{
@@ -1086,23 +1166,24 @@ void LLTextureCache::readEntriesHeader()
 	}
 }
 
+// Any lock, once the entries file is open.
 void LLTextureCache::writeEntriesHeader()
 {
-	llassert_always(mHeaderAPRFile == NULL);
-	if (!mReadOnly)
+	LLMutexLock lock(&mFreeListMutex);
+	if (!mReadOnly && openHeaderEntriesFile())
 	{
-		LLAPRFile::writeEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
-						   getLocalAPRFilePool());
+		memcpy(mHeaderEntriesFile.getData(), &mHeaderEntriesInfo, sizeof(EntriesInfo));
 	}
 }
 
-//mHeaderMutex is locked before calling this.
+//the shard of id is locked before calling this.
 S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create)
 {
 	S32 idx = -1;
 	
-	id_map_t::iterator iter1 = mHeaderIDMap.find(id);
-	if (iter1 != mHeaderIDMap.end())
+	HeaderShard& shard = getShard(id);
+	id_map_t::iterator iter1 = shard.mHeaderIDMap.find(id);
+	if (iter1 != shard.mHeaderIDMap.end())
 	{
 		idx = iter1->second;
 	}
@@ -1111,6 +1192,7 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 	{
 		if (create && !mReadOnly)
 		{
+			LLMutexLock lock(&mFreeListMutex);
 			if (mHeaderEntriesInfo.mEntries < sCacheMaxEntries)
 			{
 				// Add an entry to the end of the list
@@ -1122,28 +1204,8 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 				idx = *(mFreeList.begin());
 				mFreeList.erase(mFreeList.begin());
 			}
-			else
-			{
-				// Look for a still valid entry in the LRU
-				for (std::set<LLUUID>::iterator iter2 = mLRU.begin(); iter2 != mLRU.end();)
-				{
-					std::set<LLUUID>::iterator curiter2 = iter2++;
-					LLUUID oldid = *curiter2;
-					// Erase entry from LRU regardless
-					mLRU.erase(curiter2);
-					// Look up entry and use it if it is valid
-					id_map_t::iterator iter3 = mHeaderIDMap.find(oldid);
-					if (iter3 != mHeaderIDMap.end() && iter3->second >= 0)
-					{
-						idx = iter3->second;
-						removeCachedTexture(oldid) ;//remove the existing cached texture to release the entry index.
-						break;
-					}
-				}
-				// if (idx < 0) at this point, we will rebuild the LRU 
-				//  and retry if called from setHeaderCacheEntry(),
-				//  otherwise this shouldn't happen and will trigger an error
-			}
+			// if (idx < 0) at this point, setHeaderCacheEntry() evicts
+			//  the least recently used entry and retries
 			if (idx >= 0)
 			{
 				entry.mID = id ;
@@ -1155,88 +1217,93 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 	else
 	{
 		// Remove this entry from the LRU if it exists
-		mLRU.erase(id);
+		shard.mLRU.erase(id);
 		// Read the entry
-		idx_entry_map_t::iterator iter = mUpdatedEntryMap.find(idx) ;
-		if(iter != mUpdatedEntryMap.end())
-		{
-			entry = iter->second ;
-		}
-		else
-		{
-			readEntryFromHeaderImmediately(idx, entry) ;
-		}
-		if(entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
+		readEntryFromHeaderImmediately(idx, entry) ;
+		if(idx >= 0 && entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
 		{
 			LL_WARNS() << "corrupted entry: " << id << " entry image size: " << entry.mImageSize << " entry body size: " << entry.mBodySize << LL_ENDL ;
 
 			//erase this entry and the cached texture from the cache.
 			std::string tex_filename = getTextureFileName(id);
 			removeEntry(idx, entry, tex_filename) ;
-			mUpdatedEntryMap.erase(idx) ;
 			idx = -1 ;
 		}
 	}
 	return idx;
 }
 
-//mHeaderMutex is locked before calling this.
-void LLTextureCache::writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header)
-{	
-	LLAPRFile* aprfile ;
-	S32 bytes_written ;
-	S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-	if(write_header)
-	{
-		aprfile = openHeaderEntriesFile(false, 0);		
-		bytes_written = aprfile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-		if(bytes_written != sizeof(EntriesInfo))
-		{
-			clearCorruptedCache() ; //clear the cache.
-			idx = -1 ;//mark the idx invalid.
-			return ;
+// No lock held. Frees the slot of a texture from the LRU of the first shard
+// that has one, returns false if every LRU is empty.
+bool LLTextureCache::evictLRUEntry()
+{
+	for (S32 i = 0; i < NUM_HEADER_SHARDS; ++i)
+	{
+		HeaderShard& shard = mHeaderShards[i];
+		LLMutexLock lock(&shard.mMutex);
+		for (std::set<LLUUID>::iterator iter = shard.mLRU.begin(); iter != shard.mLRU.end();)
+		{
+			LLUUID oldid = *iter;
+			// Erase entry from LRU regardless
+			iter = shard.mLRU.erase(iter);
+			// Look up entry and free it if it is valid
+			id_map_t::iterator iter2 = shard.mHeaderIDMap.find(oldid);
+			if (iter2 != shard.mHeaderIDMap.end() && iter2->second >= 0)
+			{
+				S32 idx = iter2->second;
+				if (idx < (S32)getMappedEntryCount() && getMappedEntry(idx)->mID == oldid)
+				{
+					std::string tex_filename = getTextureFileName(oldid);
+					removeEntry(idx, *getMappedEntry(idx), tex_filename);
+				}
+				else
+				{
+					removeCachedTexture(oldid);
+				}
+				return true;
+			}
 		}
-
-		mHeaderAPRFile->seek(APR_SET, offset);
-	}
-	else
-	{
-		aprfile = openHeaderEntriesFile(false, offset);
 	}
-	bytes_written = aprfile->write((void*)&entry, (S32)sizeof(Entry));
-	if(bytes_written != sizeof(Entry))
+	return false;
+}
+
+//the shard of entry.mID is locked before calling this.
+void LLTextureCache::writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header)
+{	
+	if (!mHeaderEntriesFile.isOpen() || idx >= (S32)getMappedEntryCount())
 	{
-		clearCorruptedCache() ; //clear the cache.
+		mCacheCorrupted = true; //clear the cache.
 		idx = -1 ;//mark the idx invalid.
-
 		return ;
 	}
 
-	closeHeaderEntriesFile();
-	mUpdatedEntryMap.erase(idx) ;
+	if(write_header)
+	{
+		writeEntriesHeader();
+	}
+	*getMappedEntry(idx) = entry;
 }
 
-//mHeaderMutex is locked before calling this.
+//the shard of the entry is locked before calling this.
 void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
 {
-	S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-	LLAPRFile* aprfile = openHeaderEntriesFile(true, offset);
-	S32 bytes_read = aprfile->read((void*)&entry, (S32)sizeof(Entry));
-	closeHeaderEntriesFile();
-
-	if(bytes_read != sizeof(Entry))
+	if (!mHeaderEntriesFile.isOpen() || idx >= (S32)getMappedEntryCount())
 	{
-		clearCorruptedCache() ; //clear the cache.
+		mCacheCorrupted = true; //clear the cache.
 		idx = -1 ;//mark the idx invalid.
+		return ;
 	}
+
+	entry = *getMappedEntry(idx);
 }
 
-//mHeaderMutex is locked before calling this.
-//update an existing entry time stamp, delay writing.
+//the shard of entry.mID is locked before calling this.
+//update an existing entry time stamp in the mapped file.
 void LLTextureCache::updateEntryTimeStamp(S32 idx, Entry& entry)
 {
 	static const U32 MAX_ENTRIES_WITHOUT_TIME_STAMP = (U32)(LLTextureCache::sCacheMaxEntries * 0.75f) ;
 
+	// unlocked read, only a hint
 	if(mHeaderEntriesInfo.mEntries < MAX_ENTRIES_WITHOUT_TIME_STAMP)
 	{
 		return ; //there are enough empty entry index space, no need to stamp time.
@@ -1244,14 +1311,15 @@ void LLTextureCache::updateEntryTimeStamp(S32 idx, Entry& entry)
 
 	if (idx >= 0)
 	{
-		if (!mReadOnly)
+		if (!mReadOnly && idx < (S32)getMappedEntryCount())
 		{
 			entry.mTime = time(NULL);			
-			mUpdatedEntryMap[idx] = entry ;
+			getMappedEntry(idx)->mTime = entry.mTime;
 		}
 	}
 }
 
+//No lock held.
 //update an existing entry, write to header file immediately.
 bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32 new_data_size)
 {
@@ -1265,13 +1333,14 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 	{
 		bool purge = false ;
 
-		lockHeaders() ;
+		HeaderShard& shard = getShard(entry.mID);
+		shard.mMutex.lock() ;
 
 		bool update_header = false ;
 		if(entry.mImageSize < 0) //is a brand-new entry
 		{
-			mHeaderIDMap[entry.mID] = idx;
-			mTexturesSizeMap[entry.mID] = new_body_size ;
+			shard.mHeaderIDMap[entry.mID] = idx;
+			shard.mTexturesSizeMap[entry.mID] = new_body_size ;
 			mTexturesSizeTotal += new_body_size ;
 			
 			// Update Header
@@ -1280,9 +1349,8 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 		else if (entry.mBodySize != new_body_size)
 		{
 			//already in mHeaderIDMap.
-			mTexturesSizeMap[entry.mID] = new_body_size ;
-			mTexturesSizeTotal -= entry.mBodySize ;
-			mTexturesSizeTotal += new_body_size ;
+			shard.mTexturesSizeMap[entry.mID] = new_body_size ;
+			mTexturesSizeTotal += new_body_size - entry.mBodySize ;
 		}
 		entry.mTime = time(NULL);
 		entry.mImageSize = new_image_size ; 
@@ -1295,7 +1363,7 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 			purge = true;
 		}
 		
-		unlockHeaders() ;
+		shard.mMutex.unlock() ;
 
 		if (purge)
 		{
@@ -1306,136 +1374,79 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 	return false ;
 }
 
-U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
+// Rebuilds the in-memory index from the mapped entries.
+U32 LLTextureCache::openAndReadEntries()
 {
 	U32 num_entries = mHeaderEntriesInfo.mEntries;
 
-	mHeaderIDMap.clear();
-	mTexturesSizeMap.clear();
+	for (S32 i = 0; i < NUM_HEADER_SHARDS; ++i)
+	{
+		mHeaderShards[i].mHeaderIDMap.clear();
+		mHeaderShards[i].mTexturesSizeMap.clear();
+	}
 	mFreeList.clear();
 	mTexturesSizeTotal = 0;
 
-	LLAPRFile* aprfile = NULL; 
-	if(mUpdatedEntryMap.empty())
+	if (!num_entries)
 	{
-		aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
+		return 0;
 	}
-	else //update the header file first.
+	if (!openHeaderEntriesFile() || num_entries > getMappedEntryCount())
 	{
-		aprfile = openHeaderEntriesFile(false, 0);
-		updatedHeaderEntriesFile() ;
-		if(!aprfile)
-		{
-			return 0;
-		}
-		aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo));
+		LL_WARNS() << "Corrupted header entries, " << num_entries << " entries do not fit in "
+				   << mHeaderEntriesFileName << LL_ENDL;
+		purgeAllTextures(false);
+		return 0;
 	}
+
+	for (S32 i = 0; i < NUM_HEADER_SHARDS; ++i)
+	{
+		mHeaderShards[i].mHeaderIDMap.reserve(num_entries / NUM_HEADER_SHARDS);
+	}
+	const Entry* entries = getMappedEntry(0);
+	S64 textures_size = 0;
 	for (U32 idx=0; idx<num_entries; idx++)
 	{
-		Entry entry;
-		S32 bytes_read = aprfile->read((void*)(&entry), (S32)sizeof(Entry));
-		if (bytes_read < sizeof(Entry))
-		{
-			LL_WARNS() << "Corrupted header entries, failed at " << idx << " / " << num_entries << LL_ENDL;
-			closeHeaderEntriesFile();
-			purgeAllTextures(false);
-			return 0;
-		}
-		entries.push_back(entry);
+		const Entry& entry = entries[idx];
 // 		LL_INFOS() << "ENTRY: " << entry.mTime << " TEX: " << entry.mID << " IDX: " << idx << " Size: " << entry.mImageSize << LL_ENDL;
 		if(entry.mImageSize > entry.mBodySize)
 		{
-			mHeaderIDMap[entry.mID] = idx;
-			mTexturesSizeMap[entry.mID] = entry.mBodySize;
-			mTexturesSizeTotal += entry.mBodySize;
+			HeaderShard& shard = getShard(entry.mID);
+			shard.mHeaderIDMap[entry.mID] = idx;
+			shard.mTexturesSizeMap[entry.mID] = entry.mBodySize;
+			textures_size += entry.mBodySize;
 		}
 		else
 		{
 			mFreeList.insert(idx);
 		}
 	}
-	closeHeaderEntriesFile();
+	mTexturesSizeTotal = textures_size;
 	return num_entries;
 }
 
-void LLTextureCache::writeEntriesAndClose(const std::vector<Entry>& entries)
-{
-	S32 num_entries = entries.size();
-	llassert_always(num_entries == mHeaderEntriesInfo.mEntries);
-	
-	if (!mReadOnly)
-	{
-		LLAPRFile* aprfile = openHeaderEntriesFile(false, (S32)sizeof(EntriesInfo));
-		for (S32 idx=0; idx<num_entries; idx++)
-		{
-			S32 bytes_written = aprfile->write((void*)(&entries[idx]), (S32)sizeof(Entry));
-			if(bytes_written != sizeof(Entry))
-			{
-				clearCorruptedCache() ; //clear the cache.
-				return ;
-			}
-		}
-		closeHeaderEntriesFile();
-	}
-}
-
+//No lock held.
+// Entries are written in place; this pushes the pages modified since the
+// last call towards the disk without waiting for them.
 void LLTextureCache::writeUpdatedEntries()
 {
-	lockHeaders() ;
-	if (!mReadOnly && !mUpdatedEntryMap.empty())
-	{
-		openHeaderEntriesFile(false, 0);
-		updatedHeaderEntriesFile() ;
-		closeHeaderEntriesFile();
-	}
-	unlockHeaders() ;
-}
-
-//mHeaderMutex is locked and mHeaderAPRFile is created before calling this.
-void LLTextureCache::updatedHeaderEntriesFile()
-{
-	if (!mReadOnly && !mUpdatedEntryMap.empty() && mHeaderAPRFile)
+	HeadersLock lock(this);
+	if (!mReadOnly)
 	{
-		//entriesInfo
-		mHeaderAPRFile->seek(APR_SET, 0);
-		S32 bytes_written = mHeaderAPRFile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-		if(bytes_written != sizeof(EntriesInfo))
-		{
-			clearCorruptedCache() ; //clear the cache.
-			return ;
-		}
-		
-		//write each updated entry
-		S32 entry_size = (S32)sizeof(Entry) ;
-		S32 prev_idx = -1 ;
-		S32 delta_idx ;
-		for (idx_entry_map_t::iterator iter = mUpdatedEntryMap.begin(); iter != mUpdatedEntryMap.end(); ++iter)
-		{
-			delta_idx = iter->first - prev_idx - 1;
-			prev_idx = iter->first ;
-			if(delta_idx)
-			{
-				mHeaderAPRFile->seek(APR_CUR, delta_idx * entry_size);
-			}
-			
-			bytes_written = mHeaderAPRFile->write((void*)(&iter->second), entry_size);
-			if(bytes_written != entry_size)
-			{
-				clearCorruptedCache() ; //clear the cache.
-				return ;
-			}
-		}
-		mUpdatedEntryMap.clear() ;
+		mHeaderEntriesFile.flush();
 	}
 }
 //----------------------------------------------------------------------------
 
-// Called from either the main thread or the worker thread
+// Called from either the main thread or the worker thread, no lock held
 void LLTextureCache::readHeaderCache()
 {
-	mHeaderMutex.lock();
+	lockHeaders();
 
-	mLRU.clear(); // always clear the LRU
+	for (S32 i = 0; i < NUM_HEADER_SHARDS; ++i)
+	{
+		mHeaderShards[i].mLRU.clear(); // always clear the LRU
+	}
 
 	readEntriesHeader();
 	
@@ -1448,10 +1459,10 @@ void LLTextureCache::readHeaderCache()
 	}
 	else
 	{
-		std::vector<Entry> entries;
-		U32 num_entries = openAndReadEntries(entries);
+		U32 num_entries = openAndReadEntries();
 		if (num_entries)
 		{
+			Entry* entries = getMappedEntry(0);
 			U32 empty_entries = 0;
 			typedef std::pair<U32, S32> lru_data_t;
 			std::set<lru_data_t> lru;
@@ -1499,7 +1510,8 @@ void LLTextureCache::readHeaderCache()
 				S32 lru_entries = (S32)((F32)sCacheMaxEntries * TEXTURE_CACHE_LRU_SIZE);
 				for (std::set<lru_data_t>::iterator iter = lru.begin(); iter != lru.end(); ++iter)
 				{
-					mLRU.insert(entries[iter->second].mID);
+					const LLUUID& id = entries[iter->second].mID;
+					getShard(id).mLRU.insert(id);
 // 					LL_INFOS() << "LRU: " << iter->first << " : " << iter->second << LL_ENDL;
 					if (--lru_entries <= 0)
 						break;
@@ -1513,25 +1525,23 @@ void LLTextureCache::readHeaderCache()
 					std::string tex_filename = getTextureFileName(entries[*iter].mID);
 					removeEntry((S32)*iter, entries[*iter], tex_filename);
 				}
-				// If we removed any entries, we need to rebuild the entries list,
+				// If we removed any entries, we need to compact the entries,
 				// write the header, and call this again
-				std::vector<Entry> new_entries;
+				U32 new_entries = 0;
 				for (U32 i=0; i<num_entries; i++)
 				{
-					const Entry& entry = entries[i];
-					if (entry.mImageSize > 0)
+					if (entries[i].mImageSize > 0)
 					{
-						new_entries.push_back(entry);
+						entries[new_entries++] = entries[i];
 					}
 				}
                 mFreeList.clear(); // recreating list, no longer valid.
-				llassert_always(new_entries.size() <= sCacheMaxEntries);
-				mHeaderEntriesInfo.mEntries = new_entries.size();
+				llassert_always(new_entries <= sCacheMaxEntries);
+				mHeaderEntriesInfo.mEntries = new_entries;
 				writeEntriesHeader();
-				writeEntriesAndClose(new_entries);
-				mHeaderMutex.unlock(); // unlock the mutex before calling again
+				unlockHeaders(); // unlock the shards before calling again
 				readHeaderCache(); // repeat with new entries file
-				mHeaderMutex.lock();
+				lockHeaders();
 			}
 			else
 			{
@@ -1539,12 +1549,11 @@ void LLTextureCache::readHeaderCache()
 			}
 		}
 	}
-	mHeaderMutex.unlock();
+	unlockHeaders();
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
-//the header mutex is locked before calling this.
 void LLTextureCache::clearCorruptedCache()
 {
 	LL_WARNS() << "the texture cache is corrupted, need to be cleared." << LL_ENDL ;
@@ -1563,6 +1572,7 @@ void LLTextureCache::clearCorruptedCache()
 			LLFile::mkdir(dirname);
 		}
 	}
+	mCacheCorrupted = false;
 
 	return ;
 }
@@ -1571,6 +1581,12 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
 {
 	if (!mReadOnly)
 	{
+		if (purge_directories)
+		{
+			// the entries file is about to be deleted with the directory
+			closeHeaderEntriesFile();
+			closeFastCache();
+		}
 		const char* subdirs = "0123456789abcdef";
 		std::string delem = gDirUtilp->getDirDelimiter();
 		std::string mask = "*";
@@ -1593,21 +1609,26 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
 			LLFile::rmdir(mTexturesDirName);
 		}
 	}
-	mHeaderIDMap.clear();
-	mTexturesSizeMap.clear();
+	for (S32 i = 0; i < NUM_HEADER_SHARDS; ++i)
+	{
+		mHeaderShards[i].mHeaderIDMap.clear();
+		mHeaderShards[i].mTexturesSizeMap.clear();
+	}
 	mTexturesSizeTotal = 0;
 	mFreeList.clear();
-	mTexturesSizeTotal = 0;
-	mUpdatedEntryMap.clear();
 
 	// Info with 0 entries
 	mHeaderEntriesInfo.mVersion = sHeaderCacheVersion;
 	mHeaderEntriesInfo.mEntries = 0;
-	writeEntriesHeader();
+	if (!purge_directories)
+	{
+		writeEntriesHeader();
+	}
 
 	LL_INFOS() << "The entire texture cache is cleared." << LL_ENDL ;
 }
 
+//No lock held.
 void LLTextureCache::purgeTextures(bool validate)
 {
 	if (mReadOnly)
@@ -1621,36 +1642,41 @@ void LLTextureCache::purgeTextures(bool validate)
 		LLAppViewer::instance()->pauseMainloopTimeout();
 	}
 	
-	LLMutexLock lock(&mHeaderMutex);
+	HeadersLock lock(this);
 
 	LL_INFOS() << "TEXTURE CACHE: Purging." << LL_ENDL;
 
-	// Read the entries list
-	std::vector<Entry> entries;
-	U32 num_entries = openAndReadEntries(entries);
-	if (!num_entries)
+	// The shard maps are kept up to date as entries change, so only the
+	// entries of textures with bodies are visited.
+	U32 num_entries = mHeaderEntriesInfo.mEntries;
+	if (!num_entries || !openHeaderEntriesFile() || num_entries > getMappedEntryCount())
 	{
 		return; // nothing to purge
 	}
+	Entry* entries = getMappedEntry(0);
 	
-	// Use mTexturesSizeMap to collect UUIDs of textures with bodies
+	// Use the size maps to collect UUIDs of textures with bodies
 	typedef std::set<std::pair<U32,S32> > time_idx_set_t;
 	std::set<std::pair<U32,S32> > time_idx_set;
-	for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
-		 iter1 != mTexturesSizeMap.end(); ++iter1)
+	for (S32 i = 0; i < NUM_HEADER_SHARDS; ++i)
 	{
-		if (iter1->second > 0)
+		HeaderShard& shard = mHeaderShards[i];
+		for (size_map_t::iterator iter1 = shard.mTexturesSizeMap.begin();
+			 iter1 != shard.mTexturesSizeMap.end(); ++iter1)
 		{
-			id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-			if (iter2 != mHeaderIDMap.end())
+			if (iter1->second > 0)
 			{
-				S32 idx = iter2->second;
-				time_idx_set.emplace(entries[idx].mTime, idx);
-// 				LL_INFOS() << "TIME: " << entries[idx].mTime << " TEX: " << entries[idx].mID << " IDX: " << idx << " Size: " << entries[idx].mImageSize << LL_ENDL;
-			}
-			else
-			{
-				LL_ERRS() << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL ;
+				id_map_t::iterator iter2 = shard.mHeaderIDMap.find(iter1->first);
+				if (iter2 != shard.mHeaderIDMap.end())
+				{
+					S32 idx = iter2->second;
+					time_idx_set.emplace(entries[idx].mTime, idx);
+// 					LL_INFOS() << "TIME: " << entries[idx].mTime << " TEX: " << entries[idx].mID << " IDX: " << idx << " Size: " << entries[idx].mImageSize << LL_ENDL;
+				}
+				else
+				{
+					LL_ERRS() << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL ;
+				}
 			}
 		}
 	}
@@ -1685,7 +1711,7 @@ void LLTextureCache::purgeTextures(bool validate)
 			if (uuididx == validate_idx)
 			{
  				LL_DEBUGS("TextureCache") << "Validating: " << filename << "Size: " << entries[idx].mBodySize << LL_ENDL;
-				S32 bodysize = LLAPRFile::size(filename, getLocalAPRFilePool());
+				S32 bodysize = LLAPRFile::size(filename, getFilePool());
 				if (bodysize != entries[idx].mBodySize)
 				{
 					LL_WARNS("TextureCache") << "TEXTURE CACHE BODY HAS BAD SIZE: " << bodysize << " != " << entries[idx].mBodySize
@@ -1708,9 +1734,7 @@ void LLTextureCache::purgeTextures(bool validate)
 		}
 	}
 
-	LL_DEBUGS("TextureCache") << "TEXTURE CACHE: Writing Entries: " << num_entries << LL_ENDL;
-
-	writeEntriesAndClose(entries);
+	mHeaderEntriesFile.flush();
 	
 	// *FIX:Mani - watchdog back on.
 	LLAppViewer::instance()->resumeMainloopTimeout();
@@ -1753,7 +1777,7 @@ LLTextureCacheWorker* LLTextureCache::getWriter(handle_t handle)
 // Reads imagesize from the header, updates timestamp
 S32 LLTextureCache::getHeaderCacheEntry(const LLUUID& id, Entry& entry)
 {
-	LLMutexLock lock(&mHeaderMutex);	
+	LLMutexLock lock(&getShard(id).mMutex);
 	S32 idx = openAndReadEntry(id, entry, false);
 	if (idx >= 0)
 	{		
@@ -1765,9 +1789,10 @@ S32 LLTextureCache::getHeaderCacheEntry(const LLUUID& id, Entry& entry)
 // Writes imagesize to the header, updates timestamp
 S32 LLTextureCache::setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize)
 {
-	mHeaderMutex.lock();
+	HeaderShard& shard = getShard(id);
+	shard.mMutex.lock();
 	S32 idx = openAndReadEntry(id, entry, true);
-	mHeaderMutex.unlock();
+	shard.mMutex.unlock();
 
 	if (idx >= 0)
 	{
@@ -1776,11 +1801,16 @@ S32 LLTextureCache::setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imag
 
 	if(idx < 0) // retry
 	{
-		readHeaderCache(); // We couldn't write an entry, so refresh the LRU
-	
-		mHeaderMutex.lock();
-		llassert_always(!mLRU.empty() || mHeaderEntriesInfo.mEntries < sCacheMaxEntries);
-		mHeaderMutex.unlock();
+		// We couldn't get an entry, so free the least recently used one,
+		// refreshing the LRU first if it has run dry
+		if (!evictLRUEntry())
+		{
+			readHeaderCache();
+			bool evicted = evictLRUEntry();
+
+			LLMutexLock lock(&mFreeListMutex);
+			llassert_always(evicted || !mFreeList.empty() || mHeaderEntriesInfo.mEntries < sCacheMaxEntries);
+		}
 
 		idx = setHeaderCacheEntry(id, entry, imagesize, datasize); // assert above ensures no inf. recursion
 	}
@@ -1859,6 +1889,11 @@ LLTextureCache::handle_t LLTextureCache::writeToCache(const LLUUID& id, U32 prio
 		delete responder;
 		return LLWorkerThread::nullHandle();
 	}
+	if (mCacheCorrupted)
+	{
+		HeadersLock lock(this);
+		clearCorruptedCache();
+	}
 	if (mDoPurge)
 	{
 		// NOTE: This may cause an occasional hiccup,
@@ -1886,86 +1921,136 @@ LLTextureCache::handle_t LLTextureCache::writeToCache(const LLUUID& id, U32 prio
 //called in the main thread
 LLPointer<LLImageRaw> LLTextureCache::readFromFastCache(const LLUUID& id, S32& discardlevel)
 {
-	U32 offset;
+	S32 idx;
 	{
-		LLMutexLock lock(&mHeaderMutex);
-		id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-		if(iter == mHeaderIDMap.end())
+		HeaderShard& shard = getShard(id);
+		LLMutexLock lock(&shard.mMutex);
+		id_map_t::const_iterator iter = shard.mHeaderIDMap.find(id);
+		if(iter == shard.mHeaderIDMap.end())
 		{
+			record(sFastCacheHitRate, LLUnits::Ratio::fromValue(0));
 			return NULL; //not in the cache
 		}
 
-		offset = iter->second;
+		idx = iter->second;
 	}
-	offset *= TEXTURE_FAST_CACHE_ENTRY_SIZE;
 
-	U8* data;
-	S32 head[4];
+	// the largest tier holding the texture wins
+	LLPointer<LLImageRaw> raw;
+	for (S32 tier = NUM_FAST_CACHE_TIERS - 1; tier >= 0; --tier)
 	{
-		LLMutexLock lock(&mFastCacheMutex);
+		if (readFastCacheTier(tier, idx, id, raw, discardlevel))
+		{
+			record(sFastCacheHitRate, LLUnits::Ratio::fromValue(1));
+			switch (tier)
+			{
+			case 0:
+				add(sFastCacheTier0Hits, 1);
+				break;
+			case 1:
+				add(sFastCacheTier1Hits, 1);
+				break;
+			default:
+				add(sFastCacheTier2Hits, 1);
+				break;
+			}
+			return raw;
+		}
+	}
 
-		openFastCache();
+	record(sFastCacheHitRate, LLUnits::Ratio::fromValue(0));
+	return NULL;
+}
 
-		mFastCachep->seek(APR_SET, offset);		
-	
-		if(mFastCachep->read(head, TEXTURE_FAST_CACHE_ENTRY_OVERHEAD) != TEXTURE_FAST_CACHE_ENTRY_OVERHEAD)
+bool LLTextureCache::readFastCacheTier(S32 tier, S32 idx, const LLUUID& id, LLPointer<LLImageRaw>& raw, S32& discardlevel)
+{
+	FastCacheTier& fast_cache = mFastCacheTiers[tier];
+	U32 slots = fast_cache.mSlots;
+	if (!slots)
+	{
+		return false;
+	}
+	U32 slot = (U32)idx % slots;
+	S32 entry_size = get_fast_cache_data_size(tier) + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD;
+
+	U8* data;
+	FastCacheEntry head;
+	{
+		LLMutexLock lock(&getFastCacheMutex(slot));
+		if (!fast_cache.mSlab.isOpen())
 		{
-			//cache corrupted or under thread race condition
-			closeFastCache(); 
-			return NULL;
+			return false;
 		}
-		
-		S32 image_size = head[0] * head[1] * head[2];
-		if(!image_size) //invalid
+		const U8* entry = fast_cache.mSlab.getData() + (size_t)slot * entry_size;
+		memcpy(&head, entry, sizeof(FastCacheEntry));
+
+		// Slots of the larger tiers may hold another texture, and any slot
+		// may have been written by an older viewer or be garbage after a crash.
+		// Bound each dimension on its own before multiplying, so garbage
+		// can't overflow the pixel count.
+		const S32 max_pixels = TEXTURE_FAST_CACHE_TIER_DIMENSIONS[tier] * TEXTURE_FAST_CACHE_TIER_DIMENSIONS[tier];
+		if (head.mID != id
+			|| head.mWidth <= 0 || head.mWidth > max_pixels
+			|| head.mHeight <= 0 || head.mHeight > max_pixels / head.mWidth
+			|| head.mComponents <= 0 || head.mComponents > TEXTURE_FAST_CACHE_MAX_COMPONENTS)
 		{
-			closeFastCache();
-			return NULL;
+			return false;
 		}
-		discardlevel = head[3];
-		
-		data =  (U8*)ll_aligned_malloc_16(image_size);
-		if(mFastCachep->read(data, image_size) != image_size)
+
+		S32 image_size = head.mWidth * head.mHeight * head.mComponents;
+		data = (U8*)ll_aligned_malloc_16(image_size);
+		if (!data)
 		{
-			ll_aligned_free_16(data);
-			closeFastCache();
-			return NULL;
+			return false;
 		}
-
-		closeFastCache();
+		memcpy(data, entry + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD, image_size);
 	}
-	LLPointer<LLImageRaw> raw = new LLImageRaw(data, head[0], head[1], head[2], true);
-
-	return raw;
+	discardlevel = head.mDiscardLevel;
+	raw = new LLImageRaw(data, head.mWidth, head.mHeight, head.mComponents, true);
+	return true;
 }
 
-//return the fast cache location
-bool LLTextureCache::writeToFastCache(S32 id, LLPointer<LLImageRaw> raw, S32 discardlevel)
+// Stores raw in every tier it is large enough for: each tier only takes
+// images too large for the tier below it, downscaled to fit. Tiers already
+// holding this texture at the same resolution or better are left alone.
+bool LLTextureCache::writeToFastCache(S32 idx, const LLUUID& id, LLPointer<LLImageRaw> raw, S32 discardlevel)
 {
-	//rescale image if needed
 	if (raw.isNull() || !raw->getData())
 	{
 		LL_ERRS() << "Attempted to write NULL raw image to fastcache" << LL_ENDL;
 		return false;
 	}
 
-	S32 w, h, c;
-	w = raw->getWidth();
-	h = raw->getHeight();
-	c = raw->getComponents();
-
-	S32 i = 0 ;
-	
-	while(((w >> i) * (h >> i) * c) > TEXTURE_FAST_CACHE_ENTRY_SIZE - TEXTURE_FAST_CACHE_ENTRY_OVERHEAD)
+	// largest tier first, so each smaller image is scaled from the one before
+	for (S32 tier = NUM_FAST_CACHE_TIERS - 1; tier >= 0; --tier)
 	{
-		++i ;
-	}
-		
-	if(i)
-	{
-		w >>= i;
-		h >>= i;
-		if(w * h *c > 0) //valid
+		FastCacheTier& fast_cache = mFastCacheTiers[tier];
+		U32 slots = fast_cache.mSlots;
+		S32 w = raw->getWidth();
+		S32 h = raw->getHeight();
+		S32 c = raw->getComponents();
+		if (!slots || c > TEXTURE_FAST_CACHE_MAX_COMPONENTS
+			|| (tier > 0 && w * h <= TEXTURE_FAST_CACHE_TIER_DIMENSIONS[tier - 1] * TEXTURE_FAST_CACHE_TIER_DIMENSIONS[tier - 1]))
 		{
+			continue;
+		}
+
+		// as many pixels as a square image of the tier's size
+		S32 max_pixels = TEXTURE_FAST_CACHE_TIER_DIMENSIONS[tier] * TEXTURE_FAST_CACHE_TIER_DIMENSIONS[tier];
+		S32 i = 0;
+		while (((w >> i) * (h >> i)) > max_pixels)
+		{
+			++i;
+		}
+		if (i)
+		{
+			w >>= i;
+			h >>= i;
+			if (w * h * c <= 0)
+			{
+				// too narrow to scale down, the smaller tiers won't do better
+				break;
+			}
 			//make a duplicate to keep the original raw image untouched.
 			raw = raw->duplicate();
 			if (raw->isBufferInvalid())
@@ -1973,92 +2058,90 @@ bool LLTextureCache::writeToFastCache(S32 id, LLPointer<LLImageRaw> raw, S32 dis
 				LL_WARNS() << "Invalid image duplicate buffer" << LL_ENDL;
 				return false;
 			}
-
-			raw->scale(w, h) ;
-			
-			discardlevel += i ;
+			raw->scale(w, h);
+			discardlevel += i;
 		}
-	}
-	
-	//copy data
-	memcpy(mFastCachePadBuffer, &w, sizeof(S32));
-	memcpy(mFastCachePadBuffer + sizeof(S32), &h, sizeof(S32));
-	memcpy(mFastCachePadBuffer + sizeof(S32) * 2, &c, sizeof(S32));
-	memcpy(mFastCachePadBuffer + sizeof(S32) * 3, &discardlevel, sizeof(S32));
-
-	S32 copy_size = w * h * c;
-	if(copy_size > 0) //valid
-	{
-		copy_size = llmin(copy_size, TEXTURE_FAST_CACHE_ENTRY_SIZE - TEXTURE_FAST_CACHE_ENTRY_OVERHEAD);
-		memcpy(mFastCachePadBuffer + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD, raw->getData(), copy_size);
-	}
-	S32 offset = id * TEXTURE_FAST_CACHE_ENTRY_SIZE;
-
-	{
-		LLMutexLock lock(&mFastCacheMutex);
 
-		openFastCache();
+		U32 slot = (U32)idx % slots;
+		S32 entry_size = get_fast_cache_data_size(tier) + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD;
 
-		mFastCachep->seek(APR_SET, offset);	
-		
-		//no need to do this assertion check. When it fails, let it fail quietly.
-		//this failure could happen because other viewer removes the fast cache file when clearing cache.
-		//--> llassert_always(mFastCachep->write(mFastCachePadBuffer, TEXTURE_FAST_CACHE_ENTRY_SIZE) == TEXTURE_FAST_CACHE_ENTRY_SIZE);
-		mFastCachep->write(mFastCachePadBuffer, TEXTURE_FAST_CACHE_ENTRY_SIZE);
-
-		closeFastCache(true);
+		LLMutexLock lock(&getFastCacheMutex(slot));
+		if (!fast_cache.mSlab.isOpen() || !fast_cache.mSlab.isWritable())
+		{
+			continue;
+		}
+		U8* entry = fast_cache.mSlab.getData() + (size_t)slot * entry_size;
+		FastCacheEntry* head = (FastCacheEntry*)entry;
+		if (head->mID == id && head->mDiscardLevel <= discardlevel
+			&& head->mWidth * head->mHeight > 0)
+		{
+			continue;
+		}
+		// a crash in the middle of the copy leaves a slot naming no texture
+		head->mID.setNull();
+		memcpy(entry + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD, raw->getData(), w * h * c);
+		head->mWidth = w;
+		head->mHeight = h;
+		head->mComponents = c;
+		head->mDiscardLevel = discardlevel;
+		head->mID = id;
 	}
 
 	return true;
 }
 
-void LLTextureCache::openFastCache(bool first_time)
+void LLTextureCache::openFastCache(U64 large_tiers_size)
 {
-	if(!mFastCachep)
+	if (!mReadOnly)
 	{
-		if(first_time)
+		// replaced by the tiers
+		LLFile::remove(mTexturesDirName + gDirUtilp->getDirDelimiter() + old_fast_cache_filename, ENOENT);
+	}
+
+	for (S32 i = 0; i < NUM_FAST_CACHE_TIERS; ++i)
+	{
+		FastCacheTier& fast_cache = mFastCacheTiers[i];
+		S32 entry_size = get_fast_cache_data_size(i) + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD;
+		U32 slots = i ? (U32)(large_tiers_size * TEXTURE_FAST_CACHE_TIER_SHARE[i] / entry_size) : sCacheMaxEntries;
+		if (!slots)
 		{
-			if(!mFastCachePadBuffer)
-			{
-				mFastCachePadBuffer = (U8*)ll_aligned_malloc_16(TEXTURE_FAST_CACHE_ENTRY_SIZE);
-			}
-			mFastCachePoolp = new LLVolatileAPRPool();
-			if (LLAPRFile::isExist(mFastCacheFileName, mFastCachePoolp))
-			{
-				mFastCachep = new LLAPRFile(mFastCacheFileName, APR_READ|APR_WRITE|APR_BINARY, mFastCachePoolp) ;				
-			}
-			else
+			if (!mReadOnly)
 			{
-				mFastCachep = new LLAPRFile(mFastCacheFileName, APR_CREATE|APR_READ|APR_WRITE|APR_BINARY, mFastCachePoolp) ;
+				LLFile::remove(fast_cache.mFileName, ENOENT);
 			}
+			continue;
+		}
+
+		// A read-only cache uses whatever the other viewer left behind, as
+		// long as it has at least as many slots
+		if (fast_cache.mSlab.open(fast_cache.mFileName, (size_t)slots * entry_size, !mReadOnly))
+		{
+			fast_cache.mSlots = slots;
 		}
 		else
 		{
-			mFastCachep = new LLAPRFile(mFastCacheFileName, APR_READ|APR_WRITE|APR_BINARY, mFastCachePoolp) ;
+			LL_WARNS("TextureCache") << "Unable to map fast cache " << fast_cache.mFileName << LL_ENDL;
 		}
-
-		mFastCacheTimer.reset();
 	}
-	return;
+	LL_INFOS("TextureCache") << "Fast cache slots: " << mFastCacheTiers[0].mSlots << " / "
+		<< mFastCacheTiers[1].mSlots << " / " << mFastCacheTiers[2].mSlots << LL_ENDL;
 }
 	
-void LLTextureCache::closeFastCache(bool forced)
-{	
-	static const F32 timeout = 10.f ; //seconds
-
-	if(!mFastCachep)
+void LLTextureCache::closeFastCache()
+{
+	for (S32 i = 0; i < NUM_FAST_CACHE_LOCKS; ++i)
 	{
-		return ;
+		mFastCacheMutexes[i].lock();
 	}
-
-	if(!forced && mFastCacheTimer.getElapsedTimeF32() < timeout)
+	for (S32 i = 0; i < NUM_FAST_CACHE_TIERS; ++i)
 	{
-		return ;
+		mFastCacheTiers[i].mSlab.close();
+		mFastCacheTiers[i].mSlots = 0;
+	}
+	for (S32 i = NUM_FAST_CACHE_LOCKS - 1; i >= 0; --i)
+	{
+		mFastCacheMutexes[i].unlock();
 	}
-
-	delete mFastCachep;
-	mFastCachep = NULL;
-	return;
 }
 	
 bool LLTextureCache::writeComplete(handle_t handle, bool abort)
@@ -2097,19 +2180,21 @@ void LLTextureCache::addCompleted(Responder* responder, bool success)
 
 //////////////////////////////////////////////////////////////////////////////
 
-//called after mHeaderMutex is locked.
+//called after the shard of id is locked.
 void LLTextureCache::removeCachedTexture(const LLUUID& id)
 {
-	if(mTexturesSizeMap.find(id) != mTexturesSizeMap.end())
+	HeaderShard& shard = getShard(id);
+	size_map_t::iterator iter = shard.mTexturesSizeMap.find(id);
+	if(iter != shard.mTexturesSizeMap.end())
 	{
-		mTexturesSizeTotal -= mTexturesSizeMap[id] ;
-		mTexturesSizeMap.erase(id);
+		mTexturesSizeTotal -= iter->second ;
+		shard.mTexturesSizeMap.erase(iter);
 	}
-	mHeaderIDMap.erase(id);
-	LLAPRFile::remove(getTextureFileName(id), getLocalAPRFilePool());		
+	shard.mHeaderIDMap.erase(id);
+	LLAPRFile::remove(getTextureFileName(id), getFilePool());		
 }
 
-//called after mHeaderMutex is locked.
+//called after the shard of entry.mID is locked.
 void LLTextureCache::removeEntry(S32 idx, Entry& entry, std::string& filename)
 {
  	bool file_maybe_exists = true;	// Always attempt to remove when idx is invalid.
@@ -2118,7 +2203,7 @@ void LLTextureCache::removeEntry(S32 idx, Entry& entry, std::string& filename)
 	{
 		if (entry.mBodySize == 0)	// Always attempt to remove when mBodySize > 0.
 		{
-		  if (LLAPRFile::isExist(filename, getLocalAPRFilePool()))		// Sanity check. Shouldn't exist when body size is 0.
+		  if (LLAPRFile::isExist(filename, getFilePool()))		// Sanity check. Shouldn't exist when body size is 0.
 		  {
 			  LL_WARNS("TextureCache") << "Entry has body size of zero but file " << filename << " exists. Deleting this file, too." << LL_ENDL;
 		  }
@@ -2131,14 +2216,16 @@ void LLTextureCache::removeEntry(S32 idx, Entry& entry, std::string& filename)
 
 		entry.mImageSize = -1;
 		entry.mBodySize = 0;
-		mHeaderIDMap.erase(entry.mID);
-		mTexturesSizeMap.erase(entry.mID);		
+		HeaderShard& shard = getShard(entry.mID);
+		shard.mHeaderIDMap.erase(entry.mID);
+		shard.mTexturesSizeMap.erase(entry.mID);		
+		LLMutexLock lock(&mFreeListMutex);
 		mFreeList.insert(idx);	
 	}
 
 	if (file_maybe_exists)
 	{
-		LLAPRFile::remove(filename, getLocalAPRFilePool());		
+		LLAPRFile::remove(filename, getFilePool());		
 	}
 }
 
@@ -2148,7 +2235,8 @@ bool LLTextureCache::removeFromCache(const LLUUID& id)
 	bool ret = false ;
 	if (!mReadOnly)
 	{
-		lockHeaders() ;
+		HeaderShard& shard = getShard(id);
+		shard.mMutex.lock() ;
 
 		Entry entry;
 		S32 idx = openAndReadEntry(id, entry, false);
@@ -2160,7 +2248,7 @@ bool LLTextureCache::removeFromCache(const LLUUID& id)
 			ret = true;
 		}
 
-		unlockHeaders() ;
+		shard.mMutex.unlock() ;
 	}
 	return ret ;
 }
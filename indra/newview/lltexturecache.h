@@ -28,8 +28,12 @@
 #define LL_LLTEXTURECACHE_H
 
 #include "lldir.h"
+#include "llmappedfile.h"
 #include "lluuid.h"
 
+#include <boost/unordered_map.hpp>
+
+#include "llatomic.h"
 #include "llworkerthread.h"
 
 class LLImageFormatted;
@@ -97,7 +101,9 @@ public:
 		}
 	};
 	
-	LLTextureCache(bool threaded);
+	// More than one thread runs up to num_threads requests at once on the
+	// shared LLThreadPool (0 = as many as it has workers)
+	LLTextureCache(bool threaded, U32 num_threads = 1);
 	~LLTextureCache();
 
 	/*virtual*/ S32 update(F32 max_time_ms) override;	
@@ -129,10 +135,11 @@ public:
 	// debug
 	S32 getNumReads() { return mReaders.size(); }
 	S32 getNumWrites() { return mWriters.size(); }
-	S64Bytes getUsage() { return S64Bytes(mTexturesSizeTotal); }
+	S64Bytes getUsage() { return S64Bytes((S64)mTexturesSizeTotal); }
 	S64Bytes getMaxUsage() { return S64Bytes(sCacheMaxTexturesSize); }
 	U32 getEntries() { return mHeaderEntriesInfo.mEntries; }
 	U32 getMaxEntries() { return sCacheMaxEntries; };
+	U32 getThreadCount() const;
 	BOOL isInCache(const LLUUID& id) ;
 	BOOL isInLocal(const LLUUID& id) ;
 
@@ -141,25 +148,56 @@ protected:
 	std::string getLocalFileName(const LLUUID& id);
 	std::string getTextureFileName(const LLUUID& id);
 	void addCompleted(Responder* responder, bool success);
+	// Pool workers share the global (locked) APR file pool
+	LLVolatileAPRPool* getFilePool() { return mPool ? nullptr : getLocalAPRFilePool(); }
 	
 protected:
 	//void setFileAPRPool(apr_pool_t* pool) { mFileAPRPool = pool ; }
 
 private:
+	typedef boost::unordered_map<LLUUID, S32> id_map_t;
+	typedef std::map<LLUUID,S32> size_map_t;
+
+	// The in-memory header index is split by texture id so that workers
+	// handling different textures do not wait on each other. The entry slots
+	// they point into are shared and handed out under mFreeListMutex, which
+	// is only ever taken while holding at most one shard lock.
+	enum { NUM_HEADER_SHARDS = 16 };
+	struct HeaderShard
+	{
+		LLMutex mMutex;
+		id_map_t mHeaderIDMap;
+		size_map_t mTexturesSizeMap; // bodies only
+		std::set<LLUUID> mLRU;
+	};
+
+	class HeadersLock
+	{
+	public:
+		HeadersLock(LLTextureCache* cache) : mCache(cache) { mCache->lockHeaders(); }
+		~HeadersLock() { mCache->unlockHeaders(); }
+	private:
+		LLTextureCache* mCache;
+	};
+
+	HeaderShard& getShard(const LLUUID& id) { return mHeaderShards[id.mData[UUID_BYTES - 1] % NUM_HEADER_SHARDS]; }
+
 	void setDirNames(ELLPath location);
 	void readHeaderCache();
 	void clearCorruptedCache();
 	void purgeAllTextures(bool purge_directories);
 	void purgeTextures(bool validate);
-	LLAPRFile* openHeaderEntriesFile(bool readonly, S32 offset);
+	bool openHeaderEntriesFile();
 	void closeHeaderEntriesFile();
+	U32 getMappedEntryCount() const;
+	Entry* getMappedEntry(S32 idx);
 	void readEntriesHeader();
 	void writeEntriesHeader();
 	S32 openAndReadEntry(const LLUUID& id, Entry& entry, bool create);
+	bool evictLRUEntry();
 	bool updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32 new_body_size);
 	void updateEntryTimeStamp(S32 idx, Entry& entry) ;
-	U32 openAndReadEntries(std::vector<Entry>& entries);
-	void writeEntriesAndClose(const std::vector<Entry>& entries);
+	U32 openAndReadEntries();
 	void readEntryFromHeaderImmediately(S32& idx, Entry& entry) ;
 	void writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header = false) ;
 	void removeEntry(S32 idx, Entry& entry, std::string& filename);
@@ -167,22 +205,24 @@ private:
 	S32 getHeaderCacheEntry(const LLUUID& id, Entry& entry);
 	S32 setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize);
 	void writeUpdatedEntries() ;
-	void updatedHeaderEntriesFile() ;
-	void lockHeaders() { mHeaderMutex.lock(); }
-	void unlockHeaders() { mHeaderMutex.unlock(); }
+	void lockHeaders();
+	void unlockHeaders();
 	
-	void openFastCache(bool first_time = false);
-	void closeFastCache(bool forced = false);
-	bool writeToFastCache(S32 id, LLPointer<LLImageRaw> raw, S32 discardlevel);	
+	void openFastCache(U64 large_tiers_size);
+	void closeFastCache();
+	bool writeToFastCache(S32 idx, const LLUUID& id, LLPointer<LLImageRaw> raw, S32 discardlevel);
+	bool readFastCacheTier(S32 tier, S32 idx, const LLUUID& id, LLPointer<LLImageRaw>& raw, S32& discardlevel);
+	LLMutex& getFastCacheMutex(U32 slot) { return mFastCacheMutexes[slot % NUM_FAST_CACHE_LOCKS]; }
 
 private:
 	// Internal
 	LLMutex mWorkersMutex;
-	LLMutex mHeaderMutex;
+	HeaderShard mHeaderShards[NUM_HEADER_SHARDS];
+	LLMutex mFreeListMutex; // mHeaderEntriesInfo and mFreeList
 	LLMutex mListMutex;
-	LLMutex mFastCacheMutex;
-	LLAPRFile* mHeaderAPRFile;
-	LLVolatileAPRPool* mFastCachePoolp;
+	// texture.entries: EntriesInfo followed by up to sCacheMaxEntries Entry
+	// records, mapped for the life of the cache and updated in place
+	LLMappedFile mHeaderEntriesFile;
 	
 	typedef std::map<handle_t, LLTextureCacheWorker*> handle_map_t;
 	handle_map_t mReaders;
@@ -199,27 +239,32 @@ private:
 	// HEADERS (Include first mip)
 	std::string mHeaderEntriesFileName;
 	std::string mHeaderDataFileName;
-	std::string mFastCacheFileName;
 	EntriesInfo mHeaderEntriesInfo;
 	std::set<S32> mFreeList; // deleted entries
-	std::set<LLUUID> mLRU;
-	typedef std::map<LLUUID, S32> id_map_t;
-	id_map_t mHeaderIDMap;
+	// set when an entry is found outside the mapped file; the cache is
+	// cleared by the next writeToCache(), which can take every shard lock
+	LLAtomic32<bool> mCacheCorrupted;
 
-	LLAPRFile*   mFastCachep;
-	LLFrameTimer mFastCacheTimer;
-	U8*          mFastCachePadBuffer;
+	// FAST CACHE (decoded thumbnails, one mapped slab per resolution tier)
+	// Tier 0 has a slot for every header entry. The larger tiers are sized
+	// from FastCacheLargeTierSize and shared by entries with the same index
+	// modulo their slot count, so every slot records whose image it holds.
+	enum { NUM_FAST_CACHE_TIERS = 3, NUM_FAST_CACHE_LOCKS = 16 };
+	struct FastCacheTier
+	{
+		std::string mFileName;
+		LLMappedFile mSlab;
+		U32 mSlots;
+	};
+	FastCacheTier mFastCacheTiers[NUM_FAST_CACHE_TIERS];
+	// guard slots of every tier, by slot index
+	LLMutex mFastCacheMutexes[NUM_FAST_CACHE_LOCKS];
 
 	// BODIES (TEXTURES minus headers)
 	std::string mTexturesDirName;
-	typedef std::map<LLUUID,S32> size_map_t;
-	size_map_t mTexturesSizeMap;
-	S64 mTexturesSizeTotal;
+	LLAtomic32<S64> mTexturesSizeTotal;
 	LLAtomic32<bool> mDoPurge;
 
-	typedef std::map<S32, Entry> idx_entry_map_t;
-	idx_entry_map_t mUpdatedEntryMap;
-
 	// Statics
 	static F32 sHeaderCacheVersion;
 	static U32 sCacheMaxEntries;
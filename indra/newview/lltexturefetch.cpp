@@ -49,6 +49,7 @@
 #include "llviewerassetstats.h"
 #include "llworld.h"
 #include "llsdparam.h"
+#include "llsdserialize.h"
 #include "llsdutil.h"
 #include "llstartup.h"
 #include "llviewernetwork.h"
@@ -1784,12 +1785,24 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				mFileSize = total_size + 1 ; //flag the file is not fully loaded.
 			}
 			
-			U8 * buffer = (U8 *)ll_aligned_malloc_16(total_size);
-			if (cur_size > 0)
+			// A first fetch that arrived in one block is taken over
+			// as is, otherwise the pieces are copied together.
+			U8 * buffer(NULL);
+			size_t detached_size(0);
+			if (cur_size == 0 && src_offset == 0)
 			{
-				memcpy(buffer, mFormattedImage->getData(), cur_size);
+				buffer = (U8 *) mHttpBufferArray->detachContiguous(&detached_size);
+				llassert_always(! buffer || detached_size == total_size);
+			}
+			if (! buffer)
+			{
+				buffer = (U8 *)ll_aligned_malloc_16(total_size);
+				if (cur_size > 0)
+				{
+					memcpy(buffer, mFormattedImage->getData(), cur_size);
+				}
+				mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
 			}
-			mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
 
 			// NOTE: setData releases current data and owns new data (buffer)
 			mFormattedImage->setData(buffer, total_size);
@@ -2567,8 +2580,10 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, LLImageDecodeThread* image
 	LLAppCoreHttp & app_core_http(LLAppViewer::instance()->getAppCoreHttp());
 	mHttpRequest = new LLCore::HttpRequest;
 	mHttpOptions = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
+	mHttpOptions->setContiguousBody(true);
 	mHttpOptionsWithHeaders = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
 	mHttpOptionsWithHeaders->setWantHeaders(true);
+	mHttpOptionsWithHeaders->setContiguousBody(true);
     mHttpHeaders = LLCore::HttpHeaders::ptr_t(new LLCore::HttpHeaders);
 	mHttpHeaders->append(HTTP_OUT_HEADER_ACCEPT, HTTP_CONTENT_IMAGE_X_J2C);
 	mHttpPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_TEXTURE);
@@ -4488,6 +4503,59 @@ void LLTextureFetchDebugger::addHistoryEntry(LLTextureFetchWorker* worker)
 		worker->mFormattedImage->getDataSize(), worker->mRawImage->getDataSize()));
 }
 
+bool LLTextureFetchDebugger::saveTrace(const std::string& filename)
+{
+	LLSD trace = LLSD::emptyArray();
+	for (fetch_list_t::const_iterator iter = mFetchingHistory.begin(); iter != mFetchingHistory.end(); ++iter)
+	{
+		LLSD entry;
+		entry["id"] = iter->mID;
+		entry["requested_size"] = iter->mRequestedSize;
+		entry["decoded_level"] = iter->mDecodedLevel;
+		entry["fetched_size"] = iter->mFetchedSize;
+		entry["decoded_size"] = iter->mDecodedSize;
+		trace.append(entry);
+	}
+
+	llofstream out_file(filename.c_str());
+	if (!out_file.is_open())
+	{
+		LL_WARNS("TextureFetch") << "Unable to write texture fetch trace " << filename << LL_ENDL;
+		return false;
+	}
+	LLSDSerialize::toXML(trace, out_file);
+	LL_INFOS("TextureFetch") << "Saved " << trace.size() << " texture fetches to " << filename << LL_ENDL;
+	return true;
+}
+
+bool LLTextureFetchDebugger::loadTrace(const std::string& filename)
+{
+	if (mDebuggerState != IDLE)
+	{
+		return false;
+	}
+
+	LLSD trace;
+	llifstream in_file(filename.c_str());
+	if (!in_file.is_open() || LLSDSerialize::fromXML(trace, in_file) <= 0 || !trace.isArray())
+	{
+		LL_WARNS("TextureFetch") << "Unable to read texture fetch trace " << filename << LL_ENDL;
+		return false;
+	}
+
+	mFetchingHistory.clear();
+	mFetchingHistory.reserve(trace.size());
+	for (LLSD::array_const_iterator iter = trace.beginArray(); iter != trace.endArray(); ++iter)
+	{
+		const LLSD& entry = *iter;
+		LLUUID id = entry["id"].asUUID();
+		mFetchingHistory.push_back(FetchEntry(id, entry["requested_size"].asInteger(), entry["decoded_level"].asInteger(),
+											  entry["fetched_size"].asInteger(), entry["decoded_size"].asInteger()));
+	}
+	LL_INFOS("TextureFetch") << "Loaded " << mFetchingHistory.size() << " texture fetches from " << filename << LL_ENDL;
+	return true;
+}
+
 void LLTextureFetchDebugger::lockCache()
 {
 }
@@ -4900,6 +4968,21 @@ bool LLTextureFetchDebugger::update(F32 max_time)
 			mCacheReadTime = mTimer.getElapsedTimeF32() ;
 			setDebuggerState(IDLE);
 			unlockCache();
+
+			S32 hits = 0;
+			S64 bytes = 0;
+			for (fetch_list_t::const_iterator iter = mFetchingHistory.begin(); iter != mFetchingHistory.end(); ++iter)
+			{
+				if (iter->mFormattedImage.notNull())
+				{
+					++hits;
+					bytes += iter->mFormattedImage->getDataSize();
+				}
+			}
+			LL_INFOS("TextureFetch") << "Cache read of " << mFetchingHistory.size() << " textures: " << hits << " hits, "
+									 << (bytes >> 10) << " KB in " << mCacheReadTime << " s ("
+									 << (mCacheReadTime > 0.f ? (S32)(hits / mCacheReadTime) : 0) << " reads/s) on "
+									 << mTextureCache->getThreadCount() << " cache threads" << LL_ENDL;
 		}
 		break;
 	case WRITE_CACHE:
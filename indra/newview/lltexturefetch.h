@@ -547,6 +547,12 @@ public:
 	//fetching history
 	void clearHistory();
 	void addHistoryEntry(LLTextureFetchWorker* worker);
+
+	// The fetching history doubles as a texture request trace: saved from
+	// one session, it can be loaded in another and replayed against the
+	// texture cache with READ_CACHE.
+	bool saveTrace(const std::string& filename);
+	bool loadTrace(const std::string& filename);
 	
 	// Inherited from LLCore::HttpHandler
 	// Threads:  Ttf
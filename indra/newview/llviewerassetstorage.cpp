@@ -30,6 +30,7 @@
 
 #include "llviewerassetstorage.h"
 
+#include "llsharedassetstore.h"
 #include "llvfile.h"
 #include "llvfs.h"
 #include "message.h"
@@ -113,6 +114,7 @@ LLViewerAssetStorage::LLViewerAssetStorage(LLMessageSystem *msg, LLXferManager *
       mCountStarted(0),
       mCountCompleted(0),
       mCountSucceeded(0),
+      mCountSharedHits(0),
       mTotalBytesFetched(0)
 {
 }
@@ -126,6 +128,7 @@ LLViewerAssetStorage::LLViewerAssetStorage(LLMessageSystem *msg, LLXferManager *
       mCountStarted(0),
       mCountCompleted(0),
       mCountSucceeded(0),
+      mCountSharedHits(0),
       mTotalBytesFetched(0)
 {
 }
@@ -446,6 +449,13 @@ void LLViewerAssetStorage::assetRequestCoro(
     S32 result_code = LL_ERR_NOERR;
     LLExtStat ext_status = LL_EXSTAT_NONE;
 
+    // Filed under the grid the request was made on
+    const LLUUID shared_ns = getSharedNamespace();
+    if (fetchFromSharedStore(req, uuid, atype, shared_ns))
+    {
+        return;
+    }
+
     if (!gAgent.getRegion())
     {
         LL_WARNS_ONCE("ViewerAsset") << "Asset request fails: no region set" << LL_ENDL;
@@ -567,6 +577,10 @@ void LLViewerAssetStorage::assetRequestCoro(
             else
             {
                 mCountSucceeded++;
+                if (gSharedAssetStore)
+                {
+                    gSharedAssetStore->store(shared_ns, uuid, atype, raw.data(), size);
+                }
             }
         }
         else
@@ -582,6 +596,48 @@ void LLViewerAssetStorage::assetRequestCoro(
     removeAndCallbackPendingDownloads(uuid, atype, uuid, atype, result_code, ext_status);
 }
 
+const LLUUID& LLViewerAssetStorage::getSharedNamespace()
+{
+    // We are created before the grid is chosen at the login screen
+    const std::string grid_id = LLGridManager::getInstance()->getGridId();
+    if (grid_id != mSharedGridId || mSharedNamespace.isNull())
+    {
+        mSharedGridId = grid_id;
+        mSharedNamespace = LLSharedAssetStore::makeNamespace(grid_id);
+    }
+    return mSharedNamespace;
+}
+
+bool LLViewerAssetStorage::fetchFromSharedStore(LLViewerAssetRequest *req, const LLUUID& uuid, LLAssetType::EType atype,
+                                                const LLUUID& shared_ns)
+{
+    std::vector<U8> data;
+    if (!gSharedAssetStore || !gSharedAssetStore->read(shared_ns, uuid, atype, data))
+    {
+        return false;
+    }
+
+    // Same create-then-rename flow as a download
+    LLUUID temp_id;
+    temp_id.generate();
+    LLVFile vf(gAssetStorage->mVFS, temp_id, atype, LLVFile::WRITE);
+    vf.setMaxSize(data.size());
+    if (!vf.write(&data[0], data.size()) || !vf.rename(uuid, atype))
+    {
+        LL_WARNS("ViewerAsset") << "Couldn't copy shared asset " << uuid << " to the VFS" << LL_ENDL;
+        vf.remove();
+        return false;
+    }
+
+    LL_DEBUGS("ViewerAsset") << "Found asset " << uuid << " in the shared asset store" << LL_ENDL;
+
+    // not a fetch, keep it out of the request timings
+    req->mMetricsStartTime = (U32Seconds)0;
+    mCountSharedHits++;
+    removeAndCallbackPendingDownloads(uuid, atype, uuid, atype, LL_ERR_NOERR, LL_EXSTAT_VFS_CACHED);
+    return true;
+}
+
 std::string LLViewerAssetStorage::getAssetURL(const std::string& cap_url, const LLUUID& uuid, LLAssetType::EType atype)
 {
     std::string type_name = LLAssetType::lookup(atype);
@@ -598,4 +654,9 @@ void LLViewerAssetStorage::logAssetStorageInfo()
     LL_INFOS("AssetStorage") << "mCountCompleted " << mCountCompleted << LL_ENDL;
     LL_INFOS("AssetStorage") << "mCountSucceeded " << mCountSucceeded << LL_ENDL;
     LL_INFOS("AssetStorage") << "mTotalBytesFetched " << mTotalBytesFetched << LL_ENDL;
+    LL_INFOS("AssetStorage") << "mCountSharedHits " << mCountSharedHits << LL_ENDL;
+    if (gSharedAssetStore)
+    {
+        gSharedAssetStore->dumpStats();
+    }
 }
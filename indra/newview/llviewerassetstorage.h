@@ -89,6 +89,14 @@ protected:
                           void (*callback) (LLVFS *vfs, const LLUUID&, LLAssetType::EType, void *, S32, LLExtStat),
                           void *user_data);
 
+    // gSharedAssetStore namespace of the current grid
+    const LLUUID& getSharedNamespace();
+
+    // Copies the asset from gSharedAssetStore into the VFS and completes the
+    // request, if the store has it under shared_ns.
+    bool fetchFromSharedStore(LLViewerAssetRequest *req, const LLUUID& uuid, LLAssetType::EType atype,
+                              const LLUUID& shared_ns);
+
     std::string getAssetURL(const std::string& cap_url, const LLUUID& uuid, LLAssetType::EType atype);
 
     void logAssetStorageInfo() override;
@@ -99,7 +107,10 @@ protected:
     S32 mCountStarted;
     S32 mCountCompleted;
     S32 mCountSucceeded;
+    S32 mCountSharedHits;
     S64 mTotalBytesFetched;
+    std::string mSharedGridId;
+    LLUUID mSharedNamespace; // for mSharedGridId
 };
 
 #endif
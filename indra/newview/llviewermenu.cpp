@@ -80,6 +80,7 @@
 #include "lllandmarkactions.h"
 #include "llgroupmgr.h"
 #include "lltooltip.h"
+#include "lltracering.h"
 #include "lltoolface.h"
 #include "llhudeffecttrail.h"
 #include "llhudmanager.h"
@@ -7631,6 +7632,21 @@ void handle_dump_timers()
 	LLTrace::BlockTimer::dumpCurTimes();
 }
 
+void handle_dump_trace_events()
+{
+	// the last few seconds of every thread, for chrome://tracing or Perfetto
+	const F64 TRACE_SECONDS = 10.0;
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "block_timer_trace.json");
+	llofstream os(filename.c_str());
+	if (!os.is_open())
+	{
+		LL_WARNS() << "Unable to write " << filename << LL_ENDL;
+		return;
+	}
+	U32 events = LLTrace::EventRing::writeChromeTrace(os, TRACE_SECONDS);
+	LL_INFOS() << "Wrote " << events << " block timer events to " << filename << LL_ENDL;
+}
+
 void handle_debug_avatar_textures(void*)
 {
 	LLViewerObject* objectp = LLSelectMgr::getInstance()->getSelection()->getPrimaryObject();
@@ -8795,6 +8811,7 @@ void initialize_menus()
 	view_listener_t::addMenu(new LLAdvancedDumpSelectMgr(), "Advanced.DumpSelectMgr");
 	view_listener_t::addMenu(new LLAdvancedDumpInventory(), "Advanced.DumpInventory");
 	commit.add("Advanced.DumpTimers", boost::bind(&handle_dump_timers) );
+	commit.add("Advanced.DumpTraceEvents", boost::bind(&handle_dump_trace_events) );
 	commit.add("Advanced.DumpFocusHolder", boost::bind(&handle_dump_focus) );
 	view_listener_t::addMenu(new LLAdvancedPrintSelectedObjectInfo(), "Advanced.PrintSelectedObjectInfo");
 	view_listener_t::addMenu(new LLAdvancedPrintAgentInfo(), "Advanced.PrintAgentInfo");
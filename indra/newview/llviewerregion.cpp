@@ -529,6 +529,7 @@ LLViewerRegion::LLViewerRegion(const U64 &handle,
 	mViewerAssetUrl(""),
 	mCacheLoaded(FALSE),
 	mCacheDirty(FALSE),
+	mCacheLoading(false),
 	mCapabilitiesReceived(false),
 	mSimulatorFeaturesReceived(false),
 	mReleaseNotesRequested(FALSE),
@@ -634,6 +635,10 @@ LLViewerRegion::~LLViewerRegion()
 #endif	
 	std::for_each(mImpl->mObjectPartition.begin(), mImpl->mObjectPartition.end(), DeletePointer());
 
+	if (mCacheLoading && LLVOCache::instanceExists())
+	{
+		LLVOCache::getInstance()->cancelRead(mHandle);
+	}
 	saveObjectCache();
 
 	delete mImpl;
@@ -676,18 +681,38 @@ void LLViewerRegion::loadObjectCache()
 
 	if(LLVOCache::instanceExists())
 	{
-		LLVOCache::getInstance()->readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap) ;
-		if (mImpl->mCacheMap.empty())
-		{
-			mCacheDirty = TRUE;
-		}
+		mCacheLoading = LLVOCache::getInstance()->readFromCache(mHandle, mImpl->mCacheID,
+			boost::bind(&LLViewerRegion::onObjectCacheLoaded, this, _1));
+	}
+	if (!mCacheLoading && mImpl->mCacheMap.empty())
+	{
+		mCacheDirty = TRUE;
+	}
+}
+
+void LLViewerRegion::onObjectCacheLoaded(LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+{
+	mCacheLoading = false;
+
+	// keep anything the simulator already told us about
+	mImpl->mCacheMap.insert(cache_entry_map.begin(), cache_entry_map.end());
+	if (mImpl->mCacheMap.empty())
+	{
+		mCacheDirty = TRUE;
+	}
+
+	if (!mHandshakeHost.isInvalid())
+	{
+		sendRegionHandshakeReply();
 	}
 }
 
 
 void LLViewerRegion::saveObjectCache()
 {
-	if (!mCacheLoaded)
+	// Still loading: what we have is not the whole cache, and writing it
+	// would throw away the part on disk.
+	if (!mCacheLoaded || mCacheLoading)
 	{
 		return;
 	}
@@ -2285,7 +2310,7 @@ void LLViewerRegion::decodeBoundingInfo(LLVOCacheEntry* entry)
 		gObjectList.processObjectUpdateFromCache(entry, this);
 		return;
 	}
-	if(!entry || !entry->isValid())
+	if(!entry || !entry->isValid() || !entry->getDP())
 	{
 		return;
 	}
@@ -2594,6 +2619,15 @@ bool LLViewerRegion::probeCache(U32 local_id, U32 crc, U32 flags, U8 &cache_miss
 				return true; //already probed
 			}
 
+			if(!entry->getDP())
+			{
+				// cached data could not be read back, drop it so the
+				// full update that answers the miss is cached afresh
+				mImpl->mCacheMap.erase(local_id);
+				addCacheMiss(local_id, CACHE_MISS_TYPE_FULL);
+				return false;
+			}
+
 			entry->setValid();
 			decodeBoundingInfo(entry);
 			return true;
@@ -2864,9 +2898,22 @@ void LLViewerRegion::unpackRegionHandshake()
 	loadObjectCache();
 
 	// After loading cache, signal that simulator can start
-	// sending data.
+	// sending data. The cache loads in the background, and the reply
+	// waits for it so the simulator knows whether to send cache probes.
+	mHandshakeHost = msg->getSender();
+	if (!mCacheLoading)
+	{
+		sendRegionHandshakeReply();
+	}
+}
+
+void LLViewerRegion::sendRegionHandshakeReply()
+{
 	// TODO: Send all upstream viewer->sim handshake info here.
-	LLHost host = msg->getSender();
+	LLMessageSystem* msg = gMessageSystem;
+	LLHost host = mHandshakeHost;
+	mHandshakeHost.invalidate();
+
 	msg->newMessage("RegionHandshakeReply");
 	msg->nextBlock("AgentData");
 	msg->addUUID("AgentID", gAgent.getID());
@@ -99,9 +99,11 @@ public:
 				   const F32 region_width_meters);
 	~LLViewerRegion();
 
-	// Call this after you have the region name and handle.
+	// Call this after you have the region name and handle. The cache is
+	// loaded in the background, see isObjectCacheLoading().
 	void loadObjectCache();
 	void saveObjectCache();
+	bool isObjectCacheLoading() const { return mCacheLoading; }
 
 	void sendMessage(); // Send the current message to this region's simulator
 	void sendReliableMessage(); // Send the current message to this region's simulator
@@ -445,6 +447,8 @@ protected:
 	void disconnectAllNeighbors();
 	void initStats();
 	void initPartitions();
+	void onObjectCacheLoaded(std::map<U32, LLPointer<LLVOCacheEntry> >& cache_entry_map);
+	void sendRegionHandshakeReply();
 
 public:
 	LLWind  mWind;
@@ -547,6 +551,8 @@ private:
 	// a structure of size 2^14 = 16,000
 	BOOL									mCacheLoaded;
 	BOOL                                    mCacheDirty;
+	bool                                    mCacheLoading;
+	LLHost                                  mHandshakeHost; // where to reply once the cache is loaded
 	BOOL	mAlive;					// can become false if circuit disconnects
 	BOOL	mCapabilitiesReceived;
 	BOOL	mSimulatorFeaturesReceived;
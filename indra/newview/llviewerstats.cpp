@@ -275,6 +275,8 @@ void LLViewerStats::updateFrameStats(const F64Seconds time_diff)
 	}
 	
 	mLastTimeDiff = time_diff;
+
+	LLAppViewer::instance()->getAppCoreHttp().sampleStats();
 }
 
 void LLViewerStats::addToMessage(LLSD &body)
@@ -37,6 +37,13 @@
 #include "pipeline.h"
 #include "llagentcamera.h"
 #include "llmemory.h"
+#include "llqueuedthread.h"
+#include "llthreadpool.h"
+#ifdef LL_USESYSTEMLIBS
+#include <zlib.h>
+#else
+#include "zlib/zlib.h"
+#endif
 
 //static variables
 U32 LLVOCacheEntry::sMinFrameRange = 0;
@@ -100,80 +107,24 @@ LLVOCacheEntry::LLVOCacheEntry()
 	mDP.assignBuffer(mBuffer, 0);
 }
 
-LLVOCacheEntry::LLVOCacheEntry(LLAPRFile* apr_file)
+LLVOCacheEntry::LLVOCacheEntry(U32 local_id, U32 crc, S32 hit_count, S32 dupe_count, S32 crc_change_count, const PackedData& packed)
 :	LLViewerOctreeEntryData(LLViewerOctreeEntry::LLVOCACHEENTRY),
 	LLTrace::MemTrackable<LLVOCacheEntry, 16>("LLVOCacheEntry"), 
+	mLocalID(local_id),
 	mParentID(0),
+	mCRC(crc),
 	mUpdateFlags(-1),
+	mHitCount(hit_count),
+	mDupeCount(dupe_count),
+	mCRCChangeCount(crc_change_count),
 	mBuffer(nullptr),
+	mPacked(packed),
 	mSceneContrib(0.f),
 	mState(INACTIVE),
 	mValid(FALSE),
 	mBSphereRadius(-1.0f)
 {
-	S32 size = -1;
-	BOOL success;
-
 	mDP.assignBuffer(mBuffer, 0);
-	
-	success = check_read(apr_file, &mLocalID, sizeof(U32));
-	if(success)
-	{
-		success = check_read(apr_file, &mCRC, sizeof(U32));
-	}
-	if(success)
-	{
-		success = check_read(apr_file, &mHitCount, sizeof(S32));
-	}
-	if(success)
-	{
-		success = check_read(apr_file, &mDupeCount, sizeof(S32));
-	}
-	if(success)
-	{
-		success = check_read(apr_file, &mCRCChangeCount, sizeof(S32));
-	}
-	if(success)
-	{
-		success = check_read(apr_file, &size, sizeof(S32));
-
-		// Corruption in the cache entries
-		if ((size > 10000) || (size < 1))
-		{
-			// We've got a bogus size, skip reading it.
-			// We won't bother seeking, because the rest of this file
-			// is likely bogus, and will be tossed anyway.
-			LL_WARNS() << "Bogus cache entry, size " << size << ", aborting!" << LL_ENDL;
-			success = FALSE;
-		}
-	}
-	if(success && size > 0)
-	{
-		mBuffer = new U8[size];
-		success = check_read(apr_file, mBuffer, size);
-
-		if(success)
-		{
-			mDP.assignBuffer(mBuffer, size);
-		}
-		else
-		{
-			delete[] mBuffer ;
-			mBuffer = nullptr ;
-		}
-	}
-
-	if(!success)
-	{
-		mLocalID = 0;
-		mCRC = 0;
-		mHitCount = 0;
-		mDupeCount = 0;
-		mCRCChangeCount = 0;
-		mBuffer = nullptr;
-		mEntry = nullptr;
-		mState = INACTIVE;
-	}
 }
 
 LLVOCacheEntry::~LLVOCacheEntry()
@@ -190,6 +141,7 @@ void LLVOCacheEntry::updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp)
 	}
 
 	mDP.freeBuffer();
+	mPacked = PackedData();
 
 	llassert_always(dp.getBufferSize() > 0);
 	mBuffer = new U8[dp.getBufferSize()];
@@ -225,7 +177,7 @@ void LLVOCacheEntry::removeAllChildren()
 //virtual 
 void LLVOCacheEntry::setOctreeEntry(LLViewerOctreeEntry* entry)
 {
-	if(!entry && mDP.getBufferSize() > 0)
+	if(!entry && getDP())
 	{
 		LLUUID fullid;
 		LLViewerObject::unpackUUID(&mDP, fullid, "ID");
@@ -322,6 +274,10 @@ LLVOCacheEntry* LLVOCacheEntry::getChild()
 
 LLDataPackerBinaryBuffer *LLVOCacheEntry::getDP()
 {
+	if (isPacked())
+	{
+		unpack();
+	}
 	if (mDP.getBufferSize() == 0)
 	{
 		//LL_INFOS() << "Not getting cache entry, invalid!" << LL_ENDL;
@@ -347,38 +303,36 @@ void LLVOCacheEntry::dump() const
 		<< LL_ENDL;
 }
 
-BOOL LLVOCacheEntry::writeToFile(LLAPRFile* apr_file) const
+void LLVOCacheEntry::unpack()
 {
-	BOOL success;
-	success = check_write(apr_file, (void*)&mLocalID, sizeof(U32));
-	if(success)
+	PackedData packed = mPacked;
+	mPacked = PackedData();
+
+	const U8* data = &(*packed.mFile)[packed.mOffset];
+	U8* buffer = new U8[packed.mSize];
+	bool success = true;
+	if (packed.mStoredSize == packed.mSize)
 	{
-		success = check_write(apr_file, (void*)&mCRC, sizeof(U32));
+		memcpy(buffer, data, packed.mSize);
 	}
-	if(success)
+	else
 	{
-		success = check_write(apr_file, (void*)&mHitCount, sizeof(S32));
+		uLongf size = packed.mSize;
+		success = uncompress(buffer, &size, data, packed.mStoredSize) == Z_OK && size == packed.mSize;
 	}
-	if(success)
+
+	if (success)
 	{
-		success = check_write(apr_file, (void*)&mDupeCount, sizeof(S32));
+		mBuffer = buffer;
+		mDP.assignBuffer(mBuffer, packed.mSize);
 	}
-	if(success)
+	else
 	{
-		success = check_write(apr_file, (void*)&mCRCChangeCount, sizeof(S32));
+		// leave the entry empty, getDP() returns nullptr and the region
+		// drops the entry and requests the object again
+		LL_WARNS() << "Corrupted cache entry " << mLocalID << ", discarding" << LL_ENDL;
+		delete[] buffer;
 	}
-	if(success)
-	{
-		S32 size = mDP.getBufferSize();
-		success = check_write(apr_file, (void*)&size, sizeof(S32));
-	
-		if(success)
-		{
-			success = check_write(apr_file, (void*)mBuffer, size);
-		}
-	}
-
-	return success ;
 }
 
 //static 
@@ -1048,15 +1002,375 @@ const U32 MIN_ENTRIES_TO_PURGE = 16 ;
 const U32 INVALID_TIME = 0 ;
 const char* object_cache_dirname = "objectcache";
 const char* header_filename = "object.cache";
+// regions loaded ahead of time that nobody asked for yet
+const U32 MAX_LOADED_REGIONS = 16 ;
+
+// Region cache file layout:
+//   RegionFileHeader
+//   RegionFileIndexEntry * mNumEntries, in local id order
+//   the object updates, see LLVOCacheEntry::PackedData
+// The index lets an entry be created without touching its update, which
+// is only unpacked when the region needs it.
+const U32 REGION_FILE_MAGIC = 0x43564c53 ; // "SLVC"
+const U32 REGION_FILE_FORMAT = 1 ;
+// an object update larger than this is corruption
+const U32 MAX_ENTRY_SIZE = 10000 ;
+
+struct RegionFileHeader
+{
+	U32 mMagic;
+	U32 mFormat;
+	U8  mCacheID[UUID_BYTES];
+	U32 mNumEntries;
+};
+
+struct RegionFileIndexEntry
+{
+	U32 mLocalID;
+	U32 mCRC;
+	S32 mHitCount;
+	S32 mDupeCount;
+	S32 mCRCChangeCount;
+	U32 mOffset;     // from the start of the file
+	U32 mStoredSize;
+	U32 mSize;
+};
+
+//-------------------------------------------------------------------
+// A region cache file to read, write or delete. Jobs only use what they
+// carry, never LLVOCache itself, and go through the global (thread-safe)
+// APR file pool.
+struct LLVOCache::IOJob
+{
+	enum EType { READ, WRITE, REMOVE };
+
+	// WRITE: one entry as it is to be stored. Copied on the main thread when
+	// the job is queued, since the entry itself may be unpacked or updated
+	// while the job runs.
+	struct WriteEntry
+	{
+		RegionFileIndexEntry mRecord;       // offset and sizes are set by write()
+		LLVOCacheEntry::PackedData mPacked; // stored as it was read if mPacked.mFile is set
+		std::vector<U8> mData;              // the unpacked update otherwise
+	};
+
+	IOJob(EType type, U64 handle, U32 serial)
+	:	mType(type),
+		mHandle(handle),
+		mSerial(serial),
+		mCompress(false),
+		mSuccess(false)
+	{
+	}
+
+	void run();
+	void read();
+	void write();
+
+	const EType mType;
+	const U64 mHandle;
+	const U32 mSerial;
+	std::string mFilename;
+	LLUUID mCacheID; // WRITE: stored in the file. READ: found in the file.
+	LLVOCacheEntry::vocache_entry_map_t mEntries; // READ
+	std::vector<WriteEntry> mWriteEntries;
+	bool mCompress;
+	bool mSuccess;
+};
+
+void LLVOCache::IOJob::run()
+{
+	if(mType == REMOVE)
+	{
+		LLAPRFile::remove(mFilename);
+		mSuccess = true;
+		return;
+	}
+
+	if(mType == READ)
+	{
+		read();
+	}
+	else
+	{
+		write();
+	}
+}
 
+void LLVOCache::IOJob::read()
+{
+	// the whole file in one go, the entries keep pointing into it until they are unpacked
+	std::shared_ptr<std::vector<U8> > file_data = std::make_shared<std::vector<U8> >();
+	{
+		apr_off_t file_size = 0;
+		LLAPRFile apr_file;
+		if(apr_file.open(mFilename, APR_READ|APR_BINARY, nullptr, &file_size) != APR_SUCCESS ||
+		   file_size < (apr_off_t)sizeof(RegionFileHeader))
+		{
+			return;
+		}
+		file_data->resize(file_size);
+		if(apr_file.read(&(*file_data)[0], file_size) != (apr_size_t)file_size)
+		{
+			return;
+		}
+	}
+
+	const U8* data = &(*file_data)[0];
+	const U32 file_size = file_data->size();
+	RegionFileHeader header;
+	memcpy(&header, data, sizeof(RegionFileHeader));
+	if(header.mMagic != REGION_FILE_MAGIC || header.mFormat != REGION_FILE_FORMAT)
+	{
+		LL_WARNS() << "Unknown cache file format for " << mFilename << LL_ENDL;
+		return;
+	}
+	memcpy(mCacheID.mData, header.mCacheID, UUID_BYTES);
+
+	U32 index_end = 0;
+	if(header.mNumEntries > file_size / sizeof(RegionFileIndexEntry) ||
+	   (index_end = sizeof(RegionFileHeader) + header.mNumEntries * sizeof(RegionFileIndexEntry)) > file_size)
+	{
+		LL_WARNS() << "Aborting cache file load for " << mFilename << ", cache file corruption!" << LL_ENDL;
+		return;
+	}
+
+	LLVOCacheEntry::PackedData packed;
+	packed.mFile = file_data;
+	const U8* index = data + sizeof(RegionFileHeader);
+	for(U32 i = 0; i < header.mNumEntries; i++)
+	{
+		RegionFileIndexEntry record;
+		memcpy(&record, index + i * sizeof(RegionFileIndexEntry), sizeof(RegionFileIndexEntry));
+
+		// Corruption in the cache entries. We won't bother with the rest of
+		// the file, it is likely bogus and will be tossed anyway.
+		if(!record.mLocalID || record.mSize < 1 || record.mSize > MAX_ENTRY_SIZE ||
+		   record.mStoredSize < 1 || record.mStoredSize > record.mSize ||
+		   record.mOffset < index_end || record.mOffset > file_size || record.mStoredSize > file_size - record.mOffset)
+		{
+			LL_WARNS() << "Aborting cache file load for " << mFilename << ", cache file corruption!" << LL_ENDL;
+			return;
+		}
+
+		packed.mOffset = record.mOffset;
+		packed.mStoredSize = record.mStoredSize;
+		packed.mSize = record.mSize;
+		mEntries[record.mLocalID] = new LLVOCacheEntry(record.mLocalID, record.mCRC, record.mHitCount,
+													   record.mDupeCount, record.mCRCChangeCount, packed);
+	}
+	mSuccess = true;
+}
+
+void LLVOCache::IOJob::write()
+{
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+	bool compress = mCompress && deflateInit(&strm, Z_BEST_SPEED) == Z_OK;
+
+	const U32 num_entries = mWriteEntries.size();
+
+	// header and index first, the updates get appended as we go
+	std::vector<U8> file_data(sizeof(RegionFileHeader) + num_entries * sizeof(RegionFileIndexEntry));
+	RegionFileHeader header;
+	header.mMagic = REGION_FILE_MAGIC;
+	header.mFormat = REGION_FILE_FORMAT;
+	memcpy(header.mCacheID, mCacheID.mData, UUID_BYTES);
+	header.mNumEntries = num_entries;
+	memcpy(&file_data[0], &header, sizeof(RegionFileHeader));
+
+	U32 index_offset = sizeof(RegionFileHeader);
+	for(std::vector<WriteEntry>::const_iterator iter = mWriteEntries.begin(); iter != mWriteEntries.end(); ++iter)
+	{
+		RegionFileIndexEntry record = iter->mRecord;
+		record.mOffset = file_data.size();
+
+		const LLVOCacheEntry::PackedData& packed = iter->mPacked;
+		if(packed.mFile)
+		{
+			// never looked at since it was read, store it as it came
+			record.mStoredSize = packed.mStoredSize;
+			record.mSize = packed.mSize;
+			const U8* data = &(*packed.mFile)[packed.mOffset];
+			file_data.insert(file_data.end(), data, data + packed.mStoredSize);
+		}
+		else
+		{
+			const U8* data = iter->mData.empty() ? nullptr : &iter->mData[0];
+			record.mSize = iter->mData.size();
+			record.mStoredSize = record.mSize;
+
+			if(compress && record.mSize > 0)
+			{
+				deflateReset(&strm);
+				U32 bound = deflateBound(&strm, record.mSize);
+				file_data.resize(record.mOffset + bound);
+				strm.next_in = (Bytef*)data;
+				strm.avail_in = record.mSize;
+				strm.next_out = &file_data[record.mOffset];
+				strm.avail_out = bound;
+				if(deflate(&strm, Z_FINISH) == Z_STREAM_END && strm.total_out < record.mSize)
+				{
+					record.mStoredSize = strm.total_out;
+					data = nullptr;
+				}
+				file_data.resize(record.mOffset + (data ? 0 : record.mStoredSize));
+			}
+			if(data)
+			{
+				// too small to gain anything from compression
+				file_data.insert(file_data.end(), data, data + record.mSize);
+			}
+		}
+
+		memcpy(&file_data[index_offset], &record, sizeof(RegionFileIndexEntry));
+		index_offset += sizeof(RegionFileIndexEntry);
+	}
+
+	if(compress)
+	{
+		deflateEnd(&strm);
+	}
+
+	LLAPRFile apr_file(mFilename, APR_CREATE|APR_WRITE|APR_TRUNCATE|APR_BINARY);
+	mSuccess = check_write(&apr_file, &file_data[0], file_data.size());
+}
+
+//-------------------------------------------------------------------
+// Runs the I/O jobs on the shared thread pool one at a time, in the order
+// they were queued, so that a read always sees the writes queued before it
+// and two writes of the same file never interleave. Finished jobs are
+// handed back whole to the main thread, which is where the cache entries
+// they hold must be released: their reference counts are not atomic.
+// The pool tasks hold a reference to the queue, never to LLVOCache.
+class LLVOCache::IOQueue : public std::enable_shared_from_this<IOQueue>
+{
+public:
+	IOQueue() : mDrainPosted(false), mBusy(false) {}
+
+	void push(const io_job_ptr_t& job);
+	void popCompleted(std::vector<io_job_ptr_t>& jobs);
+	// Runs whatever is left on the calling thread if the pool is not
+	// getting to it, and returns once every queued job is done.
+	void waitIdle();
+
+private:
+	bool runNext();
+	void drain();
+
+	LLCondition mCondition;
+	std::deque<io_job_ptr_t> mJobs;
+	std::vector<io_job_ptr_t> mCompleted;
+	bool mDrainPosted;
+	bool mBusy;
+};
+
+void LLVOCache::IOQueue::push(const io_job_ptr_t& job)
+{
+	{
+		LLMutexLock lock(&mCondition);
+		mJobs.push_back(job);
+		if(mDrainPosted)
+		{
+			return;
+		}
+		mDrainPosted = true;
+	}
+
+	LLThreadPool* pool = LLThreadPool::getShared();
+	std::shared_ptr<IOQueue> self = shared_from_this();
+	if(!pool || pool->isQuitting() || !pool->post([self]() { self->drain(); }, LLQueuedThread::PRIORITY_LOW))
+	{
+		drain();
+	}
+}
+
+void LLVOCache::IOQueue::popCompleted(std::vector<io_job_ptr_t>& jobs)
+{
+	LLMutexLock lock(&mCondition);
+	jobs.swap(mCompleted);
+}
+
+void LLVOCache::IOQueue::waitIdle()
+{
+	while(true)
+	{
+		if(runNext())
+		{
+			continue;
+		}
+
+		LLMutexLock lock(&mCondition);
+		if(!mBusy)
+		{
+			if(mJobs.empty())
+			{
+				return;
+			}
+			continue;
+		}
+		mCondition.wait();
+	}
+}
+
+// Runs the oldest job unless another thread is running one already.
+bool LLVOCache::IOQueue::runNext()
+{
+	io_job_ptr_t job;
+	{
+		LLMutexLock lock(&mCondition);
+		if(mBusy || mJobs.empty())
+		{
+			return false;
+		}
+		job = mJobs.front();
+		mJobs.pop_front();
+		mBusy = true;
+	}
+
+	job->run();
+
+	LLMutexLock lock(&mCondition);
+	mCompleted.push_back(std::move(job));
+	mBusy = false;
+	mCondition.broadcast();
+	return true;
+}
+
+void LLVOCache::IOQueue::drain()
+{
+	while(true)
+	{
+		if(runNext())
+		{
+			continue;
+		}
+
+		// whoever is busy (waitIdle()) takes care of the rest
+		LLMutexLock lock(&mCondition);
+		if(mBusy || mJobs.empty())
+		{
+			mDrainPosted = false;
+			return;
+		}
+	}
+}
+
+//-------------------------------------------------------------------
 
 LLVOCache::LLVOCache():
 	mInitialized(false),
 	mReadOnly(true),
 	mCacheSize(1),
-	mNumEntries(0)
+	mNumEntries(0),
+	mIOQueue(std::make_shared<IOQueue>()),
+	mIOSerial(0),
+	mClearSerial(0)
 {
 	mEnabled = gSavedSettings.getBOOL("ObjectCacheEnabled");
+	mCompress = gSavedSettings.getBOOL("ObjectCacheCompression");
 	mLocalAPRFilePoolp = new LLVolatileAPRPool() ;
 }
 
@@ -1064,6 +1378,10 @@ LLVOCache::~LLVOCache()
 {
 	if(mEnabled)
 	{
+		// finish pending writes, and forget the regions whose write failed
+		mIOQueue->waitIdle();
+		mReadRequests.clear();
+		update();
 		writeCacheHeader();
 		clearCacheInMemory();
 	}
@@ -1133,6 +1451,7 @@ void LLVOCache::removeCache(ELLPath location, bool started)
 	std::string mask = "*";
 	std::string cache_dir = gDirUtilp->getExpandedFilename(location, object_cache_dirname);
 	LL_INFOS() << "Removing cache at " << cache_dir << LL_ENDL;
+	clearPendingIO();
 	gDirUtilp->deleteFilesInDir(cache_dir, mask); //delete all files
 	LLFile::rmdir(cache_dir);
 
@@ -1156,6 +1475,7 @@ void LLVOCache::removeCache()
 
 	std::string mask = "*";
 	LL_INFOS() << "Removing object cache at " << mObjectCacheDirName << LL_ENDL;
+	clearPendingIO();
 	gDirUtilp->deleteFilesInDir(mObjectCacheDirName, mask); 
 
 	clearCacheInMemory() ;
@@ -1231,9 +1551,12 @@ void LLVOCache::removeFromCache(HeaderEntryInfo* entry)
 		return ;
 	}
 
-	std::string filename;
-	getObjectCacheFilename(entry->mHandle, filename);
-	LLAPRFile::remove(filename, mLocalAPRFilePoolp);
+	io_job_ptr_t job = std::make_shared<IOJob>(IOJob::REMOVE, entry->mHandle, ++mIOSerial);
+	getObjectCacheFilename(entry->mHandle, job->mFilename);
+	mWriteSerials[entry->mHandle] = job->mSerial;
+	dropLoaded(entry->mHandle);
+	queueJob(job);
+
 	entry->mTime = INVALID_TIME ;
 	updateEntry(entry) ; //update the head file.
 }
@@ -1381,12 +1704,12 @@ BOOL LLVOCache::updateEntry(const HeaderEntryInfo* entry)
 	return check_write(&apr_file, (void*)entry, sizeof(HeaderEntryInfo)) ;
 }
 
-void LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) 
+bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, const read_callback_t& callback) 
 {
 	if(!mEnabled)
 	{
 		LL_WARNS() << "Not reading cache for handle " << handle << "): Cache is currently disabled." << LL_ENDL;
-		return ;
+		return false;
 	}
 	llassert_always(mInitialized);
 
@@ -1394,58 +1717,161 @@ void LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
 	if(iter == mHandleEntryMap.end()) //no cache
 	{
 		LL_WARNS() << "No handle map entry for " << handle << LL_ENDL;
-		return ;
+		return false;
 	}
 
-	bool success = true ;
+	ReadRequest& request = mReadRequests[handle];
+	request.mCacheID = id;
+	request.mCallback = callback;
+
+	// a prefetched region is handed over by the next update()
+	if(mLoaded.find(handle) == mLoaded.end() && mPendingReads.find(handle) == mPendingReads.end())
 	{
-		std::string filename;
-		getObjectCacheFilename(handle, filename);
-		LLAPRFile apr_file(filename, APR_READ|APR_BINARY, mLocalAPRFilePoolp);
-	
-		LLUUID cache_id ;
-		success = check_read(&apr_file, cache_id.mData, UUID_BYTES) ;
-	
-		if(success)
-		{		
-			if(cache_id != id)
-			{
-				LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
-				success = false ;
-			}
+		queueRead(handle);
+	}
+	return true;
+}
+
+void LLVOCache::cancelRead(U64 handle)
+{
+	mReadRequests.erase(handle);
+}
+
+void LLVOCache::prefetch(U64 handle)
+{
+	if(!mEnabled || !mInitialized)
+	{
+		return;
+	}
+	if(mHandleEntryMap.find(handle) == mHandleEntryMap.end() ||
+	   mLoaded.find(handle) != mLoaded.end() ||
+	   mPendingReads.find(handle) != mPendingReads.end())
+	{
+		return;
+	}
+	queueRead(handle);
+}
 
-			if(success)
+void LLVOCache::update()
+{
+	std::vector<io_job_ptr_t> completed;
+	mIOQueue->popCompleted(completed);
+	for(std::vector<io_job_ptr_t>::iterator iter = completed.begin(); iter != completed.end(); ++iter)
+	{
+		const io_job_ptr_t& job = *iter;
+		std::map<U64, U32>::iterator serial_iter = mWriteSerials.find(job->mHandle);
+		if(job->mType == IOJob::READ)
+		{
+			mPendingReads.erase(job->mHandle);
+			if(job->mSerial < mClearSerial || (serial_iter != mWriteSerials.end() && job->mSerial < serial_iter->second))
 			{
-				S32 num_entries;
-				success = check_read(&apr_file, &num_entries, sizeof(S32)) ;
-	
-				if(success)
+				// the file was rewritten or deleted since, read it again if anybody is waiting
+				if(mReadRequests.find(job->mHandle) != mReadRequests.end())
 				{
-					for (S32 i = 0; i < num_entries && apr_file.eof() != APR_EOF; i++)
-					{
-						LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry(&apr_file);
-						if (!entry->getLocalID())
-						{
-							LL_WARNS() << "Aborting cache file load for " << filename << ", cache file corruption!" << LL_ENDL;
-							success = false ;
-							break ;
-						}
-						cache_entry_map[entry->getLocalID()] = entry;
-					}
+					queueRead(job->mHandle);
 				}
+				continue;
 			}
-		}		
+			addLoaded(job);
+		}
+		else if(job->mType == IOJob::WRITE && !job->mSuccess &&
+				serial_iter != mWriteSerials.end() && serial_iter->second == job->mSerial)
+		{
+			LL_WARNS() << "Failed to write cache for handle " << job->mHandle << LL_ENDL;
+			removeEntry(job->mHandle);
+		}
 	}
-	
-	if(!success)
+
+	if(mReadRequests.empty() || mLoaded.empty())
+	{
+		return;
+	}
+
+	// the callbacks may ask for more regions, so don't hold iterators over them
+	std::vector<U64> ready;
+	for(read_request_map_t::iterator iter = mReadRequests.begin(); iter != mReadRequests.end(); ++iter)
+	{
+		if(mLoaded.find(iter->first) != mLoaded.end())
+		{
+			ready.push_back(iter->first);
+		}
+	}
+	for(std::vector<U64>::iterator iter = ready.begin(); iter != ready.end(); ++iter)
 	{
-		if(cache_entry_map.empty())
+		read_request_map_t::iterator request_iter = mReadRequests.find(*iter);
+		loaded_map_t::iterator loaded_iter = mLoaded.find(*iter);
+		if(request_iter == mReadRequests.end() || loaded_iter == mLoaded.end())
 		{
-			removeEntry(iter->second) ;
+			continue;
 		}
+		ReadRequest request = request_iter->second;
+		io_job_ptr_t job = loaded_iter->second;
+		mReadRequests.erase(request_iter);
+		dropLoaded(*iter);
+		finishRead(*iter, request, *job);
 	}
+}
 
-	return ;
+void LLVOCache::finishRead(U64 handle, const ReadRequest& request, IOJob& job)
+{
+	bool success = job.mSuccess;
+	if(job.mCacheID != request.mCacheID && (success || !job.mEntries.empty()))
+	{
+		LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
+		job.mEntries.clear();
+		success = false;
+	}
+
+	if(!success && job.mEntries.empty())
+	{
+		removeEntry(handle) ;
+	}
+
+	request.mCallback(job.mEntries);
+}
+
+void LLVOCache::queueJob(const io_job_ptr_t& job)
+{
+	mIOQueue->push(job);
+}
+
+void LLVOCache::queueRead(U64 handle)
+{
+	io_job_ptr_t job = std::make_shared<IOJob>(IOJob::READ, handle, ++mIOSerial);
+	getObjectCacheFilename(handle, job->mFilename);
+	mPendingReads.insert(handle);
+	queueJob(job);
+}
+
+void LLVOCache::addLoaded(const io_job_ptr_t& job)
+{
+	dropLoaded(job->mHandle);
+	mLoaded[job->mHandle] = job;
+	mLoadedOrder.push_back(job->mHandle);
+
+	while(mLoaded.size() > MAX_LOADED_REGIONS)
+	{
+		dropLoaded(mLoadedOrder.front());
+	}
+}
+
+void LLVOCache::dropLoaded(U64 handle)
+{
+	if(mLoaded.erase(handle))
+	{
+		mLoadedOrder.erase(std::find(mLoadedOrder.begin(), mLoadedOrder.end(), handle));
+	}
+}
+
+// Waits for the I/O queue and forgets everything read so far, before the
+// cache files are deleted wholesale.
+void LLVOCache::clearPendingIO()
+{
+	mIOQueue->waitIdle();
+	mClearSerial = ++mIOSerial;
+	mWriteSerials.clear();
+	mLoaded.clear();
+	mLoadedOrder.clear();
 }
 	
 void LLVOCache::purgeEntries(U32 size)
@@ -1518,39 +1944,38 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
 		return ; //nothing changed, no need to update.
 	}
 
-	//write to cache file
-	bool success = true ;
+	//write to cache file in the background
+	io_job_ptr_t job = std::make_shared<IOJob>(IOJob::WRITE, handle, ++mIOSerial);
+	getObjectCacheFilename(handle, job->mFilename);
+	job->mCacheID = id;
+	job->mWriteEntries.reserve(cache_entry_map.size());
+	for(LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); iter != cache_entry_map.end(); ++iter)
 	{
-		std::string filename;
-		getObjectCacheFilename(handle, filename);
-		LLAPRFile apr_file(filename, APR_CREATE|APR_WRITE|APR_BINARY, mLocalAPRFilePoolp);
-	
-		success = check_write(&apr_file, (void*)id.mData, UUID_BYTES) ;
-
-	
-		if(success)
+		const LLVOCacheEntry* entry = iter->second;
+		if(removal_enabled && !entry->isValid())
 		{
-			S32 num_entries = cache_entry_map.size() ;
-			success = check_write(&apr_file, &num_entries, sizeof(S32));
-	
-			for (LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); success && iter != cache_entry_map.end(); ++iter)
-			{
-				if(!removal_enabled || iter->second->isValid())
-				{
-					success = iter->second->writeToFile(&apr_file) ;
-					if(!success)
-					{
-						break;
-					}
-				}
-			}
+			continue;
 		}
-	}
 
-	if(!success)
-	{
-		removeEntry(entry) ;
+		job->mWriteEntries.push_back(IOJob::WriteEntry());
+		IOJob::WriteEntry& write_entry = job->mWriteEntries.back();
+		write_entry.mRecord.mLocalID = entry->getLocalID();
+		write_entry.mRecord.mCRC = entry->getCRC();
+		write_entry.mRecord.mHitCount = entry->getHitCount();
+		write_entry.mRecord.mDupeCount = entry->getDupeCount();
+		write_entry.mRecord.mCRCChangeCount = entry->getCRCChangeCount();
+		if(entry->isPacked())
+		{
+			// the file contents it points into are never changed
+			write_entry.mPacked = entry->getPackedData();
+		}
+		else if(entry->getBufferSize() > 0)
+		{
+			write_entry.mData.assign(entry->getBuffer(), entry->getBuffer() + entry->getBufferSize());
+		}
 	}
-
-	return ;
+	job->mCompress = mCompress;
+	mWriteSerials[handle] = job->mSerial;
+	dropLoaded(handle);
+	queueJob(job);
 }
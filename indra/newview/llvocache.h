@@ -33,6 +33,11 @@
 #include "llvieweroctree.h"
 #include "llapr.h"
 
+#include <boost/function.hpp>
+#include <deque>
+#include <memory>
+#include <vector>
+
 //---------------------------------------------------------------------------
 // Cache entries
 class LLCamera;
@@ -82,8 +87,21 @@ public:
 protected:
 	~LLVOCacheEntry();
 public:
+	// An object update the way a cache file stores it: mStoredSize bytes
+	// at mOffset in the file contents, deflated unless mStoredSize == mSize.
+	struct PackedData
+	{
+		PackedData() : mOffset(0), mStoredSize(0), mSize(0) {}
+
+		std::shared_ptr<const std::vector<U8> > mFile;
+		U32 mOffset;
+		U32 mStoredSize;
+		U32 mSize;
+	};
+
 	LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &dp);
-	LLVOCacheEntry(LLAPRFile* apr_file);
+	// Read from a cache file. The update is only unpacked by getDP().
+	LLVOCacheEntry(U32 local_id, U32 crc, S32 hit_count, S32 dupe_count, S32 crc_change_count, const PackedData& packed);
 	LLVOCacheEntry();	
 
 	void updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp);
@@ -100,14 +118,20 @@ public:
 	U32 getCRC() const				{ return mCRC; }
 	S32 getHitCount() const			{ return mHitCount; }
 	S32 getCRCChangeCount() const	{ return mCRCChangeCount; }
+	S32 getDupeCount() const		{ return mDupeCount; }
 	
 	void calcSceneContribution(const LLVector4a& camera_origin, bool needs_update, U32 last_update, F32 dist_threshold);
 	void setSceneContribution(F32 scene_contrib) {mSceneContrib = scene_contrib;}
 	F32 getSceneContribution() const             { return mSceneContrib;}
 
 	void dump() const;
-	BOOL writeToFile(LLAPRFile* apr_file) const;
 	LLDataPackerBinaryBuffer *getDP();
+	// Still in the form it was read from the cache file in
+	bool isPacked() const { return mPacked.mFile != nullptr; }
+	const PackedData& getPackedData() const { return mPacked; }
+	// The unpacked update, for writing it out without unpacking it again
+	const U8* getBuffer() const { return mBuffer; }
+	S32 getBufferSize() const { return mDP.getBufferSize(); }
 	void recordHit();
 	void recordDupe() { mDupeCount++; }
 	
@@ -138,6 +162,7 @@ public:
 
 private:
 	void updateParentBoundingInfo(const LLVOCacheEntry* child);	
+	void unpack();
 
 public:
 	typedef std::map<U32, LLPointer<LLVOCacheEntry> >	   vocache_entry_map_t;
@@ -155,6 +180,7 @@ protected:
 	S32							mCRCChangeCount;
 	LLDataPackerBinaryBuffer	mDP;
 	U8							*mBuffer;
+	PackedData                  mPacked;
 
 	F32                         mSceneContrib; //projected scene contributuion of this object.
 	U32                         mState; //high 16 bits reserved for special use.
@@ -219,7 +245,9 @@ private:
 };
 
 //
-//Note: LLVOCache is not thread-safe
+//Note: LLVOCache is not thread-safe. The region cache files are read and
+//written by a background I/O queue, but everything else, including the
+//callbacks of readFromCache(), happens on the main thread.
 //
 class LLVOCache : public LLSingleton<LLVOCache>
 {
@@ -257,14 +285,43 @@ private:
 	typedef std::set<HeaderEntryInfo*, header_entry_less> header_entry_queue_t;
 	typedef std::map<U64, HeaderEntryInfo*> handle_entry_map_t;
 
+	// defined in llvocache.cpp
+	struct IOJob;
+	class IOQueue;
+	typedef std::shared_ptr<IOJob> io_job_ptr_t;
+
+	struct ReadRequest
+	{
+		LLUUID mCacheID;
+		boost::function<void(LLVOCacheEntry::vocache_entry_map_t&)> mCallback;
+	};
+	typedef std::map<U64, ReadRequest> read_request_map_t;
+	typedef std::map<U64, io_job_ptr_t> loaded_map_t;
+
 public:
+	typedef boost::function<void(LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)> read_callback_t;
+
 	void initCache(ELLPath location, U32 size, U32 cache_version) ;
 	void removeCache(ELLPath location, bool started = false) ;
 
-	void readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) ;
+	// Starts loading the cache file of a region in the background. Returns
+	// false if there is nothing to load, otherwise callback is called from
+	// update() once the entries are ready (with an empty map if the file
+	// turned out to be unusable), unless cancelRead() is called first.
+	bool readFromCache(U64 handle, const LLUUID& id, const read_callback_t& callback) ;
+	void cancelRead(U64 handle) ;
+	// Speculatively loads the cache file of a region the agent may be about
+	// to enter, so that a later readFromCache() completes without touching
+	// the disk. Does nothing if the region has no cache file.
+	void prefetch(U64 handle) ;
+	// The entries are copied and written in the background, they may be
+	// changed as soon as this returns.
 	void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, BOOL dirty_cache, bool removal_enabled);
 	void removeEntry(U64 handle) ;
 
+	// Delivers finished reads and handles failed writes. Main thread, once per frame.
+	void update() ;
+
 	void setReadOnly(bool read_only) {mReadOnly = read_only;} 
 
 private:
@@ -279,11 +336,19 @@ private:
 	void removeEntry(HeaderEntryInfo* entry) ;
 	void purgeEntries(U32 size);
 	BOOL updateEntry(const HeaderEntryInfo* entry);
+
+	void queueJob(const io_job_ptr_t& job);
+	void queueRead(U64 handle);
+	void finishRead(U64 handle, const ReadRequest& request, IOJob& job);
+	void addLoaded(const io_job_ptr_t& job);
+	void dropLoaded(U64 handle);
+	void clearPendingIO();
 	
 private:
 	bool                 mEnabled;
 	bool                 mInitialized ;
 	bool                 mReadOnly ;
+	bool                 mCompress ;
 	HeaderMetaInfo       mMetaInfo;
 	U32                  mCacheSize;
 	U32                  mNumEntries;
@@ -292,6 +357,15 @@ private:
 	LLVolatileAPRPool*   mLocalAPRFilePoolp ; 	
 	header_entry_queue_t mHeaderEntryQueue;
 	handle_entry_map_t   mHandleEntryMap;	
+
+	std::shared_ptr<IOQueue> mIOQueue;
+	U32                  mIOSerial;       // stamps every queued job
+	U32                  mClearSerial;    // mIOSerial when the cache was last wiped
+	std::map<U64, U32>   mWriteSerials;   // mIOSerial of the last write or removal of each region
+	std::set<U64>        mPendingReads;   // regions with a read in the I/O queue
+	read_request_map_t   mReadRequests;   // reads waiting for their region to be loaded
+	loaded_map_t         mLoaded;         // loaded regions nobody asked for yet
+	std::deque<U64>      mLoadedOrder;    // oldest first
 };
 
 #endif
@@ -217,6 +217,12 @@ LLViewerRegion* LLWorld::addRegion(const U64 &region_handle, const LLHost &host)
 	mActiveRegionList.push_back(regionp);
 	mCulledRegionList.push_back(regionp);
 
+	// The handshake that asks for the object cache is still some way off,
+	// start reading it now.
+	if (LLVOCache::instanceExists())
+	{
+		LLVOCache::getInstance()->prefetch(region_handle);
+	}
 
 	// Find all the adjacent regions, and attach them.
 	// Generate handles for all of the adjacent regions, and attach them in the correct way.
@@ -287,6 +293,29 @@ LLViewerRegion* LLWorld::addRegion(const U64 &region_handle, const LLHost &host)
 }
 
 
+void LLWorld::prefetchObjectCaches(const U64 &region_handle)
+{
+	// only for the usual region size, the cache has no idea how big a region is
+	if (mWidth != 256 || mLength != 256 || !LLVOCache::instanceExists())
+	{
+		return;
+	}
+
+	F32 region_x = 0.f;
+	F32 region_y = 0.f;
+	from_region_handle(region_handle, &region_x, &region_y);
+	F32 width = getRegionWidthInMeters();
+	for (S32 dir = 0; dir < 8; dir++)
+	{
+		U64 adj_handle = 0;
+		to_region_handle(region_x + width * gDirAxes[dir][0], region_y + width * gDirAxes[dir][1], &adj_handle);
+		if (!getRegionFromHandle(adj_handle))
+		{
+			LLVOCache::getInstance()->prefetch(adj_handle);
+		}
+	}
+}
+
 void LLWorld::removeRegion(const LLHost &host)
 {
 	F32 x, y;
@@ -730,6 +759,12 @@ void LLWorld::updateRegions(F32 max_update_time)
 {
 	LLTimer update_timer;
 	mNumOfActiveCachedObjects = 0;
+
+	// hand the object caches that finished loading to their regions
+	if(LLVOCache::instanceExists())
+	{
+		LLVOCache::getInstance()->update();
+	}
 	
 	if(LLViewerCamera::getInstance()->isChanged())
 	{
@@ -82,6 +82,9 @@ public:
 		// safe to call if already present, does the "right thing" if
 		// hosts are same, or if hosts are different, etc...
 	void			removeRegion(const LLHost &host);
+	// Starts loading the object caches of the regions around this one
+	// that we are not connected to yet.
+	void			prefetchObjectCaches(const U64 &region_handle);
 
 	void	disconnectRegions(); // Send quit messages to all child regions
 